@@ -962,6 +962,9 @@ void MarblePart::setupActions()
         connect( (*it), SIGNAL(actionGroupsChanged()),
                  this, SLOT(createPluginMenus()) );
     }
+    // Plugins disabled by default are created when they get enabled
+    connect( m_controlView->marbleWidget(), SIGNAL(renderPluginLoaded(RenderPlugin*)),
+             this, SLOT(addRenderPluginMenus(RenderPlugin*)) );
 
     m_addBookmarkAction = new KAction( this );
     actionCollection()->addAction( "add_bookmark", m_addBookmarkAction );
@@ -1156,6 +1159,17 @@ void MarblePart::mapThemeChanged( const QString& newMapTheme )
     updateStatusBar();
 }
 
+void MarblePart::addRenderPluginMenus( RenderPlugin *renderPlugin )
+{
+    connect( renderPlugin, SIGNAL(actionGroupsChanged()),
+             this, SLOT(createPluginMenus()) );
+
+    createInfoBoxesMenu();
+    createOnlineServicesMenu();
+    createRenderPluginActions();
+    createPluginMenus();
+}
+
 void MarblePart::createPluginMenus()
 {
     unplugActionList("plugins_actionlist");
@@ -1562,7 +1576,7 @@ void MarblePart::editSettings()
     // plugin page
     MarblePluginSettingsWidget *w_pluginSettings = new MarblePluginSettingsWidget();
     RenderPluginModel *const pluginModel = new RenderPluginModel( w_pluginSettings );
-    pluginModel->setRenderPlugins( m_controlView->marbleWidget()->renderPlugins() );
+    pluginModel->setRenderPlugins( m_controlView->marbleWidget() );
     w_pluginSettings->setModel( pluginModel );
     w_pluginSettings->setObjectName( "plugin_page" );
     m_configDialog->addPage( w_pluginSettings, i18n( "Plugins" ),
@@ -1760,6 +1774,13 @@ void MarblePart::readPluginSettings()
 
     KSharedConfig::Ptr sharedConfig = KSharedConfig::openConfig( KGlobal::mainComponent() );
 
+    foreach( const RenderPluginMetaData &metaData, m_controlView->marbleWidget()->unloadedRenderPlugins() ) {
+        KConfigGroup group = sharedConfig->group( QString( "plugin_" ) + metaData.nameId );
+        if ( group.readEntry( "enabled", false ) ) {
+            m_controlView->marbleWidget()->loadRenderPlugin( metaData.nameId );
+        }
+    }
+
     foreach( RenderPlugin *plugin, m_controlView->marbleWidget()->renderPlugins() ) {
         KConfigGroup group = sharedConfig->group( QString( "plugin_" ) + plugin->nameId() );
 
@@ -52,6 +52,7 @@ class RoutingProfilesWidget;
 class SunControlWidget;
 class TimeControlWidget;
 class GeoDataFolder;
+class RenderPlugin;
 
 class MarblePart: public KParts::ReadOnlyPart
 {
@@ -133,6 +134,7 @@ class MarblePart: public KParts::ReadOnlyPart
     void  removeProgressItem();
 
     void  lockFloatItemPosition( bool );
+    void  addRenderPluginMenus( RenderPlugin *renderPlugin );
     void  controlSun();
     void  controlTime();
     void  showSun( bool );
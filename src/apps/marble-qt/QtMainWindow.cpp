@@ -553,6 +553,9 @@ void MainWindow::createMenus( const QList<QAction*> &panelActions )
             connect( (*it), SIGNAL(actionGroupsChanged()),
                      this, SLOT(createPluginMenus()) );
         }
+        // Plugins disabled by default are created when they get enabled
+        connect( m_controlView->marbleWidget(), SIGNAL(renderPluginLoaded(RenderPlugin*)),
+                 this, SLOT(addRenderPluginMenus(RenderPlugin*)) );
 }
 
 void MainWindow::createPluginsMenus()
@@ -715,6 +718,15 @@ void MainWindow::openEditBookmarkDialog()
     delete dialog;
 }
 
+void MainWindow::addRenderPluginMenus( RenderPlugin *renderPlugin )
+{
+    connect( renderPlugin, SIGNAL(actionGroupsChanged()),
+             this, SLOT(createPluginMenus()) );
+
+    createPluginsMenus();
+    createPluginMenus();
+}
+
 void MainWindow::createPluginMenus()
 {
     // Remove and delete toolbars if they exist
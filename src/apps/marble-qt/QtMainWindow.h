@@ -37,6 +37,7 @@ class TimeControlWidget;
 class QtMarbleConfigDialog;
 class DownloadRegionDialog;
 class MovieCaptureDialog;
+class RenderPlugin;
 
 class MainWindow : public QMainWindow
 {
@@ -106,6 +107,7 @@ private Q_SLOTS:
     void  lockPosition( bool );
     void  createPluginsMenus();
     void  createPluginMenus();
+    void  addRenderPluginMenus( RenderPlugin *renderPlugin );
     void  showClouds( bool );
     void  controlSun();
     void  controlTime();
@@ -22,6 +22,7 @@
 #include "MapThemeManager.h"
 #include "MarbleDirs.h"
 #include "MarbleDebug.h"
+#include "MarbleProfiler.h"
 #include "MarbleTest.h"
 #include "MarbleLocale.h"
 #include "GeoUriParser.h"
@@ -98,6 +99,7 @@ int main(int argc, char *argv[])
     QString coordinatesString;
     QString distanceString;
     QString geoUriString;
+    QString profileFile;
     MarbleGlobal::Profiles profiles = MarbleGlobal::detectProfiles();
 
     QStringList args = QApplication::arguments();
@@ -119,6 +121,7 @@ int main(int argc, char *argv[])
         qWarning() << "  --debug-info ............... write (more) debugging information to the console";
         qWarning() << "  --fps ...................... Show the paint performance (paint rate) in the top left corner";
         qWarning() << "  --runtimeTrace.............. Show the time spent and other debug info of each layer";
+        qWarning() << "  --profile=<file> ........... Record timings and write them to a Chrome trace file on exit";
         qWarning() << "  --tile-id................... Write the identifier of texture tiles on top of them";
         qWarning() << "  --timedemo ................. Measure the paint performance while moving the map and quit";
         qWarning();
@@ -136,6 +139,11 @@ int main(int argc, char *argv[])
         {
             MarbleDebug::setEnabled( true );
         }
+        else if ( arg.startsWith( QLatin1String( "--profile=" ), Qt::CaseInsensitive ) )
+        {
+            profileFile = arg.mid(10);
+            MarbleProfiler::setEnabled( true );
+        }
         else if ( arg.startsWith( QLatin1String( "--marbledatapath=" ), Qt::CaseInsensitive ) )
         {
             marbleDataPath = args.at(i).mid(17);
@@ -255,5 +263,11 @@ int main(int argc, char *argv[])
             window->addGeoDataFile( arg );
     }
 
-    return app.exec();
+    const int result = app.exec();
+
+    if ( !profileFile.isEmpty() ) {
+        MarbleProfiler::writeChromeTrace( profileFile );
+    }
+
+    return result;
 }
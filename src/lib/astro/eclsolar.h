@@ -19,6 +19,13 @@ const int MAXLUN = 15;
 
 typedef double PMJD[MAXLUN];  // array of MJD's of the respective phase
 
+// EclSolar keeps all of its state in data members and uses no global or
+// static data, so independent instances can be used in different threads at
+// the same time. A single instance must not be shared between threads since
+// most calls select or advance the eclipse it works on. Copies are cheap and
+// carry over the state, e.g. the eclipses of a year calculated by
+// getNumberEclYear(), so a configured instance can be copied for each thread.
+
 class ASTROLIB_EXPORT EclSolar     // Calculate Solar Eclipses
 {
   public:
@@ -19,6 +19,9 @@
 #include <QVariant>
 #include <QAbstractListModel>
 #include <QMetaProperty>
+#include <QRectF>
+#include <QSet>
+#include <QVector>
 
 // Marble
 #include "MarbleDebug.h"
@@ -170,6 +173,193 @@ void AbstractDataPluginModel::themeChanged()
     }
 }
 
+/**
+  * Screen space grid of the bounding rectangles of the items accepted so far.
+  * Each rectangle is stored in all cells it overlaps, so a collision test only
+  * looks at the rectangles in the cells overlapped by the tested one.
+  */
+class ItemCollisionGrid
+{
+public:
+    bool intersects( const QRectF &rect ) const
+    {
+        int left, top, right, bottom;
+        if ( !cellRange( rect, left, top, right, bottom ) ) {
+            foreach( const QRectF &other, m_oversized ) {
+                if ( other.intersects( rect ) ) {
+                    return true;
+                }
+            }
+            foreach( const QVector<QRectF> &cell, m_cells ) {
+                foreach( const QRectF &other, cell ) {
+                    if ( other.intersects( rect ) ) {
+                        return true;
+                    }
+                }
+            }
+            return false;
+        }
+
+        foreach( const QRectF &other, m_oversized ) {
+            if ( other.intersects( rect ) ) {
+                return true;
+            }
+        }
+
+        for ( int y = top; y <= bottom; ++y ) {
+            for ( int x = left; x <= right; ++x ) {
+                QHash<qint64, QVector<QRectF> >::const_iterator const cell = m_cells.constFind( key( x, y ) );
+                if ( cell == m_cells.constEnd() ) {
+                    continue;
+                }
+                foreach( const QRectF &other, cell.value() ) {
+                    if ( other.intersects( rect ) ) {
+                        return true;
+                    }
+                }
+            }
+        }
+
+        return false;
+    }
+
+    void insert( const QRectF &rect )
+    {
+        int left, top, right, bottom;
+        if ( !cellRange( rect, left, top, right, bottom ) ) {
+            m_oversized.append( rect );
+            return;
+        }
+
+        for ( int y = top; y <= bottom; ++y ) {
+            for ( int x = left; x <= right; ++x ) {
+                m_cells[key( x, y )].append( rect );
+            }
+        }
+    }
+
+private:
+    enum { CellSize = 64, MaxCellsPerAxis = 32 };
+
+    static qint64 key( int x, int y )
+    {
+        return ( qint64( x ) << 32 ) | quint32( y );
+    }
+
+    /**
+      * Determines the cells overlapped by @p rect. Returns false for rectangles
+      * that are too large to be stored in single cells.
+      */
+    static bool cellRange( const QRectF &rect, int &left, int &top, int &right, int &bottom )
+    {
+        QRectF const normalized = rect.normalized();
+        qreal const minX = std::floor( normalized.left() / CellSize );
+        qreal const minY = std::floor( normalized.top() / CellSize );
+        qreal const maxX = std::floor( normalized.right() / CellSize );
+        qreal const maxY = std::floor( normalized.bottom() / CellSize );
+        if ( maxX - minX >= MaxCellsPerAxis || maxY - minY >= MaxCellsPerAxis
+             || qAbs( minX ) > 1e8 || qAbs( minY ) > 1e8 ) {
+            return false;
+        }
+
+        left = int( minX );
+        top = int( minY );
+        right = int( maxX );
+        bottom = int( maxY );
+        return true;
+    }
+
+    QHash<qint64, QVector<QRectF> > m_cells;
+    QVector<QRectF> m_oversized;
+};
+
+/**
+  * Conservative geographic pre-filter for the items of a viewport. The view box
+  * is enlarged by the angular distance an item of the largest size can extend
+  * beyond the screen, including the strong distortion at the horizon of the globe.
+  * Items outside of the enlarged box cannot have a position on the screen.
+  */
+class ViewCullingBox
+{
+public:
+    ViewCullingBox( const ViewportParams *viewport, const QList<AbstractDataPluginItem*> &items ) :
+        m_enabled( false ),
+        m_fullLongitude( true ),
+        m_north( M_PI / 2 ),
+        m_south( -M_PI / 2 ),
+        m_west( -M_PI ),
+        m_east( M_PI )
+    {
+        GeoDataLatLonAltBox const box = viewport->viewLatLonAltBox();
+        qreal const radius = viewport->radius();
+        if ( box.isEmpty() || radius <= 0 ) {
+            return;
+        }
+
+        qreal extent = 0.0;
+        foreach( const AbstractDataPluginItem *item, items ) {
+            QSizeF const size = item->size();
+            extent = qMax( extent, qMax( size.width(), size.height() ) );
+        }
+
+        // Largest angular distance covered by extent pixels: linear in the center,
+        // growing with the square root of the distance at the horizon of the globe
+        qreal const ratio = qMin<qreal>( 1.0, ( extent + 2.0 ) / radius );
+        qreal const margin = ratio + std::acos( 1.0 - ratio );
+
+        m_north = qMin<qreal>( M_PI / 2, box.north() + margin );
+        m_south = qMax<qreal>( -M_PI / 2, box.south() - margin );
+        m_enabled = true;
+
+        qreal const maxLatitude = qMax( qAbs( m_north ), qAbs( m_south ) );
+        qreal const cosLatitude = std::cos( maxLatitude );
+        if ( cosLatitude < 0.01 ) {
+            return;
+        }
+
+        qreal const lonMargin = margin / cosLatitude;
+        if ( box.width() + 2 * lonMargin >= 2 * M_PI ) {
+            return;
+        }
+
+        m_fullLongitude = false;
+        m_west = GeoDataCoordinates::normalizeLon( box.west() - lonMargin );
+        m_east = GeoDataCoordinates::normalizeLon( box.east() + lonMargin );
+    }
+
+    bool mayBeVisible( const AbstractDataPluginItem *item ) const
+    {
+        if ( !m_enabled ) {
+            return true;
+        }
+
+        qreal lon, lat;
+        item->coordinate().geoCoordinates( lon, lat );
+        if ( lat > m_north || lat < m_south ) {
+            return false;
+        }
+
+        if ( m_fullLongitude ) {
+            return true;
+        }
+
+        if ( m_west <= m_east ) {
+            return lon >= m_west && lon <= m_east;
+        }
+
+        // crosses the date line
+        return lon >= m_west || lon <= m_east;
+    }
+
+private:
+    bool m_enabled;
+    bool m_fullLongitude;
+    qreal m_north;
+    qreal m_south;
+    qreal m_west;
+    qreal m_east;
+};
+
 static bool lessThanByPointer( const AbstractDataPluginItem *item1,
                                const AbstractDataPluginItem *item2 )
 {
@@ -304,6 +494,11 @@ QList<AbstractDataPluginItem*> AbstractDataPluginModel::items( const ViewportPar
         d->m_needsSorting =  false;
     }
 
+    QSet<AbstractDataPluginItem*> const displayedItems = d->m_displayedItems.toSet();
+    QSet<AbstractDataPluginItem*> accepted;
+    ItemCollisionGrid collisionGrid;
+    ViewCullingBox const cullingBox( viewport, candidates );
+
     QList<AbstractDataPluginItem*>::const_iterator i = candidates.constBegin();
     QList<AbstractDataPluginItem*>::const_iterator end = candidates.constEnd();
 
@@ -318,33 +513,40 @@ QList<AbstractDataPluginItem*> AbstractDataPluginModel::items( const ViewportPar
         if( d->m_favoriteItemsOnly && !(*i)->isFavorite() ) {
             continue;
         }
-        
-        (*i)->setProjection( viewport );
-        if( (*i)->positions().isEmpty() ) {
+
+        if ( accepted.contains( *i ) ) {
+            continue;
+        }
+
+        // Skip the projection of items that are far outside of the view
+        if ( !cullingBox.mayBeVisible( *i ) ) {
             continue;
         }
 
-        if ( list.contains( *i ) ) {
+        (*i)->setProjection( viewport );
+        if( (*i)->positions().isEmpty() ) {
             continue;
         }
 
         // If the item was added initially at a nearer position, they don't have priority,
         // because we zoomed out since then.
-        bool const alreadyDisplayed = d->m_displayedItems.contains( *i );
+        bool const alreadyDisplayed = displayedItems.contains( *i );
         if ( !alreadyDisplayed || (*i)->addedAngularResolution() >= viewport->angularResolution() || (*i)->isSticky() ) {
+            QList<QRectF> const boundingRects = (*i)->boundingRects();
             bool collides = false;
-            int const length = list.length();
-            for ( int j=0; !collides && j<length; ++j ) {
-                foreach( const QRectF &rect, list[j]->boundingRects() ) {
-                    foreach( const QRectF &itemRect, (*i)->boundingRects() ) {
-                        if ( rect.intersects( itemRect ) )
-                            collides = true;
-                    }
+            foreach( const QRectF &itemRect, boundingRects ) {
+                if ( collisionGrid.intersects( itemRect ) ) {
+                    collides = true;
+                    break;
                 }
             }
 
             if ( !collides ) {
                 list.append( *i );
+                accepted.insert( *i );
+                foreach( const QRectF &itemRect, boundingRects ) {
+                    collisionGrid.insert( itemRect );
+                }
                 (*i)->setSettings( d->m_itemSettings );
 
                 // We want to save the angular resolution of the first time the item got added.
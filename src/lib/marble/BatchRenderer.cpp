@@ -0,0 +1,340 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2014 The Marble contributors
+//
+
+#include "BatchRenderer.h"
+
+#include "MarbleDebug.h"
+#include "MarbleMap.h"
+#include "MarbleModel.h"
+#include "OffscreenRenderer.h"
+
+#include <QImage>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QTime>
+#include <QWaitCondition>
+
+#include <algorithm>
+#include <cmath>
+
+namespace Marble
+{
+
+BatchRenderJob::BatchRenderJob() :
+    m_projection( Spherical ),
+    m_zoom( 0 )
+{
+}
+
+BatchRenderJob::BatchRenderJob( const QString &mapThemeId, Projection projection,
+                                const GeoDataCoordinates &center, int zoom,
+                                const QSize &size, const QString &outputFile ) :
+    m_mapThemeId( mapThemeId ),
+    m_projection( projection ),
+    m_center( center ),
+    m_zoom( zoom ),
+    m_size( size ),
+    m_outputFile( outputFile )
+{
+}
+
+QString BatchRenderJob::mapThemeId() const
+{
+    return m_mapThemeId;
+}
+
+Projection BatchRenderJob::projection() const
+{
+    return m_projection;
+}
+
+GeoDataCoordinates BatchRenderJob::center() const
+{
+    return m_center;
+}
+
+int BatchRenderJob::zoom() const
+{
+    return m_zoom;
+}
+
+QSize BatchRenderJob::size() const
+{
+    return m_size;
+}
+
+QString BatchRenderJob::outputFile() const
+{
+    return m_outputFile;
+}
+
+namespace
+{
+
+bool renderOrderLessThan( const BatchRenderJob &a, const BatchRenderJob &b )
+{
+    if ( a.mapThemeId() != b.mapThemeId() ) {
+        return a.mapThemeId() < b.mapThemeId();
+    }
+    if ( a.projection() != b.projection() ) {
+        return a.projection() < b.projection();
+    }
+    if ( a.size().width() != b.size().width() ) {
+        return a.size().width() < b.size().width();
+    }
+    return a.size().height() < b.size().height();
+}
+
+}
+
+class BatchRenderer::Private
+{
+public:
+    explicit Private( MarbleModel *model );
+
+    /** Takes the next job of the running render() call; returns false if none is left */
+    bool takeJob( BatchRenderJob &job );
+
+    /** Paints a job into @p map and hands over the image to the writer threads */
+    void renderJob( MarbleMap *map, const BatchRenderJob &job );
+
+    MarbleMap m_map;
+    QList<BatchRenderJob> m_jobs;
+    int m_imageQuality;
+    int m_maximumWaitTime;
+    int m_renderThreadCount;
+    OffscreenRenderer m_offscreenRenderer;
+    qreal m_jobsPerSecond;
+
+    // The jobs of the running render() call, shared with the render threads
+    QMutex m_queueMutex;
+    QWaitCondition m_jobFinished;
+    QList<BatchRenderJob> m_queue;
+    int m_finishedJobs;
+    // The state of map() at the start of render(), taken over by the render threads
+    OffscreenRenderer::MapState m_mapState;
+
+    /**
+      * Paints jobs with a model and a map of its own
+      */
+    class RenderThread : public QThread
+    {
+    public:
+        explicit RenderThread( Private *renderer ) :
+            m_renderer( renderer )
+        {
+        }
+
+        virtual void run()
+        {
+            // Both are created here so that they belong to this thread
+            MarbleModel model;
+            MarbleMap map( &model );
+            m_renderer->m_mapState.apply( &map );
+            OffscreenRenderer::waitForFiles( &model );
+
+            BatchRenderJob job;
+            while ( m_renderer->takeJob( job ) ) {
+                m_renderer->renderJob( &map, job );
+            }
+        }
+
+    private:
+        Private *const m_renderer;
+    };
+};
+
+BatchRenderer::Private::Private( MarbleModel *model ) :
+    m_map( model ),
+    m_imageQuality( -1 ),
+    m_maximumWaitTime( 0 ),
+    m_renderThreadCount( 1 ),
+    m_jobsPerSecond( 0.0 ),
+    m_finishedJobs( 0 )
+{
+    m_map.setViewContext( Still );
+}
+
+bool BatchRenderer::Private::takeJob( BatchRenderJob &job )
+{
+    QMutexLocker locker( &m_queueMutex );
+    if ( m_queue.isEmpty() ) {
+        return false;
+    }
+
+    job = m_queue.takeFirst();
+    return true;
+}
+
+void BatchRenderer::Private::renderJob( MarbleMap *map, const BatchRenderJob &job )
+{
+    if ( map->mapThemeId() != job.mapThemeId() ) {
+        // A new theme starts with default property values and loads its own documents
+        map->setMapThemeId( job.mapThemeId() );
+        m_mapState.applyProperties( map );
+        OffscreenRenderer::waitForFiles( map->model() );
+    }
+    map->setProjection( job.projection() );
+    map->setSize( job.size() );
+    map->setRadius( qRound( std::exp( job.zoom() / 200.0 ) ) );
+    map->centerOn( job.center().longitude( GeoDataCoordinates::Degree ),
+                   job.center().latitude( GeoDataCoordinates::Degree ) );
+
+    QImage image( job.size(), QImage::Format_ARGB32_Premultiplied );
+    OffscreenRenderer::paintComplete( map, image, Qt::transparent, m_maximumWaitTime );
+    m_offscreenRenderer.write( image, job.outputFile(), m_imageQuality );
+
+    QMutexLocker locker( &m_queueMutex );
+    ++m_finishedJobs;
+    m_jobFinished.wakeAll();
+}
+
+BatchRenderer::BatchRenderer( MarbleModel *model, QObject *parent ) :
+    QObject( parent ),
+    d( new Private( model ) )
+{
+}
+
+BatchRenderer::~BatchRenderer()
+{
+    delete d;
+}
+
+MarbleMap *BatchRenderer::map()
+{
+    return &d->m_map;
+}
+
+void BatchRenderer::addJob( const BatchRenderJob &job )
+{
+    d->m_jobs << job;
+}
+
+int BatchRenderer::jobCount() const
+{
+    return d->m_jobs.size();
+}
+
+void BatchRenderer::setImageQuality( int quality )
+{
+    d->m_imageQuality = quality;
+}
+
+void BatchRenderer::setMaximumWaitTime( int msecs )
+{
+    d->m_maximumWaitTime = msecs;
+}
+
+void BatchRenderer::setRenderThreadCount( int count )
+{
+    d->m_renderThreadCount = qMax( 1, count );
+}
+
+int BatchRenderer::renderThreadCount() const
+{
+    return d->m_renderThreadCount;
+}
+
+void BatchRenderer::setWriterThreadCount( int count )
+{
+    d->m_offscreenRenderer.setWriterThreadCount( count );
+}
+
+bool BatchRenderer::render()
+{
+    QList<BatchRenderJob> jobs = d->m_jobs;
+    d->m_jobs.clear();
+    d->m_offscreenRenderer.clearWriteErrors();
+
+    std::stable_sort( jobs.begin(), jobs.end(), renderOrderLessThan );
+    const int total = jobs.size();
+    {
+        QMutexLocker locker( &d->m_queueMutex );
+        d->m_queue = jobs;
+        d->m_finishedJobs = 0;
+    }
+
+    QTime time;
+    time.start();
+
+    // The render threads start from the state of map() once its documents are loaded
+    OffscreenRenderer::waitForFiles( d->m_map.model() );
+    d->m_mapState = OffscreenRenderer::MapState( &d->m_map );
+
+    QList<Private::RenderThread *> threads;
+    int threadCount = qMin( d->m_renderThreadCount, total );
+    if ( threadCount > 1 && !d->m_mapState.isCopyable() ) {
+        mDebug() << "Rendering in one thread: the model holds documents which are not backed by a file";
+        threadCount = 1;
+    }
+    for ( int i = 1; i < threadCount; ++i ) {
+        threads << new Private::RenderThread( d );
+        threads.last()->start();
+    }
+
+    // Paints jobs until the queue is empty, then waits for the render threads
+    int finished = 0;
+    while ( finished < total ) {
+        BatchRenderJob job;
+        const bool hasJob = d->takeJob( job );
+        if ( hasJob ) {
+            d->renderJob( &d->m_map, job );
+        }
+
+        int finishedJobs = 0;
+        {
+            QMutexLocker locker( &d->m_queueMutex );
+            if ( !hasJob && d->m_finishedJobs == finished ) {
+                d->m_jobFinished.wait( &d->m_queueMutex );
+            }
+            finishedJobs = d->m_finishedJobs;
+        }
+        while ( finished < finishedJobs ) {
+            emit progress( ++finished, total );
+        }
+    }
+
+    foreach ( Private::RenderThread *thread, threads ) {
+        thread->wait();
+    }
+    qDeleteAll( threads );
+    d->m_offscreenRenderer.waitForDone();
+
+    const int elapsed = qMax( 1, time.elapsed() );
+    d->m_jobsPerSecond = 1000.0 * total / elapsed;
+
+    typedef QPair<QString, QString> WriteError;
+    const QList<WriteError> errors = d->m_offscreenRenderer.writeErrors();
+    foreach ( const WriteError &error, errors ) {
+        emit writeFailed( error.first, error.second );
+    }
+
+    return errors.isEmpty();
+}
+
+QStringList BatchRenderer::failedFiles() const
+{
+    QStringList result;
+    typedef QPair<QString, QString> WriteError;
+    foreach ( const WriteError &error, d->m_offscreenRenderer.writeErrors() ) {
+        result << error.first;
+    }
+    return result;
+}
+
+qreal BatchRenderer::jobsPerSecond() const
+{
+    return d->m_jobsPerSecond;
+}
+
+}
+
+#include "BatchRenderer.moc"
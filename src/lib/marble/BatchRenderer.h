@@ -0,0 +1,184 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2014 The Marble contributors
+//
+
+#ifndef MARBLE_BATCHRENDERER_H
+#define MARBLE_BATCHRENDERER_H
+
+#include "marble_export.h"
+#include "MarbleGlobal.h"
+#include "GeoDataCoordinates.h"
+
+#include <QObject>
+#include <QSize>
+#include <QString>
+#include <QStringList>
+
+namespace Marble
+{
+
+class MarbleMap;
+class MarbleModel;
+
+/**
+  * @short A single image to be rendered by BatchRenderer
+  */
+class MARBLE_EXPORT BatchRenderJob
+{
+public:
+    BatchRenderJob();
+
+    /**
+     * @param mapThemeId map theme id a la "earth/openstreetmap/openstreetmap.dgml"
+     * @param projection projection of the image
+     * @param center center of the image
+     * @param zoom zoom value as used by MarbleWidget::setZoom
+     * @param size size of the image in pixels
+     * @param outputFile file to write; the image format is derived from its suffix
+     */
+    BatchRenderJob( const QString &mapThemeId, Projection projection,
+                    const GeoDataCoordinates &center, int zoom,
+                    const QSize &size, const QString &outputFile );
+
+    QString mapThemeId() const;
+
+    Projection projection() const;
+
+    GeoDataCoordinates center() const;
+
+    int zoom() const;
+
+    QSize size() const;
+
+    QString outputFile() const;
+
+private:
+    QString m_mapThemeId;
+    Projection m_projection;
+    GeoDataCoordinates m_center;
+    int m_zoom;
+    QSize m_size;
+    QString m_outputFile;
+};
+
+/**
+  * @short Renders a queue of map images without a widget
+  *
+  * Jobs are painted by map() on top of the given model, so map themes,
+  * layers, plugins and the tile cache are set up once and shared by many
+  * images. Jobs are reordered by map theme, projection and size to keep
+  * switches between them rare. The model and the map are not thread safe,
+  * hence each additional render thread paints with a model and a map of its
+  * own, which share the tile cache on disk. They take over the state of map()
+  * at the start of render(): the user documents loaded from files, the clock,
+  * the view settings, the changed map theme properties and the render plugin
+  * configuration. The threads take the next job from a common queue. Encoding and writing the images, which takes about as long as
+  * painting them, runs in a pool of writer threads in parallel to painting
+  * the next jobs.
+  */
+class MARBLE_EXPORT BatchRenderer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit BatchRenderer( MarbleModel *model, QObject *parent = 0 );
+
+    ~BatchRenderer();
+
+    /**
+     * @brief Returns the map used for painting, e.g. to configure render plugins
+     */
+    MarbleMap *map();
+
+    /**
+     * @brief Queues a job for the next call of render()
+     */
+    void addJob( const BatchRenderJob &job );
+
+    /**
+     * @brief Returns the number of queued jobs
+     */
+    int jobCount() const;
+
+    /**
+     * @brief Sets the quality passed to QImageWriter, from 0 to 100, or -1 for the default
+     */
+    void setImageQuality( int quality );
+
+    /**
+     * @brief Sets how long a job may wait for missing tiles and documents
+     *
+     * Jobs are painted again whenever new data arrives until the map reports
+     * a complete render state or the time is up. The default of 0 paints each
+     * job once with whatever is cached, which suits a warm tile cache. Documents
+     * of the map theme are always loaded completely before a job is painted.
+     */
+    void setMaximumWaitTime( int msecs );
+
+    /**
+     * @brief Sets the number of threads painting jobs
+     *
+     * The calling thread of render() paints jobs with map(); count - 1 further
+     * threads are started, each with a MarbleModel of its own. The default is 1.
+     *
+     * Documents which the render threads cannot load again from a file, e.g.
+     * added with MarbleModel::addGeoDataString() or search results, restrict
+     * render() to the calling thread. Changes made to loaded documents in
+     * memory are not seen by the render threads.
+     */
+    void setRenderThreadCount( int count );
+
+    int renderThreadCount() const;
+
+    /**
+     * @brief Sets the number of threads encoding and writing images
+     */
+    void setWriterThreadCount( int count );
+
+    /**
+     * @brief Renders all queued jobs and returns when all images are written
+     *
+     * Events of the calling thread are processed while waiting for data.
+     * @return whether all images were written successfully
+     */
+    bool render();
+
+    /**
+     * @brief Returns the output files of the last render() call that could not be written
+     */
+    QStringList failedFiles() const;
+
+    /**
+     * @brief Returns the throughput of the last render() call
+     */
+    qreal jobsPerSecond() const;
+
+Q_SIGNALS:
+    /**
+     * Emitted in the thread of render() after a job was painted and handed over
+     * to the writer threads
+     */
+    void progress( int finished, int total );
+
+    /**
+     * Emitted by render() for each image that could not be written, once all
+     * images are done
+     */
+    void writeFailed( const QString &outputFile, const QString &error );
+
+private:
+    Q_DISABLE_COPY( BatchRenderer )
+
+    class Private;
+    Private *const d;
+};
+
+}
+
+#endif
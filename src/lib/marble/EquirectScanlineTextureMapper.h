@@ -36,9 +36,23 @@ class EquirectScanlineTextureMapper : public TextureMapperInterface
                              const QRect &dirtyRect,
                              TextureColorizer *texColorizer );
 
+    virtual void setCenterChanged();
+
  private:
     void mapTexture( const ViewportParams *viewport, int tileZoomLevel, MapQuality mapQuality );
 
+    /**
+     * Moves the last frame by the pixel offset of the new center and maps
+     * the texture onto the uncovered strips only.
+     * @return false if the frame cannot be reused, e.g. because the
+     *         offset is not a whole number of pixels
+     */
+    bool scrollTexture( const ViewportParams *viewport, int tileZoomLevel, MapQuality mapQuality );
+
+    void paintedRows( const ViewportParams *viewport, int &yPaintedTop, int &yPaintedBottom ) const;
+
+    static int yCenterOffset( const ViewportParams *viewport );
+
  private:
     class RenderJob;
 
@@ -46,6 +60,12 @@ class EquirectScanlineTextureMapper : public TextureMapperInterface
     int m_radius;
     QImage m_canvasImage;
     int    m_oldYPaintedTop;
+    bool   m_centerChanged;
+    qreal  m_oldCenterLon;
+    int    m_oldYCenterOffset;
+    qreal  m_scrollError;
+    int    m_oldTileZoomLevel;
+    MapQuality m_oldMapQuality;
     QThreadPool m_threadPool;
 };
 
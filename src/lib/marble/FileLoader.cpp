@@ -77,6 +77,7 @@ public:
     }
 
     void createFilterProperties( GeoDataContainer *container );
+    void shareInlineStyle( GeoDataPlacemark *placemark );
     static int cityPopIdx( qint64 population );
     static int spacePopIdx( qint64 population );
     static int areaPopIdx( qreal area );
@@ -94,6 +95,7 @@ public:
     GeoDataStyleMap* m_styleMap;
     GeoDataDocument *m_document;
     QString m_error;
+    QVector<GeoDataStyle*> m_sharedStyles;
 };
 
 FileLoader::FileLoader( QObject* parent, const PluginManager *pluginManager, bool recenter,
@@ -125,6 +127,11 @@ GeoDataDocument* FileLoader::document()
     return d->m_document;
 }
 
+void FileLoader::setDocumentCacheEnabled( bool enabled )
+{
+    d->m_runner.setDocumentCacheEnabled( enabled );
+}
+
 QString FileLoader::error() const
 {
     return d->m_error;
@@ -228,6 +235,37 @@ void FileLoaderPrivate::documentParsed( GeoDataDocument* doc, const QString& err
     emit q->loaderFinished( q );
 }
 
+void FileLoaderPrivate::shareInlineStyle( GeoDataPlacemark *placemark )
+{
+    // Only inline styles belong to the placemark. Styles referenced by
+    // styleUrl live in the document.
+    if ( !placemark->styleUrl().isEmpty() || !placemark->customStyle() ) {
+        return;
+    }
+
+    GeoDataStyle *style = const_cast<GeoDataStyle*>( placemark->customStyle() );
+    foreach ( GeoDataStyle *shared, m_sharedStyles ) {
+        if ( shared == style ) {
+            return;
+        }
+        if ( *shared == *style ) {
+            // setStyle() re-parents the style, it stays with the placemark that owns it
+            GeoDataObject *const owner = shared->parent();
+            placemark->setStyle( shared );
+            shared->setParent( owner );
+            if ( style->parent() == placemark ) {
+                delete style;
+            }
+            return;
+        }
+    }
+
+    // Bound the number of comparisons for documents with many distinct styles
+    if ( m_sharedStyles.size() < 32 ) {
+        m_sharedStyles << style;
+    }
+}
+
 void FileLoaderPrivate::createFilterProperties( GeoDataContainer *container )
 {
     QVector<GeoDataFeature*>::Iterator i = container->begin();
@@ -248,6 +286,8 @@ void FileLoaderPrivate::createFilterProperties( GeoDataContainer *container )
             GeoDataPlacemark* placemark = static_cast<GeoDataPlacemark*>( *i );
             Q_ASSERT( placemark->geometry() );
 
+            shareInlineStyle( placemark );
+
             bool hasPopularity = false;
 
             if ( placemark->geometry()->nodeType() != GeoDataTypes::GeoDataTrackType &&
@@ -38,6 +38,11 @@ class FileLoader : public QThread
         GeoDataDocument *document();
         QString error() const;
 
+        /**
+         * Enables binary snapshots of the parsed file, see ParsingRunnerManager
+         */
+        void setDocumentCacheEnabled( bool enabled );
+
     Q_SIGNALS:
         void loaderFinished( FileLoader* );
         void newGeoDataDocumentAdded( GeoDataDocument* );
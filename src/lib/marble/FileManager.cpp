@@ -27,6 +27,11 @@
 #include "GeoWriter.h"
 #include <KmlElementDictionary.h>
 
+#ifdef MARBLE_HAVE_QUAZIP
+#include <quazip/quazip.h>
+#include <quazip/quazipfile.h>
+#endif
+
 
 using namespace Marble;
 
@@ -93,6 +98,8 @@ void FileManager::addFile( const QString& filepath, const QString& property, con
     mDebug() << "Starting placemark loading timer";
     d->m_timer.start();
     FileLoader* loader = new FileLoader( this, d->m_pluginManager, recenter, filepath, property, style, role );
+    // Only files opened by the user are worth snapshots
+    loader->setDocumentCacheEnabled( role == UserDocument );
     d->appendLoader( loader );
 }
 
@@ -142,21 +149,56 @@ void FileManagerPrivate::closeFile( const QString& key )
     }
 }
 
-void FileManager::saveFile( const QString &fileName, const GeoDataDocument *document )
+bool FileManager::saveFile( const QString &fileName, const GeoDataDocument *document )
 {
     GeoWriter writer;
     writer.setDocumentType( kml::kmlTag_nameSpaceOgc22 );
 
     if (fileName.isEmpty())
-        return;
+        return false;
+
+    if ( QFileInfo( fileName ).suffix().toLower() == "kmz" ) {
+#ifdef MARBLE_HAVE_QUAZIP
+        // The document is compressed while it is written, no temporary file needed
+        QuaZip zip( fileName );
+        if ( !zip.open( QuaZip::mdCreate ) ) {
+            mDebug() << "Unable to create" << fileName;
+            return false;
+        }
+        QuaZipFile zipFile( &zip );
+        if ( !zipFile.open( QIODevice::WriteOnly, QuaZipNewInfo( "doc.kml" ) ) ) {
+            mDebug() << "Unable to add doc.kml to" << fileName;
+            zip.close();
+            return false;
+        }
+        bool success = writer.write( &zipFile, document );
+        zipFile.close();
+        success = success && zipFile.getZipError() == ZIP_OK;
+        zip.close();
+        success = success && zip.getZipError() == ZIP_OK;
+        if ( !success ) {
+            mDebug() << "Unable to write" << fileName;
+        }
+        return success;
+#else
+        mDebug() << "Unable to write" << fileName << "- Marble was built without KMZ support";
+        return false;
+#endif
+    }
 
     QFile file( fileName );
     if ( !file.open( QIODevice::WriteOnly | QIODevice::Truncate ) ) {
-        return;
+        mDebug() << "Unable to open" << fileName << ":" << file.errorString();
+        return false;
     }
 
-    writer.write( &file, document );
+    bool const success = writer.write( &file, document );
     file.close();
+    if ( !success || file.error() != QFile::NoError ) {
+        mDebug() << "Unable to write" << fileName << ":" << file.errorString();
+        return false;
+    }
+    return true;
 }
 
 void FileManager::closeFile( const GeoDataDocument *document )
@@ -67,7 +67,11 @@ class FileManager : public QObject
     */
     void addData( const QString &name, const QString &data, DocumentRole role );
 
-    void saveFile( const QString &fileName, const GeoDataDocument *document );
+    /**
+    * save the document as KML, or as compressed KMZ archive if the file name ends with .kmz
+    * @return whether the document was written completely
+    */
+    bool saveFile( const QString &fileName, const GeoDataDocument *document );
     void closeFile( const GeoDataDocument *document );
 
     int size() const;
@@ -14,6 +14,7 @@
 // Qt
 #include <QSortFilterProxyModel>
 #include <QFileDialog>
+#include <QMessageBox>
 #include <QMenu>
 #include <QAction>
 
@@ -143,7 +144,11 @@ void FileViewWidgetPrivate::saveFile()
         = index.model()->data( index, MarblePlacemarkModel::ObjectPointerRole ).value<GeoDataObject*>();
     GeoDataDocument *document = dynamic_cast<GeoDataDocument*>(object);
     if ( document && !document->fileName().isEmpty() ) {
-        m_fileManager->saveFile( QFileDialog::getSaveFileName( q, "Select filename for KML document" ), document );
+        const QString fileName = QFileDialog::getSaveFileName( q, "Select filename for KML document" );
+        if ( !fileName.isEmpty() && !m_fileManager->saveFile( fileName, document ) ) {
+            QMessageBox::warning( q, QObject::tr( "File Saving Error" ),
+                                  QObject::tr( "Unable to save the document to %1." ).arg( fileName ) );
+        }
     }
 }
 
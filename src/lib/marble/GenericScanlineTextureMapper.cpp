@@ -23,6 +23,8 @@
 #include "GeoPainter.h"
 #include "MarbleDirs.h"
 #include "MarbleDebug.h"
+#include "MarbleProfiler.h"
+#include "ScanlineChunkQueue.h"
 #include "ScanlineTextureMapperContext.h"
 #include "StackedTileLoader.h"
 #include "TextureColorizer.h"
@@ -36,7 +38,7 @@ using namespace Marble;
 class GenericScanlineTextureMapper::RenderJob : public QRunnable
 {
 public:
-    RenderJob( StackedTileLoader *tileLoader, int tileLevel, QImage *canvasImage, const ViewportParams *viewport, MapQuality mapQuality, int yTop, int yBottom );
+    RenderJob( StackedTileLoader *tileLoader, int tileLevel, QImage *canvasImage, const ViewportParams *viewport, MapQuality mapQuality, ScanlineChunkQueue *queue );
 
     virtual void run();
 
@@ -46,18 +48,16 @@ private:
     QImage *const m_canvasImage;
     const ViewportParams *const m_viewport;
     const MapQuality m_mapQuality;
-    const int m_yTop;
-    const int m_yBottom;
+    ScanlineChunkQueue *const m_queue;
 };
 
-GenericScanlineTextureMapper::RenderJob::RenderJob( StackedTileLoader *tileLoader, int tileLevel, QImage *canvasImage, const ViewportParams *viewport, MapQuality mapQuality, int yTop, int yBottom )
+GenericScanlineTextureMapper::RenderJob::RenderJob( StackedTileLoader *tileLoader, int tileLevel, QImage *canvasImage, const ViewportParams *viewport, MapQuality mapQuality, ScanlineChunkQueue *queue )
     : m_tileLoader( tileLoader ),
       m_tileLevel( tileLevel ),
       m_canvasImage( canvasImage ),
       m_viewport( viewport ),
       m_mapQuality( mapQuality ),
-      m_yTop( yTop ),
-      m_yBottom( yBottom )
+      m_queue( queue )
 {
 }
 
@@ -115,6 +115,8 @@ void GenericScanlineTextureMapper::mapTexture( GeoPainter *painter,
 
 void GenericScanlineTextureMapper::mapTexture( const ViewportParams *viewport, int tileZoomLevel, MapQuality mapQuality )
 {
+    MARBLE_PROFILE_SCOPE( "GenericScanlineTextureMapper::mapTexture" );
+
     // Reset backend
     m_tileLoader->resetTilehash();
 
@@ -130,11 +132,11 @@ void GenericScanlineTextureMapper::mapTexture( const ViewportParams *viewport, i
                                       : yTop + radius + radius - skip;
 
     const int numThreads = m_threadPool.maxThreadCount();
-    const int yStep = qCeil(qreal( yBottom - yTop ) / qreal(numThreads));
-    for ( int i = 0; i < numThreads; ++i ) {
-        const int yStart = yTop +  i      * yStep;
-        const int yEnd   = qMin(yBottom, yTop + (i + 1) * yStep);
-        QRunnable *const job = new RenderJob( m_tileLoader, tileZoomLevel, &m_canvasImage, viewport, mapQuality, yStart, yEnd );
+    const int rowAlignment = ( mapQuality == LowQuality ) ? 2 : 1;
+    ScanlineChunkQueue queue( yTop, yBottom, ScanlineChunkQueue::discRowCosts( yTop, yBottom, m_canvasImage.width(), imageHeight, radius ),
+                              numThreads, rowAlignment, &m_cancelled );
+    for ( int i = 0; i < qMin( numThreads, queue.chunkCount() ); ++i ) {
+        QRunnable *const job = new RenderJob( m_tileLoader, tileZoomLevel, &m_canvasImage, viewport, mapQuality, &queue );
         m_threadPool.start( job );
     }
 
@@ -145,6 +147,8 @@ void GenericScanlineTextureMapper::mapTexture( const ViewportParams *viewport, i
 
 void GenericScanlineTextureMapper::RenderJob::run()
 {
+    MARBLE_PROFILE_SCOPE( "GenericScanlineTextureMapper::RenderJob" );
+
     const int imageWidth  = m_canvasImage->width();
     const int imageHeight  = m_canvasImage->height();
     const qint64  radius  = m_viewport->radius();
@@ -171,107 +175,111 @@ void GenericScanlineTextureMapper::RenderJob::run()
 
 
     // Paint the map.
-    for ( int y = m_yTop; y < m_yBottom; ++y ) {
-
-        // rx is the radius component in x direction
-        const int rx = (int)sqrt( (qreal)( clipRadius * clipRadius
-                                      - ( ( y - imageHeight / 2 )
-                                          * ( y - imageHeight / 2 ) ) ) );
-
-        // Calculate the actual x-range of the map within the current scanline.
-        //
-        // If the circular border of the earth disk is still visible then xLeft
-        // equals the scanline position of the most left pixel that gets covered
-        // by the earth disk. In terms of math this equals the half image width minus
-        // the radius component on the current scanline in x direction ("rx").
-        //
-        // If the zoom factor is high enough then the whole screen gets covered
-        // by the earth and the border of the earth disk isn't visible anymore.
-        // In that situation xLeft equals zero.
-        // For xRight the situation is similar.
-
-        const int xLeft  = ( imageWidth / 2 - rx > 0 ) ? imageWidth / 2 - rx
-                                                       : 0;
-        const int xRight = ( imageWidth / 2 - rx > 0 ) ? xLeft + rx + rx
-                                                       : imageWidth;
-
-        QRgb * scanLine = (QRgb*)( m_canvasImage->scanLine( y ) ) + xLeft;
-
-        const int xIpLeft  = ( imageWidth / 2 - rx > 0 ) ? n * (int)( xLeft / n + 1 )
-                                                         : 1;
-        const int xIpRight = ( imageWidth / 2 - rx > 0 ) ? n * (int)( xRight / n - 1 )
-                                                         : n * (int)( xRight / n - 1 ) + 1;
-
-        // Decrease pole distortion due to linear approximation ( y-axis )
-        bool crossingPoleArea = false;
-        if ( !globeHidesNorthPole
-             && northPoleY - ( n * 0.75 ) <= y
-             && northPoleY + ( n * 0.75 ) >= y )
-        {
-            crossingPoleArea = true;
-        }
+    int yStart;
+    int yEnd;
+    while ( m_queue->takeChunk( yStart, yEnd ) ) {
+        for ( int y = yStart; y < yEnd; ++y ) {
+
+            // rx is the radius component in x direction
+            const int rx = (int)sqrt( (qreal)( clipRadius * clipRadius
+                                          - ( ( y - imageHeight / 2 )
+                                              * ( y - imageHeight / 2 ) ) ) );
+
+            // Calculate the actual x-range of the map within the current scanline.
+            //
+            // If the circular border of the earth disk is still visible then xLeft
+            // equals the scanline position of the most left pixel that gets covered
+            // by the earth disk. In terms of math this equals the half image width minus
+            // the radius component on the current scanline in x direction ("rx").
+            //
+            // If the zoom factor is high enough then the whole screen gets covered
+            // by the earth and the border of the earth disk isn't visible anymore.
+            // In that situation xLeft equals zero.
+            // For xRight the situation is similar.
+
+            const int xLeft  = ( imageWidth / 2 - rx > 0 ) ? imageWidth / 2 - rx
+                                                           : 0;
+            const int xRight = ( imageWidth / 2 - rx > 0 ) ? xLeft + rx + rx
+                                                           : imageWidth;
+
+            QRgb * scanLine = (QRgb*)( m_canvasImage->scanLine( y ) ) + xLeft;
+
+            const int xIpLeft  = ( imageWidth / 2 - rx > 0 ) ? n * (int)( xLeft / n + 1 )
+                                                             : 1;
+            const int xIpRight = ( imageWidth / 2 - rx > 0 ) ? n * (int)( xRight / n - 1 )
+                                                             : n * (int)( xRight / n - 1 ) + 1;
+
+            // Decrease pole distortion due to linear approximation ( y-axis )
+            bool crossingPoleArea = false;
+            if ( !globeHidesNorthPole
+                 && northPoleY - ( n * 0.75 ) <= y
+                 && northPoleY + ( n * 0.75 ) >= y )
+            {
+                crossingPoleArea = true;
+            }
 
-        int ncount = 0;
+            int ncount = 0;
 
 
-        for ( int x = xLeft; x < xRight; ++x ) {
+            for ( int x = xLeft; x < xRight; ++x ) {
 
-            // Prepare for interpolation
-            const int leftInterval = xIpLeft + ncount * n;
+                // Prepare for interpolation
+                const int leftInterval = xIpLeft + ncount * n;
 
-            bool interpolate = false;
+                bool interpolate = false;
 
-            if ( x >= xIpLeft && x <= xIpRight ) {
+                if ( x >= xIpLeft && x <= xIpRight ) {
 
-                // Decrease pole distortion due to linear approximation ( x-axis )
-                if ( crossingPoleArea
-                     && northPoleX >= leftInterval + n
-                     && northPoleX < leftInterval + 2 * n
-                     && x < leftInterval + 3 * n )
-                {
-                    interpolate = false;
-                }
-                else {
-                    x += n - 1;
-                    interpolate = !printQuality;
-                    ++ncount;
+                    // Decrease pole distortion due to linear approximation ( x-axis )
+                    if ( crossingPoleArea
+                         && northPoleX >= leftInterval + n
+                         && northPoleX < leftInterval + 2 * n
+                         && x < leftInterval + 3 * n )
+                    {
+                        interpolate = false;
+                    }
+                    else {
+                        x += n - 1;
+                        interpolate = !printQuality;
+                        ++ncount;
+                    }
                 }
-            }
-            else
-                interpolate = false;
+                else
+                    interpolate = false;
 
-            qreal lon;
-            qreal lat;
-            m_viewport->geoCoordinates(x,y, lon, lat, GeoDataCoordinates::Radian);
+                qreal lon;
+                qreal lat;
+                m_viewport->geoCoordinates(x,y, lon, lat, GeoDataCoordinates::Radian);
 
-            if ( interpolate ) {
-                if ( highQuality )
-                    context.pixelValueApproxF( lon, lat, scanLine, n );
-                else
-                    context.pixelValueApprox( lon, lat, scanLine, n );
+                if ( interpolate ) {
+                    if ( highQuality )
+                        context.pixelValueApproxF( lon, lat, scanLine, n );
+                    else
+                        context.pixelValueApprox( lon, lat, scanLine, n );
 
-                scanLine += ( n - 1 );
-            }
+                    scanLine += ( n - 1 );
+                }
 
-            if ( x < imageWidth ) {
-                if ( highQuality )
-                    context.pixelValueF( lon, lat, scanLine );
-                else
-                    context.pixelValue( lon, lat, scanLine );
-            }
+                if ( x < imageWidth ) {
+                    if ( highQuality )
+                        context.pixelValueF( lon, lat, scanLine );
+                    else
+                        context.pixelValue( lon, lat, scanLine );
+                }
 
-            ++scanLine;
-        }
+                ++scanLine;
+            }
 
-        // copy scanline to improve performance
-        if ( interlaced && y + 1 < m_yBottom ) {
+            // copy scanline to improve performance
+            if ( interlaced && y + 1 < yEnd ) {
 
-            const int pixelByteSize = m_canvasImage->bytesPerLine() / imageWidth;
+                const int pixelByteSize = m_canvasImage->bytesPerLine() / imageWidth;
 
-            memcpy( m_canvasImage->scanLine( y + 1 ) + xLeft * pixelByteSize,
-                    m_canvasImage->scanLine( y     ) + xLeft * pixelByteSize,
-                    ( xRight - xLeft ) * pixelByteSize );
-            ++y;
+                memcpy( m_canvasImage->scanLine( y + 1 ) + xLeft * pixelByteSize,
+                        m_canvasImage->scanLine( y     ) + xLeft * pixelByteSize,
+                        ( xRight - xLeft ) * pixelByteSize );
+                ++y;
+            }
         }
     }
 }
@@ -29,6 +29,11 @@ RenderState LayerInterface::renderState() const
     return RenderState();
 }
 
+LayerInterface::CacheInputs LayerInterface::cacheInputs() const
+{
+    return NoCaching;
+}
+
 QString LayerInterface::runtimeTrace() const
 {
     return QString();
@@ -26,6 +26,21 @@ class ViewportParams;
 class MARBLE_EXPORT LayerInterface
 {
 public:
+    /**
+     * @brief The inputs a cached rendering of the layer depends on
+     *
+     * If the layer cache is enabled (see MarbleMap::setLayerCacheEnabled()), a layer
+     * that returns anything but NoCaching from cacheInputs() is rendered into an
+     * offscreen image by the LayerManager. The image is composited as long as none
+     * of the declared inputs changed.
+     */
+    enum CacheInput {
+        NoCaching = 0x0,       ///< The layer is rendered on every repaint (default)
+        ViewportInput = 0x1,   ///< Projection, radius, center, heading, size and map quality
+        ClockInput = 0x2,      ///< The date and time of the MarbleClock
+        ModelInput = 0x4       ///< Data, settings or map theme changes reported by the layer
+    };
+    Q_DECLARE_FLAGS( CacheInputs, CacheInput )
 
     /** Destructor */
     virtual ~LayerInterface();
@@ -70,6 +85,16 @@ public:
 
     virtual RenderState renderState() const;
 
+    /**
+      * @brief Returns the inputs a cached rendering of the layer depends on (default: NoCaching).
+      *
+      * Layers opting into caching must render only through the painter passed
+      * to render() and must not depend on anything else than the returned inputs.
+      * Data changes are reported through MarbleMap::invalidateLayerCache() or,
+      * for render plugins, by emitting repaintNeeded() or settingsChanged().
+      */
+    virtual CacheInputs cacheInputs() const;
+
     /**
       * @brief Returns a debug line for perfo/tracing issues
       */
@@ -78,4 +103,6 @@ public:
 
 } // namespace Marble
 
+Q_DECLARE_OPERATORS_FOR_FLAGS( Marble::LayerInterface::CacheInputs )
+
 #endif
@@ -24,7 +24,17 @@
 #include "PluginManager.h"
 #include "RenderPlugin.h"
 #include "LayerInterface.h"
+#include "MarbleClock.h"
+#include "MarbleProfiler.h"
+#include "Quaternion.h"
 #include "RenderState.h"
+#include "ViewportParams.h"
+
+// Qt
+#include <QDateTime>
+#include <QHash>
+#include <QImage>
+#include <QPair>
 
 namespace Marble
 {
@@ -39,6 +49,96 @@ bool zValueLessThan( const LayerInterface * const one, const LayerInterface * co
     return one->zValue() < two->zValue();
 }
 
+/**
+  * The state of all inputs a cached layer image was rendered with. Inputs not declared
+  * by the layer keep their default values and therefore always compare equal.
+  */
+class LayerCacheKey
+{
+ public:
+    LayerCacheKey();
+
+    bool operator==( const LayerCacheKey &other ) const;
+
+    Projection m_projection;
+    int m_radius;
+    QSize m_size;
+    Quaternion m_planetAxis;
+    MapQuality m_mapQuality;
+    QDateTime m_dateTime;
+    int m_generation;
+};
+
+LayerCacheKey::LayerCacheKey()
+    : m_projection( Spherical ),
+      m_radius( 0 ),
+      m_mapQuality( NormalQuality ),
+      m_generation( 0 )
+{
+}
+
+bool LayerCacheKey::operator==( const LayerCacheKey &other ) const
+{
+    return m_projection == other.m_projection
+        && m_radius == other.m_radius
+        && m_size == other.m_size
+        && m_planetAxis == other.m_planetAxis
+        && m_mapQuality == other.m_mapQuality
+        && m_dateTime == other.m_dateTime
+        && m_generation == other.m_generation;
+}
+
+/**
+  * Offscreen images of a layer, one per render position, and its cache statistics
+  */
+class LayerCache
+{
+ public:
+    LayerCache();
+
+    QHash<QString, QPair<LayerCacheKey, QImage> > m_images;
+    int m_generation;
+    int m_hits;
+    int m_misses;
+};
+
+LayerCache::LayerCache()
+    : m_generation( 0 ),
+      m_hits( 0 ),
+      m_misses( 0 )
+{
+}
+
+/**
+  * A layer scheduled for a render position. m_renderPlugin is null for internal layers.
+  */
+class ScheduledLayer
+{
+ public:
+    explicit ScheduledLayer( LayerInterface *layer = 0, RenderPlugin *renderPlugin = 0 );
+
+    LayerInterface *m_layer;
+    RenderPlugin *m_renderPlugin;
+    const char *m_profilerName;
+};
+
+ScheduledLayer::ScheduledLayer( LayerInterface *layer, RenderPlugin *renderPlugin )
+    : m_layer( layer ),
+      m_renderPlugin( renderPlugin ),
+      m_profilerName( 0 )
+{
+    QString name = renderPlugin ? renderPlugin->nameId() : QString();
+    if ( name.isEmpty() && layer ) {
+        name = layer->renderState().name();
+    }
+    m_profilerName = MarbleProfiler::internedName( name.isEmpty() ? QString( "Layer" ) : name );
+}
+
+bool scheduledZValueLessThan( const ScheduledLayer &one, const ScheduledLayer &two )
+{
+    return zValueLessThan( one.m_layer, two.m_layer );
+}
+
 class LayerManager::Private
 {
  public:
@@ -49,9 +149,23 @@ class LayerManager::Private
 
     void addPlugins();
 
+    RenderPlugin *addPlugin( const RenderPlugin *factory );
+
+    RenderPlugin *renderPlugin( const QString &nameId ) const;
+
+    void invalidatePluginCache();
+
+    void invalidateModelCaches();
+
+    void updateSchedule();
+
+    bool renderLayer( GeoPainter *painter, ViewportParams *viewport,
+                      const QString &renderPosition, LayerInterface *layer );
+
     LayerManager *const q;
 
     QList<RenderPlugin *> m_renderPlugins;
+    QList<RenderPluginMetaData> m_unloadedPlugins;
     QList<AbstractFloatItem *> m_floatItems;
     QList<AbstractDataPlugin *> m_dataPlugins;
     QList<LayerInterface *> m_internalLayers;
@@ -61,15 +175,26 @@ class LayerManager::Private
 
     RenderState m_renderState;
     bool m_showRuntimeTrace;
-};
 
+    // All render positions in painting order, and the layers sorted by zValue() for each
+    QStringList m_renderPositions;
+    QHash<QString, QList<ScheduledLayer> > m_schedule;
+    bool m_scheduleDirty;
+
+    bool m_layerCacheEnabled;
+    QHash<const LayerInterface *, LayerCache> m_layerCaches;
+};
 LayerManager::Private::Private( const MarbleModel* model, LayerManager *parent )
     : q( parent ),
       m_renderPlugins(),
       m_model( model ),
       m_showBackground( true ),
-      m_showRuntimeTrace( false )
+      m_showRuntimeTrace( false ),
+      m_scheduleDirty( true ),
+      m_layerCacheEnabled( false )
 {
+    m_renderPositions << "STARS" << "BEHIND_TARGET" << "SURFACE" << "HOVERS_ABOVE_SURFACE"
+                      << "ATMOSPHERE" << "ORBIT" << "ALWAYS_ON_TOP" << "FLOAT_ITEM" << "USER_TOOLS";
 }
 
 LayerManager::Private::~Private()
@@ -82,6 +207,98 @@ void LayerManager::Private::updateVisibility( bool visible, const QString &nameI
     emit q->visibilityChanged( nameId, visible );
 }
 
+void LayerManager::Private::invalidatePluginCache()
+{
+    RenderPlugin *const renderPlugin = qobject_cast<RenderPlugin *>( q->sender() );
+    if ( renderPlugin && m_layerCaches.contains( renderPlugin ) ) {
+        ++m_layerCaches[renderPlugin].m_generation;
+    }
+}
+
+void LayerManager::Private::invalidateModelCaches()
+{
+    QHash<const LayerInterface *, LayerCache>::iterator it = m_layerCaches.begin();
+    for ( ; it != m_layerCaches.end(); ++it ) {
+        ++it.value().m_generation;
+    }
+}
+
+void LayerManager::Private::updateSchedule()
+{
+    m_schedule.clear();
+
+    foreach( const QString &renderPosition, m_renderPositions ) {
+        QList<ScheduledLayer> layers;
+
+        // collect all RenderPlugins of current renderPosition
+        foreach( RenderPlugin *renderPlugin, m_renderPlugins ) {
+            if ( renderPlugin && renderPlugin->renderPosition().contains( renderPosition ) ) {
+                layers.push_back( ScheduledLayer( renderPlugin, renderPlugin ) );
+            }
+        }
+
+        // collect all internal LayerInterfaces of current renderPosition
+        foreach( LayerInterface *layer, m_internalLayers ) {
+            if ( layer && layer->renderPosition().contains( renderPosition ) ) {
+                layers.push_back( ScheduledLayer( layer ) );
+            }
+        }
+
+        // sort them according to their zValue()s
+        qStableSort( layers.begin(), layers.end(), scheduledZValueLessThan );
+
+        m_schedule.insert( renderPosition, layers );
+    }
+
+    m_scheduleDirty = false;
+}
+
+bool LayerManager::Private::renderLayer( GeoPainter *painter, ViewportParams *viewport,
+                                         const QString &renderPosition, LayerInterface *layer )
+{
+    const LayerInterface::CacheInputs inputs = layer->cacheInputs();
+    if ( !m_layerCacheEnabled || inputs == LayerInterface::NoCaching ) {
+        return layer->render( painter, viewport, renderPosition, 0 );
+    }
+
+    LayerCache &cache = m_layerCaches[layer];
+
+    LayerCacheKey key;
+    if ( inputs & LayerInterface::ViewportInput ) {
+        key.m_projection = viewport->projection();
+        key.m_radius = viewport->radius();
+        key.m_size = viewport->size();
+        key.m_planetAxis = viewport->planetAxis();
+        key.m_mapQuality = painter->mapQuality();
+    }
+    if ( inputs & LayerInterface::ClockInput ) {
+        key.m_dateTime = m_model->clock()->dateTime();
+    }
+    if ( inputs & LayerInterface::ModelInput ) {
+        key.m_generation = cache.m_generation;
+    }
+
+    QPair<LayerCacheKey, QImage> &cached = cache.m_images[renderPosition];
+    bool result = true;
+    if ( cached.second.isNull() || cached.second.size() != viewport->size() || !( cached.first == key ) ) {
+        ++cache.m_misses;
+        if ( cached.second.size() != viewport->size() ) {
+            cached.second = QImage( viewport->size(), QImage::Format_ARGB32_Premultiplied );
+        }
+        cached.second.fill( Qt::transparent );
+        cached.first = key;
+
+        GeoPainter cachePainter( &cached.second, viewport, painter->mapQuality() );
+        cachePainter.setRenderHints( painter->renderHints() );
+        result = layer->render( &cachePainter, viewport, renderPosition, 0 );
+    } else {
+        ++cache.m_hits;
+    }
+
+    painter->drawImage( QPoint( 0, 0 ), cached.second );
+    return result;
+}
+
 
 LayerManager::LayerManager( const MarbleModel* model, QObject *parent )
     : QObject( parent ),
@@ -89,6 +306,7 @@ LayerManager::LayerManager( const MarbleModel* model, QObject *parent )
 {
     d->addPlugins();
     connect( model->pluginManager(), SIGNAL(renderPluginsChanged()), this, SLOT(addPlugins()) );
+    connect( model, SIGNAL(themeChanged(QString)), this, SLOT(invalidateModelCaches()) );
 }
 
 LayerManager::~LayerManager()
@@ -106,6 +324,36 @@ QList<RenderPlugin *> LayerManager::renderPlugins() const
     return d->m_renderPlugins;
 }
 
+QList<RenderPluginMetaData> LayerManager::unloadedRenderPlugins() const
+{
+    return d->m_unloadedPlugins;
+}
+
+RenderPlugin *LayerManager::loadRenderPlugin( const QString &nameId )
+{
+    RenderPlugin *renderPlugin = d->renderPlugin( nameId );
+    if ( renderPlugin ) {
+        return renderPlugin;
+    }
+
+    const RenderPlugin *const factory = d->m_model->pluginManager()->renderPlugin( nameId );
+    if ( !factory ) {
+        return 0;
+    }
+
+    for ( int i = 0; i < d->m_unloadedPlugins.size(); ++i ) {
+        if ( d->m_unloadedPlugins[i].nameId == nameId ) {
+            d->m_unloadedPlugins.removeAt( i );
+            break;
+        }
+    }
+
+    renderPlugin = d->addPlugin( factory );
+    emit renderPluginLoaded( renderPlugin );
+
+    return renderPlugin;
+}
+
 QList<AbstractFloatItem *> LayerManager::floatItems() const
 {
     return d->m_floatItems;
@@ -128,57 +376,50 @@ QList<AbstractDataPluginItem *> LayerManager::whichItemAt( const QPoint& curpos
 
 void LayerManager::renderLayers( GeoPainter *painter, ViewportParams *viewport )
 {
-    d->m_renderState = RenderState( "Marble" );
-    const QTime totalTime = QTime::currentTime();
+    MARBLE_PROFILE_SCOPE( "LayerManager::renderLayers" );
 
-    QStringList renderPositions;
+    d->m_renderState = RenderState( "Marble" );
+    const qint64 totalStart = MarbleProfiler::timestamp();
 
-    if ( d->m_showBackground ) {
-        renderPositions << "STARS" << "BEHIND_TARGET";
+    if ( d->m_scheduleDirty ) {
+        d->updateSchedule();
     }
 
-    renderPositions << "SURFACE" << "HOVERS_ABOVE_SURFACE" << "ATMOSPHERE"
-                    << "ORBIT" << "ALWAYS_ON_TOP" << "FLOAT_ITEM" << "USER_TOOLS";
-
     QStringList traceList;
-    foreach( const QString& renderPosition, renderPositions ) {
-        QList<LayerInterface*> layers;
+    foreach( const QString& renderPosition, d->m_renderPositions ) {
+        if ( !d->m_showBackground && ( renderPosition == "STARS" || renderPosition == "BEHIND_TARGET" ) ) {
+            continue;
+        }
 
-        // collect all RenderPlugins of current renderPosition
-        foreach( RenderPlugin *renderPlugin, d->m_renderPlugins ) {
-            if ( renderPlugin && renderPlugin->renderPosition().contains( renderPosition ) ) {
-                if ( renderPlugin->enabled() && renderPlugin->visible() ) {
-                    if ( !renderPlugin->isInitialized() ) {
-                        renderPlugin->initialize();
-                        emit renderPluginInitialized( renderPlugin );
-                    }
-                    layers.push_back( renderPlugin );
+        // render the layers of the current renderPosition
+        foreach( const ScheduledLayer &scheduled, d->m_schedule.value( renderPosition ) ) {
+            RenderPlugin *const renderPlugin = scheduled.m_renderPlugin;
+            if ( renderPlugin ) {
+                if ( !renderPlugin->enabled() || !renderPlugin->visible() ) {
+                    continue;
+                }
+                if ( !renderPlugin->isInitialized() ) {
+                    renderPlugin->initialize();
+                    emit renderPluginInitialized( renderPlugin );
                 }
             }
-        }
 
-        // collect all internal LayerInterfaces of current renderPosition
-        foreach( LayerInterface *layer, d->m_internalLayers ) {
-            if ( layer && layer->renderPosition().contains( renderPosition ) ) {
-                layers.push_back( layer );
+            LayerInterface *const layer = scheduled.m_layer;
+            const qint64 start = MarbleProfiler::timestamp();
+            d->renderLayer( painter, viewport, renderPosition, layer );
+            const qint64 duration = MarbleProfiler::timestamp() - start;
+            if ( MarbleProfiler::isEnabled() ) {
+                MarbleProfiler::addEvent( scheduled.m_profilerName, start, duration );
             }
-        }
-
-        // sort them according to their zValue()s
-        qSort( layers.begin(), layers.end(), zValueLessThan );
-
-        // render the layers of the current renderPosition
-        QTime timer;
-        foreach( LayerInterface *layer, layers ) {
-            timer.start();
-            layer->render( painter, viewport, renderPosition, 0 );
             d->m_renderState.addChild( layer->renderState() );
-            traceList.append( QString("%2 ms %3").arg( timer.elapsed(),3 ).arg( layer->runtimeTrace() ) );
+            if ( d->m_showRuntimeTrace ) {
+                traceList.append( QString("%2 ms %3").arg( duration / 1000000, 3 ).arg( layer->runtimeTrace() ) );
+            }
         }
     }
 
     if ( d->m_showRuntimeTrace ) {
-        const int totalElapsed = totalTime.elapsed();
+        const int totalElapsed = qMax<qint64>( 1, ( MarbleProfiler::timestamp() - totalStart ) / 1000000 );
         const int fps = 1000.0/totalElapsed;
         traceList.append( QString( "Total: %1 ms (%2 fps)" ).arg( totalElapsed, 3 ).arg( fps ) );
 
@@ -201,42 +442,73 @@ void LayerManager::renderLayers( GeoPainter *painter, ViewportParams *viewport )
 
 void LayerManager::Private::addPlugins()
 {
-    foreach ( const RenderPlugin *factory, m_model->pluginManager()->renderPlugins() ) {
-        bool alreadyCreated = false;
-        foreach( const RenderPlugin* existing, m_renderPlugins ) {
-            if ( existing->nameId() == factory->nameId() ) {
-                alreadyCreated = true;
-                break;
-            }
+    foreach ( const RenderPluginMetaData &metaData, m_model->pluginManager()->renderPluginMetaData() ) {
+        if ( renderPlugin( metaData.nameId ) ) {
+            continue;
         }
 
-        if ( alreadyCreated ) {
+        // Plugins that start disabled are only listed until loadRenderPlugin() is called
+        if ( !metaData.enabledByDefault ) {
+            bool alreadyListed = false;
+            foreach ( const RenderPluginMetaData &unloaded, m_unloadedPlugins ) {
+                alreadyListed = alreadyListed || unloaded.nameId == metaData.nameId;
+            }
+            if ( !alreadyListed ) {
+                m_unloadedPlugins.append( metaData );
+            }
             continue;
         }
 
-        RenderPlugin *const renderPlugin = factory->newInstance( m_model );
-        Q_ASSERT( renderPlugin && "Plugin returned null when requesting a new instance." );
-        m_renderPlugins.append( renderPlugin );
-
-        QObject::connect( renderPlugin, SIGNAL(settingsChanged(QString)),
-                 q, SIGNAL(pluginSettingsChanged()) );
-        QObject::connect( renderPlugin, SIGNAL(repaintNeeded(QRegion)),
-                 q, SIGNAL(repaintNeeded(QRegion)) );
-        QObject::connect( renderPlugin, SIGNAL(visibilityChanged(bool,QString)),
-                 q, SLOT(updateVisibility(bool,QString)) );
-
-        // get float items ...
-        AbstractFloatItem * const floatItem =
-            qobject_cast<AbstractFloatItem *>( renderPlugin );
-        if ( floatItem )
-            m_floatItems.append( floatItem );
-
-        // ... and data plugins
-        AbstractDataPlugin * const dataPlugin =
-            qobject_cast<AbstractDataPlugin *>( renderPlugin );
-        if( dataPlugin )
-            m_dataPlugins.append( dataPlugin );
+        const RenderPlugin *const factory = m_model->pluginManager()->renderPlugin( metaData.nameId );
+        if ( factory ) {
+            addPlugin( factory );
+        }
+    }
+}
+
+RenderPlugin *LayerManager::Private::addPlugin( const RenderPlugin *factory )
+{
+    RenderPlugin *const renderPlugin = factory->newInstance( m_model );
+    Q_ASSERT( renderPlugin && "Plugin returned null when requesting a new instance." );
+    m_renderPlugins.append( renderPlugin );
+
+    QObject::connect( renderPlugin, SIGNAL(settingsChanged(QString)),
+             q, SIGNAL(pluginSettingsChanged()) );
+    QObject::connect( renderPlugin, SIGNAL(repaintNeeded(QRegion)),
+             q, SIGNAL(repaintNeeded(QRegion)) );
+    QObject::connect( renderPlugin, SIGNAL(visibilityChanged(bool,QString)),
+             q, SLOT(updateVisibility(bool,QString)) );
+    QObject::connect( renderPlugin, SIGNAL(settingsChanged(QString)),
+             q, SLOT(invalidatePluginCache()) );
+    QObject::connect( renderPlugin, SIGNAL(repaintNeeded(QRegion)),
+             q, SLOT(invalidatePluginCache()) );
+
+    // get float items ...
+    AbstractFloatItem * const floatItem =
+        qobject_cast<AbstractFloatItem *>( renderPlugin );
+    if ( floatItem )
+        m_floatItems.append( floatItem );
+
+    // ... and data plugins
+    AbstractDataPlugin * const dataPlugin =
+        qobject_cast<AbstractDataPlugin *>( renderPlugin );
+    if( dataPlugin )
+        m_dataPlugins.append( dataPlugin );
+
+    m_scheduleDirty = true;
+
+    return renderPlugin;
+}
+
+RenderPlugin *LayerManager::Private::renderPlugin( const QString &nameId ) const
+{
+    foreach( RenderPlugin *renderPlugin, m_renderPlugins ) {
+        if ( renderPlugin->nameId() == nameId ) {
+            return renderPlugin;
+        }
     }
+
+    return 0;
 }
 
 void LayerManager::setShowBackground( bool show )
@@ -249,14 +521,60 @@ void LayerManager::setShowRuntimeTrace( bool show )
     d->m_showRuntimeTrace = show;
 }
 
+void LayerManager::setLayerCacheEnabled( bool enabled )
+{
+    d->m_layerCacheEnabled = enabled;
+    if ( !enabled ) {
+        d->m_layerCaches.clear();
+    }
+}
+
+bool LayerManager::isLayerCacheEnabled() const
+{
+    return d->m_layerCacheEnabled;
+}
+
+void LayerManager::invalidateLayerCache( const LayerInterface *layer )
+{
+    if ( layer ) {
+        if ( d->m_layerCaches.contains( layer ) ) {
+            ++d->m_layerCaches[layer].m_generation;
+        }
+    } else {
+        d->invalidateModelCaches();
+    }
+}
+
+int LayerManager::layerCacheHits( const LayerInterface *layer ) const
+{
+    return d->m_layerCaches.value( layer ).m_hits;
+}
+
+int LayerManager::layerCacheMisses( const LayerInterface *layer ) const
+{
+    return d->m_layerCaches.value( layer ).m_misses;
+}
+
+void LayerManager::resetLayerCacheStatistics()
+{
+    QHash<const LayerInterface *, LayerCache>::iterator it = d->m_layerCaches.begin();
+    for ( ; it != d->m_layerCaches.end(); ++it ) {
+        it.value().m_hits = 0;
+        it.value().m_misses = 0;
+    }
+}
+
 void LayerManager::addLayer(LayerInterface *layer)
 {
     d->m_internalLayers.push_back(layer);
+    d->m_scheduleDirty = true;
 }
 
 void LayerManager::removeLayer(LayerInterface *layer)
 {
     d->m_internalLayers.removeAll(layer);
+    d->m_layerCaches.remove(layer);
+    d->m_scheduleDirty = true;
 }
 
 QList<LayerInterface *> LayerManager::internalLayers() const
@@ -34,6 +34,7 @@ class AbstractFloatItem;
 class AbstractDataPlugin;
 class MarbleModel;
 class LayerInterface;
+struct RenderPluginMetaData;
 
 /**
  * @short Handles rendering of all active layers in the correct order
@@ -57,6 +58,17 @@ class LayerManager : public QObject
      * @return the list of RenderPlugins
      */
     QList<RenderPlugin *>      renderPlugins() const;
+    /**
+     * @brief Returns the RenderPlugins that are available but not created yet
+     * Plugins which are disabled by default are created by loadRenderPlugin() only,
+     * so their libraries are not loaded before they are needed.
+     */
+    QList<RenderPluginMetaData> unloadedRenderPlugins() const;
+    /**
+     * @brief Returns the RenderPlugin with the given name id, creating it if needed
+     * @return the plugin, or null if there is no RenderPlugin with that name id
+     */
+    RenderPlugin *loadRenderPlugin( const QString &nameId );
     /**
      * @brief Returns a list of all FloatItems on the layer
      * @return the list of the floatItems
@@ -87,12 +99,41 @@ class LayerManager : public QObject
 
     RenderState renderState() const;
 
+    /**
+     * @brief Returns whether layers declaring cache inputs are composited from offscreen images
+     * The layer cache is disabled by default.
+     */
+    bool isLayerCacheEnabled() const;
+
+    /**
+     * @brief Marks the cached images of @p layer (all layers if null) as outdated
+     * Only layers declaring LayerInterface::ModelInput are affected.
+     */
+    void invalidateLayerCache( const LayerInterface *layer = 0 );
+
+    /**
+     * @brief Returns how often @p layer was composited from its cached image
+     */
+    int layerCacheHits( const LayerInterface *layer ) const;
+
+    /**
+     * @brief Returns how often @p layer had to be rendered into its cached image
+     */
+    int layerCacheMisses( const LayerInterface *layer ) const;
+
+    void resetLayerCacheStatistics();
+
  Q_SIGNALS:
     /**
      * @brief Signal that a render item has been initialized
      */
     void renderPluginInitialized( RenderPlugin *renderPlugin );
 
+    /**
+     * @brief Signal that a render plugin has been created by loadRenderPlugin()
+     */
+    void renderPluginLoaded( RenderPlugin *renderPlugin );
+
     /**
      * This signal is emitted when the settings of a plugin changed.
      */
@@ -112,11 +153,17 @@ class LayerManager : public QObject
 
     void setShowRuntimeTrace( bool show );
 
+    void setLayerCacheEnabled( bool enabled );
+
  private:
     Q_PRIVATE_SLOT( d, void updateVisibility( bool, const QString & ) )
 
     Q_PRIVATE_SLOT( d, void addPlugins() )
 
+    Q_PRIVATE_SLOT( d, void invalidatePluginCache() )
+
+    Q_PRIVATE_SLOT( d, void invalidateModelCaches() )
+
  private:
     Q_DISABLE_COPY( LayerManager )
 
@@ -14,11 +14,17 @@
 #include "MapThemeManager.h"
 
 // Qt
+#include <QDataStream>
+#include <QDateTime>
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
 #include <QFileSystemWatcher>
+#include <QHash>
+#include <QIcon>
+#include <QPixmap>
 #include <QScopedPointer>
+#include <QSet>
 #include <QString>
 #include <QStringList>
 #include <QTimer>
@@ -48,12 +54,74 @@
 namespace
 {
     static const QString mapDirName = "maps";
-    static const int columnRelativePath = 1;
+    static const quint32 indexMagic = 0x4d544958;
+    static const qint32 indexVersion = 1;
 }
 
 namespace Marble
 {
 
+namespace
+{
+
+/**
+ * A theme list entry which loads its preview icon when it is shown first
+ */
+class MapThemeItem : public QStandardItem
+{
+public:
+    MapThemeItem( const QString &name, const QString &iconPath )
+        : QStandardItem( name ),
+          m_iconPath( iconPath ),
+          m_iconLoaded( false )
+    {
+    }
+
+    virtual QVariant data( int role = Qt::UserRole + 1 ) const
+    {
+        if ( role != Qt::DecorationRole ) {
+            return QStandardItem::data( role );
+        }
+
+        if ( !m_iconLoaded ) {
+            m_icon = loadIcon( m_iconPath );
+            m_iconLoaded = true;
+        }
+        return m_icon;
+    }
+
+private:
+    static QIcon loadIcon( const QString &iconPath )
+    {
+        QPixmap themeIconPixmap;
+        themeIconPixmap.load( MarbleDirs::path( iconPath ) );
+
+        if ( themeIconPixmap.isNull() ) {
+            themeIconPixmap.load( MarbleDirs::path( "svg/application-x-marble-gray.png" ) );
+        }
+        else {
+            // Make sure we don't keep excessively large previews in memory
+            // TODO: Scale the icon down to the default icon size in MarbleSelectView.
+            //       For now maxIconSize already equals what's expected by the listview.
+            QSize maxIconSize( 136, 136 );
+            if ( themeIconPixmap.size() != maxIconSize ) {
+                mDebug() << "Smooth scaling theme icon";
+                themeIconPixmap = themeIconPixmap.scaled( maxIconSize,
+                                                          Qt::KeepAspectRatio,
+                                                          Qt::SmoothTransformation );
+            }
+        }
+
+        return QIcon( themeIconPixmap );
+    }
+
+    const QString m_iconPath;
+    mutable QIcon m_icon;
+    mutable bool m_iconLoaded;
+};
+
+}
+
 class MapThemeManager::Private
 {
 public:
@@ -63,14 +131,45 @@ public:
     void directoryChanged( const QString& path );
     void fileChanged( const QString & path );
 
+    /**
+     * @brief The properties of a .dgml file shown in the theme list
+     */
+    struct MapThemeInfo
+    {
+        MapThemeInfo() : lastModified( 0 ), visible( false ) {}
+
+        /** Absolute path of the .dgml file, local themes hide system ones */
+        QString path;
+        /** Modification time of the .dgml file in msecs since the epoch */
+        qint64 lastModified;
+        bool visible;
+        QString name;
+        QString description;
+        /** Path of the preview image relative to MarbleDirs */
+        QString iconPath;
+    };
+
     /**
      * @brief Updates the map theme model on request.
      *
-     * This method should usually get invoked on startup or
-     * by a QFileSystemWatcher instance.
+     * This method should usually get invoked on startup.
      */
     void updateMapThemeModel();
 
+    /**
+     * @brief Updates the rows of all themes whose id starts with @p prefix
+     *
+     * Only themes that were added, removed or whose .dgml file changed since
+     * they were indexed are parsed again.
+     */
+    void updateMapThemes( const QString &prefix );
+
+    /**
+     * @brief Returns the id prefix of the themes below a watched path,
+     *        e.g. "earth/plain/" for the directory of the plain map.
+     */
+    static QString mapThemePrefix( const QString &path );
+
     void watchPaths();
 
     /**
@@ -79,22 +178,40 @@ public:
     static void addMapThemePaths( const QString& mapPathName, QStringList& result );
 
     /**
-     * @brief Helper method for findMapThemes(). Searches for .dgml files below
-     *        given directory path.
+     * @brief Helper method for findMapThemes(). Adds the ids of the .dgml files
+     *        below the given map directory and relative path to @p result.
      */
-    static QStringList findMapThemes( const QString& basePath );
+    static void findMapThemes( const QString& mapPathName, const QString& relativePath, QStringList& result );
 
     /**
-     * @brief Searches for .dgml files below local and system map directory.
+     * @brief Searches for .dgml files below local and system map directory
+     *        whose id starts with @p prefix.
      */
-    static QStringList findMapThemes();
+    static QStringList findMapThemes( const QString& prefix = QString() );
 
     static GeoSceneDocument* loadMapThemeFile( const QString& mapThemeId );
 
     /**
-     * @brief Helper method for updateMapThemeModel().
+     * @brief Returns whether the index entry of a theme matches its .dgml file
+     */
+    bool isIndexed( const QString& mapThemeId ) const;
+
+    /**
+     * @brief Returns the properties of a theme from the index, parsing
+     *        its .dgml file only if the index is outdated.
+     */
+    bool mapThemeInfo( const QString& mapThemeId, MapThemeInfo& info );
+
+    void loadIndex();
+
+    void saveIndex();
+
+    static QString indexFileName();
+
+    /**
+     * @brief Helper method for updateMapThemes().
      */
-    static QList<QStandardItem *> createMapThemeRow( const QString& mapThemeID );
+    QList<QStandardItem *> createMapThemeRow( const QString& mapThemeID );
 
     /**
      * @brief Deletes any directory with its contents.
@@ -109,6 +226,10 @@ public:
     QFileSystemWatcher m_fileSystemWatcher;
     bool m_isInitialized;
 
+    QHash<QString, MapThemeInfo> m_index;
+    bool m_indexLoaded;
+    bool m_indexModified;
+
 private:
     /**
      * @brief Returns all directory paths and .dgml file paths below local and
@@ -122,7 +243,9 @@ MapThemeManager::Private::Private( MapThemeManager *parent )
       m_mapThemeModel( 0, 3 ),
       m_celestialList(),
       m_fileSystemWatcher(),
-      m_isInitialized( false )
+      m_isInitialized( false ),
+      m_indexLoaded( false ),
+      m_indexModified( false )
 {
 }
 
@@ -271,56 +394,34 @@ QStringList MapThemeManager::Private::pathsToWatch()
     return result;
 }
 
-QStringList MapThemeManager::Private::findMapThemes( const QString& basePath )
+void MapThemeManager::Private::findMapThemes( const QString& mapPathName, const QString& relativePath, QStringList& result )
 {
-    const QString mapPathName = basePath + '/' + mapDirName;
-
-    QDir paths = QDir( mapPathName );
-
-    QStringList mapPaths = paths.entryList( QStringList( "*" ),
-                                            QDir::AllDirs
-                                            | QDir::NoSymLinks
-                                            | QDir::NoDotAndDotDot );
-    QStringList mapDirs;
-
-    for ( int planet = 0; planet < mapPaths.size(); ++planet ) {
-        QDir themeDir = QDir( mapPathName + '/' + mapPaths.at( planet ) );
-        QStringList themeMapPaths = themeDir.entryList(
-                                     QStringList( "*" ),
-                                     QDir::AllDirs |
-                                     QDir::NoSymLinks |
-                                     QDir::NoDotAndDotDot );
-        for ( int theme = 0; theme < themeMapPaths.size(); ++theme ) {
-            mapDirs << mapPathName + '/' + mapPaths.at( planet ) + '/'
-                + themeMapPaths.at( theme );
+    const QDir directory( mapPathName + '/' + relativePath );
+
+    // <planet>/<theme>/<theme>.dgml
+    if ( relativePath.count( '/' ) == 2 ) {
+        const QStringList themeFileNames = directory.entryList( QStringList( "*.dgml" ),
+                                                                QDir::Files | QDir::NoSymLinks );
+        foreach ( const QString &themeFileName, themeFileNames ) {
+            result << relativePath + themeFileName;
         }
+        return;
     }
 
-    QStringList mapFiles;
-    QStringListIterator it( mapDirs );
-    while ( it.hasNext() ) {
-        QString themeDir = it.next() + '/';
-        QString themeDirName = QDir( themeDir ).path().section( '/', -2, -1 );
-        QStringList tmp = QDir( themeDir ).entryList( QStringList( "*.dgml" ),
-                                                      QDir::Files | QDir::NoSymLinks );
-        if ( !tmp.isEmpty() ) {
-            QStringListIterator k( tmp );
-            while ( k.hasNext() ) {
-                QString themeXml = k.next();
-                mapFiles << themeDirName + '/' + themeXml;
-            }
-        }
+    const QStringList subDirectories = directory.entryList( QStringList( "*" ),
+                                                            QDir::AllDirs
+                                                            | QDir::NoSymLinks
+                                                            | QDir::NoDotAndDotDot );
+    foreach ( const QString &subDirectory, subDirectories ) {
+        findMapThemes( mapPathName, relativePath + subDirectory + '/', result );
     }
-
-    return mapFiles;
 }
 
-QStringList MapThemeManager::Private::findMapThemes()
+QStringList MapThemeManager::Private::findMapThemes( const QString& prefix )
 {
-    QStringList mapFilesLocal = findMapThemes( MarbleDirs::localPath() );
-    QStringList mapFilesSystem = findMapThemes( MarbleDirs::systemPath() );
-    QStringList allMapFiles( mapFilesLocal );
-    allMapFiles << mapFilesSystem;
+    QStringList allMapFiles;
+    findMapThemes( MarbleDirs::localPath() + '/' + mapDirName, prefix, allMapFiles );
+    findMapThemes( MarbleDirs::systemPath() + '/' + mapDirName, prefix, allMapFiles );
 
     // remove duplicate entries
     allMapFiles.sort();
@@ -334,6 +435,152 @@ QStringList MapThemeManager::Private::findMapThemes()
     return allMapFiles;
 }
 
+QString MapThemeManager::Private::mapThemePrefix( const QString& path )
+{
+    const QStringList mapPathNames = QStringList()
+            << QDir::cleanPath( MarbleDirs::localPath() + '/' + mapDirName )
+            << QDir::cleanPath( MarbleDirs::systemPath() + '/' + mapDirName );
+    const QString cleanPath = QDir::cleanPath( path );
+
+    foreach ( const QString &mapPathName, mapPathNames ) {
+        if ( !cleanPath.startsWith( mapPathName + '/' ) ) {
+            continue;
+        }
+
+        QStringList sections = cleanPath.mid( mapPathName.size() + 1 ).split( '/', QString::SkipEmptyParts );
+        if ( cleanPath.endsWith( ".dgml" ) ) {
+            sections.removeLast();
+        }
+        QString prefix;
+        for ( int i = 0; i < qMin( 2, sections.size() ); ++i ) {
+            prefix += sections.at( i ) + '/';
+        }
+        return prefix;
+    }
+
+    return QString();
+}
+
+bool MapThemeManager::Private::isIndexed( const QString& mapThemeId ) const
+{
+    QHash<QString, MapThemeInfo>::const_iterator const it = m_index.constFind( mapThemeId );
+    if ( it == m_index.constEnd() ) {
+        return false;
+    }
+
+    const QString path = MarbleDirs::path( mapDirName + '/' + mapThemeId );
+    return it->path == path
+            && it->lastModified == QFileInfo( path ).lastModified().toMSecsSinceEpoch();
+}
+
+bool MapThemeManager::Private::mapThemeInfo( const QString& mapThemeId, MapThemeInfo& info )
+{
+    if ( isIndexed( mapThemeId ) ) {
+        info = m_index.value( mapThemeId );
+        return true;
+    }
+
+    m_indexModified = true;
+    QScopedPointer<GeoSceneDocument> mapTheme( loadMapThemeFile( mapThemeId ) );
+    if ( !mapTheme ) {
+        m_index.remove( mapThemeId );
+        return false;
+    }
+
+    info.path = MarbleDirs::path( mapDirName + '/' + mapThemeId );
+    info.lastModified = QFileInfo( info.path ).lastModified().toMSecsSinceEpoch();
+    info.visible = mapTheme->head()->visible();
+    info.name = mapTheme->head()->name();
+    info.description = mapTheme->head()->description();
+    info.iconPath = mapDirName + '/'
+        + mapTheme->head()->target() + '/' + mapTheme->head()->theme() + '/'
+        + mapTheme->head()->icon()->pixmap();
+    m_index.insert( mapThemeId, info );
+
+    return true;
+}
+
+QString MapThemeManager::Private::indexFileName()
+{
+    return MarbleDirs::localPath() + "/cache/mapthemes.index";
+}
+
+void MapThemeManager::Private::loadIndex()
+{
+    if ( m_indexLoaded ) {
+        return;
+    }
+    m_indexLoaded = true;
+
+    QFile file( indexFileName() );
+    if ( !file.open( QIODevice::ReadOnly ) ) {
+        return;
+    }
+
+    QDataStream stream( &file );
+    stream.setVersion( QDataStream::Qt_4_2 );
+
+    quint32 magic;
+    qint32 version;
+    qint32 count;
+    stream >> magic >> version >> count;
+    if ( stream.status() != QDataStream::Ok || magic != indexMagic || version != indexVersion ) {
+        mDebug() << "Ignoring map theme index" << file.fileName();
+        return;
+    }
+
+    for ( int i = 0; i < count; ++i ) {
+        QString mapThemeId;
+        MapThemeInfo info;
+        stream >> mapThemeId >> info.path >> info.lastModified >> info.visible
+               >> info.name >> info.description >> info.iconPath;
+        if ( stream.status() != QDataStream::Ok ) {
+            mDebug() << "Ignoring truncated map theme index" << file.fileName();
+            m_index.clear();
+            return;
+        }
+        m_index.insert( mapThemeId, info );
+    }
+}
+
+void MapThemeManager::Private::saveIndex()
+{
+    if ( !m_indexModified ) {
+        return;
+    }
+    m_indexModified = false;
+
+    const QString fileName = indexFileName();
+    QDir().mkpath( QFileInfo( fileName ).absolutePath() );
+
+    // Readers must never see a partially written index
+    const QString partFile = fileName + ".part";
+    QFile file( partFile );
+    if ( !file.open( QIODevice::WriteOnly ) ) {
+        mDebug() << "Unable to write map theme index" << partFile;
+        return;
+    }
+
+    QDataStream stream( &file );
+    stream.setVersion( QDataStream::Qt_4_2 );
+    stream << indexMagic << indexVersion << qint32( m_index.size() );
+
+    QHash<QString, MapThemeInfo>::const_iterator it = m_index.constBegin();
+    for ( ; it != m_index.constEnd(); ++it ) {
+        stream << it.key() << it->path << it->lastModified << it->visible
+               << it->name << it->description << it->iconPath;
+    }
+    file.close();
+
+    if ( stream.status() != QDataStream::Ok || file.error() != QFile::NoError ) {
+        QFile::remove( partFile );
+        return;
+    }
+
+    QFile::remove( fileName );
+    QFile::rename( partFile, fileName );
+}
+
 QStandardItemModel* MapThemeManager::mapThemeModel()
 {
     if ( !d->m_isInitialized ) {
@@ -357,48 +604,18 @@ QList<QStandardItem *> MapThemeManager::Private::createMapThemeRow( QString cons
 {
     QList<QStandardItem *> itemList;
 
-    QScopedPointer<GeoSceneDocument> mapTheme( loadMapThemeFile( mapThemeID ) );
-    if ( !mapTheme || !mapTheme->head()->visible() ) {
+    MapThemeInfo info;
+    if ( !mapThemeInfo( mapThemeID, info ) || !info.visible ) {
         return itemList;
     }
 
-    QPixmap themeIconPixmap;
-    QString relativePath;
-
-    relativePath = mapDirName + '/'
-        + mapTheme->head()->target() + '/' + mapTheme->head()->theme() + '/'
-        + mapTheme->head()->icon()->pixmap();
-    themeIconPixmap.load( MarbleDirs::path( relativePath ) );
-
-    if ( themeIconPixmap.isNull() ) {
-        relativePath = "svg/application-x-marble-gray.png";
-        themeIconPixmap.load( MarbleDirs::path( relativePath ) );
-    }
-    else {
-        // Make sure we don't keep excessively large previews in memory
-        // TODO: Scale the icon down to the default icon size in MarbleSelectView.
-        //       For now maxIconSize already equals what's expected by the listview.
-        QSize maxIconSize( 136, 136 );
-        if ( themeIconPixmap.size() != maxIconSize ) {
-            mDebug() << "Smooth scaling theme icon";
-            themeIconPixmap = themeIconPixmap.scaled( maxIconSize,
-                                                      Qt::KeepAspectRatio,
-                                                      Qt::SmoothTransformation );
-        }
-    }
-
-    QIcon mapThemeIcon =  QIcon( themeIconPixmap );
-
-    QString name = mapTheme->head()->name();
-    QString description = mapTheme->head()->description();
-
-    QStandardItem *item = new QStandardItem( name );
-    item->setData( QObject::tr( name.toUtf8() ), Qt::DisplayRole );
-    item->setData( mapThemeIcon, Qt::DecorationRole );
+    // The preview icon is loaded when the item is shown first
+    QStandardItem *item = new MapThemeItem( info.name, info.iconPath );
+    item->setData( QObject::tr( info.name.toUtf8() ), Qt::DisplayRole );
     item->setData( QString( "<span style=\" max-width: 150 px;\"> "
-                            + QObject::tr( description.toUtf8() ) + " </span>" ), Qt::ToolTipRole );
+                            + QObject::tr( info.description.toUtf8() ) + " </span>" ), Qt::ToolTipRole );
     item->setData( mapThemeID, Qt::UserRole + 1 );
-    item->setData( QObject::tr( description.toUtf8() ), Qt::UserRole + 2 );
+    item->setData( QObject::tr( info.description.toUtf8() ), Qt::UserRole + 2 );
 
     itemList << item;
 
@@ -412,17 +629,59 @@ void MapThemeManager::Private::updateMapThemeModel()
 
     m_mapThemeModel.setHeaderData(0, Qt::Horizontal, QObject::tr("Name"));
 
-    QStringList stringlist = findMapThemes();
-    QStringListIterator it( stringlist );
+    updateMapThemes( QString() );
+}
+
+void MapThemeManager::Private::updateMapThemes( const QString& prefix )
+{
+    mDebug() << "updateMapThemes" << prefix;
+    loadIndex();
+
+    const QStringList stringlist = findMapThemes( prefix );
+    const QSet<QString> mapThemeIds = stringlist.toSet();
+
+    // Remove the rows of deleted and changed themes
+    QSet<QString> unchanged;
+    for ( int row = m_mapThemeModel.rowCount() - 1; row >= 0; --row ) {
+        const QString mapThemeId = m_mapThemeModel.item( row )->data( Qt::UserRole + 1 ).toString();
+        if ( !mapThemeId.startsWith( prefix ) ) {
+            continue;
+        }
+
+        if ( mapThemeIds.contains( mapThemeId ) && isIndexed( mapThemeId ) ) {
+            unchanged << mapThemeId;
+        } else {
+            qDeleteAll( m_mapThemeModel.takeRow( row ) );
+        }
+    }
+
+    // Both the model and the found themes are sorted by id
+    int row = 0;
+    foreach ( const QString &mapThemeId, stringlist ) {
+        while ( row < m_mapThemeModel.rowCount()
+                && m_mapThemeModel.item( row )->data( Qt::UserRole + 1 ).toString() < mapThemeId ) {
+            ++row;
+        }
 
-    while ( it.hasNext() ) {
-        QString mapThemeID = it.next();
+        if ( unchanged.contains( mapThemeId ) ) {
+            continue;
+        }
 
-    	QList<QStandardItem *> itemList = createMapThemeRow( mapThemeID );
+        QList<QStandardItem *> itemList = createMapThemeRow( mapThemeId );
         if ( !itemList.empty() ) {
-            m_mapThemeModel.appendRow( itemList );
+            m_mapThemeModel.insertRow( row, itemList );
+            ++row;
+        }
+    }
+
+    // Forget themes that do not exist anymore
+    foreach ( const QString &mapThemeId, m_index.keys() ) {
+        if ( mapThemeId.startsWith( prefix ) && !mapThemeIds.contains( mapThemeId ) ) {
+            m_index.remove( mapThemeId );
+            m_indexModified = true;
         }
     }
+    saveIndex();
 
     foreach ( const QString &mapThemeId, stringlist ) {
         QString celestialBodyId = mapThemeId.section( '/', 0, 0 );
@@ -456,8 +715,12 @@ void MapThemeManager::Private::directoryChanged( const QString& path )
     mDebug() << "directoryChanged:" << path;
     watchPaths();
 
+    // Only the themes below the changed directory need to be updated
+    if ( m_isInitialized ) {
+        updateMapThemes( mapThemePrefix( path ) );
+    }
+
     mDebug() << "Emitting themesChanged()";
-    updateMapThemeModel();
     emit q->themesChanged();
 }
 
@@ -465,36 +728,13 @@ void MapThemeManager::Private::fileChanged( const QString& path )
 {
     mDebug() << "fileChanged:" << path;
 
-    // 1. if the file does not (anymore) exist, it got deleted and we
-    //    have to delete the corresponding item from the model
-    // 2. if the file exists it is changed and we have to replace
-    //    the item with a new one.
-
-    QString mapThemeId = path.section( '/', -3 );
-    mDebug() << "mapThemeId:" << mapThemeId;
-    QList<QStandardItem *> matchingItems = m_mapThemeModel.findItems( mapThemeId,
-                                                                          Qt::MatchFixedString
-                                                                          | Qt::MatchCaseSensitive,
-                                                                          columnRelativePath );
-    mDebug() << "matchingItems:" << matchingItems.size();
-    Q_ASSERT( matchingItems.size() <= 1 );
-    int insertAtRow = 0;
-
-    if ( matchingItems.size() == 1 ) {
-        const int row = matchingItems.front()->row();
-	insertAtRow = row;
-        QList<QStandardItem *> toBeDeleted = m_mapThemeModel.takeRow( row );
-	while ( !toBeDeleted.isEmpty() ) {
-            delete toBeDeleted.takeFirst();
-        }
-    }
+    // A replaced .dgml file is not watched anymore
+    watchPaths();
 
-    QFileInfo fileInfo( path );
-    if ( fileInfo.exists() ) {
-        QList<QStandardItem *> newMapThemeRow = createMapThemeRow( mapThemeId );
-        if ( !newMapThemeRow.empty() ) {
-            m_mapThemeModel.insertRow( insertAtRow, newMapThemeRow );
-        }
+    // Deleted themes are removed from the model, changed ones
+    // are parsed again
+    if ( m_isInitialized ) {
+        updateMapThemes( mapThemePrefix( path ) );
     }
 
     emit q->themesChanged();
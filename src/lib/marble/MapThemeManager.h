@@ -34,6 +34,11 @@ class GeoDataPhotoOverlay;
  * After parsing the data it only stores the name, description and path
  * into a QStandardItemModel.
  *
+ * The name and description of each theme are kept in an index below the
+ * local cache directory together with the modification time of its .dgml
+ * file, so only new and changed themes are parsed again. Preview icons are
+ * loaded when they are shown first.
+ *
  * The MapThemeManager is not owned by the MarbleWidget/Map itself.
  * Instead it is owned by the widget or application that contains
  * MarbleWidget/Map ( usually: the ControlView convenience class )
@@ -64,8 +64,10 @@
 #include "LayerManager.h"
 #include "MapThemeManager.h"
 #include "MarbleDebug.h"
+#include "MarbleProfiler.h"
 #include "MarbleDirs.h"
 #include "MarbleModel.h"
+#include "PluginManager.h"
 #include "RenderPlugin.h"
 #include "SunLocator.h"
 #include "TileCoordsPyramid.h"
@@ -124,6 +126,8 @@ public:
 
     void updateProperty( const QString &, bool );
 
+    void updateThemeVisibility( RenderPlugin *renderPlugin );
+
     void setDocument( QString key );
 
     MarbleMap *const q;
@@ -161,8 +165,8 @@ MarbleMapPrivate::MarbleMapPrivate( MarbleMap *parent, MarbleModel *model ) :
     m_layerManager( model, parent ),
     m_customPaintLayer( parent ),
     m_geometryLayer( model->treeModel() ),
-    m_textureLayer( model->downloadManager(), model->sunLocator(), model->groundOverlayModel() ),
-    m_placemarkLayer( model->placemarkModel(), model->placemarkSelectionModel(), model->clock() ),
+    m_textureLayer( model->downloadManager(), model->sunLocator(), model->placemarkRegistry() ),
+    m_placemarkLayer( model->placemarkRegistry(), model->placemarkSelectionModel(), model->clock() ),
     m_vectorTileLayer( model->downloadManager(), model->pluginManager(), model->treeModel() ),
     m_isLockedToSubSolarPoint( false ),
     m_isSubSolarPointIconVisible( false )
@@ -188,6 +192,10 @@ MarbleMapPrivate::MarbleMapPrivate( MarbleMap *parent, MarbleModel *model ) :
                        parent,        SIGNAL(repaintNeeded(QRegion)) );
     QObject::connect ( &m_layerManager, SIGNAL(renderPluginInitialized(RenderPlugin*)),
                        parent,        SIGNAL(renderPluginInitialized(RenderPlugin*)) );
+    QObject::connect ( &m_layerManager, SIGNAL(renderPluginLoaded(RenderPlugin*)),
+                       parent,        SLOT(updateThemeVisibility(RenderPlugin*)) );
+    QObject::connect ( &m_layerManager, SIGNAL(renderPluginLoaded(RenderPlugin*)),
+                       parent,        SIGNAL(renderPluginLoaded(RenderPlugin*)) );
     QObject::connect ( &m_layerManager, SIGNAL(visibilityChanged(QString,bool)),
                        parent,        SLOT(setPropertyValue(QString,bool)) );
 
@@ -210,6 +218,8 @@ MarbleMapPrivate::MarbleMapPrivate( MarbleMap *parent, MarbleModel *model ) :
                       parent, SIGNAL(tileLevelChanged(int)) );
     QObject::connect( &m_textureLayer, SIGNAL(repaintNeeded()),
                       parent, SIGNAL(repaintNeeded()) );
+    QObject::connect( &m_textureLayer, SIGNAL(frameLatency(int,int)),
+                      parent, SIGNAL(frameLatency(int,int)) );
 
     QObject::connect( parent, SIGNAL(visibleLatLonAltBoxChanged(GeoDataLatLonAltBox)),
                       parent, SIGNAL(repaintNeeded()) );
@@ -349,6 +359,16 @@ ViewContext MarbleMap::viewContext() const
     return d->m_viewParams.viewContext();
 }
 
+void MarbleMap::setProgressiveRendering( bool enabled )
+{
+    d->m_textureLayer.setProgressiveRendering( enabled );
+}
+
+bool MarbleMap::progressiveRendering() const
+{
+    return d->m_textureLayer.progressiveRendering();
+}
+
 
 void MarbleMap::setSize( int width, int height )
 {
@@ -756,6 +776,8 @@ void MarbleMap::paint( GeoPainter &painter, const QRect &dirtyRect )
 {
     Q_UNUSED( dirtyRect );
 
+    MARBLE_PROFILE_SCOPE( "MarbleMap::paint" );
+
     if ( !d->m_model->mapTheme() ) {
         mDebug() << "No theme yet!";
         d->m_marbleSplashLayer.render( &painter, &d->m_viewport );
@@ -982,19 +1004,28 @@ void MarbleMapPrivate::updateMapTheme()
     m_placemarkLayer.requestStyleReset();
 
     foreach( RenderPlugin *renderPlugin, m_layerManager.renderPlugins() ) {
-        bool propertyAvailable = false;
-        m_model->mapTheme()->settings()->propertyAvailable( renderPlugin->nameId(), propertyAvailable );
-        bool propertyValue = false;
-        m_model->mapTheme()->settings()->propertyValue( renderPlugin->nameId(), propertyValue );
-
-        if ( propertyAvailable ) {
-            renderPlugin->setVisible( propertyValue );
-        }
+        updateThemeVisibility( renderPlugin );
     }
 
     emit q->themeChanged( m_model->mapTheme()->head()->mapThemeId() );
 }
 
+void MarbleMapPrivate::updateThemeVisibility( RenderPlugin *renderPlugin )
+{
+    if ( !m_model->mapTheme() ) {
+        return;
+    }
+
+    bool propertyAvailable = false;
+    m_model->mapTheme()->settings()->propertyAvailable( renderPlugin->nameId(), propertyAvailable );
+    bool propertyValue = false;
+    m_model->mapTheme()->settings()->propertyValue( renderPlugin->nameId(), propertyValue );
+
+    if ( propertyAvailable ) {
+        renderPlugin->setVisible( propertyValue );
+    }
+}
+
 void MarbleMap::setPropertyValue( const QString& name, bool value )
 {
     mDebug() << "In MarbleMap the property " << name << "was set to " << value;
@@ -1159,6 +1190,36 @@ void MarbleMap::setShowBackground( bool visible )
     d->m_layerManager.setShowBackground( visible );
 }
 
+void MarbleMap::setLayerCacheEnabled( bool enabled )
+{
+    d->m_layerManager.setLayerCacheEnabled( enabled );
+}
+
+bool MarbleMap::isLayerCacheEnabled() const
+{
+    return d->m_layerManager.isLayerCacheEnabled();
+}
+
+void MarbleMap::invalidateLayerCache( const LayerInterface *layer )
+{
+    d->m_layerManager.invalidateLayerCache( layer );
+}
+
+int MarbleMap::layerCacheHits( const LayerInterface *layer ) const
+{
+    return d->m_layerManager.layerCacheHits( layer );
+}
+
+int MarbleMap::layerCacheMisses( const LayerInterface *layer ) const
+{
+    return d->m_layerManager.layerCacheMisses( layer );
+}
+
+void MarbleMap::resetLayerCacheStatistics()
+{
+    d->m_layerManager.resetLayerCacheStatistics();
+}
+
 void MarbleMap::notifyMouseClick( int x, int y )
 {
     qreal  lon   = 0;
@@ -1224,6 +1285,16 @@ QList<RenderPlugin *> MarbleMap::renderPlugins() const
     return d->m_layerManager.renderPlugins();
 }
 
+QList<RenderPluginMetaData> MarbleMap::unloadedRenderPlugins() const
+{
+    return d->m_layerManager.unloadedRenderPlugins();
+}
+
+RenderPlugin *MarbleMap::loadRenderPlugin( const QString &nameId )
+{
+    return d->m_layerManager.loadRenderPlugin( nameId );
+}
+
 QList<AbstractFloatItem *> MarbleMap::floatItems() const
 {
     return d->m_layerManager.floatItems();
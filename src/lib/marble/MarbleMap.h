@@ -54,6 +54,7 @@ class RenderPlugin;
 class AbstractDataPlugin;
 class AbstractDataPluginItem;
 class AbstractFloatItem;
+struct RenderPluginMetaData;
 class TextureLayer;
 class TileCoordsPyramid;
 
@@ -157,6 +158,16 @@ class MARBLE_EXPORT MarbleMap : public QObject
     void setViewContext( ViewContext viewContext );
     ViewContext viewContext() const;
 
+    /**
+     * @brief Enables progressive rendering of still frames
+     *
+     * The texture of a high quality frame is shown as a low quality preview
+     * first and refined on a worker thread, so that the map responds at once
+     * when an animation ends. frameLatency() is emitted for every refined frame.
+     */
+    void setProgressiveRendering( bool enabled );
+    bool progressiveRendering() const;
+
     void setSize( int width, int height );
     void setSize( const QSize& size );
     QSize size() const;
@@ -367,6 +378,20 @@ class MARBLE_EXPORT MarbleMap : public QObject
      * @return the list of RenderPlugins
      */
     QList<RenderPlugin *> renderPlugins() const;
+
+    /**
+     * @brief Returns the RenderPlugins which are disabled by default and not created yet
+     * Their libraries are not loaded until loadRenderPlugin() is called for them.
+     * @return the descriptions of the plugins
+     */
+    QList<RenderPluginMetaData> unloadedRenderPlugins() const;
+
+    /**
+     * @brief Returns the RenderPlugin with the given name id, creating it if needed
+     * @return the plugin, or null if there is no RenderPlugin with that name id
+     */
+    RenderPlugin *loadRenderPlugin( const QString &nameId );
+
     QList<AbstractFloatItem *> floatItems() const;
 
     /**
@@ -406,6 +431,30 @@ class MARBLE_EXPORT MarbleMap : public QObject
 
     RenderState renderState() const;
 
+    /**
+     * @brief Returns whether layers declaring cache inputs are composited from offscreen images
+     * @see LayerInterface::cacheInputs()
+     */
+    bool isLayerCacheEnabled() const;
+
+    /**
+     * @brief Marks the cached images of @p layer (all layers if null) as outdated
+     * Only layers declaring LayerInterface::ModelInput are affected.
+     */
+    void invalidateLayerCache( const LayerInterface *layer = 0 );
+
+    /**
+     * @brief Returns how often @p layer was composited from its cached image
+     */
+    int layerCacheHits( const LayerInterface *layer ) const;
+
+    /**
+     * @brief Returns how often @p layer had to be rendered into its cached image
+     */
+    int layerCacheMisses( const LayerInterface *layer ) const;
+
+    void resetLayerCacheStatistics();
+
  public Q_SLOTS:
 
     /**
@@ -619,6 +668,12 @@ class MARBLE_EXPORT MarbleMap : public QObject
 
     void setShowBackground( bool visible );
 
+    /**
+     * @brief Set whether layers declaring cache inputs are composited from offscreen images
+     * @param enabled  whether the layer cache is used (default: false)
+     */
+    void setLayerCacheEnabled( bool enabled );
+
      /**
      * @brief used to notify about the position of the mouse click
       */
@@ -663,6 +718,13 @@ class MARBLE_EXPORT MarbleMap : public QObject
 
     void framesPerSecond( qreal fps );
 
+    /**
+     * Emitted when a progressively rendered frame got refined.
+     * @param previewLatency milliseconds taken to map the preview texture
+     * @param refinedLatency milliseconds until the refined texture was ready
+     */
+    void frameLatency( int previewLatency, int refinedLatency );
+
     /**
      * This signal is emitted when the repaint of the view was requested.
      * If available with the @p dirtyRegion which is the region the view will change in.
@@ -686,6 +748,12 @@ class MARBLE_EXPORT MarbleMap : public QObject
      */
     void renderPluginInitialized( RenderPlugin *renderPlugin );
 
+    /**
+     * @brief Signal that a render plugin disabled by default has been created
+     * @see loadRenderPlugin
+     */
+    void renderPluginLoaded( RenderPlugin *renderPlugin );
+
     /**
      * @brief Emitted when the layer rendering status has changed
      * @param status New render status
@@ -710,6 +778,7 @@ class MARBLE_EXPORT MarbleMap : public QObject
  private:
     Q_PRIVATE_SLOT( d, void updateMapTheme() )
     Q_PRIVATE_SLOT( d, void updateProperty( const QString &, bool ) )
+    Q_PRIVATE_SLOT( d, void updateThemeVisibility( RenderPlugin * ) )
     Q_PRIVATE_SLOT( d, void setDocument(QString) )
 
  private:
@@ -37,6 +37,7 @@
 #include "MapThemeManager.h"
 #include "MarbleGlobal.h"
 #include "MarbleDebug.h"
+#include "MarblePlacemarkModel.h"
 
 #include "GeoSceneDocument.h"
 #include "GeoSceneGeodata.h"
@@ -65,6 +66,8 @@
 #include "FileManager.h"
 #include "GeoDataTreeModel.h"
 #include "PlacemarkPositionProviderPlugin.h"
+#include "PlacemarkRegistry.h"
+#include "PlacemarkSearchIndex.h"
 #include "Planet.h"
 #include "PlanetFactory.h"
 #include "PluginManager.h"
@@ -96,8 +99,11 @@ class MarbleModelPrivate
           m_downloadManager( &m_storagePolicy ),
           m_storageWatcher( MarbleDirs::localPath() ),
           m_treeModel(),
-          m_descendantProxy(),
-          m_placemarkProxyModel(),
+          m_placemarkRegistry( &m_treeModel ),
+          m_placemarkModel(),
+          m_descendantProxy( 0 ),
+          m_groundOverlayProxyModel( 0 ),
+          m_placemarkSearchIndex( &m_placemarkRegistry ),
           m_placemarkSelectionModel( 0 ),
           m_fileManager( &m_treeModel, &m_pluginManager ),
           m_positionTracking( &m_treeModel ),
@@ -108,19 +114,16 @@ class MarbleModelPrivate
           m_workOffline( false ),
           m_elevationModel( &m_downloadManager )
     {
-        m_descendantProxy.setSourceModel( &m_treeModel );
-
-        m_placemarkProxyModel.setFilterFixedString( GeoDataTypes::GeoDataPlacemarkType );
-        m_placemarkProxyModel.setFilterKeyColumn( 1 );
-        m_placemarkProxyModel.setSourceModel( &m_descendantProxy );
-
-        m_groundOverlayProxyModel.setFilterFixedString( GeoDataTypes::GeoDataGroundOverlayType );
-        m_groundOverlayProxyModel.setFilterKeyColumn( 1 );
-        m_groundOverlayProxyModel.setSourceModel( &m_descendantProxy );
+        m_placemarkModel.setPlacemarkContainer( &m_placemarkRegistry.placemarks() );
+        m_placemarkModel.resetPlacemarks();
+        QObject::connect( &m_placemarkRegistry, SIGNAL(changed()),
+                          &m_placemarkModel, SLOT(resetPlacemarks()) );
     }
 
     ~MarbleModelPrivate()
     {
+        delete m_groundOverlayProxyModel;
+        delete m_descendantProxy;
         delete m_mapTheme;
         delete m_legend;
     }
@@ -152,6 +155,8 @@ class MarbleModelPrivate
 
     void addHighlightStyle( GeoDataDocument *doc );
 
+    QSortFilterProxyModel *groundOverlayProxyModel();
+
     // Misc stuff.
     MarbleClock              m_clock;
     Planet                   m_planet;
@@ -174,9 +179,12 @@ class MarbleModelPrivate
 
     // Places on the map
     GeoDataTreeModel         m_treeModel;
-    KDescendantsProxyModel   m_descendantProxy;
-    QSortFilterProxyModel    m_placemarkProxyModel;
-    QSortFilterProxyModel    m_groundOverlayProxyModel;
+    PlacemarkRegistry        m_placemarkRegistry;
+    MarblePlacemarkModel     m_placemarkModel;
+    // Only created on demand, flattening the tree model is expensive
+    KDescendantsProxyModel  *m_descendantProxy;
+    QSortFilterProxyModel   *m_groundOverlayProxyModel;
+    PlacemarkSearchIndex     m_placemarkSearchIndex;
 
     // Selection handling
     QItemSelectionModel      m_placemarkSelectionModel;
@@ -197,6 +205,21 @@ class MarbleModelPrivate
     ElevationModel           m_elevationModel;
 };
 
+QSortFilterProxyModel *MarbleModelPrivate::groundOverlayProxyModel()
+{
+    if ( !m_groundOverlayProxyModel ) {
+        m_descendantProxy = new KDescendantsProxyModel;
+        m_descendantProxy->setSourceModel( &m_treeModel );
+
+        m_groundOverlayProxyModel = new QSortFilterProxyModel;
+        m_groundOverlayProxyModel->setFilterFixedString( GeoDataTypes::GeoDataGroundOverlayType );
+        m_groundOverlayProxyModel->setFilterKeyColumn( 1 );
+        m_groundOverlayProxyModel->setSourceModel( m_descendantProxy );
+    }
+
+    return m_groundOverlayProxyModel;
+}
+
 MarbleModel::MarbleModel( QObject *parent )
     : QObject( parent ),
       d( new MarbleModelPrivate() )
@@ -557,22 +580,32 @@ const GeoDataTreeModel *MarbleModel::treeModel() const
 
 QAbstractItemModel *MarbleModel::placemarkModel()
 {
-    return &d->m_placemarkProxyModel;
+    return &d->m_placemarkModel;
 }
 
 const QAbstractItemModel *MarbleModel::placemarkModel() const
 {
-    return &d->m_placemarkProxyModel;
+    return &d->m_placemarkModel;
+}
+
+const PlacemarkRegistry *MarbleModel::placemarkRegistry() const
+{
+    return &d->m_placemarkRegistry;
+}
+
+const PlacemarkSearchIndex *MarbleModel::placemarkSearchIndex() const
+{
+    return &d->m_placemarkSearchIndex;
 }
 
 QAbstractItemModel *MarbleModel::groundOverlayModel()
 {
-    return &d->m_groundOverlayProxyModel;
+    return d->groundOverlayProxyModel();
 }
 
 const QAbstractItemModel *MarbleModel::groundOverlayModel() const
 {
-    return &d->m_groundOverlayProxyModel;
+    return d->groundOverlayProxyModel();
 }
 
 QItemSelectionModel *MarbleModel::placemarkSelectionModel()
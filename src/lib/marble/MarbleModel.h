@@ -50,6 +50,8 @@ class AbstractDataPluginItem;
 class GeoDataPlacemark;
 class GeoPainter;
 class MeasureTool;
+class PlacemarkRegistry;
+class PlacemarkSearchIndex;
 class PositionTracking;
 class HttpDownloadManager;
 class MarbleModelPrivate;
@@ -119,12 +121,33 @@ class MARBLE_EXPORT MarbleModel : public QObject
     GeoDataTreeModel *treeModel();
     const GeoDataTreeModel *treeModel() const;
 
+    /**
+     * @brief Return a flat model of all ground overlays in treeModel()
+     *
+     * The model is created on the first call.
+     */
     QAbstractItemModel *groundOverlayModel();
     const QAbstractItemModel *groundOverlayModel() const;
 
+    /**
+     * @brief Return a flat list model of all placemarks in treeModel()
+     */
     QAbstractItemModel *placemarkModel();
     const QAbstractItemModel *placemarkModel() const;
 
+    /**
+     * @brief Return the placemarks and ground overlays in treeModel()
+     *
+     * Prefer it over placemarkModel() and groundOverlayModel() to follow
+     * the features that are added and removed.
+     */
+    const PlacemarkRegistry *placemarkRegistry() const;
+
+    /**
+     * @brief Return the prefix index over the names of the placemarks in placemarkModel()
+     */
+    const PlacemarkSearchIndex *placemarkSearchIndex() const;
+
     QItemSelectionModel *placemarkSelectionModel();
 
     /**
@@ -39,7 +39,7 @@ class MarblePlacemarkModel::Private
     }
 
     int m_size;
-    QVector<GeoDataPlacemark*>     *m_placemarkContainer;
+    const QVector<GeoDataPlacemark*> *m_placemarkContainer;
 };
 
 
@@ -66,7 +66,7 @@ MarblePlacemarkModel::~MarblePlacemarkModel()
     delete d;
 }
 
-void MarblePlacemarkModel::setPlacemarkContainer( QVector<GeoDataPlacemark*> *container )
+void MarblePlacemarkModel::setPlacemarkContainer( const QVector<GeoDataPlacemark*> *container )
 {
     d->m_placemarkContainer = container;
 }
@@ -219,4 +219,12 @@ void  MarblePlacemarkModel::removePlacemarks( const QString &containerName,
     }
 }
 
+void MarblePlacemarkModel::resetPlacemarks()
+{
+    beginResetModel();
+    d->m_size = d->m_placemarkContainer ? d->m_placemarkContainer->size() : 0;
+    endResetModel();
+    emit countChanged();
+}
+
 #include "MarblePlacemarkModel.moc"
@@ -79,7 +79,7 @@ class MARBLE_EXPORT MarblePlacemarkModel : public QAbstractListModel
      */
     ~MarblePlacemarkModel();
 
-    void setPlacemarkContainer( QVector<GeoDataPlacemark*> *container );
+    void setPlacemarkContainer( const QVector<GeoDataPlacemark*> *container );
 
     /**
      * Return the number of Placemarks in the Model.
@@ -121,6 +121,13 @@ class MARBLE_EXPORT MarblePlacemarkModel : public QAbstractListModel
                            int start,
                            int length );
 
+ public Q_SLOTS:
+    /**
+     * Resets the model to the current content of the place mark container.
+     * Used when place marks were added or removed at arbitrary positions.
+     */
+    void resetPlacemarks();
+
 Q_SIGNALS:
     void countChanged();
 
@@ -55,13 +55,14 @@ void MarblePluginSettingsWidgetPrivate::showPluginAboutDialog( const QModelIndex
 
     QPointer<PluginAboutDialog> aboutDialog = new PluginAboutDialog( q );
 
+    // Asking for the authors creates a plugin that is only listed from its metadata
+    aboutDialog->setAuthors( m_pluginModel->pluginAuthors( index ) );
     aboutDialog->setName( m_pluginModel->data( index, RenderPluginModel::Name ).toString() );
     aboutDialog->setIcon( qvariant_cast<QIcon>( m_pluginModel->data( index, RenderPluginModel::Icon ) ) );
     aboutDialog->setVersion( m_pluginModel->data( index, RenderPluginModel::Version ).toString() );
     aboutDialog->setDataText( m_pluginModel->data( index, RenderPluginModel::AboutDataText ).toString() );
     const QString copyrightText = QObject::tr( "<br/>(c) %1 The Marble Project<br /><br/><a href=\"http://edu.kde.org/marble\">http://edu.kde.org/marble</a>" );
     aboutDialog->setAboutText( copyrightText.arg( m_pluginModel->data( index, RenderPluginModel::CopyrightYears ).toString() ) );
-    aboutDialog->setAuthors( m_pluginModel->pluginAuthors( index ) );
 
     aboutDialog->exec();
     delete aboutDialog;
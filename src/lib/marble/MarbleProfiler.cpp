@@ -0,0 +1,257 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2014 The Marble contributors
+//
+
+#include "MarbleProfiler.h"
+
+#include "MarbleDebug.h"
+
+#include <QAtomicInt>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QList>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSet>
+#include <QThread>
+#include <QThreadStorage>
+#include <QVector>
+
+namespace Marble
+{
+
+QAtomicInt MarbleProfiler::m_enabled;
+
+namespace
+{
+
+class ProfilerEvent
+{
+public:
+    ProfilerEvent() : m_name( 0 ), m_start( 0 ), m_duration( 0 ) {}
+
+    const char *m_name;
+    qint64 m_start;
+    qint64 m_duration;
+};
+
+/**
+  * Ring buffer of a single thread. Only the owning thread writes events; the write
+  * counter is published with release semantics so that readers in other threads
+  * see complete events. Readers detect and drop slots overwritten while copying.
+  */
+class ProfilerBuffer
+{
+public:
+    enum { Capacity = 16384 };
+
+    ProfilerBuffer( int threadId, const QString &threadName ) :
+        m_threadId( threadId ),
+        m_threadName( threadName ),
+        m_events( Capacity ),
+        m_localWritten( 0 ),
+        m_written( 0 ),
+        m_resetAt( 0 )
+    {
+    }
+
+    void add( const char *name, qint64 start, qint64 duration )
+    {
+        const int index = m_localWritten;
+        ProfilerEvent &event = m_events[index % Capacity];
+        event.m_name = name;
+        event.m_start = start;
+        event.m_duration = duration;
+        m_localWritten = index + 1;
+        m_written.fetchAndStoreRelease( m_localWritten );
+    }
+
+    QVector<ProfilerEvent> events() const
+    {
+        const int first = m_written.fetchAndAddAcquire( 0 );
+        const int resetAt = m_resetAt.fetchAndAddAcquire( 0 );
+        const int begin = qMax( resetAt, first - Capacity );
+        QVector<ProfilerEvent> result;
+        result.reserve( first - begin );
+        for ( int i = begin; i < first; ++i ) {
+            result << m_events[i % Capacity];
+        }
+
+        // Drop events that the writer overwrote while they were copied. The writer
+        // may be filling the slot of event last - Capacity, which is not yet published.
+        const int last = m_written.fetchAndAddAcquire( 0 );
+        const int overwritten = qMax( 0, last + 1 - Capacity - begin );
+        return result.mid( qMin( overwritten, result.size() ) );
+    }
+
+    void clear()
+    {
+        m_resetAt.fetchAndStoreRelease( m_written.fetchAndAddAcquire( 0 ) );
+    }
+
+    const int m_threadId;
+    const QString m_threadName;
+
+private:
+    QVector<ProfilerEvent> m_events;
+    int m_localWritten;
+    mutable QAtomicInt m_written;
+    mutable QAtomicInt m_resetAt;
+};
+
+/**
+  * Owns the buffers of all threads, including those of finished threads
+  */
+class ProfilerRegistry
+{
+public:
+    ProfilerRegistry()
+    {
+        m_timer.start();
+    }
+
+    ~ProfilerRegistry()
+    {
+        qDeleteAll( m_buffers );
+    }
+
+    ProfilerBuffer *createBuffer()
+    {
+        QMutexLocker locker( &m_mutex );
+        QThread *const thread = QThread::currentThread();
+        QString threadName = thread ? thread->objectName() : QString();
+        if ( threadName.isEmpty() ) {
+            const bool mainThread = QCoreApplication::instance() && thread == QCoreApplication::instance()->thread();
+            threadName = mainThread ? QString( "Main Thread" ) : QString( "Thread %1" ).arg( m_buffers.size() );
+        }
+        ProfilerBuffer *const buffer = new ProfilerBuffer( m_buffers.size(), threadName );
+        m_buffers << buffer;
+        return buffer;
+    }
+
+    QList<ProfilerBuffer *> buffers()
+    {
+        QMutexLocker locker( &m_mutex );
+        return m_buffers;
+    }
+
+    const char *intern( const QString &name )
+    {
+        QMutexLocker locker( &m_mutex );
+        QSet<QByteArray>::const_iterator it = m_names.insert( name.toUtf8() );
+        return it->constData();
+    }
+
+    QElapsedTimer m_timer;
+
+private:
+    QMutex m_mutex;
+    QList<ProfilerBuffer *> m_buffers;
+    QSet<QByteArray> m_names;
+};
+
+/**
+  * Thread local handle of a buffer. Deleting it at thread exit leaves the buffer
+  * in the registry so that events of finished threads can still be exported.
+  */
+class ProfilerBufferHandle
+{
+public:
+    explicit ProfilerBufferHandle( ProfilerBuffer *buffer ) : m_buffer( buffer ) {}
+
+    ProfilerBuffer *const m_buffer;
+};
+
+Q_GLOBAL_STATIC( ProfilerRegistry, profilerRegistry )
+
+QThreadStorage<ProfilerBufferHandle *> s_threadBuffer;
+
+QByteArray escaped( const QByteArray &text )
+{
+    QByteArray result = text;
+    result.replace( '\\', "\\\\" );
+    result.replace( '"', "\\\"" );
+    return result;
+}
+
+}
+
+void MarbleProfiler::setEnabled( bool enabled )
+{
+    // make sure the time base is set up before recording starts
+    profilerRegistry();
+    m_enabled.fetchAndStoreOrdered( enabled ? 1 : 0 );
+}
+
+qint64 MarbleProfiler::timestamp()
+{
+    return profilerRegistry()->m_timer.nsecsElapsed();
+}
+
+void MarbleProfiler::addEvent( const char *name, qint64 start, qint64 duration )
+{
+    if ( !s_threadBuffer.hasLocalData() ) {
+        s_threadBuffer.setLocalData( new ProfilerBufferHandle( profilerRegistry()->createBuffer() ) );
+    }
+
+    s_threadBuffer.localData()->m_buffer->add( name, start, duration );
+}
+
+const char *MarbleProfiler::internedName( const QString &name )
+{
+    return profilerRegistry()->intern( name );
+}
+
+void MarbleProfiler::clear()
+{
+    foreach( ProfilerBuffer *buffer, profilerRegistry()->buffers() ) {
+        buffer->clear();
+    }
+}
+
+QByteArray MarbleProfiler::chromeTrace()
+{
+    QByteArray result = "{\"traceEvents\":[\n";
+    bool first = true;
+
+    foreach( const ProfilerBuffer *buffer, profilerRegistry()->buffers() ) {
+        const QByteArray tid = QByteArray::number( buffer->m_threadId );
+        if ( !first ) {
+            result += ",\n";
+        }
+        first = false;
+        result += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + tid
+                + ",\"args\":{\"name\":\"" + escaped( buffer->m_threadName.toUtf8() ) + "\"}}";
+
+        foreach( const ProfilerEvent &event, buffer->events() ) {
+            // timestamps are given in microseconds
+            result += ",\n{\"name\":\"" + escaped( event.m_name ) + "\",\"cat\":\"marble\",\"ph\":\"X\",\"pid\":1,\"tid\":" + tid
+                    + ",\"ts\":" + QByteArray::number( event.m_start / 1000.0, 'f', 3 )
+                    + ",\"dur\":" + QByteArray::number( event.m_duration / 1000.0, 'f', 3 ) + "}";
+        }
+    }
+
+    result += "\n],\"displayTimeUnit\":\"ms\"}\n";
+    return result;
+}
+
+bool MarbleProfiler::writeChromeTrace( const QString &fileName )
+{
+    QFile file( fileName );
+    if ( !file.open( QIODevice::WriteOnly | QIODevice::Truncate ) ) {
+        mDebug() << "Cannot write profiling data to" << fileName << ":" << file.errorString();
+        return false;
+    }
+
+    const QByteArray trace = chromeTrace();
+    return file.write( trace ) == trace.size();
+}
+
+}
@@ -0,0 +1,136 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2014 The Marble contributors
+//
+
+#ifndef MARBLE_MARBLEPROFILER_H
+#define MARBLE_MARBLEPROFILER_H
+
+#include "marble_export.h"
+
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QString>
+
+namespace Marble
+{
+
+/**
+  * @short Low overhead recorder of nested timing scopes
+  *
+  * Each thread records into its own fixed size ring buffer without taking locks.
+  * Once the buffer of a thread is full, its oldest events are overwritten.
+  * The recorded events can be exported in the Chrome trace event format
+  * (load it in chrome://tracing or any compatible viewer).
+  *
+  * Recording is disabled by default. While disabled, a ProfilerScope costs a
+  * single branch.
+  *
+  * @see ProfilerScope, MARBLE_PROFILE_SCOPE
+  */
+class MARBLE_EXPORT MarbleProfiler
+{
+public:
+    /**
+     * @brief Returns whether timing scopes are recorded
+     */
+    static bool isEnabled()
+    {
+#if QT_VERSION >= 0x050000
+        return m_enabled.load();
+#else
+        return m_enabled;
+#endif
+    }
+
+    /**
+     * @brief Toggle the recording of timing scopes
+     * May be called from any thread, also while other threads are rendering.
+     */
+    static void setEnabled( bool enabled );
+
+    /**
+     * @brief Returns the number of nanoseconds passed since the profiler was first used
+     */
+    static qint64 timestamp();
+
+    /**
+     * @brief Records a finished scope in the ring buffer of the calling thread
+     * @param name scope name. The pointer must stay valid until the events are exported,
+     *        use a string literal or internedName()
+     * @param start timestamp() when the scope was entered
+     * @param duration time spent in the scope, in nanoseconds
+     */
+    static void addEvent( const char *name, qint64 start, qint64 duration );
+
+    /**
+     * @brief Returns a pointer to a copy of @p name which stays valid for the lifetime of
+     * the application. Use it to record events with dynamic names.
+     */
+    static const char *internedName( const QString &name );
+
+    /**
+     * @brief Discards all events recorded so far
+     */
+    static void clear();
+
+    /**
+     * @brief Returns all recorded events in the Chrome trace event JSON format
+     */
+    static QByteArray chromeTrace();
+
+    /**
+     * @brief Writes chromeTrace() to the given file
+     * @return true if the file was written successfully
+     */
+    static bool writeChromeTrace( const QString &fileName );
+
+private:
+    static QAtomicInt m_enabled;
+};
+
+/**
+  * @short Records the time between its construction and destruction with MarbleProfiler
+  *
+  * Scopes may be nested arbitrarily; they show up as nested slices in the trace.
+  */
+class ProfilerScope
+{
+public:
+    explicit ProfilerScope( const char *name )
+        : m_name( MarbleProfiler::isEnabled() ? name : 0 ),
+          m_start( m_name ? MarbleProfiler::timestamp() : 0 )
+    {
+    }
+
+    ~ProfilerScope()
+    {
+        if ( m_name ) {
+            MarbleProfiler::addEvent( m_name, m_start, MarbleProfiler::timestamp() - m_start );
+        }
+    }
+
+private:
+    Q_DISABLE_COPY( ProfilerScope )
+
+    const char *const m_name;
+    const qint64 m_start;
+};
+
+}
+
+#define MARBLE_PROFILER_CONCAT_( a, b ) a##b
+#define MARBLE_PROFILER_CONCAT( a, b ) MARBLE_PROFILER_CONCAT_( a, b )
+
+/**
+  * Records the time spent until the end of the enclosing block under the given name
+  */
+#define MARBLE_PROFILE_SCOPE( name ) \
+    Marble::ProfilerScope MARBLE_PROFILER_CONCAT( marbleProfilerScope, __LINE__ )( name )
+
+#endif
@@ -12,9 +12,18 @@
 #include <MarbleQuickItem.h>
 #include <QPainter>
 #include <QPaintDevice>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QQuickWindow>
+#include <QSGSimpleTextureNode>
+#include <QSGTexture>
+#include <QThread>
+#include <QTimer>
 #include <QtMath>
 #include <MarbleModel.h>
 #include <MarbleMap.h>
+#include <OffscreenRenderer.h>
 #include <ViewportParams.h>
 #include <GeoPainter.h>
 #include <GeoDataLookAt.h>
@@ -124,14 +133,310 @@ namespace Marble
         bool m_usePinchArea;
     };
 
+    /**
+     * The view a frame is painted for
+     */
+    class MarbleQuickFrame
+    {
+    public:
+        MarbleQuickFrame() : m_projection(Spherical), m_radius(0), m_quality(NormalQuality) {}
+
+        explicit MarbleQuickFrame(const MarbleMap *map)
+            : m_mapThemeId(map->mapThemeId())
+            ,m_projection(map->projection())
+            ,m_center(map->centerLongitude(), map->centerLatitude(), 0.0, GeoDataCoordinates::Degree)
+            ,m_radius(map->radius())
+            ,m_size(map->size())
+            ,m_quality(map->mapQuality())
+        {
+        }
+
+        QString m_mapThemeId;
+        Projection m_projection;
+        GeoDataCoordinates m_center;
+        int m_radius;
+        QSize m_size;
+        MapQuality m_quality;
+    };
+
+    /**
+     * Paints the frames of a MarbleQuickItem in TextureRendering mode.
+     *
+     * The thread paints with a model and a map of its own, which take over the
+     * state of the map of the item whenever it changes. Requests are coalesced:
+     * only the latest one is painted once the thread is done with the current
+     * frame. The painted frame is kept until updatePaintNode takes it.
+     */
+    class MarbleQuickRenderThread : public QThread
+    {
+        Q_OBJECT
+
+    public:
+        MarbleQuickRenderThread()
+            : m_worker(0)
+            ,m_hasRequest(false)
+            ,m_stateChanged(false)
+            ,m_scheduled(false)
+            ,m_frameChanged(false)
+            ,m_hasAppliedState(false)
+            ,m_painting(false)
+        {
+        }
+
+        ~MarbleQuickRenderThread()
+        {
+            quit();
+            wait();
+        }
+
+        /**
+         * Replaces the frame to be painted next. The map of the thread takes
+         * over @p state if it differs from the one passed before.
+         */
+        void requestFrame(const MarbleQuickFrame &frame, const OffscreenRenderer::MapState &state)
+        {
+            QMutexLocker locker(&m_mutex);
+            m_request = frame;
+            m_hasRequest = true;
+            if (state != m_state)
+            {
+                m_state = state;
+                m_stateChanged = true;
+            }
+            schedule();
+        }
+
+        /**
+         * Returns the last painted frame if it was not taken before
+         */
+        bool takeFrame(QImage &image, MarbleQuickFrame &frame)
+        {
+            QMutexLocker locker(&m_mutex);
+            if (!m_frameChanged)
+            {
+                return false;
+            }
+
+            image = m_frontBuffer;
+            frame = m_frame;
+            m_frameChanged = false;
+            return true;
+        }
+
+        /**
+         * Paints the latest request again, e.g. when tiles arrived. Called in this thread.
+         */
+        void repaint()
+        {
+            if (m_painting)
+            {   // Layers asking for another frame while being painted would keep the thread busy
+                return;
+            }
+
+            QMutexLocker locker(&m_mutex);
+            schedule();
+        }
+
+        /**
+         * Paints the latest request with @p map. Called in this thread.
+         */
+        void renderFrame(MarbleMap *map)
+        {
+            MarbleQuickFrame frame;
+            OffscreenRenderer::MapState state;
+            bool stateChanged = false;
+            {
+                QMutexLocker locker(&m_mutex);
+                m_scheduled = false;
+                if (!m_hasRequest)
+                {
+                    return;
+                }
+                frame = m_request;
+                stateChanged = m_stateChanged;
+                if (stateChanged)
+                {
+                    state = m_state;
+                    m_stateChanged = false;
+                }
+            }
+
+            if (stateChanged)
+            {
+                state.apply(map, m_hasAppliedState ? &m_appliedState : 0);
+                m_appliedState = state;
+                m_hasAppliedState = true;
+            }
+
+            if (map->mapThemeId() != frame.m_mapThemeId)
+            {   // A new theme starts with default property values
+                map->setMapThemeId(frame.m_mapThemeId);
+                m_appliedState.applyProperties(map);
+            }
+            map->setMapQualityForViewContext(frame.m_quality, Still);
+            map->setProjection(frame.m_projection);
+            map->setSize(frame.m_size);
+            map->setRadius(frame.m_radius);
+            map->centerOn(frame.m_center.longitude(GeoDataCoordinates::Degree),
+                          frame.m_center.latitude(GeoDataCoordinates::Degree));
+
+            if (m_backBuffer.size() != frame.m_size)
+            {
+                m_backBuffer = QImage(frame.m_size, QImage::Format_ARGB32_Premultiplied);
+            }
+            m_backBuffer.fill(Qt::transparent);
+
+            m_painting = true;
+            {
+                GeoPainter geoPainter(&m_backBuffer, map->viewport(), map->mapQuality());
+                geoPainter.setOpacity(0.9);
+                map->paint(geoPainter, QRect(QPoint(0, 0), frame.m_size));
+            }
+            m_painting = false;
+
+            {
+                QMutexLocker locker(&m_mutex);
+                qSwap(m_frontBuffer, m_backBuffer);
+                m_frame = frame;
+                m_frameChanged = true;
+            }
+            emit frameReady();
+        }
+
+    signals:
+        /**
+         * Emitted in this thread when a frame was painted
+         */
+        void frameReady();
+
+    protected:
+        void run();
+
+    private:
+        // Posts a call of renderFrame unless one is pending; m_mutex must be locked
+        void schedule();
+
+        QMutex m_mutex;
+        QObject *m_worker;
+        MarbleQuickFrame m_request;
+        OffscreenRenderer::MapState m_state;
+        bool m_hasRequest;
+        bool m_stateChanged;
+        bool m_scheduled;
+
+        // The last painted frame, shown by the item
+        QImage m_frontBuffer;
+        MarbleQuickFrame m_frame;
+        bool m_frameChanged;
+
+        // Used in this thread only
+        QImage m_backBuffer;
+        OffscreenRenderer::MapState m_appliedState;
+        bool m_hasAppliedState;
+        bool m_painting;
+    };
+
+    /**
+     * Receives the calls of MarbleQuickRenderThread in its thread
+     */
+    class MarbleQuickRenderWorker : public QObject
+    {
+        Q_OBJECT
+
+    public:
+        MarbleQuickRenderWorker(MarbleQuickRenderThread *thread, MarbleMap *map)
+            : m_thread(thread)
+            ,m_map(map)
+        {
+        }
+
+    public slots:
+        void renderFrame()
+        {
+            m_thread->renderFrame(m_map);
+        }
+
+        void repaint()
+        {
+            m_thread->repaint();
+        }
+
+    private:
+        MarbleQuickRenderThread *const m_thread;
+        MarbleMap *const m_map;
+    };
+
+    void MarbleQuickRenderThread::run()
+    {
+        // Created here so that they belong to this thread
+        MarbleModel model;
+        MarbleMap map(&model);
+        map.setViewContext(Still);
+        MarbleQuickRenderWorker worker(this, &map);
+        connect(&map, SIGNAL(repaintNeeded(QRegion)), &worker, SLOT(repaint()));
+
+        {
+            QMutexLocker locker(&m_mutex);
+            m_worker = &worker;
+            schedule();
+        }
+
+        exec();
+
+        QMutexLocker locker(&m_mutex);
+        m_worker = 0;
+        m_scheduled = false;
+    }
+
+    void MarbleQuickRenderThread::schedule()
+    {
+        if (m_worker && m_hasRequest && !m_scheduled)
+        {
+            m_scheduled = true;
+            QMetaObject::invokeMethod(m_worker, "renderFrame", Qt::QueuedConnection);
+        }
+    }
+
     class MarbleQuickItemPrivate : public MarbleAbstractPresenter
     {
     public:
         MarbleQuickItemPrivate(MarbleQuickItem *marble) : MarbleAbstractPresenter()
           ,m_marble(marble)
           ,m_inputHandler(this, marble)
+          ,m_renderMode(MarbleQuickItem::PaintedRendering)
+          ,m_nodeRenderMode(MarbleQuickItem::PaintedRendering)
+          ,m_frameChanged(false)
+          ,m_frameTime(0)
+        {
+            connect(this, SIGNAL(updateRequired()), m_marble, SLOT(scheduleRepaint()));
+            m_renderTimer.setSingleShot(true);
+            connect(&m_renderTimer, SIGNAL(timeout()), m_marble, SLOT(renderFrame()));
+            connect(&m_renderThread, SIGNAL(frameReady()), m_marble, SLOT(showFrame()));
+        }
+
+        /**
+         * Returns where the front buffer has to be drawn so that it matches
+         * the current viewport. While the view is panned or zoomed, the last
+         * frame is moved and scaled this way until the next one is ready.
+         */
+        QRectF frameRect() const
         {
-            connect(this, SIGNAL(updateRequired()), m_marble, SLOT(update()));
+            QRectF rect(QPointF(0, 0), m_frontBuffer.size());
+            if (m_frame.m_projection != map()->projection() || m_frame.m_radius <= 0)
+            {
+                return rect;
+            }
+
+            qreal x, y;
+            if (!map()->viewport()->screenCoordinates(m_frame.m_center.longitude(), m_frame.m_center.latitude(), x, y))
+            {
+                return rect;
+            }
+
+            qreal const scale = qreal(map()->radius()) / m_frame.m_radius;
+            rect.setSize(rect.size() * scale);
+            rect.moveCenter(QPointF(x, y));
+            return rect;
         }
 
     private:
@@ -139,6 +444,20 @@ namespace Marble
         friend class MarbleQuickItem;
 
         MarbleQuickInputHandler m_inputHandler;
+
+        MarbleQuickItem::RenderMode m_renderMode;
+        MarbleQuickItem::RenderMode m_nodeRenderMode;
+
+        // The frame shown, taken from the render thread or painted here
+        QImage m_frontBuffer;
+        MarbleQuickFrame m_frame;
+        bool m_frameChanged;
+
+        QTimer m_renderTimer;
+        int m_frameTime;
+
+        // Started with the first frame in TextureRendering mode
+        MarbleQuickRenderThread m_renderThread;
     };
 
     MarbleQuickItem::MarbleQuickItem(QQuickItem *parent) : QQuickPaintedItem(parent)
@@ -150,7 +469,7 @@ namespace Marble
             item->hide();
         }
 
-        connect(d->map(), SIGNAL(repaintNeeded(QRegion)), this, SLOT(update()));
+        connect(d->map(), SIGNAL(repaintNeeded(QRegion)), this, SLOT(scheduleRepaint()));
         connect(this, SIGNAL(widthChanged()), this, SLOT(resizeMap()));
         connect(this, SIGNAL(heightChanged()), this, SLOT(resizeMap()));
 
@@ -166,11 +485,154 @@ namespace Marble
         int newHeight = height() > minHeight ? (int)height() : minHeight;
 
         d->map()->setSize(newWidth, newHeight);
-        update();
+        scheduleRepaint();
+    }
+
+    MarbleQuickItem::RenderMode MarbleQuickItem::renderMode() const
+    {
+        return d->m_renderMode;
+    }
+
+    void MarbleQuickItem::setRenderMode(RenderMode mode)
+    {
+        if (mode == d->m_renderMode)
+        {
+            return;
+        }
+
+        d->m_renderMode = mode;
+        d->m_renderTimer.stop();
+        d->m_frontBuffer = QImage();
+        d->m_frame = MarbleQuickFrame();
+        scheduleRepaint();
+        emit renderModeChanged(mode);
+    }
+
+    void MarbleQuickItem::scheduleRepaint()
+    {
+        if (d->m_renderMode == PaintedRendering)
+        {
+            update();
+            return;
+        }
+
+        // Show the last frame moved to the new viewport right away
+        QQuickItem::update();
+
+        // Coalesces the requests of one event loop iteration. Frames painted in
+        // this thread (see renderFrame) leave as much time for input handling
+        // as painting takes, so that slow frames do not pile up while panning.
+        if (!d->m_renderTimer.isActive())
+        {
+            d->m_renderTimer.start(qMin(d->m_frameTime, 100));
+        }
+    }
+
+    void MarbleQuickItem::renderFrame()
+    {
+        if (d->m_renderMode != TextureRendering)
+        {
+            return;
+        }
+
+        MarbleQuickFrame const frame(d->map());
+        OffscreenRenderer::MapState const state(d->map());
+        if (state.isCopyable())
+        {
+            if (!d->m_renderThread.isRunning())
+            {
+                d->m_renderThread.start();
+            }
+            d->m_renderThread.requestFrame(frame, state);
+            d->m_frameTime = 0;
+            return;
+        }
+
+        // The map of the render thread cannot load all documents of the model,
+        // e.g. those added as data strings, so the frame is painted here
+        QElapsedTimer timer;
+        timer.start();
+
+        QImage image(frame.m_size, QImage::Format_ARGB32_Premultiplied);
+        image.fill(Qt::transparent);
+        {
+            GeoPainter geoPainter(&image, d->map()->viewport(), d->map()->mapQuality());
+            geoPainter.setOpacity(0.9);
+            d->map()->paint(geoPainter, QRect(QPoint(0, 0), frame.m_size));
+        }
+
+        d->m_frontBuffer = image;
+        d->m_frame = frame;
+        d->m_frameChanged = true;
+        d->m_frameTime = timer.elapsed();
+
+        QQuickItem::update();
+    }
+
+    void MarbleQuickItem::showFrame()
+    {
+        if (d->m_renderMode == TextureRendering)
+        {
+            QQuickItem::update();
+        }
+    }
+
+    QSGNode *MarbleQuickItem::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data)
+    {
+        if (oldNode && d->m_nodeRenderMode != d->m_renderMode)
+        {
+            delete oldNode;
+            oldNode = 0;
+        }
+        d->m_nodeRenderMode = d->m_renderMode;
+
+        if (d->m_renderMode == PaintedRendering)
+        {
+            return QQuickPaintedItem::updatePaintNode(oldNode, data);
+        }
+
+        // Runs in the scene graph render thread while the thread of the item is blocked
+        QImage image;
+        MarbleQuickFrame frame;
+        if (d->m_renderThread.takeFrame(image, frame) && frame.m_mapThemeId == d->map()->mapThemeId())
+        {
+            d->m_frontBuffer = image;
+            d->m_frame = frame;
+            d->m_frameChanged = true;
+        }
+
+        if (d->m_frontBuffer.isNull())
+        {
+            delete oldNode;
+            return 0;
+        }
+
+        QSGSimpleTextureNode *node = static_cast<QSGSimpleTextureNode*>(oldNode);
+        if (!node)
+        {
+            node = new QSGSimpleTextureNode;
+            node->setOwnsTexture(true);
+            d->m_frameChanged = true;
+        }
+
+        if (d->m_frameChanged)
+        {
+            // Works with the software backend as well, no GPU context needed here
+            node->setTexture(window()->createTextureFromImage(d->m_frontBuffer));
+            d->m_frameChanged = false;
+        }
+
+        node->setRect(d->frameRect());
+        return node;
     }
 
     void MarbleQuickItem::paint(QPainter *painter)
     {   //TODO - much to be done here still, i.e paint !enabled version
+        if (d->m_renderMode != PaintedRendering)
+        {
+            return;
+        }
+
         QPaintDevice *paintDevice = painter->device();
         QImage image;
         QRect rect = contentsBoundingRect().toRect();
@@ -247,3 +709,5 @@ namespace Marble
         d->m_inputHandler.pinch(center, scale, state);
     }
 }
+
+#include "MarbleQuickItem.moc"
@@ -26,10 +26,24 @@ namespace Marble
     class MARBLE_EXPORT MarbleQuickItem : public QQuickPaintedItem
     {
     Q_OBJECT
+    Q_ENUMS(RenderMode)
+    Q_PROPERTY(RenderMode renderMode READ renderMode WRITE setRenderMode NOTIFY renderModeChanged)
 
     public:
+        enum RenderMode
+        {
+            PaintedRendering, ///< Paint through QQuickPaintedItem on the scene graph render thread
+            TextureRendering  ///< Paint double-buffered images in a worker thread, hand them over as textures
+        };
+
         MarbleQuickItem(QQuickItem *parent = 0);
 
+        RenderMode renderMode() const;
+        void setRenderMode(RenderMode mode);
+
+    signals:
+        void renderModeChanged(RenderMode mode);
+
     public slots:
         void goHome();
         void setZoom(int zoom, FlyToMode mode = Instant);
@@ -47,6 +61,9 @@ namespace Marble
         void classBegin();
         void componentComplete();
 
+    protected:
+        QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data);
+
     protected:
         MarbleModel* model();
         const MarbleModel* model() const;
@@ -59,6 +76,9 @@ namespace Marble
 
     private slots:
         void resizeMap();
+        void scheduleRepaint();
+        void renderFrame();
+        void showFrame();
 
     private:
         typedef QSharedPointer<MarbleQuickItemPrivate> MarbleQuickItemPrivatePtr;
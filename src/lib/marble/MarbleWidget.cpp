@@ -42,6 +42,7 @@
 #include "MarbleMap.h"
 #include "MarbleModel.h"
 #include "MarblePhysics.h"
+#include "PluginManager.h"
 #include "MarbleWidgetInputHandler.h"
 #ifndef SUBSURFACE
 #include "MarbleWidgetPopupMenu.h"
@@ -215,11 +216,15 @@ void MarbleWidgetPrivate::construct()
                        m_widget, SIGNAL(tileLevelChanged(int)) );
     m_widget->connect( map(),   SIGNAL(framesPerSecond(qreal)),
                        m_widget, SIGNAL(framesPerSecond(qreal)) );
+    m_widget->connect( map(),   SIGNAL(frameLatency(int,int)),
+                       m_widget, SIGNAL(frameLatency(int,int)) );
 
     m_widget->connect( map(),   SIGNAL(pluginSettingsChanged()),
                        m_widget, SIGNAL(pluginSettingsChanged()) );
     m_widget->connect( map(),   SIGNAL(renderPluginInitialized(RenderPlugin*)),
                        m_widget, SIGNAL(renderPluginInitialized(RenderPlugin*)) );
+    m_widget->connect( map(),   SIGNAL(renderPluginLoaded(RenderPlugin*)),
+                       m_widget, SIGNAL(renderPluginLoaded(RenderPlugin*)) );
 
     // react to some signals of m_map
     m_widget->connect( map(),   SIGNAL(themeChanged(QString)),
@@ -1050,6 +1055,17 @@ ViewContext MarbleWidget::viewContext() const
     return d->viewContext();
 }
 
+void MarbleWidget::setProgressiveRendering( bool enabled )
+{
+    d->map()->setProgressiveRendering( enabled );
+    update();
+}
+
+bool MarbleWidget::progressiveRendering() const
+{
+    return d->map()->progressiveRendering();
+}
+
 void MarbleWidget::setViewContext( ViewContext viewContext )
 {   //TODO - move to MarbleAbstractPresenter as soon as RoutingLayer is ported there, replace with pImpl call
     if ( d->map()->viewContext() != viewContext ) {
@@ -1138,8 +1154,24 @@ QList<RenderPlugin *> MarbleWidget::renderPlugins() const
     return d->map()->renderPlugins();
 }
 
+QList<RenderPluginMetaData> MarbleWidget::unloadedRenderPlugins() const
+{
+    return d->map()->unloadedRenderPlugins();
+}
+
+RenderPlugin *MarbleWidget::loadRenderPlugin( const QString &nameId )
+{
+    return d->map()->loadRenderPlugin( nameId );
+}
+
 void MarbleWidget::readPluginSettings( QSettings& settings )
 {
+    foreach( const RenderPluginMetaData &metaData, unloadedRenderPlugins() ) {
+        if ( settings.value( QString( "plugin_%1/enabled" ).arg( metaData.nameId ), false ).toBool() ) {
+            loadRenderPlugin( metaData.nameId );
+        }
+    }
+
     foreach( RenderPlugin *plugin, renderPlugins() ) {
         settings.beginGroup( QString( "plugin_" ) + plugin->nameId() );
 
@@ -53,6 +53,7 @@ class MarbleWidgetPopupMenu;
 class MarbleWidgetInputHandler;
 class MarbleWidgetPrivate;
 class RenderPlugin;
+struct RenderPluginMetaData;
 class RoutingLayer;
 class TextureLayer;
 class TileCoordsPyramid;
@@ -192,6 +193,18 @@ class MARBLE_EXPORT MarbleWidget : public QWidget
      */
     QList<RenderPlugin *> renderPlugins() const;
 
+    /**
+     * @brief Returns the RenderPlugins which are disabled by default and not created yet
+     * @see MarbleMap::unloadedRenderPlugins()
+     */
+    QList<RenderPluginMetaData> unloadedRenderPlugins() const;
+
+    /**
+     * @brief Returns the RenderPlugin with the given name id, creating it if needed
+     * @see MarbleMap::loadRenderPlugin()
+     */
+    RenderPlugin *loadRenderPlugin( const QString &nameId );
+
     /**
      * @brief Returns a list of all FloatItems on the widget
      * @return the list of the floatItems
@@ -208,6 +221,7 @@ class MARBLE_EXPORT MarbleWidget : public QWidget
 
     /**
      * Reads the plugin settings from the passed QSettings.
+     * Plugins which are not created yet are loaded if the settings enable them.
      * You shouldn't use this in a KDE application as these use KConfig. Here you could
      * use MarblePart which is handling this automatically.
      * @param settings The QSettings object to be used.
@@ -227,6 +241,11 @@ class MARBLE_EXPORT MarbleWidget : public QWidget
      */
     ViewContext viewContext() const;
 
+    /**
+     * @brief Return whether still frames are rendered progressively
+     */
+    bool progressiveRendering() const;
+
     /**
      * @brief Get the GeoSceneDocument object of the current map theme
      */
@@ -947,6 +966,16 @@ class MARBLE_EXPORT MarbleWidget : public QWidget
      */
     void setViewContext( ViewContext viewContext );
 
+    /**
+     * @brief Set whether still frames are rendered progressively
+     *
+     * If enabled, the map shows a low quality texture at once when an
+     * animation ends and swaps in the high quality texture once it was
+     * computed on a worker thread.
+     * @see MarbleMap::setProgressiveRendering()
+     */
+    void setProgressiveRendering( bool enabled );
+
     /**
      * @brief Set whether travels to a point should get animated
      */
@@ -1034,6 +1063,11 @@ class MARBLE_EXPORT MarbleWidget : public QWidget
 
     void framesPerSecond( qreal fps );
 
+    /**
+     * @see MarbleMap::frameLatency()
+     */
+    void frameLatency( int previewLatency, int refinedLatency );
+
     /** This signal is emit when a new rectangle region is selected over the map 
      *  The list of double values include coordinates in degrees using this order:
      *  lon1, lat1, lon2, lat2 (or West, North, East, South) as left/top, right/bottom rectangle.
@@ -1050,6 +1084,12 @@ class MARBLE_EXPORT MarbleWidget : public QWidget
      */
     void renderPluginInitialized( RenderPlugin *renderPlugin );
 
+    /**
+     * @brief Signal that a render plugin disabled by default has been created
+     * @see loadRenderPlugin
+     */
+    void renderPluginLoaded( RenderPlugin *renderPlugin );
+
     /**
      * This signal is emitted when the visible region of the map changes. This typically happens
      * when the user moves the map around or zooms.
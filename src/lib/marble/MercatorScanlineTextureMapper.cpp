@@ -23,6 +23,8 @@
 // Marble
 #include "GeoPainter.h"
 #include "MarbleDebug.h"
+#include "MarbleProfiler.h"
+#include "ScanlineChunkQueue.h"
 #include "ScanlineTextureMapperContext.h"
 #include "StackedTileLoader.h"
 #include "TextureColorizer.h"
@@ -35,7 +37,7 @@ using namespace Marble;
 class MercatorScanlineTextureMapper::RenderJob : public QRunnable
 {
 public:
-    RenderJob( StackedTileLoader *tileLoader, int tileLevel, QImage *canvasImage, const ViewportParams *viewport, MapQuality mapQuality, int yTop, int yBottom );
+    RenderJob( StackedTileLoader *tileLoader, int tileLevel, QImage *canvasImage, const ViewportParams *viewport, MapQuality mapQuality, ScanlineChunkQueue *queue, int xLeft, int xRight );
 
     virtual void run();
 
@@ -45,18 +47,20 @@ private:
     QImage *const m_canvasImage;
     const ViewportParams *const m_viewport;
     const MapQuality m_mapQuality;
-    const int m_yPaintedTop;
-    const int m_yPaintedBottom;
+    ScanlineChunkQueue *const m_queue;
+    const int m_xLeft;
+    const int m_xRight;
 };
 
-MercatorScanlineTextureMapper::RenderJob::RenderJob( StackedTileLoader *tileLoader, int tileLevel, QImage *canvasImage, const ViewportParams *viewport, MapQuality mapQuality, int yTop, int yBottom )
+MercatorScanlineTextureMapper::RenderJob::RenderJob( StackedTileLoader *tileLoader, int tileLevel, QImage *canvasImage, const ViewportParams *viewport, MapQuality mapQuality, ScanlineChunkQueue *queue, int xLeft, int xRight )
     : m_tileLoader( tileLoader ),
       m_tileLevel( tileLevel ),
       m_canvasImage( canvasImage ),
       m_viewport( viewport ),
       m_mapQuality( mapQuality ),
-      m_yPaintedTop( yTop ),
-      m_yPaintedBottom( yBottom )
+      m_queue( queue ),
+      m_xLeft( xLeft ),
+      m_xRight( xRight )
 {
 }
 
@@ -64,7 +68,13 @@ MercatorScanlineTextureMapper::MercatorScanlineTextureMapper( StackedTileLoader
     : TextureMapperInterface(),
       m_tileLoader( tileLoader ),
       m_radius( 0 ),
-      m_oldYPaintedTop( 0 )
+      m_oldYPaintedTop( 0 ),
+      m_centerChanged( false ),
+      m_oldCenterLon( 0.0 ),
+      m_oldYCenterOffset( 0 ),
+      m_scrollError( 0.0 ),
+      m_oldTileZoomLevel( -1 ),
+      m_oldMapQuality( NormalQuality )
 {
 }
 
@@ -89,6 +99,14 @@ void MercatorScanlineTextureMapper::mapTexture( GeoPainter *painter,
         m_repaintNeeded = true;
     }
 
+    // Colorizing works on whole images, hence colorized maps are not scrolled
+    if ( m_centerChanged && !m_repaintNeeded ) {
+        const bool canScroll = !texColorizer
+                               && tileZoomLevel == m_oldTileZoomLevel
+                               && painter->mapQuality() == m_oldMapQuality;
+        m_repaintNeeded = !canScroll || !scrollTexture( viewport, tileZoomLevel, painter->mapQuality() );
+    }
+
     if ( m_repaintNeeded ) {
         mapTexture( viewport, tileZoomLevel, painter->mapQuality() );
 
@@ -96,14 +114,23 @@ void MercatorScanlineTextureMapper::mapTexture( GeoPainter *painter,
             texColorizer->colorize( &m_canvasImage, viewport, painter->mapQuality() );
         }
 
+        m_scrollError = 0.0;
         m_repaintNeeded = false;
     }
 
+    m_centerChanged = false;
+    m_oldCenterLon = viewport->centerLongitude();
+    m_oldYCenterOffset = yCenterOffset( viewport );
+    m_oldTileZoomLevel = tileZoomLevel;
+    m_oldMapQuality = painter->mapQuality();
+
     painter->drawImage( dirtyRect, m_canvasImage, dirtyRect );
 }
 
 void MercatorScanlineTextureMapper::mapTexture( const ViewportParams *viewport, int tileZoomLevel, MapQuality mapQuality )
 {
+    MARBLE_PROFILE_SCOPE( "MercatorScanlineTextureMapper::mapTexture" );
+
     // Reset backend
     m_tileLoader->resetTilehash();
 
@@ -128,11 +155,11 @@ void MercatorScanlineTextureMapper::mapTexture( const ViewportParams *viewport,
     yPaintedBottom = qBound(0, yPaintedBottom, imageHeight);
 
     const int numThreads = m_threadPool.maxThreadCount();
-    const int yStep = ( yPaintedBottom - yPaintedTop ) / numThreads;
-    for ( int i = 0; i < numThreads; ++i ) {
-        const int yStart = yPaintedTop +  i      * yStep;
-        const int yEnd   = yPaintedTop + (i + 1) * yStep;
-        QRunnable *const job = new RenderJob( m_tileLoader, tileZoomLevel, &m_canvasImage, viewport, mapQuality, yStart, yEnd );
+    const int rowAlignment = ( mapQuality == LowQuality ) ? 2 : 1;
+    ScanlineChunkQueue queue( yPaintedTop, yPaintedBottom, QVector<int>(),
+                              numThreads, rowAlignment, &m_cancelled );
+    for ( int i = 0; i < qMin( numThreads, queue.chunkCount() ); ++i ) {
+        QRunnable *const job = new RenderJob( m_tileLoader, tileZoomLevel, &m_canvasImage, viewport, mapQuality, &queue, 0, m_canvasImage.width() );
         m_threadPool.start( job );
     }
 
@@ -154,9 +181,124 @@ void MercatorScanlineTextureMapper::mapTexture( const ViewportParams *viewport,
     m_tileLoader->cleanupTilehash();
 }
 
+void MercatorScanlineTextureMapper::setCenterChanged()
+{
+    m_centerChanged = true;
+}
+
+bool MercatorScanlineTextureMapper::scrollTexture( const ViewportParams *viewport, int tileZoomLevel, MapQuality mapQuality )
+{
+    MARBLE_PROFILE_SCOPE( "MercatorScanlineTextureMapper::scrollTexture" );
+
+    const int imageWidth  = m_canvasImage.width();
+    const int imageHeight = m_canvasImage.height();
+    const qint64 radius   = viewport->radius();
+    // Calculate how many degrees are being represented per pixel.
+    const float rad2Pixel = (float)( 2 * radius ) / M_PI;
+
+    // Longitudes map linearly onto x, so the offset of the center is a
+    // whole number of pixels for panning by pixels only up to rounding
+    // errors. These are summed up so that the frame never drifts by more
+    // than half a pixel.
+    qreal lonDelta = viewport->centerLongitude() - m_oldCenterLon;
+    while ( lonDelta < -M_PI ) lonDelta += 2 * M_PI;
+    while ( lonDelta >  M_PI ) lonDelta -= 2 * M_PI;
+    const qreal realDx = -lonDelta * rad2Pixel;
+    const int dx = qRound( realDx );
+    const qreal scrollError = m_scrollError + realDx - dx;
+
+    // Scanlines are placed by an integral offset already
+    const int dy = yCenterOffset( viewport ) - m_oldYCenterOffset;
+
+    if ( qAbs( scrollError ) > 0.5 || qAbs( dx ) >= imageWidth || qAbs( dy ) >= imageHeight ) {
+        return false;
+    }
+
+    m_scrollError = scrollError;
+
+    if ( dx == 0 && dy == 0 ) {
+        return true;
+    }
+
+    ScanlineTextureMapperContext::scrollCanvasImage( &m_canvasImage, dx, dy );
+
+    int yPaintedTop;
+    int yPaintedBottom;
+    paintedRows( viewport, yPaintedTop, yPaintedBottom );
+
+    // Rows that became visible at the top or bottom are painted across the
+    // whole width, the other rows only in the columns uncovered at the side
+    const int newRowsTop    = ( dy > 0 ) ? 0 : imageHeight + dy;
+    const int newRowsBottom = ( dy > 0 ) ? dy : imageHeight;
+    const int oldRowsTop    = ( dy > 0 ) ? dy : 0;
+    const int oldRowsBottom = ( dy > 0 ) ? imageHeight : imageHeight + dy;
+    const int newColumnsLeft  = ( dx > 0 ) ? 0 : imageWidth + dx;
+    const int newColumnsRight = ( dx > 0 ) ? dx : imageWidth;
+
+    // Reset backend
+    m_tileLoader->resetTilehash();
+
+    const int numThreads = m_threadPool.maxThreadCount();
+    const int rowAlignment = ( mapQuality == LowQuality ) ? 2 : 1;
+    ScanlineChunkQueue rowQueue( qMax( newRowsTop, yPaintedTop ), qMin( newRowsBottom, yPaintedBottom ), QVector<int>(),
+                                 numThreads, rowAlignment, &m_cancelled );
+    for ( int i = 0; i < qMin( numThreads, rowQueue.chunkCount() ); ++i ) {
+        QRunnable *const job = new RenderJob( m_tileLoader, tileZoomLevel, &m_canvasImage, viewport, mapQuality, &rowQueue, 0, imageWidth );
+        m_threadPool.start( job );
+    }
+
+    ScanlineChunkQueue columnQueue( qMax( oldRowsTop, yPaintedTop ), qMin( oldRowsBottom, yPaintedBottom ), QVector<int>(),
+                                    numThreads, rowAlignment, &m_cancelled );
+    for ( int i = 0; dx != 0 && i < qMin( numThreads, columnQueue.chunkCount() ); ++i ) {
+        QRunnable *const job = new RenderJob( m_tileLoader, tileZoomLevel, &m_canvasImage, viewport, mapQuality, &columnQueue, newColumnsLeft, newColumnsRight );
+        m_threadPool.start( job );
+    }
+
+    // Remove unused lines
+    const int bytesPerLine = m_canvasImage.bytesPerLine();
+    for ( int y = 0; y < yPaintedTop; ++y ) {
+        memset( m_canvasImage.scanLine( y ), 0, bytesPerLine );
+    }
+    for ( int y = yPaintedBottom; y < imageHeight; ++y ) {
+        memset( m_canvasImage.scanLine( y ), 0, bytesPerLine );
+    }
+
+    m_threadPool.waitForDone();
+
+    m_oldYPaintedTop = yPaintedTop;
+
+    m_tileLoader->cleanupTilehash();
+
+    return true;
+}
+
+void MercatorScanlineTextureMapper::paintedRows( const ViewportParams *viewport, int &yPaintedTop, int &yPaintedBottom ) const
+{
+    const int imageHeight = m_canvasImage.height();
+
+    qreal realYTop, realYBottom, dummyX;
+    GeoDataCoordinates yNorth(0, viewport->currentProjection()->maxLat(), 0);
+    GeoDataCoordinates ySouth(0, viewport->currentProjection()->minLat(), 0);
+    viewport->screenCoordinates(yNorth, dummyX, realYTop );
+    viewport->screenCoordinates(ySouth, dummyX, realYBottom );
+
+    yPaintedTop    = qBound( 0, int( qBound( qreal( 0.0 ), realYTop, qreal( imageHeight ) ) ), imageHeight );
+    yPaintedBottom = qBound( 0, int( qBound( qreal( 0.0 ), realYBottom, qreal( imageHeight ) ) ), imageHeight );
+}
+
+int MercatorScanlineTextureMapper::yCenterOffset( const ViewportParams *viewport )
+{
+    // Same as in RenderJob::run()
+    const float rad2Pixel = (float)( 2 * viewport->radius() ) / M_PI;
+
+    return (int)( asinh( tan( viewport->centerLatitude() ) ) * rad2Pixel );
+}
+
 
 void MercatorScanlineTextureMapper::RenderJob::run()
 {
+    MARBLE_PROFILE_SCOPE( "MercatorScanlineTextureMapper::RenderJob" );
+
     // Scanline based algorithm to do texture mapping
 
     const int imageHeight = m_canvasImage->height();
@@ -186,6 +328,12 @@ void MercatorScanlineTextureMapper::RenderJob::run()
 
     const int maxInterpolationPointX = n * (int)( imageWidth / n - 1 ) + 1;
 
+    // Start at the exactly evaluated pixel left of the first requested
+    // column so that the interpolation matches a fully painted scanline
+    const int xBegin = n * ( m_xLeft / n );
+    qreal lonBegin = leftLon + xBegin * pixel2Rad;
+    while ( lonBegin > M_PI ) lonBegin -= 2 * M_PI;
+
 
     // initialize needed variables that are modified during texture mapping:
 
@@ -194,58 +342,62 @@ void MercatorScanlineTextureMapper::RenderJob::run()
 
     // Scanline based algorithm to do texture mapping
 
-    for ( int y = m_yPaintedTop; y < m_yPaintedBottom; ++y ) {
-
-        QRgb * scanLine = (QRgb*)( m_canvasImage->scanLine( y ) );
-
-        qreal lon = leftLon;
-        const qreal lat = gd ( ( (imageHeight / 2 + yCenterOffset) - y )
-                    * pixel2Rad );
-
-        for ( int x = 0; x < imageWidth; ++x ) {
-            // Prepare for interpolation
-            bool interpolate = false;
-            if ( x > 0 && x <= maxInterpolationPointX ) {
-                x += n - 1;
-                lon += (n - 1) * pixel2Rad;
-                interpolate = !printQuality;
+    int yStart;
+    int yEnd;
+    while ( m_queue->takeChunk( yStart, yEnd ) ) {
+        for ( int y = yStart; y < yEnd; ++y ) {
+
+            QRgb * scanLine = (QRgb*)( m_canvasImage->scanLine( y ) ) + xBegin;
+
+            qreal lon = lonBegin;
+            const qreal lat = gd ( ( (imageHeight / 2 + yCenterOffset) - y )
+                        * pixel2Rad );
+
+            for ( int x = xBegin; x < m_xRight; ++x ) {
+                // Prepare for interpolation
+                bool interpolate = false;
+                if ( x > xBegin && x <= maxInterpolationPointX ) {
+                    x += n - 1;
+                    lon += (n - 1) * pixel2Rad;
+                    interpolate = !printQuality;
+                }
+                else {
+                    interpolate = false;
+                }
+
+                if ( lon < -M_PI ) lon += 2 * M_PI;
+                if ( lon >  M_PI ) lon -= 2 * M_PI;
+
+                if ( interpolate ) {
+                    if (highQuality)
+                        context.pixelValueApproxF( lon, lat, scanLine, n );
+                    else
+                        context.pixelValueApprox( lon, lat, scanLine, n );
+
+                    scanLine += ( n - 1 );
+                }
+
+                if ( x < imageWidth ) {
+                    if ( highQuality )
+                        context.pixelValueF( lon, lat, scanLine );
+                    else
+                        context.pixelValue( lon, lat, scanLine );
+                }
+
+                ++scanLine;
+                lon += pixel2Rad;
             }
-            else {
-                interpolate = false;
-            }
-
-            if ( lon < -M_PI ) lon += 2 * M_PI;
-            if ( lon >  M_PI ) lon -= 2 * M_PI;
 
-            if ( interpolate ) {
-                if (highQuality)
-                    context.pixelValueApproxF( lon, lat, scanLine, n );
-                else
-                    context.pixelValueApprox( lon, lat, scanLine, n );
+            // copy scanline to improve performance
+            if ( interlaced && y + 1 < yEnd ) { 
 
-                scanLine += ( n - 1 );
-            }
+                const int pixelByteSize = m_canvasImage->bytesPerLine() / imageWidth;
 
-            if ( x < imageWidth ) {
-                if ( highQuality )
-                    context.pixelValueF( lon, lat, scanLine );
-                else
-                    context.pixelValue( lon, lat, scanLine );
+                memcpy( m_canvasImage->scanLine( y + 1 ) + xBegin * pixelByteSize,
+                        m_canvasImage->scanLine( y     ) + xBegin * pixelByteSize,
+                        ( m_xRight - xBegin ) * pixelByteSize );
+                ++y;
             }
-
-            ++scanLine;
-            lon += pixel2Rad;
-        }
-
-        // copy scanline to improve performance
-        if ( interlaced && y + 1 < m_yPaintedBottom ) { 
-
-            const int pixelByteSize = m_canvasImage->bytesPerLine() / imageWidth;
-
-            memcpy( m_canvasImage->scanLine( y + 1 ),
-                    m_canvasImage->scanLine( y     ),
-                    imageWidth * pixelByteSize );
-            ++y;
         }
     }
 }
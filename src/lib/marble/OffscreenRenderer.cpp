@@ -0,0 +1,398 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2014 The Marble contributors
+//
+
+#include "OffscreenRenderer.h"
+
+#include "FileManager.h"
+#include "GeoDataDocument.h"
+#include "GeoDataTreeModel.h"
+#include "GeoPainter.h"
+#include "GeoSceneDocument.h"
+#include "GeoSceneProperty.h"
+#include "GeoSceneSettings.h"
+#include "MarbleClock.h"
+#include "MarbleDebug.h"
+#include "MarbleMap.h"
+#include "MarbleModel.h"
+#include "RenderPlugin.h"
+
+#include <QEventLoop>
+#include <QImage>
+#include <QImageWriter>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QThread>
+#include <QTime>
+#include <QTimer>
+
+namespace Marble
+{
+
+/**
+  * Encodes and writes a painted image in a writer thread
+  */
+class OffscreenRenderer::ImageWriterTask : public QRunnable
+{
+public:
+    ImageWriterTask( OffscreenRenderer *renderer, const QImage &image, const QString &fileName, int quality ) :
+        m_renderer( renderer ),
+        m_image( image ),
+        m_fileName( fileName ),
+        m_quality( quality )
+    {
+    }
+
+    virtual void run()
+    {
+        QImageWriter writer( m_fileName );
+        writer.setQuality( m_quality );
+        if ( !writer.write( m_image ) ) {
+            m_renderer->addWriteError( m_fileName, writer.errorString() );
+        }
+        m_image = QImage();
+        m_renderer->releasePendingImage();
+    }
+
+private:
+    OffscreenRenderer *const m_renderer;
+    QImage m_image;
+    const QString m_fileName;
+    const int m_quality;
+};
+
+OffscreenRenderer::MapState::MapState() :
+    m_copyable( true ),
+    m_clockSpeed( 1 ),
+    m_clockTimezone( 0 ),
+    m_clockUpdateInterval( 60 ),
+    m_quality( NormalQuality ),
+    m_showSunShading( false ),
+    m_showCityLights( false ),
+    m_showClouds( false ),
+    m_showAtmosphere( false ),
+    m_showBackground( true ),
+    m_showFrameRate( false ),
+    m_subSolarPointIconVisible( false ),
+    m_layerCacheEnabled( false ),
+    m_volatileTileCacheLimit( 0 )
+{
+}
+
+OffscreenRenderer::MapState::MapState( MarbleMap *map ) :
+    m_copyable( true )
+{
+    MarbleModel *const model = map->model();
+    foreach ( const GeoDataFeature *feature, model->treeModel()->rootDocument()->featureList() ) {
+        const GeoDataDocument *const document = dynamic_cast<const GeoDataDocument *>( feature );
+        if ( !document ) {
+            m_copyable = false;
+            continue;
+        }
+
+        // Map documents come with the map theme and bookmarks with each model
+        switch ( document->documentRole() ) {
+        case UserDocument:
+            if ( document->fileName().isEmpty() ) {
+                m_copyable = false;
+            } else {
+                m_userFiles << document->fileName();
+            }
+            break;
+        case TrackingDocument:
+        case SearchResultDocument:
+            if ( document->size() > 0 ) {
+                m_copyable = false;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    if ( model->mapTheme() ) {
+        foreach ( const GeoSceneProperty *property, model->mapTheme()->settings()->allProperties() ) {
+            if ( property->value() != property->defaultValue() ) {
+                m_properties.insert( property->name(), property->value() );
+            }
+        }
+    }
+
+    foreach ( const RenderPlugin *plugin, map->renderPlugins() ) {
+        RenderPluginState state;
+        state.m_nameId = plugin->nameId();
+        state.m_enabled = plugin->enabled();
+        state.m_visible = plugin->visible();
+        state.m_settings = plugin->settings();
+        m_renderPlugins << state;
+    }
+
+    m_captureTime = QDateTime::currentDateTimeUtc();
+    m_clockDateTime = model->clockDateTime();
+    m_clockSpeed = model->clockSpeed();
+    m_clockTimezone = model->clockTimezone();
+    m_clockUpdateInterval = model->clock()->updateInterval();
+
+    m_quality = map->mapQuality( Still );
+    m_showSunShading = map->showSunShading();
+    m_showCityLights = map->showCityLights();
+    m_showClouds = map->showClouds();
+    m_showAtmosphere = map->showAtmosphere();
+    m_showBackground = map->showBackground();
+    m_showFrameRate = map->showFrameRate();
+    m_subSolarPointIconVisible = map->isSubSolarPointIconVisible();
+    m_layerCacheEnabled = map->isLayerCacheEnabled();
+    m_volatileTileCacheLimit = map->volatileTileCacheLimit();
+}
+
+bool OffscreenRenderer::MapState::isCopyable() const
+{
+    return m_copyable;
+}
+
+void OffscreenRenderer::MapState::apply( MarbleMap *map, const MapState *previous ) const
+{
+    MarbleModel *const model = map->model();
+    if ( !previous || !previous->hasSameClock( *this ) ) {
+        // Continue where the clock of the snapshot is by now
+        const qint64 elapsed = m_captureTime.msecsTo( QDateTime::currentDateTimeUtc() );
+        model->setClockDateTime( m_clockDateTime.addMSecs( elapsed * m_clockSpeed ) );
+        model->setClockSpeed( m_clockSpeed );
+        model->setClockTimezone( m_clockTimezone );
+    }
+
+    if ( previous ) {
+        foreach ( const QString &fileName, previous->m_userFiles ) {
+            if ( !m_userFiles.contains( fileName ) ) {
+                model->removeGeoData( fileName );
+            }
+        }
+    }
+    foreach ( const QString &fileName, m_userFiles ) {
+        if ( !previous || !previous->m_userFiles.contains( fileName ) ) {
+            model->addGeoDataFile( fileName );
+        }
+    }
+
+    map->setViewContext( Still );
+    map->setMapQualityForViewContext( m_quality, Still );
+    map->setShowSunShading( m_showSunShading );
+    map->setShowCityLights( m_showCityLights );
+    map->setShowClouds( m_showClouds );
+    map->setShowAtmosphere( m_showAtmosphere );
+    map->setShowBackground( m_showBackground );
+    map->setShowFrameRate( m_showFrameRate );
+    map->setSubSolarPointIconVisible( m_subSolarPointIconVisible );
+    map->setLayerCacheEnabled( m_layerCacheEnabled );
+    map->setVolatileTileCacheLimit( m_volatileTileCacheLimit );
+
+    if ( previous && model->mapTheme() ) {
+        // Properties which are back at their default
+        const GeoSceneSettings *const settings = model->mapTheme()->settings();
+        foreach ( const QString &name, previous->m_properties.keys() ) {
+            const GeoSceneProperty *const property = settings->property( name );
+            if ( property && !m_properties.contains( name ) ) {
+                map->setPropertyValue( name, property->defaultValue() );
+            }
+        }
+    }
+    applyProperties( map );
+
+    foreach ( const RenderPluginState &state, m_renderPlugins ) {
+        if ( previous && previous->m_renderPlugins.contains( state ) ) {
+            continue;
+        }
+
+        RenderPlugin *plugin = 0;
+        foreach ( RenderPlugin *candidate, map->renderPlugins() ) {
+            if ( candidate->nameId() == state.m_nameId ) {
+                plugin = candidate;
+                break;
+            }
+        }
+        // Plugins disabled by default are created only where they are enabled
+        if ( !plugin && state.m_enabled ) {
+            plugin = map->loadRenderPlugin( state.m_nameId );
+        }
+        if ( !plugin ) {
+            continue;
+        }
+
+        plugin->setEnabled( state.m_enabled );
+        plugin->setVisible( state.m_visible );
+        plugin->setSettings( state.m_settings );
+    }
+}
+
+void OffscreenRenderer::MapState::applyProperties( MarbleMap *map ) const
+{
+    QHash<QString, bool>::const_iterator property = m_properties.constBegin();
+    for ( ; property != m_properties.constEnd(); ++property ) {
+        map->setPropertyValue( property.key(), property.value() );
+    }
+}
+
+bool OffscreenRenderer::MapState::operator==( const MapState &other ) const
+{
+    return m_copyable == other.m_copyable
+        && m_userFiles == other.m_userFiles
+        && m_properties == other.m_properties
+        && m_renderPlugins == other.m_renderPlugins
+        && hasSameClock( other )
+        && m_quality == other.m_quality
+        && m_showSunShading == other.m_showSunShading
+        && m_showCityLights == other.m_showCityLights
+        && m_showClouds == other.m_showClouds
+        && m_showAtmosphere == other.m_showAtmosphere
+        && m_showBackground == other.m_showBackground
+        && m_showFrameRate == other.m_showFrameRate
+        && m_subSolarPointIconVisible == other.m_subSolarPointIconVisible
+        && m_layerCacheEnabled == other.m_layerCacheEnabled
+        && m_volatileTileCacheLimit == other.m_volatileTileCacheLimit;
+}
+
+bool OffscreenRenderer::MapState::operator!=( const MapState &other ) const
+{
+    return !( *this == other );
+}
+
+bool OffscreenRenderer::MapState::RenderPluginState::operator==( const RenderPluginState &other ) const
+{
+    return m_nameId == other.m_nameId
+        && m_enabled == other.m_enabled
+        && m_visible == other.m_visible
+        && m_settings == other.m_settings;
+}
+
+bool OffscreenRenderer::MapState::hasSameClock( const MapState &other ) const
+{
+    if ( !m_captureTime.isValid() || !other.m_captureTime.isValid() ) {
+        return false;
+    }
+
+    if ( m_clockSpeed != other.m_clockSpeed || m_clockTimezone != other.m_clockTimezone ) {
+        return false;
+    }
+
+    // The clock only advances once per update interval, allow for that much difference
+    const qint64 elapsed = m_captureTime.msecsTo( other.m_captureTime );
+    const QDateTime expected = m_clockDateTime.addMSecs( elapsed * m_clockSpeed );
+    return qAbs( expected.msecsTo( other.m_clockDateTime ) ) <= 1000 * qint64( m_clockUpdateInterval );
+}
+
+OffscreenRenderer::OffscreenRenderer() :
+    m_maximumPendingImages( 0 )
+{
+    setWriterThreadCount( QThread::idealThreadCount() );
+}
+
+OffscreenRenderer::~OffscreenRenderer()
+{
+    m_writerPool.waitForDone();
+}
+
+void OffscreenRenderer::paint( MarbleMap *map, QImage &image, const QColor &background )
+{
+    image.fill( background );
+    GeoPainter painter( &image, map->viewport(), map->mapQuality() );
+    map->paint( painter, image.rect() );
+}
+
+void OffscreenRenderer::paintComplete( MarbleMap *map, QImage &image, const QColor &background, int maximumWaitTime )
+{
+    paint( map, image, background );
+    if ( maximumWaitTime <= 0 || map->renderStatus() == Complete ) {
+        return;
+    }
+
+    // Newly arrived tiles and documents trigger a repaint request
+    QEventLoop loop;
+    QTimer timeout;
+    timeout.setSingleShot( true );
+    QObject::connect( map, SIGNAL(repaintNeeded(QRegion)), &loop, SLOT(quit()) );
+    QObject::connect( &timeout, SIGNAL(timeout()), &loop, SLOT(quit()) );
+
+    QTime time;
+    time.start();
+    while ( time.elapsed() < maximumWaitTime && map->renderStatus() != Complete ) {
+        timeout.start( maximumWaitTime - time.elapsed() );
+        loop.exec();
+        paint( map, image, background );
+    }
+}
+
+void OffscreenRenderer::waitForFiles( MarbleModel *model )
+{
+    // Loaded documents are added to the model in the event loop of its thread
+    QEventLoop loop;
+    QTimer poll;
+    QObject::connect( &poll, SIGNAL(timeout()), &loop, SLOT(quit()) );
+    poll.start( 10 );
+    while ( model->fileManager()->pendingFiles() > 0 ) {
+        loop.exec();
+    }
+}
+
+void OffscreenRenderer::setWriterThreadCount( int count )
+{
+    m_writerPool.waitForDone();
+
+    count = qMax( 1, count );
+    m_writerPool.setMaxThreadCount( count );
+    m_pendingImages.acquire( m_pendingImages.available() );
+    m_maximumPendingImages = 2 * count;
+    m_pendingImages.release( m_maximumPendingImages );
+}
+
+int OffscreenRenderer::writerThreadCount() const
+{
+    return m_writerPool.maxThreadCount();
+}
+
+void OffscreenRenderer::write( const QImage &image, const QString &fileName, int quality )
+{
+    acquirePendingImage();
+    m_writerPool.start( new ImageWriterTask( this, image, fileName, quality ) );
+}
+
+void OffscreenRenderer::acquirePendingImage()
+{
+    m_pendingImages.acquire();
+}
+
+void OffscreenRenderer::releasePendingImage()
+{
+    m_pendingImages.release();
+}
+
+void OffscreenRenderer::waitForDone()
+{
+    m_writerPool.waitForDone();
+}
+
+QList<QPair<QString, QString> > OffscreenRenderer::writeErrors() const
+{
+    QMutexLocker locker( &m_errorMutex );
+    return m_writeErrors;
+}
+
+void OffscreenRenderer::clearWriteErrors()
+{
+    QMutexLocker locker( &m_errorMutex );
+    m_writeErrors.clear();
+}
+
+void OffscreenRenderer::addWriteError( const QString &fileName, const QString &error )
+{
+    mDebug() << "Unable to write" << fileName << ":" << error;
+    QMutexLocker locker( &m_errorMutex );
+    m_writeErrors << qMakePair( fileName, error );
+}
+
+}
@@ -0,0 +1,209 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2014 The Marble contributors
+//
+
+#ifndef MARBLE_OFFSCREENRENDERER_H
+#define MARBLE_OFFSCREENRENDERER_H
+
+#include "MarbleGlobal.h"
+
+#include <QColor>
+#include <QDateTime>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QPair>
+#include <QSemaphore>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+#include <QVariant>
+
+class QImage;
+
+namespace Marble
+{
+
+class MarbleMap;
+class MarbleModel;
+
+/**
+  * @short Paints maps into images and writes them in worker threads
+  *
+  * Used by BatchRenderer, TourRenderer and MarbleQuickItem. Painted images
+  * are handed over to a pool of writer threads through a bounded queue, so
+  * painting the next image and encoding the previous ones overlap without
+  * keeping an unlimited number of images in memory.
+  */
+class OffscreenRenderer
+{
+public:
+    /**
+      * @short The state of a map and its model, taken over by a map painting in another thread
+      *
+      * MarbleMap and MarbleModel are not thread safe, so a thread painting in
+      * parallel needs a model and a map of its own. The snapshot covers the
+      * user documents loaded from files, the clock, the view settings, the
+      * map theme properties changed from their default and the configuration
+      * of the render plugins.
+      */
+    class MapState
+    {
+    public:
+        MapState();
+
+        /** Takes a snapshot of @p map and its model */
+        explicit MapState( MarbleMap *map );
+
+        /**
+         * @brief Returns false if the model holds documents that cannot be loaded again
+         * This is the case for documents without a file, e.g. added with
+         * MarbleModel::addGeoDataString(), and for search results. Changes made
+         * to loaded documents in memory are not covered either.
+         */
+        bool isCopyable() const;
+
+        /**
+         * @brief Sets up @p map and its model like the map of the snapshot
+         * Only the parts that differ from @p previous are set if it is given,
+         * user documents missing from this snapshot are removed then. Does not
+         * wait for documents to be loaded, see waitForFiles().
+         */
+        void apply( MarbleMap *map, const MapState *previous = 0 ) const;
+
+        /**
+         * @brief Sets the changed map theme properties, e.g. after switching the map theme
+         */
+        void applyProperties( MarbleMap *map ) const;
+
+        /**
+         * @brief Returns whether @p other holds the same state
+         * Clocks are the same if they run at the same pace from the same time.
+         */
+        bool operator==( const MapState &other ) const;
+
+        bool operator!=( const MapState &other ) const;
+
+    private:
+        struct RenderPluginState
+        {
+            QString m_nameId;
+            bool m_enabled;
+            bool m_visible;
+            QHash<QString, QVariant> m_settings;
+
+            bool operator==( const RenderPluginState &other ) const;
+        };
+
+        bool hasSameClock( const MapState &other ) const;
+
+        bool m_copyable;
+        QStringList m_userFiles;
+        QHash<QString, bool> m_properties;
+        QList<RenderPluginState> m_renderPlugins;
+
+        QDateTime m_captureTime;
+        QDateTime m_clockDateTime;
+        int m_clockSpeed;
+        int m_clockTimezone;
+        int m_clockUpdateInterval;
+
+        MapQuality m_quality;
+        bool m_showSunShading;
+        bool m_showCityLights;
+        bool m_showClouds;
+        bool m_showAtmosphere;
+        bool m_showBackground;
+        bool m_showFrameRate;
+        bool m_subSolarPointIconVisible;
+        bool m_layerCacheEnabled;
+        quint64 m_volatileTileCacheLimit;
+    };
+
+    OffscreenRenderer();
+
+    /** Waits for all images to be written */
+    ~OffscreenRenderer();
+
+    /**
+     * @brief Paints @p map into @p image on top of @p background
+     */
+    static void paint( MarbleMap *map, QImage &image, const QColor &background );
+
+    /**
+     * @brief Paints @p map into @p image and repaints it when data arrives
+     *
+     * The image is painted again whenever new tiles or documents arrive, until
+     * the map reports a complete render state or @p maximumWaitTime milliseconds
+     * passed. Events of the calling thread are processed while waiting.
+     */
+    static void paintComplete( MarbleMap *map, QImage &image, const QColor &background, int maximumWaitTime );
+
+    /**
+     * @brief Processes events of the calling thread until @p model added all documents being loaded
+     */
+    static void waitForFiles( MarbleModel *model );
+
+    /**
+     * @brief Sets the number of writer threads
+     * Waits for all pending images to be written first.
+     */
+    void setWriterThreadCount( int count );
+
+    int writerThreadCount() const;
+
+    /**
+     * @brief Writes @p image to @p fileName in a writer thread
+     * Blocks while twice as many images as there are writer threads are pending.
+     * @param quality the quality passed to QImageWriter, or -1 for the default
+     */
+    void write( const QImage &image, const QString &fileName, int quality = -1 );
+
+    /**
+     * @brief Takes a place in the queue of pending images, blocking while it is full
+     * For images written by other means than write(), e.g. piped to an encoder.
+     */
+    void acquirePendingImage();
+
+    /**
+     * @brief Frees a place taken by acquirePendingImage()
+     */
+    void releasePendingImage();
+
+    /**
+     * @brief Waits until all images passed to write() are written
+     */
+    void waitForDone();
+
+    /**
+     * @brief Returns the files that could not be written, together with the reason
+     */
+    QList<QPair<QString, QString> > writeErrors() const;
+
+    void clearWriteErrors();
+
+private:
+    Q_DISABLE_COPY( OffscreenRenderer )
+
+    class ImageWriterTask;
+    friend class ImageWriterTask;
+
+    void addWriteError( const QString &fileName, const QString &error );
+
+    QThreadPool m_writerPool;
+    QSemaphore m_pendingImages;
+    int m_maximumPendingImages;
+
+    mutable QMutex m_errorMutex;
+    QList<QPair<QString, QString> > m_writeErrors;
+};
+
+}
+
+#endif
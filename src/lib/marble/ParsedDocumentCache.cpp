@@ -0,0 +1,321 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2014 The Marble contributors
+//
+
+#include "ParsedDocumentCache.h"
+
+#include "GeoDataDocument.h"
+#include "GeoDataExtendedData.h"
+#include "GeoDataFolder.h"
+#include "GeoDataMultiGeometry.h"
+#include "GeoDataPlacemark.h"
+#include "GeoDataSchema.h"
+#include "GeoDataSchemaData.h"
+#include "GeoDataSnippet.h"
+#include "GeoDataStyleMap.h"
+#include "GeoDataTimeSpan.h"
+#include "GeoDataTimeStamp.h"
+#include "GeoDataTypes.h"
+#include "MarbleDebug.h"
+#include "MarbleDirs.h"
+
+#include <QBuffer>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMultiMap>
+#include <QThread>
+
+namespace Marble
+{
+
+namespace
+{
+
+const quint32 CacheMagic = 0x4d504443;
+// Increase whenever the pack() format of a geodata class changes
+const qint32 CacheVersion = 1;
+const qint64 DefaultMaximumSize = 100 * 1024 * 1024;
+
+bool isCacheableGeometry( const GeoDataGeometry *geometry )
+{
+    if ( !geometry ) {
+        return true;
+    }
+
+    const char *const type = geometry->nodeType();
+    if ( type == GeoDataTypes::GeoDataPointType
+         || type == GeoDataTypes::GeoDataLineStringType
+         || type == GeoDataTypes::GeoDataLinearRingType
+         || type == GeoDataTypes::GeoDataPolygonType ) {
+        return true;
+    }
+
+    if ( type == GeoDataTypes::GeoDataMultiGeometryType ) {
+        const GeoDataMultiGeometry *multiGeometry = static_cast<const GeoDataMultiGeometry*>( geometry );
+        for ( int i = 0; i < multiGeometry->size(); ++i ) {
+            if ( !isCacheableGeometry( &multiGeometry->at( i ) ) ) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    return false;
+}
+
+bool isCacheableFeature( const GeoDataFeature *feature )
+{
+    if ( feature->timeSpan().isValid()
+         || feature->timeStamp().when().isValid()
+         || feature->abstractView()
+         || feature->styleMap()
+         || !feature->snippet().text().isEmpty()
+         || ( feature->hasExtendedData() && !feature->extendedData().schemaDataList().isEmpty() ) ) {
+        return false;
+    }
+
+    const char *const type = feature->nodeType();
+    if ( type == GeoDataTypes::GeoDataPlacemarkType ) {
+        return isCacheableGeometry( static_cast<const GeoDataPlacemark*>( feature )->geometry() );
+    }
+
+    if ( type == GeoDataTypes::GeoDataFolderType || type == GeoDataTypes::GeoDataDocumentType ) {
+        const GeoDataContainer *container = static_cast<const GeoDataContainer*>( feature );
+        foreach ( const GeoDataFeature *child, container->featureList() ) {
+            // unpack() restores folders and placemarks only
+            if ( child->nodeType() != GeoDataTypes::GeoDataFolderType
+                 && child->nodeType() != GeoDataTypes::GeoDataPlacemarkType ) {
+                return false;
+            }
+            if ( !isCacheableFeature( child ) ) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    return false;
+}
+
+/**
+  * Styles are unpacked after the features of a document, so style urls
+  * can only be resolved once the whole document is read.
+  */
+void resolveStyleUrls( GeoDataContainer *container )
+{
+    foreach ( GeoDataFeature *feature, container->featureList() ) {
+        if ( !feature->styleUrl().isEmpty() ) {
+            feature->setStyleUrl( feature->styleUrl() );
+        }
+        if ( feature->nodeType() == GeoDataTypes::GeoDataFolderType ) {
+            resolveStyleUrls( static_cast<GeoDataFolder*>( feature ) );
+        }
+    }
+}
+
+void writeHeader( QDataStream &stream, const QFileInfo &fileInfo )
+{
+    stream << CacheMagic << CacheVersion;
+    stream << fileInfo.absoluteFilePath();
+    stream << qint64( fileInfo.size() );
+    stream << qint64( fileInfo.lastModified().toMSecsSinceEpoch() );
+}
+
+bool isUpToDate( QDataStream &stream, const QFileInfo &fileInfo )
+{
+    quint32 magic;
+    qint32 version;
+    QString path;
+    qint64 size;
+    qint64 lastModified;
+    stream >> magic >> version >> path >> size >> lastModified;
+
+    return stream.status() == QDataStream::Ok
+            && magic == CacheMagic
+            && version == CacheVersion
+            && path == fileInfo.absoluteFilePath()
+            && size == fileInfo.size()
+            && lastModified == fileInfo.lastModified().toMSecsSinceEpoch();
+}
+
+}
+
+ParsedDocumentCache::ParsedDocumentCache( const QString &cacheDirectory ) :
+    m_cacheDirectory( cacheDirectory.isEmpty() ? MarbleDirs::localPath() + "/cache/documents/" : cacheDirectory ),
+    m_maximumSize( DefaultMaximumSize )
+{
+}
+
+void ParsedDocumentCache::setMaximumSize( qint64 bytes )
+{
+    m_maximumSize = bytes;
+}
+
+qint64 ParsedDocumentCache::maximumSize() const
+{
+    return m_maximumSize;
+}
+
+QString ParsedDocumentCache::cacheDirectory() const
+{
+    return m_cacheDirectory;
+}
+
+QString ParsedDocumentCache::cacheFileName( const QString &fileName ) const
+{
+    const QString path = QFileInfo( fileName ).absoluteFilePath();
+    const QByteArray hash = QCryptographicHash::hash( path.toUtf8(), QCryptographicHash::Md5 ).toHex();
+    return QDir( m_cacheDirectory ).filePath( QString::fromLatin1( hash ) + ".cache" );
+}
+
+GeoDataDocument *ParsedDocumentCache::load( const QString &fileName ) const
+{
+    const QFileInfo fileInfo( fileName );
+    if ( !fileInfo.isFile() ) {
+        return 0;
+    }
+
+    QFile file( cacheFileName( fileName ) );
+    if ( !file.open( QIODevice::ReadOnly ) || file.size() == 0 ) {
+        return 0;
+    }
+
+    // Reading from the mapped file avoids copying the snapshot into memory first
+    uchar *const mapped = file.map( 0, file.size() );
+    QByteArray data;
+    if ( mapped ) {
+        data = QByteArray::fromRawData( reinterpret_cast<const char*>( mapped ), file.size() );
+    } else {
+        data = file.readAll();
+    }
+
+    QBuffer buffer( &data );
+    buffer.open( QIODevice::ReadOnly );
+    QDataStream stream( &buffer );
+    stream.setVersion( QDataStream::Qt_4_2 );
+
+    GeoDataDocument *document = 0;
+    if ( isUpToDate( stream, fileInfo ) ) {
+        document = new GeoDataDocument;
+        document->unpack( stream );
+        if ( stream.status() != QDataStream::Ok ) {
+            mDebug() << "Ignoring truncated document cache" << file.fileName();
+            delete document;
+            document = 0;
+        }
+    }
+
+    buffer.close();
+    if ( mapped ) {
+        file.unmap( mapped );
+    }
+
+    if ( document ) {
+        document->setFileName( fileName );
+        document->setBaseUri( fileName );
+        resolveStyleUrls( document );
+        touch( file );
+    }
+
+    return document;
+}
+
+bool ParsedDocumentCache::save( const QString &fileName, const GeoDataDocument *document ) const
+{
+    const QFileInfo fileInfo( fileName );
+    if ( !document || !fileInfo.isFile() || !isCacheable( document ) ) {
+        return false;
+    }
+
+    // e.g. KMZ archives, whose resources are extracted to a temporary location
+    if ( !document->baseUri().isEmpty() && QFileInfo( document->baseUri() ) != fileInfo ) {
+        return false;
+    }
+
+    const QString cacheFile = cacheFileName( fileName );
+    QDir().mkpath( QFileInfo( cacheFile ).absolutePath() );
+
+    // Readers must never see a partially written snapshot. Several threads
+    // may write a snapshot of the same file at once.
+    const QString partFile = QString( "%1.%2.part" ).arg( cacheFile ).arg( quintptr( QThread::currentThreadId() ) );
+    QFile file( partFile );
+    if ( !file.open( QIODevice::WriteOnly ) ) {
+        mDebug() << "Unable to write document cache" << partFile;
+        return false;
+    }
+
+    QDataStream stream( &file );
+    stream.setVersion( QDataStream::Qt_4_2 );
+    writeHeader( stream, fileInfo );
+    document->pack( stream );
+    file.close();
+
+    if ( stream.status() != QDataStream::Ok || file.error() != QFile::NoError ) {
+        QFile::remove( partFile );
+        return false;
+    }
+
+    QFile::remove( cacheFile );
+    if ( !QFile::rename( partFile, cacheFile ) ) {
+        QFile::remove( partFile );
+        return false;
+    }
+
+    prune();
+    return true;
+}
+
+void ParsedDocumentCache::prune() const
+{
+    QDir const directory( m_cacheDirectory );
+    QFileInfoList const snapshots = directory.entryInfoList( QStringList() << "*.cache", QDir::Files );
+
+    qint64 size = 0;
+    QMultiMap<QDateTime, QString> snapshotsByUse;
+    foreach ( const QFileInfo &snapshot, snapshots ) {
+        size += snapshot.size();
+        snapshotsByUse.insert( snapshot.lastModified(), snapshot.absoluteFilePath() );
+    }
+
+    // Remove the least recently used snapshots first
+    QMultiMap<QDateTime, QString>::const_iterator it = snapshotsByUse.constBegin();
+    for ( ; size > m_maximumSize && it != snapshotsByUse.constEnd(); ++it ) {
+        const qint64 snapshotSize = QFileInfo( it.value() ).size();
+        if ( QFile::remove( it.value() ) ) {
+            size -= snapshotSize;
+        }
+    }
+}
+
+void ParsedDocumentCache::touch( QFile &file )
+{
+    // Rewriting the magic number marks the snapshot as recently used for
+    // prune(), which removes snapshots by their modification time
+    file.close();
+    if ( file.open( QIODevice::ReadWrite ) ) {
+        QDataStream stream( &file );
+        stream.setVersion( QDataStream::Qt_4_2 );
+        stream << CacheMagic;
+        file.close();
+    }
+}
+
+bool ParsedDocumentCache::isCacheable( const GeoDataDocument *document )
+{
+    return document
+            && document->styleMaps().isEmpty()
+            && document->schemas().isEmpty()
+            && isCacheableFeature( document );
+}
+
+}
@@ -0,0 +1,102 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2014 The Marble contributors
+//
+
+#ifndef MARBLE_PARSEDDOCUMENTCACHE_H
+#define MARBLE_PARSEDDOCUMENTCACHE_H
+
+#include "marble_export.h"
+
+#include <QString>
+
+class QFile;
+
+namespace Marble
+{
+
+class GeoDataDocument;
+
+/**
+  * @short Binary snapshots of parsed documents
+  *
+  * Parsing large KML, GPX or OSM files takes much longer than reading back
+  * the resulting document written by GeoDataDocument::pack(). The cache
+  * stores such a snapshot per source file, together with the path, size and
+  * modification time of the file. A snapshot is only used as long as all
+  * of these still match, so editing or replacing the file makes the next
+  * load parse it again.
+  *
+  * pack() covers folders, placemarks with their common geometries, styles
+  * and extended data, but not e.g. tracks, overlays, tours, style maps or
+  * time primitives. Documents using those are not cached at all, see
+  * isCacheable().
+  *
+  * Snapshots are limited to maximumSize() bytes in total. Once a save
+  * exceeds it, the least recently used snapshots are removed.
+  */
+class MARBLE_EXPORT ParsedDocumentCache
+{
+public:
+    /**
+     * @param cacheDirectory directory the snapshots are written to. Defaults
+     * to cache/documents/ in the local Marble directory.
+     */
+    explicit ParsedDocumentCache( const QString &cacheDirectory = QString() );
+
+    QString cacheDirectory() const;
+
+    /**
+     * @brief Sets the total size of all snapshots, 100 MB by default
+     */
+    void setMaximumSize( qint64 bytes );
+
+    qint64 maximumSize() const;
+
+    /**
+     * @brief Returns the snapshot file used for the given source file
+     */
+    QString cacheFileName( const QString &fileName ) const;
+
+    /**
+     * @brief Loads the snapshot of the given source file
+     * @return the document or 0 if there is no up to date snapshot. The
+     * caller takes ownership.
+     */
+    GeoDataDocument *load( const QString &fileName ) const;
+
+    /**
+     * @brief Writes a snapshot of the document parsed from the given file
+     * @return whether the snapshot was written; documents that are not
+     * cacheable are skipped.
+     *
+     * Safe to call from worker threads as long as no other thread changes
+     * the document meanwhile.
+     */
+    bool save( const QString &fileName, const GeoDataDocument *document ) const;
+
+    /**
+     * @brief Removes the least recently used snapshots above maximumSize()
+     */
+    void prune() const;
+
+    /**
+     * @brief Returns whether pack() stores all contents of the document
+     */
+    static bool isCacheable( const GeoDataDocument *document );
+
+private:
+    static void touch( QFile &file );
+
+    QString m_cacheDirectory;
+    qint64 m_maximumSize;
+};
+
+}
+
+#endif
@@ -15,6 +15,7 @@
 #include "MarbleDebug.h"
 #include "GeoDataDocument.h"
 #include "GeoDataPlacemark.h"
+#include "ParsedDocumentCache.h"
 #include "PluginManager.h"
 #include "ParseRunnerPlugin.h"
 #include "RunnerTask.h"
@@ -43,12 +44,15 @@ public:
     const PluginManager *const m_pluginManager;
     QList<ParsingTask *> m_parsingTasks;
     GeoDataDocument *m_fileResult;
+    ParsedDocumentCache m_documentCache;
+    bool m_documentCacheEnabled;
 };
 
 ParsingRunnerManager::Private::Private( ParsingRunnerManager *parent, const PluginManager *pluginManager ) :
     q( parent ),
     m_pluginManager( pluginManager ),
-    m_fileResult( 0 )
+    m_fileResult( 0 ),
+    m_documentCacheEnabled( false )
 {
     qRegisterMetaType<GeoDataDocument*>( "GeoDataDocument*" );
 }
@@ -94,15 +98,27 @@ ParsingRunnerManager::~ParsingRunnerManager()
 
 void ParsingRunnerManager::parseFile( const QString &fileName, DocumentRole role )
 {
-    QList<const ParseRunnerPlugin*> plugins = d->m_pluginManager->parsingRunnerPlugins();
     const QFileInfo fileInfo( fileName );
     const QString suffix = fileInfo.suffix().toLower();
     const QString completeSuffix = fileInfo.completeSuffix().toLower();
 
+    GeoDataDocument *cachedDocument = d->m_documentCacheEnabled ? d->m_documentCache.load( fileName ) : 0;
+    if ( cachedDocument ) {
+        mDebug() << "Using cached document for" << fileName;
+        cachedDocument->setDocumentRole( role );
+        d->m_fileResult = cachedDocument;
+        emit parsingFinished( cachedDocument, QString() );
+        d->cleanupParsingTask( 0 );
+        return;
+    }
+
+    // Only the plugins handling the suffix are loaded
+    QList<const ParseRunnerPlugin*> plugins = d->m_pluginManager->parsingRunnerPlugins( QStringList() << suffix << completeSuffix );
     foreach( const ParseRunnerPlugin *plugin, plugins ) {
         QStringList const extensions = plugin->fileExtensions();
         if ( extensions.isEmpty() || extensions.contains( suffix ) || extensions.contains( completeSuffix ) ) {
-            ParsingTask *task = new ParsingTask( plugin->newRunner(), this, fileName, role );
+            ParsingTask *task = new ParsingTask( plugin->newRunner(), this, fileName, role,
+                                                 d->m_documentCacheEnabled ? &d->m_documentCache : 0 );
             connect( task, SIGNAL(finished(ParsingTask*)), this, SLOT(cleanupParsingTask(ParsingTask*)) );
             mDebug() << "parse task " << plugin->nameId() << " " << (quintptr)task;
             d->m_parsingTasks << task;
@@ -118,6 +134,16 @@ void ParsingRunnerManager::parseFile( const QString &fileName, DocumentRole role
     }
 }
 
+void ParsingRunnerManager::setDocumentCacheEnabled( bool enabled )
+{
+    d->m_documentCacheEnabled = enabled;
+}
+
+bool ParsingRunnerManager::isDocumentCacheEnabled() const
+{
+    return d->m_documentCacheEnabled;
+}
+
 GeoDataDocument *ParsingRunnerManager::openFile( const QString &fileName, DocumentRole role, int timeout ) {
     QEventLoop localEventLoop;
     QTimer watchdog;
@@ -52,6 +52,15 @@ public:
     void parseFile( const QString &fileName, DocumentRole role = UserDocument );
     GeoDataDocument *openFile( const QString &fileName, DocumentRole role = UserDocument, int timeout = 30000 );
 
+    /**
+     * Enables loading documents from binary snapshots and writing snapshots
+     * of parsed documents, see ParsedDocumentCache. Off by default, meant
+     * for files opened by the user rather than e.g. vector tiles.
+     */
+    void setDocumentCacheEnabled( bool enabled );
+
+    bool isDocumentCacheEnabled() const;
+
 Q_SIGNALS:
     /**
      * The file was parsed and potential error message
@@ -12,7 +12,6 @@
 
 #include "PlacemarkLayout.h"
 
-#include <QAbstractItemModel>
 #include <QList>
 #include <QPoint>
 #include <QVector>
@@ -32,6 +31,8 @@
 #include "MarbleClock.h"
 #include "MarblePlacemarkModel.h"
 #include "MarbleDirs.h"
+#include "MarbleProfiler.h"
+#include "PlacemarkRegistry.h"
 #include "ViewportParams.h"
 #include "TileId.h"
 #include "TileCoordsPyramid.h"
@@ -133,11 +134,12 @@ QVector<GeoDataFeature::GeoDataVisualCategory> sortedVisualCategories()
 }
 
 
-PlacemarkLayout::PlacemarkLayout( QAbstractItemModel  *placemarkModel,
+PlacemarkLayout::PlacemarkLayout( const PlacemarkRegistry *placemarkRegistry,
                                   QItemSelectionModel *selectionModel,
                                   MarbleClock *clock,
                                   QObject* parent )
     : QObject( parent ),
+      m_placemarkRegistry( placemarkRegistry ),
       m_selectionModel( selectionModel ),
       m_clock( clock ),
       m_acceptedVisualCategories( sortedVisualCategories() ),
@@ -151,23 +153,18 @@ PlacemarkLayout::PlacemarkLayout( QAbstractItemModel  *placemarkModel,
       m_maxLabelHeight( 0 ),
       m_styleResetRequested( true )
 {
-    m_placemarkModel.setSourceModel( placemarkModel );
-    m_placemarkModel.setDynamicSortFilter( true );
-    m_placemarkModel.setSortRole( MarblePlacemarkModel::PopularityIndexRole );
-    m_placemarkModel.sort( 0, Qt::AscendingOrder );
-
     connect( m_selectionModel,  SIGNAL( selectionChanged( QItemSelection,
                                                            QItemSelection) ),
              this,               SLOT(requestStyleReset()) );
 
-    connect( &m_placemarkModel, SIGNAL(dataChanged(QModelIndex,QModelIndex)),
-             this, SLOT(resetCacheData()) );
-    connect( &m_placemarkModel, SIGNAL(rowsInserted(QModelIndex,int,int)),
-             this, SLOT(addPlacemarks(QModelIndex,int,int)) );
-    connect( &m_placemarkModel, SIGNAL(rowsAboutToBeRemoved(QModelIndex,int,int)),
-             this, SLOT(removePlacemarks(QModelIndex,int,int)) );
-    connect( &m_placemarkModel, SIGNAL(modelReset()),
+    connect( m_placemarkRegistry, SIGNAL(placemarksAdded(QVector<GeoDataPlacemark*>)),
+             this, SLOT(addPlacemarks(QVector<GeoDataPlacemark*>)) );
+    connect( m_placemarkRegistry, SIGNAL(placemarksAboutToBeRemoved(QVector<GeoDataPlacemark*>)),
+             this, SLOT(removePlacemarks(QVector<GeoDataPlacemark*>)) );
+    connect( m_placemarkRegistry, SIGNAL(reset()),
              this, SLOT(resetCacheData()) );
+
+    resetCacheData();
 }
 
 PlacemarkLayout::~PlacemarkLayout()
@@ -248,31 +245,31 @@ int PlacemarkLayout::maxLabelHeight() const
 {
     int maxLabelHeight = 0;
 
-    for ( int i = 0; i < m_placemarkModel.rowCount(); ++i ) {
-        QModelIndex index = m_placemarkModel.index( i, 0 );
-        const GeoDataPlacemark *placemark = dynamic_cast<GeoDataPlacemark*>(qvariant_cast<GeoDataObject*>(index.data( MarblePlacemarkModel::ObjectPointerRole ) ));
-        if ( placemark ) {
-            const GeoDataStyle* style = placemark->style();
-            QFont labelFont = style->labelStyle().font();
-            int textHeight = QFontMetrics( labelFont ).height();
-            if ( textHeight > maxLabelHeight )
-                maxLabelHeight = textHeight;
-        }
+    foreach ( const GeoDataPlacemark *placemark, m_placemarkRegistry->placemarks() ) {
+        const GeoDataStyle* style = placemark->style();
+        QFont labelFont = style->labelStyle().font();
+        int textHeight = QFontMetrics( labelFont ).height();
+        if ( textHeight > maxLabelHeight )
+            maxLabelHeight = textHeight;
     }
 
     //mDebug() <<"Detected maxLabelHeight: " << maxLabelHeight;
     return maxLabelHeight;
 }
 
+bool PlacemarkLayout::morePopular( const GeoDataPlacemark *a, const GeoDataPlacemark *b )
+{
+    if ( a->zoomLevel() != b->zoomLevel() ) {
+        return a->zoomLevel() < b->zoomLevel();
+    }
+    return a->popularity() > b->popularity();
+}
+
 /// feed an internal QMap of placemarks with TileId as key when model changes
-void PlacemarkLayout::addPlacemarks( QModelIndex parent, int first, int last )
+void PlacemarkLayout::addPlacemarks( const QVector<GeoDataPlacemark*> &placemarks )
 {
-    Q_ASSERT( first < m_placemarkModel.rowCount() );
-    Q_ASSERT( last < m_placemarkModel.rowCount() );
-    for( int i=first; i<=last; ++i ) {
-        QModelIndex index = m_placemarkModel.index( i, 0, parent );
-        Q_ASSERT( index.isValid() );
-        const GeoDataPlacemark *placemark = static_cast<GeoDataPlacemark*>(qvariant_cast<GeoDataObject*>(index.data( MarblePlacemarkModel::ObjectPointerRole ) ));
+    QSet<TileId> changedTiles;
+    foreach ( const GeoDataPlacemark *placemark, placemarks ) {
         const GeoDataCoordinates coordinates = placemarkIconCoordinates( placemark );
         if ( !coordinates.isValid() ) {
             continue;
@@ -281,19 +278,26 @@ void PlacemarkLayout::addPlacemarks( QModelIndex parent, int first, int last )
         int zoomLevel = placemark->zoomLevel();
         TileId key = TileId::fromCoordinates( coordinates, zoomLevel );
         m_placemarkCache[key].append( placemark );
+        changedTiles.insert( key );
     }
+
+    // generateLayout() expects the most popular placemarks first: they are
+    // laid out before others and win label collisions. A stable sort keeps
+    // the order of the documents among equally popular placemarks.
+    foreach ( const TileId &key, changedTiles ) {
+        QVector<const GeoDataPlacemark*> &tile = m_placemarkCache[key];
+        qStableSort( tile.begin(), tile.end(), morePopular );
+    }
+
     requestStyleReset();
     emit repaintNeeded();
 }
 
-void PlacemarkLayout::removePlacemarks( QModelIndex parent, int first, int last )
+void PlacemarkLayout::removePlacemarks( const QVector<GeoDataPlacemark*> &placemarks )
 {
-    Q_ASSERT( first < m_placemarkModel.rowCount() );
-    Q_ASSERT( last < m_placemarkModel.rowCount() );
-    for( int i=first; i<=last; ++i ) {
-        QModelIndex index = m_placemarkModel.index( i, 0, parent );
-        Q_ASSERT( index.isValid() );
-        const GeoDataPlacemark *placemark = static_cast<GeoDataPlacemark*>(qvariant_cast<GeoDataObject*>( index.data( MarblePlacemarkModel::ObjectPointerRole ) ));
+    // Group the placemarks by tile so that each tile is filtered only once
+    QMap<TileId, QSet<const GeoDataPlacemark*> > removed;
+    foreach ( const GeoDataPlacemark *placemark, placemarks ) {
         const GeoDataCoordinates coordinates = placemarkIconCoordinates( placemark );
         if ( !coordinates.isValid() ) {
             continue;
@@ -301,18 +305,39 @@ void PlacemarkLayout::removePlacemarks( QModelIndex parent, int first, int last
 
         int zoomLevel = placemark->zoomLevel();
         TileId key = TileId::fromCoordinates( coordinates, zoomLevel );
-        m_placemarkCache[key].removeAll( placemark );
+        removed[key].insert( placemark );
     }
+
+    QMap<TileId, QSet<const GeoDataPlacemark*> >::const_iterator it = removed.constBegin();
+    for ( ; it != removed.constEnd(); ++it ) {
+        QMap<TileId, QVector<const GeoDataPlacemark*> >::iterator tile = m_placemarkCache.find( it.key() );
+        if ( tile == m_placemarkCache.end() ) {
+            continue;
+        }
+
+        QVector<const GeoDataPlacemark*> remaining;
+        remaining.reserve( tile->size() );
+        foreach ( const GeoDataPlacemark *placemark, *tile ) {
+            if ( !it->contains( placemark ) ) {
+                remaining << placemark;
+            }
+        }
+
+        if ( remaining.isEmpty() ) {
+            m_placemarkCache.erase( tile );
+        } else {
+            *tile = remaining;
+        }
+    }
+
     emit repaintNeeded();
 }
 
 void PlacemarkLayout::resetCacheData()
 {
-    const int rowCount = m_placemarkModel.rowCount();
-
     m_placemarkCache.clear();
     requestStyleReset();
-    addPlacemarks( m_placemarkModel.index( 0, 0 ), 0, rowCount );
+    addPlacemarks( m_placemarkRegistry->placemarks() );
     emit repaintNeeded();
 }
 
@@ -370,8 +395,10 @@ QSet<TileId> PlacemarkLayout::visibleTiles( const ViewportParams *viewport )
 
 QVector<VisiblePlacemark *> PlacemarkLayout::generateLayout( const ViewportParams *viewport )
 {
+    MARBLE_PROFILE_SCOPE( "PlacemarkLayout::generateLayout" );
+
     m_runtimeTrace.clear();
-    if ( m_placemarkModel.rowCount() <= 0 )
+    if ( m_placemarkRegistry->placemarks().isEmpty() )
         return QVector<VisiblePlacemark *>();
 
     if ( m_styleResetRequested ) {
@@ -428,7 +455,7 @@ QVector<VisiblePlacemark *> PlacemarkLayout::generateLayout( const ViewportParam
 
     QList<TileId> tileIdList = visibleTiles( viewport ).toList();
     qSort( tileIdList );
-    QList<const GeoDataPlacemark*> placemarkList;
+    QVector<const GeoDataPlacemark*> placemarkList;
     foreach ( const TileId &tileId, tileIdList ) {
         placemarkList += m_placemarkCache.value( tileId );
     }
@@ -19,15 +19,14 @@
 
 
 #include <QHash>
-#include <QModelIndex>
+#include <QMap>
 #include <QRect>
 #include <QSet>
 #include <QVector>
-#include <QSortFilterProxyModel>
 
 #include "GeoDataFeature.h"
+#include "marble_export.h"
 
-class QAbstractItemModel;
 class QItemSelectionModel;
 class QPoint;
 
@@ -41,6 +40,7 @@ class GeoDataStyle;
 class GeoPainter;
 class MarbleClock;
 class PlacemarkPainter;
+class PlacemarkRegistry;
 class TileId;
 class VisiblePlacemark;
 class ViewportParams;
@@ -51,7 +51,7 @@ class ViewportParams;
 
 
 
-class PlacemarkLayout : public QObject
+class MARBLE_EXPORT PlacemarkLayout : public QObject
 {
     Q_OBJECT
 
@@ -59,7 +59,7 @@ class PlacemarkLayout : public QObject
     /**
      * Creates a new place mark layout.
      */
-    PlacemarkLayout( QAbstractItemModel  *placemarkModel,
+    PlacemarkLayout( const PlacemarkRegistry *placemarkRegistry,
                      QItemSelectionModel *selectionModel,
                      MarbleClock *clock,
                      QObject *parent = 0 );
@@ -94,8 +94,8 @@ class PlacemarkLayout : public QObject
     void setShowMaria( bool show );
 
     void requestStyleReset();
-    void addPlacemarks( QModelIndex index, int first, int last );
-    void removePlacemarks( QModelIndex index, int first, int last );
+    void addPlacemarks( const QVector<GeoDataPlacemark*> &placemarks );
+    void removePlacemarks( const QVector<GeoDataPlacemark*> &placemarks );
     void resetCacheData();
 
  Q_SIGNALS:
@@ -113,6 +113,12 @@ class PlacemarkLayout : public QObject
 
     void styleReset();
 
+    /**
+     * Orders placemarks by their popularity index (zoom level), then by
+     * their popularity, most popular first.
+     */
+    static bool morePopular( const GeoDataPlacemark *a, const GeoDataPlacemark *b );
+
     static QSet<TileId> visibleTiles( const ViewportParams *viewport );
     bool layoutPlacemark( const GeoDataPlacemark *placemark, qreal x, qreal y, bool selected );
 
@@ -131,7 +137,7 @@ class PlacemarkLayout : public QObject
 
  private:
     Q_DISABLE_COPY( PlacemarkLayout )
-    QSortFilterProxyModel  m_placemarkModel;
+    const PlacemarkRegistry *const m_placemarkRegistry;
     QItemSelectionModel *const m_selectionModel;
     MarbleClock *const m_clock;
 
@@ -142,7 +148,7 @@ class PlacemarkLayout : public QObject
     QVector< QVector< VisiblePlacemark* > >  m_rowsection;
 
     /// map providing the list of placemark belonging in TileId as key
-    QMap<TileId, QList<const GeoDataPlacemark*> > m_placemarkCache;
+    QMap<TileId, QVector<const GeoDataPlacemark*> > m_placemarkCache;
 
     const QVector< GeoDataFeature::GeoDataVisualCategory > m_acceptedVisualCategories;
 
@@ -0,0 +1,187 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2014 The Marble contributors
+//
+
+#include "PlacemarkRegistry.h"
+
+#include "GeoDataContainer.h"
+#include "GeoDataDocument.h"
+#include "GeoDataGroundOverlay.h"
+#include "GeoDataPlacemark.h"
+#include "GeoDataTreeModel.h"
+#include "GeoDataTypes.h"
+
+#include <QSet>
+
+namespace Marble
+{
+
+namespace
+{
+
+/**
+  * Removes the given items, keeping the order of the remaining ones
+  */
+template<class T>
+void removeItems( QVector<T*> &items, const QVector<T*> &removed )
+{
+    // Single features are removed and re-added while they are edited,
+    // which leaves them at the end of the vector
+    if ( removed.size() <= 8 ) {
+        foreach ( T *item, removed ) {
+            const int index = items.lastIndexOf( item );
+            if ( index >= 0 ) {
+                items.remove( index );
+            }
+        }
+        return;
+    }
+
+    QSet<T*> removedSet;
+    removedSet.reserve( removed.size() );
+    foreach ( T *item, removed ) {
+        removedSet.insert( item );
+    }
+
+    int kept = 0;
+    for ( int i = 0; i < items.size(); ++i ) {
+        if ( !removedSet.contains( items[i] ) ) {
+            items[kept] = items[i];
+            ++kept;
+        }
+    }
+    items.resize( kept );
+}
+
+}
+
+class PlacemarkRegistry::Private
+{
+public:
+    explicit Private( GeoDataTreeModel *treeModel );
+
+    static void collect( GeoDataObject *object,
+                         QVector<GeoDataPlacemark*> &placemarks,
+                         QVector<GeoDataGroundOverlay*> &groundOverlays );
+
+    GeoDataTreeModel *const m_treeModel;
+    QVector<GeoDataPlacemark*> m_placemarks;
+    QVector<GeoDataGroundOverlay*> m_groundOverlays;
+};
+
+PlacemarkRegistry::Private::Private( GeoDataTreeModel *treeModel ) :
+    m_treeModel( treeModel )
+{
+}
+
+void PlacemarkRegistry::Private::collect( GeoDataObject *object,
+                                          QVector<GeoDataPlacemark*> &placemarks,
+                                          QVector<GeoDataGroundOverlay*> &groundOverlays )
+{
+    if ( object->nodeType() == GeoDataTypes::GeoDataPlacemarkType ) {
+        placemarks << static_cast<GeoDataPlacemark*>( object );
+    } else if ( object->nodeType() == GeoDataTypes::GeoDataGroundOverlayType ) {
+        groundOverlays << static_cast<GeoDataGroundOverlay*>( object );
+    } else if ( object->nodeType() == GeoDataTypes::GeoDataDocumentType
+                || object->nodeType() == GeoDataTypes::GeoDataFolderType ) {
+        const GeoDataContainer *container = static_cast<const GeoDataContainer*>( object );
+        foreach ( GeoDataFeature *feature, container->featureList() ) {
+            collect( feature, placemarks, groundOverlays );
+        }
+    }
+}
+
+PlacemarkRegistry::PlacemarkRegistry( GeoDataTreeModel *treeModel, QObject *parent ) :
+    QObject( parent ),
+    d( new Private( treeModel ) )
+{
+    connect( treeModel, SIGNAL(added(GeoDataObject*)),
+             this, SLOT(addFeature(GeoDataObject*)) );
+    connect( treeModel, SIGNAL(removed(GeoDataObject*)),
+             this, SLOT(removeFeature(GeoDataObject*)) );
+    connect( treeModel, SIGNAL(modelReset()),
+             this, SLOT(rebuild()) );
+
+    rebuild();
+}
+
+PlacemarkRegistry::~PlacemarkRegistry()
+{
+    delete d;
+}
+
+const QVector<GeoDataPlacemark*> &PlacemarkRegistry::placemarks() const
+{
+    return d->m_placemarks;
+}
+
+const QVector<GeoDataGroundOverlay*> &PlacemarkRegistry::groundOverlays() const
+{
+    return d->m_groundOverlays;
+}
+
+void PlacemarkRegistry::addFeature( GeoDataObject *object )
+{
+    QVector<GeoDataPlacemark*> placemarks;
+    QVector<GeoDataGroundOverlay*> groundOverlays;
+    Private::collect( object, placemarks, groundOverlays );
+
+    if ( placemarks.isEmpty() && groundOverlays.isEmpty() ) {
+        return;
+    }
+
+    if ( !placemarks.isEmpty() ) {
+        d->m_placemarks += placemarks;
+        emit placemarksAdded( placemarks );
+    }
+
+    if ( !groundOverlays.isEmpty() ) {
+        d->m_groundOverlays += groundOverlays;
+        emit groundOverlaysAdded( groundOverlays );
+    }
+
+    emit changed();
+}
+
+void PlacemarkRegistry::removeFeature( GeoDataObject *object )
+{
+    QVector<GeoDataPlacemark*> placemarks;
+    QVector<GeoDataGroundOverlay*> groundOverlays;
+    Private::collect( object, placemarks, groundOverlays );
+
+    if ( placemarks.isEmpty() && groundOverlays.isEmpty() ) {
+        return;
+    }
+
+    if ( !placemarks.isEmpty() ) {
+        emit placemarksAboutToBeRemoved( placemarks );
+        removeItems( d->m_placemarks, placemarks );
+    }
+
+    if ( !groundOverlays.isEmpty() ) {
+        emit groundOverlaysAboutToBeRemoved( groundOverlays );
+        removeItems( d->m_groundOverlays, groundOverlays );
+    }
+
+    emit changed();
+}
+
+void PlacemarkRegistry::rebuild()
+{
+    d->m_placemarks.clear();
+    d->m_groundOverlays.clear();
+    Private::collect( d->m_treeModel->rootDocument(), d->m_placemarks, d->m_groundOverlays );
+
+    emit reset();
+    emit changed();
+}
+
+}
+
+#include "PlacemarkRegistry.moc"
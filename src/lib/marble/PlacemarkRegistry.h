@@ -0,0 +1,103 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2014 The Marble contributors
+//
+
+#ifndef MARBLE_PLACEMARKREGISTRY_H
+#define MARBLE_PLACEMARKREGISTRY_H
+
+#include "marble_export.h"
+
+#include <QObject>
+#include <QVector>
+
+namespace Marble
+{
+
+class GeoDataGroundOverlay;
+class GeoDataObject;
+class GeoDataPlacemark;
+class GeoDataTreeModel;
+
+/**
+  * @short Flat lists of all placemarks and ground overlays in a GeoDataTreeModel
+  *
+  * The registry follows the features added to and removed from the tree model.
+  * All placemarks and ground overlays of an added or removed document are
+  * reported in a single batch, so consumers do not have to map model rows
+  * to features one by one.
+  *
+  * Placemarks and ground overlays keep the order in which they were added.
+  */
+class MARBLE_EXPORT PlacemarkRegistry : public QObject
+{
+    Q_OBJECT
+
+ public:
+    explicit PlacemarkRegistry( GeoDataTreeModel *treeModel, QObject *parent = 0 );
+
+    ~PlacemarkRegistry();
+
+    /**
+     * @brief Returns all placemarks contained in the tree model
+     */
+    const QVector<GeoDataPlacemark*> &placemarks() const;
+
+    /**
+     * @brief Returns all ground overlays contained in the tree model
+     */
+    const QVector<GeoDataGroundOverlay*> &groundOverlays() const;
+
+ Q_SIGNALS:
+    /**
+     * Emitted after the given placemarks were appended to placemarks()
+     */
+    void placemarksAdded( const QVector<GeoDataPlacemark*> &placemarks );
+
+    /**
+     * Emitted before the given placemarks are removed from placemarks()
+     */
+    void placemarksAboutToBeRemoved( const QVector<GeoDataPlacemark*> &placemarks );
+
+    /**
+     * Emitted after the given ground overlays were appended to groundOverlays()
+     */
+    void groundOverlaysAdded( const QVector<GeoDataGroundOverlay*> &groundOverlays );
+
+    /**
+     * Emitted before the given ground overlays are removed from groundOverlays()
+     */
+    void groundOverlaysAboutToBeRemoved( const QVector<GeoDataGroundOverlay*> &groundOverlays );
+
+    /**
+     * Emitted after the registry was rebuilt because the tree model was reset
+     */
+    void reset();
+
+    /**
+     * Emitted after any of the above changes was applied
+     */
+    void changed();
+
+ private Q_SLOTS:
+    void addFeature( GeoDataObject *object );
+
+    void removeFeature( GeoDataObject *object );
+
+    void rebuild();
+
+ private:
+    Q_DISABLE_COPY( PlacemarkRegistry )
+
+    class Private;
+    Private *const d;
+};
+
+}
+
+#endif
@@ -0,0 +1,269 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2014 The Marble contributors
+//
+
+#include "PlacemarkSearchIndex.h"
+
+#include "GeoDataCoordinates.h"
+#include "GeoDataLatLonBox.h"
+#include "GeoDataPlacemark.h"
+#include "MarblePlacemarkModel_P.h"
+#include "PlacemarkRegistry.h"
+
+#include <QReadLocker>
+#include <QReadWriteLock>
+#include <QSet>
+#include <QWriteLocker>
+
+#include <algorithm>
+
+namespace Marble
+{
+
+namespace
+{
+
+class PlacemarkSearchEntry
+{
+public:
+    PlacemarkSearchEntry() :
+        m_placemark( 0 ),
+        m_zoomLevel( 0 ),
+        m_population( 0 )
+    {
+    }
+
+    PlacemarkSearchEntry( const QString &key, GeoDataPlacemark *placemark ) :
+        m_key( key ),
+        m_placemark( placemark ),
+        m_coordinate( placemark->coordinate() ),
+        m_zoomLevel( placemark->zoomLevel() ),
+        m_population( placemark->population() )
+    {
+    }
+
+    QString m_key;
+    GeoDataPlacemark *m_placemark;
+    GeoDataCoordinates m_coordinate;
+    int m_zoomLevel;
+    qint64 m_population;
+};
+
+bool keyLessThan( const PlacemarkSearchEntry &a, const PlacemarkSearchEntry &b )
+{
+    return a.m_key < b.m_key;
+}
+
+class KeyPrefixLessThan
+{
+public:
+    bool operator()( const PlacemarkSearchEntry &entry, const QString &prefix ) const
+    {
+        return entry.m_key < prefix;
+    }
+};
+
+bool rankLessThan( const PlacemarkSearchEntry *a, const PlacemarkSearchEntry *b )
+{
+    if ( a->m_zoomLevel != b->m_zoomLevel ) {
+        return a->m_zoomLevel < b->m_zoomLevel;
+    }
+    if ( a->m_population != b->m_population ) {
+        return a->m_population > b->m_population;
+    }
+    return a->m_key < b->m_key;
+}
+
+}
+
+class PlacemarkSearchIndex::Private
+{
+public:
+    explicit Private( const PlacemarkRegistry *registry );
+
+    /**
+      * Queues the entries of the given placemark. Requires the write lock.
+      */
+    void addPlacemark( GeoDataPlacemark *placemark );
+
+    /**
+      * Merges the queued entries into the sorted table. Requires the write lock.
+      */
+    void mergePending();
+
+    static void removeEntries( QVector<PlacemarkSearchEntry> &entries, const QSet<GeoDataPlacemark*> &placemarks );
+
+    const PlacemarkRegistry *const m_registry;
+
+    mutable QReadWriteLock m_lock;
+    QSet<GeoDataPlacemark*> m_placemarks;
+    QVector<PlacemarkSearchEntry> m_entries; // sorted by key
+    QVector<PlacemarkSearchEntry> m_pending; // unsorted, not yet merged into m_entries
+};
+
+PlacemarkSearchIndex::Private::Private( const PlacemarkRegistry *registry ) :
+    m_registry( registry )
+{
+}
+
+void PlacemarkSearchIndex::Private::addPlacemark( GeoDataPlacemark *placemark )
+{
+    if ( m_placemarks.contains( placemark ) ) {
+        return;
+    }
+
+    m_placemarks.insert( placemark );
+
+    const QString key = placemark->name().toCaseFolded();
+    m_pending << PlacemarkSearchEntry( key, placemark );
+
+    // Let "Munchen" find "München" as well
+    const QString deaccented = GeoString::deaccent( key );
+    if ( deaccented != key ) {
+        m_pending << PlacemarkSearchEntry( deaccented, placemark );
+    }
+}
+
+void PlacemarkSearchIndex::Private::mergePending()
+{
+    if ( m_pending.isEmpty() ) {
+        return;
+    }
+
+    // Merging lazily keeps loading many small documents linear
+    // in the size of the table
+    std::sort( m_pending.begin(), m_pending.end(), keyLessThan );
+    QVector<PlacemarkSearchEntry> merged( m_entries.size() + m_pending.size() );
+    std::merge( m_entries.constBegin(), m_entries.constEnd(),
+                m_pending.constBegin(), m_pending.constEnd(),
+                merged.begin(), keyLessThan );
+    m_entries = merged;
+    m_pending.clear();
+}
+
+void PlacemarkSearchIndex::Private::removeEntries( QVector<PlacemarkSearchEntry> &entries, const QSet<GeoDataPlacemark*> &placemarks )
+{
+    int kept = 0;
+    for ( int i = 0; i < entries.size(); ++i ) {
+        if ( !placemarks.contains( entries[i].m_placemark ) ) {
+            if ( kept != i ) {
+                entries[kept] = entries[i];
+            }
+            ++kept;
+        }
+    }
+    entries.resize( kept );
+}
+
+PlacemarkSearchIndex::PlacemarkSearchIndex( const PlacemarkRegistry *registry, QObject *parent ) :
+    QObject( parent ),
+    d( new Private( registry ) )
+{
+    connect( registry, SIGNAL(placemarksAdded(QVector<GeoDataPlacemark*>)),
+             this, SLOT(addPlacemarks(QVector<GeoDataPlacemark*>)) );
+    connect( registry, SIGNAL(placemarksAboutToBeRemoved(QVector<GeoDataPlacemark*>)),
+             this, SLOT(removePlacemarks(QVector<GeoDataPlacemark*>)) );
+    connect( registry, SIGNAL(reset()),
+             this, SLOT(rebuild()) );
+
+    rebuild();
+}
+
+PlacemarkSearchIndex::~PlacemarkSearchIndex()
+{
+    delete d;
+}
+
+QVector<GeoDataPlacemark*> PlacemarkSearchIndex::search( const QString &searchTerm, const GeoDataLatLonBox &preferred, int limit ) const
+{
+    {
+        QWriteLocker locker( &d->m_lock );
+        d->mergePending();
+    }
+
+    const QString prefix = searchTerm.toCaseFolded();
+
+    QReadLocker locker( &d->m_lock );
+
+    QVector<const PlacemarkSearchEntry*> matches;
+    QVector<PlacemarkSearchEntry>::const_iterator it = std::lower_bound( d->m_entries.constBegin(), d->m_entries.constEnd(),
+                                                                         prefix, KeyPrefixLessThan() );
+    for ( ; it != d->m_entries.constEnd() && it->m_key.startsWith( prefix ); ++it ) {
+        if ( preferred.isEmpty() || preferred.contains( it->m_coordinate ) ) {
+            matches << &*it;
+        }
+    }
+
+    std::sort( matches.begin(), matches.end(), rankLessThan );
+
+    QVector<GeoDataPlacemark*> result;
+    QSet<const GeoDataPlacemark*> added;
+    foreach ( const PlacemarkSearchEntry *entry, matches ) {
+        if ( limit >= 0 && result.size() >= limit ) {
+            break;
+        }
+
+        // accented names are indexed twice
+        if ( !added.contains( entry->m_placemark ) ) {
+            added.insert( entry->m_placemark );
+            result << new GeoDataPlacemark( *entry->m_placemark );
+        }
+    }
+
+    return result;
+}
+
+int PlacemarkSearchIndex::size() const
+{
+    QReadLocker locker( &d->m_lock );
+    return d->m_placemarks.size();
+}
+
+void PlacemarkSearchIndex::addPlacemarks( const QVector<GeoDataPlacemark*> &placemarks )
+{
+    QWriteLocker locker( &d->m_lock );
+    foreach ( GeoDataPlacemark *placemark, placemarks ) {
+        d->addPlacemark( placemark );
+    }
+}
+
+void PlacemarkSearchIndex::removePlacemarks( const QVector<GeoDataPlacemark*> &placemarks )
+{
+    QWriteLocker locker( &d->m_lock );
+
+    QSet<GeoDataPlacemark*> removed;
+    foreach ( GeoDataPlacemark *placemark, placemarks ) {
+        if ( d->m_placemarks.remove( placemark ) ) {
+            removed.insert( placemark );
+        }
+    }
+
+    if ( !removed.isEmpty() ) {
+        Private::removeEntries( d->m_entries, removed );
+        Private::removeEntries( d->m_pending, removed );
+    }
+}
+
+void PlacemarkSearchIndex::rebuild()
+{
+    QWriteLocker locker( &d->m_lock );
+
+    d->m_placemarks.clear();
+    d->m_entries.clear();
+    d->m_pending.clear();
+
+    foreach ( GeoDataPlacemark *placemark, d->m_registry->placemarks() ) {
+        d->addPlacemark( placemark );
+    }
+    d->mergePending();
+}
+
+}
+
+#include "PlacemarkSearchIndex.moc"
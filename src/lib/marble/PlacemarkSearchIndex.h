@@ -0,0 +1,79 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2014 The Marble contributors
+//
+
+#ifndef MARBLE_PLACEMARKSEARCHINDEX_H
+#define MARBLE_PLACEMARKSEARCHINDEX_H
+
+#include "marble_export.h"
+
+#include <QObject>
+#include <QVector>
+
+namespace Marble
+{
+
+class GeoDataLatLonBox;
+class GeoDataPlacemark;
+class PlacemarkRegistry;
+
+/**
+  * @short Prefix index over the names of the placemarks in a placemark registry
+  *
+  * The index keeps a sorted table of case folded placemark names. Names with
+  * accents are indexed a second time without them. The table follows the
+  * placemarks added to and removed from the registry, so a search only has to
+  * look up the range of names starting with the search term.
+  *
+  * The index must live in the thread of the registry; search() may be called
+  * from any thread.
+  */
+class MARBLE_EXPORT PlacemarkSearchIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit PlacemarkSearchIndex( const PlacemarkRegistry *registry, QObject *parent = 0 );
+
+    ~PlacemarkSearchIndex();
+
+    /**
+     * @brief Returns copies of the placemarks whose name starts with the given term
+     * @param searchTerm case insensitive name prefix
+     * @param preferred restricts the results to placemarks inside this box unless it is empty
+     * @param limit maximum number of results, or -1 for all of them
+     *
+     * Results are ordered by importance: placemarks shown at lower zoom levels
+     * come first, ties are broken by population. The caller takes ownership
+     * of the returned placemarks.
+     */
+    QVector<GeoDataPlacemark*> search( const QString &searchTerm, const GeoDataLatLonBox &preferred, int limit = -1 ) const;
+
+    /**
+     * @brief Returns the number of placemarks in the index
+     */
+    int size() const;
+
+private Q_SLOTS:
+    void addPlacemarks( const QVector<GeoDataPlacemark*> &placemarks );
+
+    void removePlacemarks( const QVector<GeoDataPlacemark*> &placemarks );
+
+    void rebuild();
+
+private:
+    Q_DISABLE_COPY( PlacemarkSearchIndex )
+
+    class Private;
+    Private *const d;
+};
+
+}
+
+#endif
@@ -17,6 +17,10 @@
 #include <QList>
 #include <QPluginLoader>
 #include <QTime>
+#if QT_VERSION >= 0x050000
+#include <QJsonArray>
+#include <QJsonObject>
+#endif
 
 // Local dir
 #include "MarbleDirs.h"
@@ -24,6 +28,7 @@
 #include "RenderPlugin.h"
 #include "PositionProviderPlugin.h"
 #include "AbstractFloatItem.h"
+#include "DialogConfigurationInterface.h"
 #include "ParseRunnerPlugin.h"
 #include "ReverseGeocodingRunnerPlugin.h"
 #include "RoutingRunnerPlugin.h"
@@ -32,19 +37,51 @@
 namespace Marble
 {
 
+/**
+ * A plugin library together with the metadata that is known without loading it
+ */
+struct PluginLibrary
+{
+    PluginLibrary() : loader( 0 ), loaded( false ) {}
+
+    QPluginLoader *loader;
+    /** The plugin type from the metadata, empty if the library has none */
+    QString type;
+    /** Parse runners only: the file extensions from the metadata */
+    QStringList fileExtensions;
+    /** Render plugins only: the description from the metadata */
+    RenderPluginMetaData renderPlugin;
+    bool loaded;
+};
+
 class PluginManagerPrivate
 {
  public:
     PluginManagerPrivate()
-            : m_pluginsLoaded(false)
+            : m_pluginsScanned(false)
     {
     }
 
     ~PluginManagerPrivate();
 
-    void loadPlugins();
+    /**
+     * Lists the plugin libraries and reads their metadata without loading them
+     */
+    void scanPlugins();
 
-    bool m_pluginsLoaded;
+    /**
+     * Loads the libraries that provide plugins of the given type. Libraries
+     * without metadata are loaded on any request, as their type is unknown.
+     * An empty type loads only those.
+     * If fileExtensions is not empty, only parse runners whose metadata lists
+     * one of them are loaded.
+     */
+    void loadPlugins( const QString &type, const QStringList &fileExtensions = QStringList() );
+
+    void loadPlugin( PluginLibrary &library );
+
+    bool m_pluginsScanned;
+    QList<PluginLibrary> m_libraries;
     QList<const RenderPlugin *> m_renderPluginTemplates;
     QList<const PositionProviderPlugin *> m_positionProviderPluginTemplates;
     QList<const SearchRunnerPlugin *> m_searchRunnerPlugins;
@@ -55,7 +92,10 @@ class PluginManagerPrivate
 
 PluginManagerPrivate::~PluginManagerPrivate()
 {
-    // nothing to do
+    // Deleting the loaders does not unload the plugins
+    foreach ( const PluginLibrary &library, m_libraries ) {
+        delete library.loader;
+    }
 }
 
 PluginManager::PluginManager( QObject *parent ) : QObject( parent ),
@@ -70,78 +110,140 @@ PluginManager::~PluginManager()
 
 QList<const RenderPlugin *> PluginManager::renderPlugins() const
 {
-    d->loadPlugins();
+    d->loadPlugins( "RenderPlugin" );
     return d->m_renderPluginTemplates;
 }
 
 void PluginManager::addRenderPlugin( const RenderPlugin *plugin )
 {
-    d->loadPlugins();
+    d->loadPlugins( "RenderPlugin" );
     d->m_renderPluginTemplates << plugin;
     emit renderPluginsChanged();
 }
 
+QList<RenderPluginMetaData> PluginManager::renderPluginMetaData() const
+{
+    d->loadPlugins( QString() );
+
+    QList<RenderPluginMetaData> result;
+    foreach ( const RenderPlugin *plugin, d->m_renderPluginTemplates ) {
+        RenderPluginMetaData metaData;
+        metaData.nameId = plugin->nameId();
+        metaData.guiString = plugin->guiString();
+        metaData.description = plugin->description();
+        metaData.enabledByDefault = plugin->enabled();
+        metaData.configurable = qobject_cast<DialogConfigurationInterface *>( plugin ) != 0;
+        result << metaData;
+    }
+
+    foreach ( const PluginLibrary &library, d->m_libraries ) {
+        if ( !library.loaded && library.type == "RenderPlugin" ) {
+            result << library.renderPlugin;
+        }
+    }
+
+    return result;
+}
+
+const RenderPlugin *PluginManager::renderPlugin( const QString &nameId ) const
+{
+    d->loadPlugins( QString() );
+
+    for ( int i = 0; i < d->m_libraries.size(); ++i ) {
+        PluginLibrary &library = d->m_libraries[i];
+        if ( !library.loaded && library.type == "RenderPlugin" && library.renderPlugin.nameId == nameId ) {
+            d->loadPlugin( library );
+        }
+    }
+
+    foreach ( const RenderPlugin *plugin, d->m_renderPluginTemplates ) {
+        if ( plugin->nameId() == nameId ) {
+            return plugin;
+        }
+    }
+
+    return 0;
+}
+
 QList<const PositionProviderPlugin *> PluginManager::positionProviderPlugins() const
 {
-    d->loadPlugins();
+    d->loadPlugins( "PositionProviderPlugin" );
     return d->m_positionProviderPluginTemplates;
 }
 
 void PluginManager::addPositionProviderPlugin( const PositionProviderPlugin *plugin )
 {
-    d->loadPlugins();
+    d->loadPlugins( "PositionProviderPlugin" );
     d->m_positionProviderPluginTemplates << plugin;
     emit positionProviderPluginsChanged();
 }
 
 QList<const SearchRunnerPlugin *> PluginManager::searchRunnerPlugins() const
 {
-    d->loadPlugins();
+    d->loadPlugins( "SearchRunnerPlugin" );
     return d->m_searchRunnerPlugins;
 }
 
 void PluginManager::addSearchRunnerPlugin( const SearchRunnerPlugin *plugin )
 {
-    d->loadPlugins();
+    d->loadPlugins( "SearchRunnerPlugin" );
     d->m_searchRunnerPlugins << plugin;
     emit searchRunnerPluginsChanged();
 }
 
 QList<const ReverseGeocodingRunnerPlugin *> PluginManager::reverseGeocodingRunnerPlugins() const
 {
-    d->loadPlugins();
+    d->loadPlugins( "ReverseGeocodingRunnerPlugin" );
     return d->m_reverseGeocodingRunnerPlugins;
 }
 
 void PluginManager::addReverseGeocodingRunnerPlugin( const ReverseGeocodingRunnerPlugin *plugin )
 {
-    d->loadPlugins();
+    d->loadPlugins( "ReverseGeocodingRunnerPlugin" );
     d->m_reverseGeocodingRunnerPlugins << plugin;
     emit reverseGeocodingRunnerPluginsChanged();
 }
 
 QList<RoutingRunnerPlugin *> PluginManager::routingRunnerPlugins() const
 {
-    d->loadPlugins();
+    d->loadPlugins( "RoutingRunnerPlugin" );
     return d->m_routingRunnerPlugins;
 }
 
 void PluginManager::addRoutingRunnerPlugin( RoutingRunnerPlugin *plugin )
 {
-    d->loadPlugins();
+    d->loadPlugins( "RoutingRunnerPlugin" );
     d->m_routingRunnerPlugins << plugin;
     emit routingRunnerPluginsChanged();
 }
 
 QList<const ParseRunnerPlugin *> PluginManager::parsingRunnerPlugins() const
 {
-    d->loadPlugins();
+    d->loadPlugins( "ParseRunnerPlugin" );
     return d->m_parsingRunnerPlugins;
 }
 
+QList<const ParseRunnerPlugin *> PluginManager::parsingRunnerPlugins( const QStringList &fileExtensions ) const
+{
+    d->loadPlugins( "ParseRunnerPlugin", fileExtensions );
+
+    QList<const ParseRunnerPlugin *> result;
+    foreach ( const ParseRunnerPlugin *plugin, d->m_parsingRunnerPlugins ) {
+        const QStringList extensions = plugin->fileExtensions();
+        bool matches = extensions.isEmpty();
+        foreach ( const QString &extension, fileExtensions ) {
+            matches = matches || extensions.contains( extension );
+        }
+        if ( matches ) {
+            result << plugin;
+        }
+    }
+    return result;
+}
+
 void PluginManager::addParseRunnerPlugin( const ParseRunnerPlugin *plugin )
 {
-    d->loadPlugins();
+    d->loadPlugins( "ParseRunnerPlugin" );
     d->m_parsingRunnerPlugins << plugin;
     emit parseRunnerPluginsChanged();
 }
@@ -180,68 +282,117 @@ bool appendPlugin( QObject * obj, QPluginLoader* &loader, QList<const T*> &plugi
     return false;
 }
 
-void PluginManagerPrivate::loadPlugins()
+void PluginManagerPrivate::scanPlugins()
 {
-#ifdef SUBSURFACE
-	// we don't use any plugins and this tries to read random files
-	return;
-#endif
-    if (m_pluginsLoaded)
-    {
+    if ( m_pluginsScanned ) {
         return;
     }
+    m_pluginsScanned = true;
 
     QTime t;
     t.start();
-    mDebug() << "Starting to load Plugins.";
 
     QStringList pluginFileNameList = MarbleDirs::pluginEntryList( "", QDir::Files );
 
     MarbleDirs::debug();
 
-    Q_ASSERT( m_renderPluginTemplates.isEmpty() );
-    Q_ASSERT( m_positionProviderPluginTemplates.isEmpty() );
-    Q_ASSERT( m_searchRunnerPlugins.isEmpty() );
-    Q_ASSERT( m_reverseGeocodingRunnerPlugins.isEmpty() );
-    Q_ASSERT( m_routingRunnerPlugins.isEmpty() );
-    Q_ASSERT( m_parsingRunnerPlugins.isEmpty() );
-
     foreach( const QString &fileName, pluginFileNameList ) {
-        // mDebug() << fileName << " - " << MarbleDirs::pluginPath( fileName );
-        QString const path = MarbleDirs::pluginPath( fileName );
-        QPluginLoader* loader = new QPluginLoader( path );
-
-        QObject * obj = loader->instance();
-
-        if ( obj ) {
-            bool isPlugin = appendPlugin<RenderPlugin, RenderPluginInterface>
-                       ( obj, loader, m_renderPluginTemplates );
-            isPlugin = isPlugin || appendPlugin<PositionProviderPlugin, PositionProviderPluginInterface>
-                       ( obj, loader, m_positionProviderPluginTemplates );
-            isPlugin = isPlugin || appendPlugin<SearchRunnerPlugin, SearchRunnerPlugin>
-                       ( obj, loader, m_searchRunnerPlugins ); // intentionally T==U
-            isPlugin = isPlugin || appendPlugin<ReverseGeocodingRunnerPlugin, ReverseGeocodingRunnerPlugin>
-                       ( obj, loader, m_reverseGeocodingRunnerPlugins ); // intentionally T==U
-            isPlugin = isPlugin || appendPlugin<RoutingRunnerPlugin, RoutingRunnerPlugin>
-                       ( obj, loader, m_routingRunnerPlugins ); // intentionally T==U
-            isPlugin = isPlugin || appendPlugin<ParseRunnerPlugin, ParseRunnerPlugin>
-                       ( obj, loader, m_parsingRunnerPlugins ); // intentionally T==U
-            if ( !isPlugin ) {
-                qWarning() << "Ignoring the following plugin since it couldn't be loaded:" << path;
-                mDebug() << "Plugin failure:" << path << "is a plugin, but it does not implement the "
-                        << "right interfaces or it was compiled against an old version of Marble. Ignoring it.";
-                delete loader;
+        PluginLibrary library;
+        library.loader = new QPluginLoader( MarbleDirs::pluginPath( fileName ) );
+
+#if QT_VERSION >= 0x050000
+        // The metadata is read from the file without loading the library
+        const QJsonObject metaData = library.loader->metaData().value( "MetaData" ).toObject();
+        library.type = metaData.value( "Type" ).toString();
+        foreach ( const QJsonValue &extension, metaData.value( "FileExtensions" ).toArray() ) {
+            library.fileExtensions << extension.toString();
+        }
+        library.renderPlugin.nameId = metaData.value( "Name" ).toString();
+        library.renderPlugin.guiString = metaData.value( "GuiString" ).toString();
+        library.renderPlugin.description = metaData.value( "Description" ).toString();
+        library.renderPlugin.enabledByDefault = metaData.value( "EnabledByDefault" ).toBool( true );
+        library.renderPlugin.configurable = metaData.value( "Configurable" ).toBool( false );
+#endif
+
+        m_libraries << library;
+    }
+
+    mDebug() << Q_FUNC_INFO << "Found" << m_libraries.size() << "plugins in" << t.elapsed() << "ms";
+}
+
+void PluginManagerPrivate::loadPlugins( const QString &type, const QStringList &fileExtensions )
+{
+#ifdef SUBSURFACE
+	// we don't use any plugins and this tries to read random files
+	return;
+#endif
+    scanPlugins();
+
+    QTime t;
+    t.start();
+    int count = 0;
+
+    for ( int i = 0; i < m_libraries.size(); ++i ) {
+        PluginLibrary &library = m_libraries[i];
+        if ( library.loaded ) {
+            continue;
+        }
+
+        if ( !library.type.isEmpty() ) {
+            if ( library.type != type ) {
+                continue;
+            }
+
+            if ( !fileExtensions.isEmpty() && !library.fileExtensions.isEmpty() ) {
+                bool matches = false;
+                foreach ( const QString &extension, fileExtensions ) {
+                    matches = matches || library.fileExtensions.contains( extension );
+                }
+                if ( !matches ) {
+                    continue;
+                }
             }
-        } else {
-            qWarning() << "Ignoring to load the following file since it doesn't look like a valid Marble plugin:" << path << endl
-                       << "Reason:" << loader->errorString();
-            delete loader;
         }
+
+        loadPlugin( library );
+        ++count;
     }
 
-    m_pluginsLoaded = true;
+    if ( count > 0 ) {
+        mDebug() << Q_FUNC_INFO << "Loaded" << count << "plugins for" << type << "in" << t.elapsed() << "ms";
+    }
+}
 
-    mDebug() << Q_FUNC_INFO << "Time elapsed:" << t.elapsed() << "ms";
+void PluginManagerPrivate::loadPlugin( PluginLibrary &library )
+{
+    library.loaded = true;
+
+    QPluginLoader* loader = library.loader;
+    QString const path = loader->fileName();
+    QObject * obj = loader->instance();
+
+    if ( obj ) {
+        bool isPlugin = appendPlugin<RenderPlugin, RenderPluginInterface>
+                   ( obj, loader, m_renderPluginTemplates );
+        isPlugin = isPlugin || appendPlugin<PositionProviderPlugin, PositionProviderPluginInterface>
+                   ( obj, loader, m_positionProviderPluginTemplates );
+        isPlugin = isPlugin || appendPlugin<SearchRunnerPlugin, SearchRunnerPlugin>
+                   ( obj, loader, m_searchRunnerPlugins ); // intentionally T==U
+        isPlugin = isPlugin || appendPlugin<ReverseGeocodingRunnerPlugin, ReverseGeocodingRunnerPlugin>
+                   ( obj, loader, m_reverseGeocodingRunnerPlugins ); // intentionally T==U
+        isPlugin = isPlugin || appendPlugin<RoutingRunnerPlugin, RoutingRunnerPlugin>
+                   ( obj, loader, m_routingRunnerPlugins ); // intentionally T==U
+        isPlugin = isPlugin || appendPlugin<ParseRunnerPlugin, ParseRunnerPlugin>
+                   ( obj, loader, m_parsingRunnerPlugins ); // intentionally T==U
+        if ( !isPlugin ) {
+            qWarning() << "Ignoring the following plugin since it couldn't be loaded:" << path;
+            mDebug() << "Plugin failure:" << path << "is a plugin, but it does not implement the "
+                    << "right interfaces or it was compiled against an old version of Marble. Ignoring it.";
+        }
+    } else {
+        qWarning() << "Ignoring to load the following file since it doesn't look like a valid Marble plugin:" << path << endl
+                   << "Reason:" << loader->errorString();
+    }
 }
 
 }
@@ -14,6 +14,7 @@
 
 #include <QObject>
 #include <QList>
+#include <QStringList>
 #include "marble_export.h"
 
 
@@ -29,6 +30,23 @@ class ReverseGeocodingRunnerPlugin;
 class RoutingRunnerPlugin;
 class ParseRunnerPlugin;
 
+/**
+ * @short Describes a RenderPlugin without creating it.
+ *
+ * For plugin libraries with metadata the description is read from the metadata,
+ * so the library does not need to be loaded. The strings are not translated.
+ */
+struct RenderPluginMetaData
+{
+    RenderPluginMetaData() : enabledByDefault( true ), configurable( false ) {}
+
+    QString nameId;
+    QString guiString;
+    QString description;
+    bool enabledByDefault;
+    bool configurable;
+};
+
 /**
  * @short The class that handles Marble's plugins.
  *
@@ -40,6 +58,15 @@ class ParseRunnerPlugin;
  * the objects, the PluginManager internally has a list of the plugins
  * which are owned by the PluginManager and destroyed by it.
  *
+ * Plugin libraries are loaded when plugins of their type are requested
+ * first. With Qt 5 the type is read from the JSON metadata embedded by
+ * Q_PLUGIN_METADATA without loading the library, e.g.
+ * { "Name": "Kml", "Type": "ParseRunnerPlugin", "FileExtensions": [ "kml" ] }.
+ * Render plugins describe themselves further with "GuiString", "Description",
+ * "EnabledByDefault" and "Configurable", so they can be listed with
+ * renderPluginMetaData() and loaded one by one with renderPlugin().
+ * Libraries without metadata are loaded on the first request of any type.
+ *
  */
 
 class MARBLE_EXPORT PluginManager : public QObject
@@ -60,6 +87,22 @@ class MARBLE_EXPORT PluginManager : public QObject
      */
     QList<const RenderPlugin *> renderPlugins() const;
 
+    /**
+     * @brief Returns the descriptions of all available RenderPlugins.
+     *
+     * Libraries with metadata are not loaded by this. Libraries without metadata
+     * have to be loaded to find out whether they provide a RenderPlugin.
+     */
+    QList<RenderPluginMetaData> renderPluginMetaData() const;
+
+    /**
+     * @brief Returns the RenderPlugin with the given name id, loading only its library.
+     *
+     * Ownership of the item remains in PluginManager.
+     * @return the plugin, or null if there is no RenderPlugin with that name id
+     */
+    const RenderPlugin *renderPlugin( const QString &nameId ) const;
+
     /**
      * @brief Add a RenderPlugin manually to the list of known plugins. Normally you
      * don't need to call this method since all plugins are loaded automatically.
@@ -128,6 +171,14 @@ class MARBLE_EXPORT PluginManager : public QObject
      */
     QList<const ParseRunnerPlugin *> parsingRunnerPlugins() const;
 
+    /**
+     * Returns the parse runner plugins that handle one of the given file extensions,
+     * or all files. Other parse runners are not loaded if their metadata tells
+     * the extensions they handle.
+     * @note: The runner plugins are owned by the PluginManager, do not delete them.
+     */
+    QList<const ParseRunnerPlugin *> parsingRunnerPlugins( const QStringList &fileExtensions ) const;
+
     /**
      * @brief Add a ParseRunnerPlugin manually to the list of known plugins. Normally you
      * don't need to call this method since all plugins are loaded automatically.
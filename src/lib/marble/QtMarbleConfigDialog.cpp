@@ -166,7 +166,7 @@ QtMarbleConfigDialog::QtMarbleConfigDialog(MarbleWidget *marbleWidget, CloudSync
     tabWidget->addTab( w_routingSettings, tr( "Routing" ) );
 
     // plugin page
-    d->m_pluginModel.setRenderPlugins( d->m_marbleWidget->renderPlugins() );
+    d->m_pluginModel.setRenderPlugins( d->m_marbleWidget );
     d->w_pluginSettings = new MarblePluginSettingsWidget( this );
     d->w_pluginSettings->setModel( &d->m_pluginModel );
     d->w_pluginSettings->setObjectName( "plugin_page" );
@@ -11,15 +11,20 @@
 #include "RenderPluginModel.h"
 
 #include "DialogConfigurationInterface.h"
+#include "MarbleWidget.h"
+#include "PluginManager.h"
 #include "RenderPlugin.h"
 
+#include <QMap>
+#include <QPointer>
+
 namespace Marble
 {
 
 class RenderPluginModel::Private
 {
 public:
-    Private();
+    Private( RenderPluginModel *parent );
 
     static bool renderPluginGuiStringLessThan( RenderPlugin* one, RenderPlugin* two )
     {
@@ -27,36 +32,91 @@ public:
         return one->guiString().remove( QLatin1Char( '&' ) ) < two->guiString().remove( QLatin1Char( '&' ) );
     }
 
+    // The gui string of a plugin that is only listed, without keyboard accelerators
+    static QString sortKey( const QString &guiString )
+    {
+        return QString( guiString ).remove( QLatin1Char( '&' ) );
+    }
+
+    /**
+     * Removes all rows. Items of loaded plugins are owned by the plugins,
+     * the ones of plugins listed from their metadata are deleted.
+     */
+    void clear();
+
+    /**
+     * Returns the plugin of the given row, creating it first if it is only listed
+     * from its metadata. Its item then replaces the one of the metadata and keeps
+     * the check state, which is applied by applyPluginState().
+     */
+    RenderPlugin *plugin( int row );
+
+    RenderPluginModel *const q;
+
+    // One per row, null for plugins that are not created yet
     QList<RenderPlugin *> m_renderPlugins;
+    QPointer<MarbleWidget> m_marbleWidget;
 };
 
-RenderPluginModel::Private::Private() :
-    m_renderPlugins()
+RenderPluginModel::Private::Private( RenderPluginModel *parent ) :
+    q( parent ),
+    m_renderPlugins(),
+    m_marbleWidget()
+{
+}
+
+void RenderPluginModel::Private::clear()
 {
+    // our model doesn't own the items of the plugins, so take them away
+    for ( int row = 0; q->invisibleRootItem()->hasChildren(); ++row ) {
+        const QList<QStandardItem *> items = q->invisibleRootItem()->takeRow( 0 );
+        if ( row < m_renderPlugins.size() && !m_renderPlugins[row] ) {
+            qDeleteAll( items );
+        }
+    }
+
+    m_renderPlugins.clear();
+}
+
+RenderPlugin *RenderPluginModel::Private::plugin( int row )
+{
+    if ( row < 0 || row >= m_renderPlugins.count() )
+        return 0;
+
+    if ( m_renderPlugins[row] || m_marbleWidget.isNull() )
+        return m_renderPlugins[row];
+
+    QStandardItem *const listed = q->invisibleRootItem()->child( row );
+    RenderPlugin *const plugin = m_marbleWidget->loadRenderPlugin( listed->data( NameId ).toString() );
+    if ( !plugin )
+        return 0;
+
+    QStandardItem *const item = plugin->item();
+    item->setCheckState( listed->checkState() );
+    delete q->invisibleRootItem()->takeRow( row ).first();
+    m_renderPlugins[row] = plugin;
+    q->invisibleRootItem()->insertRow( row, item );
+
+    return plugin;
 }
 
 RenderPluginModel::RenderPluginModel( QObject *parent ) :
     QStandardItemModel( parent ),
-    d( new Private )
+    d( new Private( this ) )
 {
 }
 
 RenderPluginModel::~RenderPluginModel()
 {
-    // our model doesn't own the items, so take them away
-    while ( invisibleRootItem()->hasChildren() ) {
-        invisibleRootItem()->takeRow( 0 );
-    }
+    d->clear();
 
     delete d;
 }
 
 void RenderPluginModel::setRenderPlugins( const QList<RenderPlugin *> &renderPlugins )
 {
-    // our model doesn't own the items, so take them away
-    while ( invisibleRootItem()->hasChildren() ) {
-        invisibleRootItem()->takeRow( 0 );
-    }
+    d->clear();
+    d->m_marbleWidget = 0;
 
     d->m_renderPlugins = renderPlugins;
     qSort( d->m_renderPlugins.begin(), d->m_renderPlugins.end(), Private::renderPluginGuiStringLessThan );
@@ -67,15 +127,53 @@ void RenderPluginModel::setRenderPlugins( const QList<RenderPlugin *> &renderPlu
     }
 }
 
+void RenderPluginModel::setRenderPlugins( MarbleWidget *marbleWidget )
+{
+    d->clear();
+    d->m_marbleWidget = marbleWidget;
+
+    QMap<QString, RenderPlugin *> sorted;
+    foreach ( RenderPlugin *plugin, marbleWidget->renderPlugins() ) {
+        sorted.insertMulti( Private::sortKey( plugin->guiString() ), plugin );
+    }
+    QMap<QString, RenderPluginMetaData> listed;
+    foreach ( const RenderPluginMetaData &metaData, marbleWidget->unloadedRenderPlugins() ) {
+        listed.insertMulti( Private::sortKey( metaData.guiString ), metaData );
+        sorted.insertMulti( Private::sortKey( metaData.guiString ), 0 );
+    }
+
+    QStandardItem *parentItem = invisibleRootItem();
+    QMap<QString, RenderPlugin *>::const_iterator it = sorted.constBegin();
+    for ( ; it != sorted.constEnd(); ++it ) {
+        d->m_renderPlugins << it.value();
+        if ( it.value() ) {
+            parentItem->appendRow( it.value()->item() );
+            continue;
+        }
+
+        const RenderPluginMetaData metaData = listed.take( it.key() );
+        QStandardItem *const item = new QStandardItem( Private::sortKey( metaData.guiString ) );
+        item->setEditable( false );
+        item->setCheckable( true );
+        item->setCheckState( Qt::Unchecked );
+        item->setToolTip( metaData.description );
+        item->setFlags( item->flags() & ~Qt::ItemIsSelectable );
+        item->setData( metaData.nameId, NameId );
+        item->setData( metaData.configurable, ConfigurationDialogAvailable );
+        parentItem->appendRow( item );
+    }
+}
+
 QList<PluginAuthor> RenderPluginModel::pluginAuthors( const QModelIndex &index ) const
 {
     if ( !index.isValid() )
         return QList<PluginAuthor>();
 
-    if ( index.row() < 0 || index.row() >= d->m_renderPlugins.count() )
+    RenderPlugin *plugin = d->plugin( index.row() );
+    if ( !plugin )
         return QList<PluginAuthor>();
 
-    return d->m_renderPlugins.at( index.row() )->pluginAuthors();
+    return plugin->pluginAuthors();
 }
 
 DialogConfigurationInterface *RenderPluginModel::pluginDialogConfigurationInterface( const QModelIndex &index )
@@ -83,24 +181,33 @@ DialogConfigurationInterface *RenderPluginModel::pluginDialogConfigurationInterf
     if ( !index.isValid() )
         return 0;
 
-    if ( index.row() < 0 || index.row() >= d->m_renderPlugins.count() )
-        return 0;
-
-    RenderPlugin *plugin = d->m_renderPlugins.at( index.row() );
+    RenderPlugin *plugin = d->plugin( index.row() );
     return qobject_cast<DialogConfigurationInterface *>( plugin );
 }
 
 void RenderPluginModel::retrievePluginState()
 {
-    foreach ( RenderPlugin *plugin, d->m_renderPlugins ) {
-        plugin->retrieveItemState();
+    for ( int row = 0; row < d->m_renderPlugins.count(); ++row ) {
+        if ( d->m_renderPlugins[row] ) {
+            d->m_renderPlugins[row]->retrieveItemState();
+        } else {
+            invisibleRootItem()->child( row )->setCheckState( Qt::Unchecked );
+        }
     }
 }
 
 void RenderPluginModel::applyPluginState()
 {
-    foreach ( RenderPlugin *plugin, d->m_renderPlugins ) {
-        plugin->applyItemState();
+    for ( int row = 0; row < d->m_renderPlugins.count(); ++row ) {
+        // Plugins that are only listed are created when they get enabled
+        if ( !d->m_renderPlugins[row] && invisibleRootItem()->child( row )->checkState() != Qt::Checked ) {
+            continue;
+        }
+
+        RenderPlugin *const plugin = d->plugin( row );
+        if ( plugin ) {
+            plugin->applyItemState();
+        }
     }
 }
 
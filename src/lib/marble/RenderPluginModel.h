@@ -22,6 +22,7 @@ namespace Marble
 {
 
 class DialogConfigurationInterface;
+class MarbleWidget;
 class RenderPlugin;
 
 /**
@@ -61,6 +62,18 @@ public:
      */
     void setRenderPlugins( const QList<RenderPlugin *> &renderPlugins );
 
+    /**
+     * @brief Set the RenderPlugins of @p marbleWidget the model should manage.
+     *
+     * Plugins which are disabled by default and not created yet are listed from their
+     * metadata. They are created through the widget, which loads their library, when
+     * they get enabled by applyPluginState() or their authors or configuration dialog
+     * are requested.
+     *
+     * @param marbleWidget the widget whose RenderPlugins are to be managed
+     */
+    void setRenderPlugins( MarbleWidget *marbleWidget );
+
     QList<PluginAuthor> pluginAuthors( const QModelIndex &index ) const;
 
     DialogConfigurationInterface *pluginDialogConfigurationInterface( const QModelIndex &index );
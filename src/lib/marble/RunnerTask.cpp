@@ -81,16 +81,31 @@ void RoutingTask::run()
     emit finished( this );
 }
 
-ParsingTask::ParsingTask( ParsingRunner *runner, ParsingRunnerManager *manager, const QString& fileName, DocumentRole role ) :
+ParsingTask::ParsingTask( ParsingRunner *runner, ParsingRunnerManager *manager, const QString& fileName, DocumentRole role,
+                          const ParsedDocumentCache *documentCache ) :
     QObject(),
     m_runner( runner ),
     m_fileName( fileName ),
-    m_role( role )
+    m_role( role ),
+    m_documentCache( documentCache ? *documentCache : ParsedDocumentCache() )
 {
+    // Connected first so that the snapshot is written before the
+    // document reaches the thread of the manager
+    if ( documentCache ) {
+        connect( m_runner, SIGNAL(parsingFinished(GeoDataDocument*,QString)),
+                 this, SLOT(saveSnapshot(GeoDataDocument*)), Qt::DirectConnection );
+    }
     connect( m_runner, SIGNAL(parsingFinished(GeoDataDocument*,QString)),
              manager, SLOT(addParsingResult(GeoDataDocument*,QString)) );
 }
 
+void ParsingTask::saveSnapshot( GeoDataDocument *document )
+{
+    if ( document ) {
+        m_documentCache.save( m_fileName, document );
+    }
+}
+
 void ParsingTask::run()
 {
     m_runner->parseFile( m_fileName, m_role );
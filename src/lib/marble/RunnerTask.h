@@ -14,6 +14,7 @@
 #include "GeoDataCoordinates.h"
 #include "GeoDataDocument.h"
 #include "GeoDataLatLonBox.h"
+#include "ParsedDocumentCache.h"
 
 #include <QRunnable>
 #include <QString>
@@ -103,7 +104,12 @@ class ParsingTask : public QObject, public QRunnable
     Q_OBJECT
 
 public:
-    ParsingTask( ParsingRunner *runner, ParsingRunnerManager *manager, const QString& fileName, DocumentRole role );
+    /**
+     * @param documentCache if not 0, a snapshot of the parsed document is
+     * written to it in the worker thread, before the document is handed over
+     */
+    ParsingTask( ParsingRunner *runner, ParsingRunnerManager *manager, const QString& fileName, DocumentRole role,
+                 const ParsedDocumentCache *documentCache = 0 );
 
     /**
      * @reimp
@@ -113,10 +119,14 @@ public:
 Q_SIGNALS:
     void finished( ParsingTask *task );
 
+private Q_SLOTS:
+    void saveSnapshot( GeoDataDocument *document );
+
 private:
     ParsingRunner *const m_runner;
     QString m_fileName;
     DocumentRole m_role;
+    ParsedDocumentCache m_documentCache;
 };
 
 }
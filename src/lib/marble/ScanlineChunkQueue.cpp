@@ -0,0 +1,129 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2014 The Marble contributors
+//
+
+#include "ScanlineChunkQueue.h"
+
+#include <QtCore/qmath.h>
+
+#include <algorithm>
+
+namespace Marble
+{
+
+namespace
+{
+
+// Chunks per thread; more chunks balance better but cost more
+// tile lookups at chunk borders
+const int chunksPerThread = 8;
+
+// Scanlines per chunk at least
+const int minimumChunkHeight = 4;
+
+class ChunkCostGreaterThan
+{
+public:
+    explicit ChunkCostGreaterThan( const QVector<qint64> &costs ) :
+        m_costs( costs )
+    {
+    }
+
+    bool operator()( int a, int b ) const
+    {
+        return m_costs[a] > m_costs[b];
+    }
+
+private:
+    const QVector<qint64> &m_costs;
+};
+
+}
+
+ScanlineChunkQueue::ScanlineChunkQueue( int yTop, int yBottom, const QVector<int> &rowCosts,
+                                        int threadCount, int rowAlignment,
+                                        QAtomicInt *cancelled ) :
+    m_next( 0 ),
+    m_cancelled( cancelled )
+{
+    const int rows = yBottom - yTop;
+    if ( rows <= 0 ) {
+        return;
+    }
+
+    const int alignment = qMax( 1, rowAlignment );
+    const int chunkCount = qBound( 1, rows / minimumChunkHeight, qMax( 1, threadCount ) * chunksPerThread );
+
+    qint64 totalCost = 0;
+    for ( int i = 0; i < rows; ++i ) {
+        totalCost += rowCosts.isEmpty() ? 1 : qMax( 1, rowCosts[i] );
+    }
+    const qint64 targetCost = qMax<qint64>( 1, totalCost / chunkCount );
+
+    QVector<QPair<int, int> > chunks;
+    QVector<qint64> costs;
+    int yStart = yTop;
+    qint64 cost = 0;
+    for ( int y = yTop; y < yBottom; ++y ) {
+        cost += rowCosts.isEmpty() ? 1 : qMax( 1, rowCosts[y - yTop] );
+        const bool aligned = ( y + 1 - yTop ) % alignment == 0;
+        if ( ( cost >= targetCost && aligned ) || y + 1 == yBottom ) {
+            chunks << qMakePair( yStart, y + 1 );
+            costs << cost;
+            yStart = y + 1;
+            cost = 0;
+        }
+    }
+
+    QVector<int> order( chunks.size() );
+    for ( int i = 0; i < order.size(); ++i ) {
+        order[i] = i;
+    }
+    std::stable_sort( order.begin(), order.end(), ChunkCostGreaterThan( costs ) );
+
+    m_chunks.reserve( chunks.size() );
+    foreach ( int index, order ) {
+        m_chunks << chunks[index];
+    }
+}
+
+bool ScanlineChunkQueue::takeChunk( int &yStart, int &yEnd )
+{
+    // testAndSet with equal values reads the flag in both Qt 4 and Qt 5
+    if ( m_cancelled && !m_cancelled->testAndSetRelaxed( 0, 0 ) ) {
+        return false;
+    }
+
+    const int index = m_next.fetchAndAddOrdered( 1 );
+    if ( index >= m_chunks.size() ) {
+        return false;
+    }
+
+    yStart = m_chunks[index].first;
+    yEnd = m_chunks[index].second;
+    return true;
+}
+
+int ScanlineChunkQueue::chunkCount() const
+{
+    return m_chunks.size();
+}
+
+QVector<int> ScanlineChunkQueue::discRowCosts( int yTop, int yBottom, int imageWidth, int imageHeight, qreal radius )
+{
+    QVector<int> costs( qMax( 0, yBottom - yTop ) );
+    for ( int y = yTop; y < yBottom; ++y ) {
+        const qreal dy = y - imageHeight / 2;
+        const qreal rx = radius * radius > dy * dy ? qSqrt( radius * radius - dy * dy ) : 0.0;
+        costs[y - yTop] = qMin( imageWidth, 2 * int( rx ) );
+    }
+    return costs;
+}
+
+}
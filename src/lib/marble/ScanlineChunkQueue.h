@@ -0,0 +1,73 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2014 The Marble contributors
+//
+
+#ifndef MARBLE_SCANLINECHUNKQUEUE_H
+#define MARBLE_SCANLINECHUNKQUEUE_H
+
+#include <QAtomicInt>
+#include <QPair>
+#include <QVector>
+
+namespace Marble
+{
+
+/**
+  * @short Shared queue of scanline ranges for the texture mapper threads
+  *
+  * The scanlines of a frame are split into many small chunks of about equal
+  * estimated cost. Each render thread keeps taking the next chunk until the
+  * queue is empty, so threads that got cheap scanlines (e.g. near the poles
+  * of the globe) help out with the expensive ones instead of idling.
+  *
+  * Chunks are handed out most expensive first to shorten the tail of a frame.
+  */
+class ScanlineChunkQueue
+{
+public:
+    /**
+     * @param yTop first scanline
+     * @param yBottom scanline after the last one
+     * @param rowCosts estimated cost of each scanline starting at @p yTop,
+     *        or an empty vector if all scanlines cost the same
+     * @param threadCount number of threads taking chunks
+     * @param rowAlignment chunks start at multiples of this from @p yTop,
+     *        e.g. 2 when pairs of scanlines are rendered together
+     * @param cancelled optional flag that empties the queue once it is
+     *        set to a value other than 0
+     */
+    ScanlineChunkQueue( int yTop, int yBottom, const QVector<int> &rowCosts,
+                        int threadCount, int rowAlignment,
+                        QAtomicInt *cancelled = 0 );
+
+    /**
+     * @brief Takes the next chunk, may be called from any thread
+     * @return false if the queue is empty or cancelled
+     */
+    bool takeChunk( int &yStart, int &yEnd );
+
+    int chunkCount() const;
+
+    /**
+     * @brief Estimates the cost of the scanlines of a disc as the width of the disc
+     *        within the image
+     */
+    static QVector<int> discRowCosts( int yTop, int yBottom, int imageWidth, int imageHeight, qreal radius );
+
+private:
+    Q_DISABLE_COPY( ScanlineChunkQueue )
+
+    QVector<QPair<int, int> > m_chunks;
+    QAtomicInt m_next;
+    QAtomicInt *const m_cancelled;
+};
+
+}
+
+#endif
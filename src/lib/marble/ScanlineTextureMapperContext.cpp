@@ -13,6 +13,8 @@
 
 #include <QImage>
 
+#include <cstring>
+
 #include "MarbleDebug.h"
 #include "StackedTile.h"
 #include "StackedTileLoader.h"
@@ -437,6 +439,35 @@ QImage::Format ScanlineTextureMapperContext::optimalCanvasImageFormat( const Vie
     return imageFormat;
 }
 
+void ScanlineTextureMapperContext::scrollCanvasImage( QImage *canvasImage, int dx, int dy )
+{
+    const int width = canvasImage->width();
+    const int height = canvasImage->height();
+    if ( qAbs( dx ) >= width || qAbs( dy ) >= height ) {
+        return;
+    }
+
+    const int bytesPerPixel = canvasImage->depth() / 8;
+    const int bytesPerLine = canvasImage->bytesPerLine();
+    const int rowBytes = ( width - qAbs( dx ) ) * bytesPerPixel;
+    uchar *const bits = canvasImage->bits();
+    uchar *const target = bits + qMax( 0, dx ) * bytesPerPixel;
+    const uchar *const source = bits + qMax( 0, -dx ) * bytesPerPixel;
+
+    // Walk against the direction of the movement so that no row gets
+    // overwritten before it was moved itself
+    if ( dy > 0 ) {
+        for ( int y = height - 1; y >= dy; --y ) {
+            memmove( target + y * bytesPerLine, source + ( y - dy ) * bytesPerLine, rowBytes );
+        }
+    }
+    else {
+        for ( int y = 0; y < height + dy; ++y ) {
+            memmove( target + y * bytesPerLine, source + ( y - dy ) * bytesPerLine, rowBytes );
+        }
+    }
+}
+
 
 void ScanlineTextureMapperContext::nextTile( int &posX, int &posY )
 {
@@ -46,6 +46,12 @@ public:
 
     static QImage::Format optimalCanvasImageFormat( const ViewportParams *viewport );
 
+    /**
+     * Moves the content of a canvas image by @p dx, @p dy pixels. The
+     * uncovered parts keep stale content and need to be painted again.
+     */
+    static void scrollCanvasImage( QImage *canvasImage, int dx, int dy );
+
     int globalWidth() const;
     int globalHeight() const;
 
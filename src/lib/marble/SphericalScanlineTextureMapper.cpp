@@ -22,7 +22,9 @@
 #include "GeoDataPolygon.h"
 #include "GeoDataDocument.h"
 #include "MarbleDebug.h"
+#include "MarbleProfiler.h"
 #include "Quaternion.h"
+#include "ScanlineChunkQueue.h"
 #include "ScanlineTextureMapperContext.h"
 #include "StackedTileLoader.h"
 #include "StackedTile.h"
@@ -36,7 +38,7 @@ using namespace Marble;
 class SphericalScanlineTextureMapper::RenderJob : public QRunnable
 {
 public:
-    RenderJob( StackedTileLoader *tileLoader, int tileLevel, QImage *canvasImage, const ViewportParams *viewport, MapQuality mapQuality, int yTop, int yBottom );
+    RenderJob( StackedTileLoader *tileLoader, int tileLevel, QImage *canvasImage, const ViewportParams *viewport, MapQuality mapQuality, ScanlineChunkQueue *queue );
 
     virtual void run();
 
@@ -46,18 +48,16 @@ private:
     QImage *const m_canvasImage;
     const ViewportParams *const m_viewport;
     const MapQuality m_mapQuality;
-    int const m_yTop;
-    int const m_yBottom;
+    ScanlineChunkQueue *const m_queue;
 };
 
-SphericalScanlineTextureMapper::RenderJob::RenderJob( StackedTileLoader *tileLoader, int tileLevel, QImage *canvasImage, const ViewportParams *viewport, MapQuality mapQuality, int yTop, int yBottom )
+SphericalScanlineTextureMapper::RenderJob::RenderJob( StackedTileLoader *tileLoader, int tileLevel, QImage *canvasImage, const ViewportParams *viewport, MapQuality mapQuality, ScanlineChunkQueue *queue )
     : m_tileLoader( tileLoader ),
       m_tileLevel( tileLevel ),
       m_canvasImage( canvasImage ),
       m_viewport( viewport ),
       m_mapQuality( mapQuality ),
-      m_yTop( yTop ),
-      m_yBottom( yBottom )
+      m_queue( queue )
 {
 }
 
@@ -114,6 +114,8 @@ void SphericalScanlineTextureMapper::mapTexture( GeoPainter *painter,
 
 void SphericalScanlineTextureMapper::mapTexture( const ViewportParams *viewport, int tileZoomLevel, MapQuality mapQuality )
 {
+    MARBLE_PROFILE_SCOPE( "SphericalScanlineTextureMapper::mapTexture" );
+
     // Reset backend
     m_tileLoader->resetTilehash();
 
@@ -131,11 +133,11 @@ void SphericalScanlineTextureMapper::mapTexture( const ViewportParams *viewport,
                                       : yTop + radius + radius - skip;
 
     const int numThreads = m_threadPool.maxThreadCount();
-    const int yStep = qCeil(qreal( yBottom - yTop ) / qreal(numThreads));
-    for ( int i = 0; i < numThreads; ++i ) {
-        const int yStart = yTop +  i      * yStep;
-        const int yEnd   = qMin(yBottom, yTop + (i + 1) * yStep);
-        QRunnable *const job = new RenderJob( m_tileLoader, tileZoomLevel, &m_canvasImage, viewport, mapQuality, yStart, yEnd );
+    const int rowAlignment = ( mapQuality == LowQuality ) ? 2 : 1;
+    ScanlineChunkQueue queue( yTop, yBottom, ScanlineChunkQueue::discRowCosts( yTop, yBottom, m_canvasImage.width(), imageHeight, radius ),
+                              numThreads, rowAlignment, &m_cancelled );
+    for ( int i = 0; i < qMin( numThreads, queue.chunkCount() ); ++i ) {
+        QRunnable *const job = new RenderJob( m_tileLoader, tileZoomLevel, &m_canvasImage, viewport, mapQuality, &queue );
         m_threadPool.start( job );
     }
 
@@ -146,6 +148,8 @@ void SphericalScanlineTextureMapper::mapTexture( const ViewportParams *viewport,
 
 void SphericalScanlineTextureMapper::RenderJob::run()
 {
+    MARBLE_PROFILE_SCOPE( "SphericalScanlineTextureMapper::RenderJob" );
+
     const int imageHeight = m_canvasImage->height();
     const int imageWidth  = m_canvasImage->width();
     const qint64  radius  = m_viewport->radius();
@@ -176,129 +180,133 @@ void SphericalScanlineTextureMapper::RenderJob::run()
     qreal  lat = 0.0;
 
     // Scanline based algorithm to texture map a sphere
-    for ( int y = m_yTop; y < m_yBottom ; ++y ) {
-
-        // Evaluate coordinates for the 3D position vector of the current pixel
-        const qreal qy = inverseRadius * (qreal)( imageHeight / 2 - y );
-        const qreal qr = 1.0 - qy * qy;
-
-        // rx is the radius component in x direction
-        const int rx = (int)sqrt( (qreal)( radius * radius
-                                      - ( ( y - imageHeight / 2 )
-                                          * ( y - imageHeight / 2 ) ) ) );
-
-        // Calculate the actual x-range of the map within the current scanline.
-        // 
-        // If the circular border of the earth disk is still visible then xLeft
-        // equals the scanline position of the most left pixel that gets covered
-        // by the earth disk. In terms of math this equals the half image width minus 
-        // the radius component on the current scanline in x direction ("rx").
-        //
-        // If the zoom factor is high enough then the whole screen gets covered
-        // by the earth and the border of the earth disk isn't visible anymore.
-        // In that situation xLeft equals zero.
-        // For xRight the situation is similar.
-
-        const int xLeft  = ( imageWidth / 2 - rx > 0 ) ? imageWidth / 2 - rx
-                                                       : 0;
-        const int xRight = ( imageWidth / 2 - rx > 0 ) ? xLeft + rx + rx
-                                                       : imageWidth;
-
-        QRgb * scanLine = (QRgb*)( m_canvasImage->scanLine( y ) ) + xLeft;
-
-        const int xIpLeft  = ( imageWidth / 2 - rx > 0 ) ? n * (int)( xLeft / n + 1 )
-                                                         : 1;
-        const int xIpRight = ( imageWidth / 2 - rx > 0 ) ? n * (int)( xRight / n - 1 )
-                                                         : n * (int)( xRight / n - 1 ) + 1; 
-
-        // Decrease pole distortion due to linear approximation ( y-axis )
-        bool crossingPoleArea = false;
-        if ( northPole.v[Q_Z] > 0
-             && northPoleY - ( n * 0.75 ) <= y
-             && northPoleY + ( n * 0.75 ) >= y ) 
-        {
-            crossingPoleArea = true;
-        }
+    int yStart;
+    int yEnd;
+    while ( m_queue->takeChunk( yStart, yEnd ) ) {
+        for ( int y = yStart; y < yEnd ; ++y ) {
+
+            // Evaluate coordinates for the 3D position vector of the current pixel
+            const qreal qy = inverseRadius * (qreal)( imageHeight / 2 - y );
+            const qreal qr = 1.0 - qy * qy;
+
+            // rx is the radius component in x direction
+            const int rx = (int)sqrt( (qreal)( radius * radius
+                                          - ( ( y - imageHeight / 2 )
+                                              * ( y - imageHeight / 2 ) ) ) );
+
+            // Calculate the actual x-range of the map within the current scanline.
+            // 
+            // If the circular border of the earth disk is still visible then xLeft
+            // equals the scanline position of the most left pixel that gets covered
+            // by the earth disk. In terms of math this equals the half image width minus 
+            // the radius component on the current scanline in x direction ("rx").
+            //
+            // If the zoom factor is high enough then the whole screen gets covered
+            // by the earth and the border of the earth disk isn't visible anymore.
+            // In that situation xLeft equals zero.
+            // For xRight the situation is similar.
+
+            const int xLeft  = ( imageWidth / 2 - rx > 0 ) ? imageWidth / 2 - rx
+                                                           : 0;
+            const int xRight = ( imageWidth / 2 - rx > 0 ) ? xLeft + rx + rx
+                                                           : imageWidth;
+
+            QRgb * scanLine = (QRgb*)( m_canvasImage->scanLine( y ) ) + xLeft;
+
+            const int xIpLeft  = ( imageWidth / 2 - rx > 0 ) ? n * (int)( xLeft / n + 1 )
+                                                             : 1;
+            const int xIpRight = ( imageWidth / 2 - rx > 0 ) ? n * (int)( xRight / n - 1 )
+                                                             : n * (int)( xRight / n - 1 ) + 1; 
+
+            // Decrease pole distortion due to linear approximation ( y-axis )
+            bool crossingPoleArea = false;
+            if ( northPole.v[Q_Z] > 0
+                 && northPoleY - ( n * 0.75 ) <= y
+                 && northPoleY + ( n * 0.75 ) >= y ) 
+            {
+                crossingPoleArea = true;
+            }
 
-        int ncount = 0;
+            int ncount = 0;
+
+            for ( int x = xLeft; x < xRight; ++x ) {
+                // Prepare for interpolation
+
+                const int leftInterval = xIpLeft + ncount * n;
+
+                bool interpolate = false;
+                if ( x >= xIpLeft && x <= xIpRight ) {
+
+                    // Decrease pole distortion due to linear approximation ( x-axis )
+    //                mDebug() << QString("NorthPole X: %1, LeftInterval: %2").arg( northPoleX ).arg( leftInterval );
+                    if ( crossingPoleArea
+                         && northPoleX >= leftInterval + n
+                         && northPoleX < leftInterval + 2 * n
+                         && x < leftInterval + 3 * n )
+                    {
+                        interpolate = false;
+                    }
+                    else {
+                        x += n - 1;
+                        interpolate = !printQuality;
+                        ++ncount;
+                    } 
+                }
+                else
+                    interpolate = false;
 
-        for ( int x = xLeft; x < xRight; ++x ) {
-            // Prepare for interpolation
+                // Evaluate more coordinates for the 3D position vector of
+                // the current pixel.
+                const qreal qx = (qreal)( x - imageWidth / 2 ) * inverseRadius;
+                const qreal qr2z = qr - qx * qx;
+                const qreal qz = ( qr2z > 0.0 ) ? sqrt( qr2z ) : 0.0;
+
+                // Create Quaternion from vector coordinates and rotate it
+                // around globe axis
+                Quaternion qpos( 0.0, qx, qy, qz );
+                qpos.rotateAroundAxis( planetAxisMatrix );
+
+                qpos.getSpherical( lon, lat );
+    //            mDebug() << QString("lon: %1 lat: %2").arg(lon).arg(lat);
+                // Approx for n-1 out of n pixels within the boundary of
+                // xIpLeft to xIpRight
+
+                if ( interpolate ) {
+                    if (highQuality)
+                        context.pixelValueApproxF( lon, lat, scanLine, n );
+                    else
+                        context.pixelValueApprox( lon, lat, scanLine, n );
+
+                    scanLine += ( n - 1 );
+                }
 
-            const int leftInterval = xIpLeft + ncount * n;
+    //          Comment out the pixelValue line and run Marble if you want
+    //          to understand the interpolation:
 
-            bool interpolate = false;
-            if ( x >= xIpLeft && x <= xIpRight ) {
+    //          Uncomment the crossingPoleArea line to check precise 
+    //          rendering around north pole:
 
-                // Decrease pole distortion due to linear approximation ( x-axis )
-//                mDebug() << QString("NorthPole X: %1, LeftInterval: %2").arg( northPoleX ).arg( leftInterval );
-                if ( crossingPoleArea
-                     && northPoleX >= leftInterval + n
-                     && northPoleX < leftInterval + 2 * n
-                     && x < leftInterval + 3 * n )
-                {
-                    interpolate = false;
+    //            if ( !crossingPoleArea )
+                if ( x < imageWidth ) {
+                    if ( highQuality )
+                        context.pixelValueF( lon, lat, scanLine );
+                    else
+                        context.pixelValue( lon, lat, scanLine );
                 }
-                else {
-                    x += n - 1;
-                    interpolate = !printQuality;
-                    ++ncount;
-                } 
-            }
-            else
-                interpolate = false;
-
-            // Evaluate more coordinates for the 3D position vector of
-            // the current pixel.
-            const qreal qx = (qreal)( x - imageWidth / 2 ) * inverseRadius;
-            const qreal qr2z = qr - qx * qx;
-            const qreal qz = ( qr2z > 0.0 ) ? sqrt( qr2z ) : 0.0;
-
-            // Create Quaternion from vector coordinates and rotate it
-            // around globe axis
-            Quaternion qpos( 0.0, qx, qy, qz );
-            qpos.rotateAroundAxis( planetAxisMatrix );
-
-            qpos.getSpherical( lon, lat );
-//            mDebug() << QString("lon: %1 lat: %2").arg(lon).arg(lat);
-            // Approx for n-1 out of n pixels within the boundary of
-            // xIpLeft to xIpRight
-
-            if ( interpolate ) {
-                if (highQuality)
-                    context.pixelValueApproxF( lon, lat, scanLine, n );
-                else
-                    context.pixelValueApprox( lon, lat, scanLine, n );
 
-                scanLine += ( n - 1 );
+                ++scanLine;
             }
 
-//          Comment out the pixelValue line and run Marble if you want
-//          to understand the interpolation:
+            // copy scanline to improve performance
+            if ( interlaced && y + 1 < yEnd ) { 
 
-//          Uncomment the crossingPoleArea line to check precise 
-//          rendering around north pole:
+                const int pixelByteSize = m_canvasImage->bytesPerLine() / imageWidth;
 
-//            if ( !crossingPoleArea )
-            if ( x < imageWidth ) {
-                if ( highQuality )
-                    context.pixelValueF( lon, lat, scanLine );
-                else
-                    context.pixelValue( lon, lat, scanLine );
+                memcpy( m_canvasImage->scanLine( y + 1 ) + xLeft * pixelByteSize, 
+                        m_canvasImage->scanLine( y ) + xLeft * pixelByteSize, 
+                        ( xRight - xLeft ) * pixelByteSize );
+                ++y;
             }
-
-            ++scanLine;
-        }
-
-        // copy scanline to improve performance
-        if ( interlaced && y + 1 < m_yBottom ) { 
-
-            const int pixelByteSize = m_canvasImage->bytesPerLine() / imageWidth;
-
-            memcpy( m_canvasImage->scanLine( y + 1 ) + xLeft * pixelByteSize, 
-                    m_canvasImage->scanLine( y ) + xLeft * pixelByteSize, 
-                    ( xRight - xLeft ) * pixelByteSize );
-            ++y;
         }
     }
 }
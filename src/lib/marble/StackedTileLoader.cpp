@@ -25,6 +25,7 @@
 #include "StackedTileLoader.h"
 
 #include "MarbleDebug.h"
+#include "MarbleProfiler.h"
 #include "MergedLayerDecorator.h"
 #include "StackedTile.h"
 #include "TileLoader.h"
@@ -127,6 +128,8 @@ const StackedTile* StackedTileLoader::loadTile( TileId const & stackedTileId )
     }
     // here ends the performance critical section of this method
 
+    MARBLE_PROFILE_SCOPE( "StackedTileLoader::loadTile" );
+
     d->m_cacheLock.lockForWrite();
 
     // has another thread loaded our tile due to a race condition?
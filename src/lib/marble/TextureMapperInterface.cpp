@@ -14,7 +14,8 @@
 using namespace Marble;
 
 TextureMapperInterface::TextureMapperInterface() :
-    m_repaintNeeded( true )
+    m_repaintNeeded( true ),
+    m_cancelled( 0 )
 {
 }
 
@@ -27,3 +28,13 @@ void TextureMapperInterface::setRepaintNeeded()
 {
     m_repaintNeeded = true;
 }
+
+void TextureMapperInterface::setCenterChanged()
+{
+    m_repaintNeeded = true;
+}
+
+void TextureMapperInterface::cancel()
+{
+    m_cancelled.fetchAndStoreOrdered( 1 );
+}
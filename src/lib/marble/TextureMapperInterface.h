@@ -12,6 +12,8 @@
 #ifndef MARBLE_TEXTUREMAPPERINTERFACE_H
 #define MARBLE_TEXTUREMAPPERINTERFACE_H
 
+#include <QAtomicInt>
+
 class QRect;
 
 namespace Marble
@@ -38,8 +40,24 @@ public:
 
     void setRepaintNeeded();
 
+    /**
+     * Called when the center of the viewport moved while the map content
+     * stayed the same. The default implementation requests a full repaint;
+     * mappers that can reuse their last frame override this.
+     */
+    virtual void setCenterChanged();
+
+    /**
+     * Makes a mapTexture() call running in another thread return as soon
+     * as possible. The mapper must not be used afterwards.
+     */
+    void cancel();
+
 protected:
     bool m_repaintNeeded;
+
+    /// Set by cancel(), checked by the render jobs of the mapper
+    QAtomicInt m_cancelled;
 };
 
 }
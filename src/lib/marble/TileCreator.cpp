@@ -13,10 +13,17 @@
 #include "TileCreator.h"
 
 #include <cmath>
+#include <cstring>
 
+#include <QAtomicInt>
 #include <QDir>
+#include <QElapsedTimer>
+#include <QHash>
 #include <QRect>
+#include <QRunnable>
+#include <QSemaphore>
 #include <QSize>
+#include <QThreadPool>
 #include <QVector>
 #include <QApplication>
 #include <QImage>
@@ -26,37 +33,91 @@
 #include "MarbleGlobal.h"
 #include "MarbleDirs.h"
 #include "MarbleDebug.h"
+#include "TileId.h"
 #include "TileLoaderHelper.h"
 
 namespace Marble
 {
 
+/**
+  * Children of a tile on a lower level that has not been created yet
+  */
+class PendingTile
+{
+ public:
+    PendingTile() : m_childCount( 0 ) {}
+
+    // downscaled children, null for existing tiles that were not loaded yet
+    QImage m_children[4];
+    QString m_childFiles[4];
+    int m_childCount;
+};
+
 class TileCreatorPrivate
 {
  public:
-    TileCreatorPrivate( TileCreatorSource *source,
+    TileCreatorPrivate( TileCreator *parent, TileCreatorSource *source,
                         const QString& dem, const QString& targetDir=QString() )
-       : m_dem( dem ),
+       : q( parent ),
+         m_dem( dem ),
          m_targetDir( targetDir ),
          m_cancelled( false ),
          m_tileFormat( "jpg" ),
          m_resume( false ),
          m_verify( false ),
-         m_source( source )
+         m_source( source ),
+         m_threadPool(),
+         m_pendingJobs( 2 * m_threadPool.maxThreadCount() + 2 ),
+         m_failed( 0 ),
+         m_createdTilesCount( 0 ),
+         m_totalTileCount( 0 ),
+         m_percentCompleted( -1 )
      {
         if ( m_dem == "true" ) {
             m_tileQuality = 70;
         } else {
             m_tileQuality = 85;
         }
+
+        for ( int cnt = 0; cnt <= 255; ++cnt ) {
+            m_grayScalePalette.insert(cnt, qRgb(cnt, cnt, cnt));
+        }
     }
 
     ~TileCreatorPrivate()
     {
+        m_threadPool.waitForDone();
         delete m_source;
     }
 
+    QString tileName( int tileLevel, int n, int m ) const;
+
+    /**
+      * Encodes and writes the tile in the thread pool. Blocks while too many tiles
+      * are waiting to be written to keep the memory usage bounded.
+      */
+    void saveTile( const QImage &tile, const QString &fileName );
+
+    /**
+      * Hands a finished tile to its parent on the next lower level. Once all four
+      * children of a parent are known, the parent is composed, saved and handed
+      * down recursively. A null tile denotes an existing tile that is only loaded
+      * from disk when its parent needs to be created.
+      */
+    void addChild( int tileLevel, int n, int m, const QImage &tile );
+
+    /**
+      * Returns @p tile scaled down by a factor of two
+      */
+    QImage downscaled( const QImage &tile ) const;
+
+    QImage compose( const QImage *children ) const;
+
+    void updateProgress();
+
  public:
+    TileCreator *const q;
+
     QString  m_dem;
     QString  m_targetDir;
     bool     m_cancelled;
@@ -66,8 +127,210 @@ class TileCreatorPrivate
     bool     m_verify;
 
     TileCreatorSource  *m_source;
+
+    QVector<QRgb> m_grayScalePalette;
+
+    QThreadPool m_threadPool;
+    QSemaphore m_pendingJobs;
+    QAtomicInt m_failed;
+
+    QHash<TileId, PendingTile> m_pendingTiles;
+
+    int m_createdTilesCount;
+    int m_totalTileCount;
+    int m_percentCompleted;
+    QElapsedTimer m_timer;
 };
 
+class TileSaveJob : public QRunnable
+{
+ public:
+    TileSaveJob( TileCreatorPrivate *creator, const QImage &tile, const QString &fileName );
+
+    virtual void run();
+
+ private:
+    TileCreatorPrivate *const m_creator;
+    const QImage m_tile;
+    const QString m_fileName;
+};
+
+TileSaveJob::TileSaveJob( TileCreatorPrivate *creator, const QImage &tile, const QString &fileName )
+    : m_creator( creator ),
+      m_tile( tile ),
+      m_fileName( fileName )
+{
+}
+
+void TileSaveJob::run()
+{
+    bool  ok = m_tile.save( m_fileName, m_creator->m_tileFormat.toLatin1().data(), m_creator->m_tileQuality );
+    if ( !ok ) {
+        mDebug() << "Error while writing Tile: " << m_fileName;
+        m_creator->m_failed.fetchAndStoreOrdered( 1 );
+    }
+
+    mDebug() << m_fileName << "size" << QFile( m_fileName ).size();
+
+    if ( ok && m_creator->m_verify ) {
+        QImage writtenTile( m_fileName );
+        Q_ASSERT( writtenTile.size() == m_tile.size() );
+        for ( int i=0; i < writtenTile.size().width(); ++i) {
+            for ( int j=0; j < writtenTile.size().height(); ++j) {
+                if ( writtenTile.pixel( i, j ) != m_tile.pixel( i, j ) ) {
+                    unsigned int  pixel = m_tile.pixel( i, j);
+                    unsigned int  writtenPixel = writtenTile.pixel( i, j);
+                    qWarning() << "***** pixel" << i << j << "is off by" << (pixel - writtenPixel) << "pixel" << pixel << "writtenPixel" << writtenPixel;
+                    QByteArray baPixel((char*)&pixel, sizeof(unsigned int));
+                    qWarning() << "pixel" << baPixel.size() << "0x" << baPixel.toHex();
+                    QByteArray baWrittenPixel((char*)&writtenPixel, sizeof(unsigned int));
+                    qWarning() << "writtenPixel" << baWrittenPixel.size() << "0x" << baWrittenPixel.toHex();
+                    Q_ASSERT(false);
+                }
+            }
+        }
+    }
+
+    m_creator->m_pendingJobs.release();
+}
+
+QString TileCreatorPrivate::tileName( int tileLevel, int n, int m ) const
+{
+    return m_targetDir + ( QString("%1/%2/%2_%3.%4")
+                           .arg( tileLevel )
+                           .arg( n, tileDigits, 10, QChar('0') )
+                           .arg( m, tileDigits, 10, QChar('0') ) )
+                           .arg( m_tileFormat );
+}
+
+void TileCreatorPrivate::saveTile( const QImage &tile, const QString &fileName )
+{
+    m_pendingJobs.acquire();
+    m_threadPool.start( new TileSaveJob( this, tile, fileName ) );
+}
+
+void TileCreatorPrivate::addChild( int tileLevel, int n, int m, const QImage &tile )
+{
+    if ( tileLevel == 0 ) {
+        return;
+    }
+
+    const TileId parentId( 0, tileLevel - 1, m / 2, n / 2 );
+    PendingTile &pending = m_pendingTiles[parentId];
+
+    const int index = 2 * ( n % 2 ) + ( m % 2 );
+    if ( tile.isNull() ) {
+        pending.m_childFiles[index] = tileName( tileLevel, n, m );
+    } else {
+        pending.m_children[index] = downscaled( tile );
+    }
+    ++pending.m_childCount;
+
+    if ( pending.m_childCount < 4 ) {
+        return;
+    }
+
+    const PendingTile complete = pending;
+    m_pendingTiles.remove( parentId );
+
+    const QString parentName = tileName( tileLevel - 1, n / 2, m / 2 );
+    if ( QFile::exists( parentName ) && m_resume ) {
+        //mDebug() << parentName << "exists already";
+        addChild( tileLevel - 1, n / 2, m / 2, QImage() );
+    } else {
+        QImage quarters[4];
+        for ( int i = 0; i < 4; ++i ) {
+            quarters[i] = complete.m_children[i];
+            if ( quarters[i].isNull() ) {
+                QImage existing( complete.m_childFiles[i] );
+                if ( existing.size() != QSize( c_defaultTileSize, c_defaultTileSize ) ) {
+                    mDebug() << "Cannot read existing tile" << complete.m_childFiles[i];
+                    m_failed.fetchAndStoreOrdered( 1 );
+                    return;
+                }
+                if ( m_dem == "true" && existing.format() != QImage::Format_Indexed8 ) {
+                    existing = existing.convertToFormat( QImage::Format_Indexed8,
+                                                         m_grayScalePalette,
+                                                         Qt::ThresholdDither );
+                }
+                quarters[i] = downscaled( existing );
+            }
+        }
+
+        const QImage parent = compose( quarters );
+        saveTile( parent, parentName );
+        addChild( tileLevel - 1, n / 2, m / 2, parent );
+    }
+
+    updateProgress();
+}
+
+QImage TileCreatorPrivate::downscaled( const QImage &tile ) const
+{
+    const int size = c_defaultTileSize / 2;
+
+    if ( m_dem == "true" ) {
+        QImage result( size, size, QImage::Format_Indexed8 );
+        result.setColorTable( m_grayScalePalette );
+        for ( int y = 0; y < size; ++y ) {
+            uchar *destLine = result.scanLine( y );
+            const uchar *srcLine = tile.scanLine( 2 * y );
+            for ( int x = 0; x < size; ++x )
+                destLine[x] = srcLine[ 2 * x ];
+        }
+        return result;
+    }
+
+    const QImage source = tile.format() == QImage::Format_ARGB32 ? tile : tile.convertToFormat( QImage::Format_ARGB32 );
+    QImage result( size, size, QImage::Format_ARGB32 );
+    for ( int y = 0; y < size; ++y ) {
+        QRgb *destLine = (QRgb*) result.scanLine( y );
+        const QRgb *srcLine = (const QRgb*) source.scanLine( 2 * y );
+        for ( int x = 0; x < size; ++x )
+            destLine[x] = srcLine[ 2 * x ];
+    }
+    return result;
+}
+
+QImage TileCreatorPrivate::compose( const QImage *children ) const
+{
+    const int size = c_defaultTileSize / 2;
+    const bool dem = m_dem == "true";
+
+    QImage tile( c_defaultTileSize, c_defaultTileSize, dem ? QImage::Format_Indexed8 : QImage::Format_ARGB32 );
+    if ( dem ) {
+        tile.setColorTable( m_grayScalePalette );
+    }
+
+    const int bytesPerLine = size * ( dem ? 1 : sizeof( QRgb ) );
+    for ( int i = 0; i < 4; ++i ) {
+        const int offsetX = ( i % 2 ) * bytesPerLine;
+        const int offsetY = ( i / 2 ) * size;
+        for ( int y = 0; y < size; ++y ) {
+            memcpy( tile.scanLine( offsetY + y ) + offsetX, children[i].scanLine( y ), bytesPerLine );
+        }
+    }
+
+    return tile;
+}
+
+void TileCreatorPrivate::updateProgress()
+{
+    ++m_createdTilesCount;
+
+    // Don't exceed 99% as this would cancel the thread unexpectedly
+    const int percentCompleted = (int) ( 99 * (qreal)(m_createdTilesCount)
+                                         / (qreal)(m_totalTileCount) );
+    if ( percentCompleted != m_percentCompleted ) {
+        m_percentCompleted = percentCompleted;
+        mDebug() << "percentCompleted" << percentCompleted;
+        emit q->progress( percentCompleted );
+
+        const qreal seconds = qMax<qint64>( 1, m_timer.elapsed() ) / 1000.0;
+        emit q->tilesPerSecond( m_createdTilesCount / seconds );
+    }
+}
+
 class TileCreatorSourceImage : public TileCreatorSource
 {
 public:
@@ -161,7 +424,7 @@ private:
 TileCreator::TileCreator(const QString& sourceDir, const QString& installMap,
                          const QString& dem, const QString& targetDir)
     : QThread(0),
-      d( new TileCreatorPrivate( 0, dem, targetDir ) )
+      d( new TileCreatorPrivate( this, 0, dem, targetDir ) )
 
 {
     mDebug() << "Prefix: " << sourceDir
@@ -195,7 +458,7 @@ TileCreator::TileCreator(const QString& sourceDir, const QString& installMap,
 
 TileCreator::TileCreator( TileCreatorSource* source, const QString& dem, const QString& targetDir )
     : QThread(0),
-      d( new TileCreatorPrivate( source, dem, targetDir ) )
+      d( new TileCreatorPrivate( this, source, dem, targetDir ) )
 {
     setTerminationEnabled( true );
 }
@@ -222,11 +485,6 @@ void TileCreator::run()
 
     mDebug() << "Installing tiles to: " << d->m_targetDir;
 
-    QVector<QRgb> grayScalePalette;
-    for ( int cnt = 0; cnt <= 255; ++cnt ) {
-        grayScalePalette.insert(cnt, qRgb(cnt, cnt, cnt));
-    }
-
     QSize fullImageSize = d->m_source->fullImageSize();
     int  imageWidth  = fullImageSize.width();
     int  imageHeight = fullImageSize.height();
@@ -254,63 +512,53 @@ void TileCreator::run()
     }
     mDebug() << "Maximum Tile Level: " << maxTileLevel;
 
-
-    if ( !QDir( d->m_targetDir ).exists() )
-        ( QDir::root() ).mkpath( d->m_targetDir );
-
     // Counting total amount of tiles to be generated for the progressbar
-    // to prevent compiler warnings this var should
-    // match the type of maxTileLevel
-    int  tileLevel      = 0;
+    // and creating the directory structure of all levels
     int  totalTileCount = 0;
 
-    while ( tileLevel <= maxTileLevel ) {
-        totalTileCount += ( TileLoaderHelper::levelToRow( defaultLevelZeroRows, tileLevel )
-                            * TileLoaderHelper::levelToColumn( defaultLevelZeroColumns, tileLevel ) );
-        tileLevel++;
+    for ( int tileLevel = 0; tileLevel <= maxTileLevel; ++tileLevel ) {
+        const int nmaxit = TileLoaderHelper::levelToRow( defaultLevelZeroRows, tileLevel );
+        totalTileCount += nmaxit * TileLoaderHelper::levelToColumn( defaultLevelZeroColumns, tileLevel );
+
+        for ( int n = 0; n < nmaxit; ++n ) {
+            QString dirName( d->m_targetDir
+                             + QString("%1/%2").arg( tileLevel ).arg( n, tileDigits, 10, QChar('0') ) );
+            if ( !QDir( dirName ).exists() )
+                ( QDir::root() ).mkpath( dirName );
+        }
     }
 
     mDebug() << totalTileCount << " tiles to be created in total.";
+    mDebug() << "Using" << d->m_threadPool.maxThreadCount() << "threads for encoding.";
 
     int  mmax = TileLoaderHelper::levelToColumn( defaultLevelZeroColumns, maxTileLevel );
     int  nmax = TileLoaderHelper::levelToRow( defaultLevelZeroRows, maxTileLevel );
 
-    // Loading each row at highest spatial resolution and cropping tiles
-    int      percentCompleted = 0;
-    int      createdTilesCount = 0;
-    QString  tileName;
-
-    // Creating directory structure for the highest level
-    QString  dirName( d->m_targetDir
-                      + QString("%1").arg(maxTileLevel) );
-    if ( !QDir( dirName ).exists() ) 
-        ( QDir::root() ).mkpath( dirName );
-
-    for ( int n = 0; n < nmax; ++n ) {
-        QString dirName( d->m_targetDir
-                         + QString("%1/%2").arg(maxTileLevel).arg( n, tileDigits, 10, QChar('0') ) );
-        if ( !QDir( dirName ).exists() ) 
-            ( QDir::root() ).mkpath( dirName );
-    }
+    d->m_pendingTiles.clear();
+    d->m_createdTilesCount = 0;
+    d->m_totalTileCount = totalTileCount;
+    d->m_percentCompleted = -1;
+    d->m_failed.fetchAndStoreOrdered( 0 );
+    d->m_timer.start();
 
+    // Cropping the tiles of the highest level row by row from the source.
+    // Encoding happens in the thread pool while the next tiles are read.
+    // Each completed tile is handed down to build the lower levels.
     for ( int n = 0; n < nmax; ++n ) {
 
         for ( int m = 0; m < mmax; ++m ) {
 
-            mDebug() << "** tile" << m << "x" << n;
-
-            if ( d->m_cancelled ) 
+            if ( d->m_cancelled || d->m_failed.fetchAndAddOrdered( 0 ) ) {
+                d->m_threadPool.waitForDone();
                 return;
+            }
 
-            tileName = d->m_targetDir + ( QString("%1/%2/%2_%3.%4")
-                                       .arg( maxTileLevel )
-                                       .arg( n, tileDigits, 10, QChar('0') )
-                                       .arg( m, tileDigits, 10, QChar('0') ) )
-                                       .arg( d->m_tileFormat );
+            const QString tileName = d->tileName( maxTileLevel, n, m );
 
             if ( QFile::exists( tileName ) && d->m_resume ) {
 
                 //mDebug() << tileName << "exists already";
+                d->addChild( maxTileLevel, n, m, QImage() );
 
             } else {
 
@@ -318,264 +566,43 @@ void TileCreator::run()
 
                 if ( tile.isNull() ) {
                     mDebug() << "Read-Error! Null QImage!";
+                    d->m_threadPool.waitForDone();
                     return;
                 }
 
                 if ( d->m_dem == "true" ) {
                     tile = tile.convertToFormat(QImage::Format_Indexed8,
-                                                grayScalePalette,
+                                                d->m_grayScalePalette,
                                                 Qt::ThresholdDither);
                 }
 
-                bool  ok = tile.save( tileName, d->m_tileFormat.toLatin1().data(), d->m_tileFormat == "jpg" ? 100 : d->m_tileQuality );
-                if ( !ok )
-                    mDebug() << "Error while writing Tile: " << tileName;
-
-                mDebug() << tileName << "size" << QFile( tileName ).size();
-
-                if ( d->m_verify ) {
-                    QImage writtenTile(tileName);
-                    Q_ASSERT( writtenTile.size() == tile.size() );
-                    for ( int i=0; i < writtenTile.size().width(); ++i) {
-                        for ( int j=0; j < writtenTile.size().height(); ++j) {
-                            if ( writtenTile.pixel( i, j ) != tile.pixel( i, j ) ) {
-                                unsigned int  pixel = tile.pixel( i, j);
-                                unsigned int  writtenPixel = writtenTile.pixel( i, j);
-                                qWarning() << "***** pixel" << i << j << "is off by" << (pixel - writtenPixel) << "pixel" << pixel << "writtenPixel" << writtenPixel;
-                                QByteArray baPixel((char*)&pixel, sizeof(unsigned int));
-                                qWarning() << "pixel" << baPixel.size() << "0x" << baPixel.toHex();
-                                QByteArray baWrittenPixel((char*)&writtenPixel, sizeof(unsigned int));
-                                qWarning() << "writtenPixel" << baWrittenPixel.size() << "0x" << baWrittenPixel.toHex();
-                                Q_ASSERT(false);
-                            }
-                        }
-                    }
-                }
-
+                d->saveTile( tile, tileName );
+                d->addChild( maxTileLevel, n, m, tile );
             }
 
-            percentCompleted =  (int) ( 90 * (qreal)(createdTilesCount) 
-                                        / (qreal)(totalTileCount) );	
-            createdTilesCount++;
-
-            mDebug() << "percentCompleted" << percentCompleted;
-            emit progress( percentCompleted );
+            d->updateProgress();
         }
     }
 
-    mDebug() << "tileLevel: " << maxTileLevel << " successfully created.";
-
-    tileLevel = maxTileLevel;
-
-    // Now that we have the tiles at the highest resolution lets build
-    // them together four by four.
-
-    while( tileLevel > 0 ) {
-        tileLevel--;
-
-        int  nmaxit =  TileLoaderHelper::levelToRow( defaultLevelZeroRows, tileLevel );
-
-        for ( int n = 0; n < nmaxit; ++n ) {
-            QString  dirName( d->m_targetDir
-                              + ( QString("%1/%2")
-                                  .arg(tileLevel)
-                                  .arg( n, tileDigits, 10, QChar('0') ) ) );
-
-            // mDebug() << "dirName: " << dirName;
-            if ( !QDir( dirName ).exists() ) 
-                ( QDir::root() ).mkpath( dirName );
-
-            int   mmaxit = TileLoaderHelper::levelToColumn( defaultLevelZeroColumns, tileLevel );
-            for ( int m = 0; m < mmaxit; ++m ) {
+    d->m_threadPool.waitForDone();
 
-                if ( d->m_cancelled )
-                    return;
+    if ( d->m_failed.fetchAndAddOrdered( 0 ) ) {
+        mDebug() << "Tile write failure. Missing write permissions?";
+        emit progress( 100 );
+        return;
+    }
 
-                QString newTileName = d->m_targetDir + ( QString("%1/%2/%2_%3.%4")
-                                           .arg( tileLevel )
-                                           .arg( n, tileDigits, 10, QChar('0') )
-                                           .arg( m, tileDigits, 10, QChar('0') ) )
-                                           .arg( d->m_tileFormat );
-
-                if ( QFile::exists( newTileName ) && d->m_resume ) {
-                    //mDebug() << newTileName << "exists already";
-                } else {
-                    tileName = d->m_targetDir + ( QString("%1/%2/%2_%3.%4")
-                                            .arg( tileLevel + 1 )
-                                            .arg( 2*n, tileDigits, 10, QChar('0') )
-                                            .arg( 2*m, tileDigits, 10, QChar('0') ) )
-                                            .arg( d->m_tileFormat );
-                    QImage  img_topleft( tileName );
-
-                    tileName = d->m_targetDir + ( QString("%1/%2/%2_%3.%4")
-                                            .arg( tileLevel + 1 )
-                                            .arg( 2*n, tileDigits, 10, QChar('0') )
-                                            .arg( 2*m+1, tileDigits, 10, QChar('0') ) )
-                                            .arg( d->m_tileFormat );
-                    QImage  img_topright( tileName );
-
-                    tileName = d->m_targetDir + ( QString("%1/%2/%2_%3.%4")
-                                            .arg( tileLevel + 1 )
-                                            .arg( 2*n+1, tileDigits, 10, QChar('0') )
-                                            .arg( 2*m, tileDigits, 10, QChar('0') ) )
-                                            .arg( d->m_tileFormat );
-                    QImage  img_bottomleft( tileName );
-
-                    tileName = d->m_targetDir + ( QString("%1/%2/%2_%3.%4")
-                                            .arg( tileLevel + 1 )
-                                            .arg( 2*n+1, tileDigits, 10, QChar('0') )
-                                            .arg( 2*m+1, tileDigits, 10, QChar('0') ) )
-                                            .arg( d->m_tileFormat );
-                    QImage  img_bottomright( tileName );
-
-                    QSize const expectedSize( c_defaultTileSize, c_defaultTileSize );
-                    if ( img_topleft.size() != expectedSize ||
-                         img_topright.size() != expectedSize ||
-                         img_bottomleft.size() != expectedSize ||
-                         img_bottomright.size() != expectedSize ) {
-                        mDebug() << "Tile write failure. Missing write permissions?";
-                        emit progress( 100 );
-                        return;
-                    }
-                    QImage  tile = img_topleft;
-
-                    if ( d->m_dem == "true" ) {
-
-                        tile.setColorTable( grayScalePalette );
-                        uchar* destLine;
-
-                        for ( uint y = 0; y < c_defaultTileSize / 2; ++y ) {
-                            destLine = tile.scanLine( y );
-                            const uchar* srcLine = img_topleft.scanLine( 2 * y );
-                            for ( uint x = 0; x < c_defaultTileSize / 2; ++x )
-                                destLine[x] = srcLine[ 2*x ];
-                        }
-                        for ( uint y = 0; y < c_defaultTileSize / 2; ++y ) {
-                            destLine = tile.scanLine( y );
-                            const uchar* srcLine = img_topright.scanLine( 2 * y );
-                            for ( uint x = c_defaultTileSize / 2; x < c_defaultTileSize; ++x )
-                                destLine[x] = srcLine[ 2 * ( x - c_defaultTileSize / 2 ) ];
-                        }
-                        for ( uint y = c_defaultTileSize / 2; y < c_defaultTileSize; ++y ) {
-                            destLine = tile.scanLine( y );
-                            const uchar* srcLine = img_bottomleft.scanLine( 2 * ( y - c_defaultTileSize / 2 ) );
-                            for ( uint x = 0; x < c_defaultTileSize / 2; ++x )
-                                destLine[ x ] = srcLine[ 2 * x ];
-                        }
-                        for ( uint y = c_defaultTileSize / 2; y < c_defaultTileSize; ++y ) {
-                            destLine = tile.scanLine( y );
-                            const uchar* srcLine = img_bottomright.scanLine( 2 * ( y - c_defaultTileSize/2 ) );
-                            for ( uint x = c_defaultTileSize / 2; x < c_defaultTileSize; ++x )
-                                destLine[x] = srcLine[ 2 * ( x - c_defaultTileSize / 2 ) ];
-                        }
-                    }
-                    else {
-
-                        // tile.depth() != 8
-
-                        img_topleft = img_topleft.convertToFormat( QImage::Format_ARGB32 );
-                        img_topright = img_topright.convertToFormat( QImage::Format_ARGB32 );
-                        img_bottomleft = img_bottomleft.convertToFormat( QImage::Format_ARGB32 );
-                        img_bottomright = img_bottomright.convertToFormat( QImage::Format_ARGB32 );
-                        tile = img_topleft;
-
-                        QRgb* destLine;
-
-                        for ( uint y = 0; y < c_defaultTileSize / 2; ++y ) {
-                            destLine = (QRgb*) tile.scanLine( y );
-                            const QRgb* srcLine = (QRgb*) img_topleft.scanLine( 2 * y );
-                            for ( uint x = 0; x < c_defaultTileSize / 2; ++x )
-                                destLine[x] = srcLine[ 2 * x ];
-                        }
-                        for ( uint y = 0; y < c_defaultTileSize / 2; ++y ) {
-                            destLine = (QRgb*) tile.scanLine( y );
-                            const QRgb* srcLine = (QRgb*) img_topright.scanLine( 2 * y );
-                            for ( uint x = c_defaultTileSize / 2; x < c_defaultTileSize; ++x )
-                                destLine[x] = srcLine[ 2 * ( x - c_defaultTileSize / 2 ) ];
-                        }
-                        for ( uint y = c_defaultTileSize / 2; y < c_defaultTileSize; ++y ) {
-                            destLine = (QRgb*) tile.scanLine( y );
-                            const QRgb* srcLine = (QRgb*) img_bottomleft.scanLine( 2 * ( y-c_defaultTileSize/2 ) );
-                            for ( uint x = 0; x < c_defaultTileSize / 2; ++x )
-                                destLine[x] = srcLine[ 2 * x ];
-                        }
-                        for ( uint y = c_defaultTileSize / 2; y < c_defaultTileSize; ++y ) {
-                            destLine = (QRgb*) tile.scanLine( y );
-                            const QRgb* srcLine = (QRgb*) img_bottomright.scanLine( 2 * ( y-c_defaultTileSize / 2 ) );
-                            for ( uint x = c_defaultTileSize / 2; x < c_defaultTileSize; ++x )
-                                destLine[x] = srcLine[ 2*( x-c_defaultTileSize / 2 ) ];
-                        }
-                    }
-
-                    mDebug() << newTileName;
-
-                    // Saving at 100% JPEG quality to have a high-quality
-                    // version to create the remaining needed tiles from.
-                    bool  ok = tile.save( newTileName, d->m_tileFormat.toLatin1().data(), d->m_tileFormat == "jpg" ? 100 : d->m_tileQuality );
-                    if ( ! ok )
-                        mDebug() << "Error while writing Tile: " << newTileName;
-                }
+    Q_ASSERT( d->m_pendingTiles.isEmpty() );
 
-                percentCompleted =  (int) ( 90 * (qreal)(createdTilesCount)
-                                            / (qreal)(totalTileCount) );	
-                createdTilesCount++;
-						
-                emit progress( percentCompleted );
-                mDebug() << "percentCompleted" << percentCompleted;
-            }
-        }
-        mDebug() << "tileLevel: " << tileLevel << " successfully created.";
-    }
-    mDebug() << "Tile creation completed.";
-
-    if ( d->m_tileFormat == "jpg" && d->m_tileQuality != 100 ) {
-
-        // Applying correct lower JPEG compression now that we created all tiles
-        int savedTilesCount = 0;
-
-        tileLevel = 0;
-        while ( tileLevel <= maxTileLevel ) {
-            int nmaxit =  TileLoaderHelper::levelToRow( defaultLevelZeroRows, tileLevel );
-            for ( int n = 0; n < nmaxit; ++n) {
-                int mmaxit =  TileLoaderHelper::levelToColumn( defaultLevelZeroColumns, tileLevel );
-                for ( int m = 0; m < mmaxit; ++m) {
-
-                    if ( d->m_cancelled )
-                        return;
-
-                    savedTilesCount++;
-
-                    tileName = d->m_targetDir + ( QString("%1/%2/%2_%3.%4")
-                                            .arg( tileLevel )
-                                            .arg( n, tileDigits, 10, QChar('0') )
-                                            .arg( m, tileDigits, 10, QChar('0') ) )
-                                            .arg( d->m_tileFormat );
-                    QImage tile( tileName );
-
-                    bool ok;
-
-                    ok = tile.save( tileName, d->m_tileFormat.toLatin1().data(), d->m_tileQuality );
-
-                    if ( !ok )
-                        mDebug() << "Error while writing Tile: " << tileName;
-                    // Don't exceed 99% as this would cancel the thread unexpectedly
-                    percentCompleted = 90 + (int)( 9 * (qreal)(savedTilesCount)
-                                                / (qreal)(totalTileCount) );
-                    emit progress( percentCompleted );
-                    mDebug() << "percentCompleted" << percentCompleted;
-                    //mDebug() << "Saving Tile #" << savedTilesCount
-                    //         << " of " << totalTileCount
-                    //         << " Percent: " << percentCompleted;
-                }
-            }
-            tileLevel++;
-        }
-    }
+    const qreal seconds = qMax<qint64>( 1, d->m_timer.elapsed() ) / 1000.0;
+    const qreal rate = d->m_createdTilesCount / seconds;
+    mDebug() << "Tile creation completed:" << d->m_createdTilesCount << "tiles in"
+             << seconds << "seconds (" << rate << "tiles/sec)";
+    emit tilesPerSecond( rate );
 
-    percentCompleted = 100;
-    emit progress( percentCompleted );
+    emit progress( 100 );
 
-    mDebug() << "percentCompleted: " << percentCompleted;
+    mDebug() << "percentCompleted: " << 100;
 }
 
 void TileCreator::setTileFormat(const QString& format)
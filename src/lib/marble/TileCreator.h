@@ -87,9 +87,15 @@ class MARBLE_EXPORT TileCreator : public QThread
  Q_SIGNALS:
     void  progress( int value );
 
+    /**
+     * Reports the average number of tiles created per second so far
+     */
+    void  tilesPerSecond( qreal rate );
+
 
  private:
     Q_DISABLE_COPY( TileCreator )
+    friend class TileCreatorPrivate;
     TileCreatorPrivate  * const d;
 };
 
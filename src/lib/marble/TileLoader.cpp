@@ -32,6 +32,7 @@
 #include "HttpDownloadManager.h"
 #include "MarbleDebug.h"
 #include "MarbleDirs.h"
+#include "MarbleProfiler.h"
 #include "ParsingRunnerManager.h"
 #include "TileLoaderHelper.h"
 
@@ -55,6 +56,8 @@ TileLoader::TileLoader(HttpDownloadManager * const downloadManager, const Plugin
 //     - if expired: create TextureTile, state is set to Expired by default, trigger dl,
 QImage TileLoader::loadTileImage( GeoSceneTextureTile const *textureLayer, TileId const & tileId, DownloadUsage const usage )
 {
+    MARBLE_PROFILE_SCOPE( "TileLoader::loadTileImage" );
+
     QString const fileName = tileFileName( textureLayer, tileId );
 
     TileStatus status = tileStatus( textureLayer, tileId );
@@ -90,6 +93,8 @@ QImage TileLoader::loadTileImage( GeoSceneTextureTile const *textureLayer, TileI
 
 GeoDataDocument *TileLoader::loadTileVectorData( GeoSceneVectorTile const *textureLayer, TileId const & tileId, DownloadUsage const usage )
 {
+    MARBLE_PROFILE_SCOPE( "TileLoader::loadTileVectorData" );
+
     // FIXME: textureLayer->fileFormat() could be used in the future for use just that parser, instead of all available parsers
 
     QString const fileName = tileFileName( textureLayer, tileId );
@@ -21,6 +21,7 @@
 
 // Marble
 #include "GeoPainter.h"
+#include "MarbleProfiler.h"
 #include "ScanlineTextureMapperContext.h"
 #include "StackedTileLoader.h"
 #include "TextureColorizer.h"
@@ -85,6 +86,8 @@ void TileScalingTextureMapper::mapTexture( GeoPainter *painter,
 
 void TileScalingTextureMapper::mapTexture( GeoPainter *painter, const ViewportParams *viewport, int tileZoomLevel, TextureColorizer *texColorizer )
 {
+    MARBLE_PROFILE_SCOPE( "TileScalingTextureMapper::mapTexture" );
+
     const int imageHeight = viewport->height();
     const int imageWidth  = viewport->width();
     const qint64  radius  = viewport->radius();
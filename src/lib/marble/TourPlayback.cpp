@@ -16,7 +16,10 @@
 #include <qurl.h>
 #include <QtCore/qnamespace.h>
 
+#include <cmath>
+
 #include "MarbleDebug.h"
+#include "MarbleMap.h"
 #include "MarbleWidget.h"
 #include "PopupLayer.h"
 #include "GeoDataTour.h"
@@ -28,6 +31,8 @@
 #include "MarbleModel.h"
 #include "GeoDataTreeModel.h"
 #include "GeoDataTypes.h"
+#include "Planet.h"
+#include "ViewportParams.h"
 #include "PlaybackFlyToItem.h"
 #include "PlaybackAnimatedUpdateItem.h"
 #include "PlaybackWaitItem.h"
@@ -47,6 +52,10 @@ public:
     TourPlaybackPrivate();
     ~TourPlaybackPrivate();
 
+    GeoDataLookAt lookAt() const;
+
+    MarbleModel *model();
+
     GeoDataTour *m_tour;
     bool m_pause;
     SerialTrack m_mainTrack;
@@ -54,18 +63,49 @@ public:
     QList<AnimatedUpdateTrack*> m_animatedUpdateTracks;
     GeoDataFlyTo m_mapCenter;
     MarbleWidget *m_widget;
+    MarbleMap *m_map;
     QUrl m_baseUrl;
 };
 
+namespace
+{
+
+// Tangent of half the view angle MarbleWidget assumes, used to convert
+// between the range of a look at and the radius of the globe
+const qreal viewAngleTangent = tan( 0.5 * 110.0 * DEG2RAD );
+
+}
+
 TourPlaybackPrivate::TourPlaybackPrivate() :
     m_tour( 0 ),
     m_pause( false ),
     m_mainTrack(),
-    m_widget( 0 )
+    m_widget( 0 ),
+    m_map( 0 )
 {
     // do nothing
 }
 
+GeoDataLookAt TourPlaybackPrivate::lookAt() const
+{
+    if ( m_widget ) {
+        return m_widget->lookAt();
+    }
+
+    GeoDataLookAt result;
+    result.setLongitude( m_map->viewport()->centerLongitude() );
+    result.setLatitude( m_map->viewport()->centerLatitude() );
+    result.setAltitude( 0.0 );
+    const qreal distance = m_map->model()->planet()->radius() * 0.4 / m_map->radius() / viewAngleTangent;
+    result.setRange( distance * KM2METER );
+    return result;
+}
+
+MarbleModel *TourPlaybackPrivate::model()
+{
+    return m_widget ? m_widget->model() : m_map->model();
+}
+
 TourPlaybackPrivate::~TourPlaybackPrivate()
 {
     qDeleteAll(m_soundTracks);
@@ -102,6 +142,10 @@ void TourPlayback::stopTour()
 
 void TourPlayback::showBalloon( GeoDataPlacemark* placemark )
 {
+    if ( !d->m_widget ) {
+        return;
+    }
+
     GeoDataPoint* point = static_cast<GeoDataPoint*>( placemark->geometry() );
     d->m_widget->popupLayer()->setCoordinates( point->coordinates(), Qt::AlignRight | Qt::AlignVCenter );
     d->m_widget->popupLayer()->setContent( placemark->description(), d->m_baseUrl );
@@ -126,11 +170,24 @@ void TourPlayback::setMarbleWidget(MarbleWidget* widget)
     d->m_widget = widget;
 
     connect( this, SIGNAL(added(GeoDataContainer*,GeoDataFeature*,int)),
-                      d->m_widget->model()->treeModel(), SLOT(addFeature(GeoDataContainer*,GeoDataFeature*,int)) );
+                      d->model()->treeModel(), SLOT(addFeature(GeoDataContainer*,GeoDataFeature*,int)) );
     connect( this, SIGNAL(removed(const GeoDataFeature*)),
-                      d->m_widget->model()->treeModel(), SLOT(removeFeature(const GeoDataFeature*)) );
+                      d->model()->treeModel(), SLOT(removeFeature(const GeoDataFeature*)) );
     connect( this, SIGNAL(updated(GeoDataFeature*)),
-                      d->m_widget->model()->treeModel(), SLOT(updateFeature(GeoDataFeature*)) );
+                      d->model()->treeModel(), SLOT(updateFeature(GeoDataFeature*)) );
+}
+
+void TourPlayback::setMarbleMap( MarbleMap *map )
+{
+    d->m_widget = 0;
+    d->m_map = map;
+
+    connect( this, SIGNAL(added(GeoDataContainer*,GeoDataFeature*,int)),
+                      d->model()->treeModel(), SLOT(addFeature(GeoDataContainer*,GeoDataFeature*,int)) );
+    connect( this, SIGNAL(removed(const GeoDataFeature*)),
+                      d->model()->treeModel(), SLOT(removeFeature(const GeoDataFeature*)) );
+    connect( this, SIGNAL(updated(GeoDataFeature*)),
+                      d->model()->treeModel(), SLOT(updateFeature(GeoDataFeature*)) );
 }
 
 void TourPlayback::setBaseUrl( const QUrl &baseUrl )
@@ -150,6 +207,14 @@ void TourPlayback::centerOn( const GeoDataCoordinates &coordinates )
         lookat.setCoordinates( coordinates );
         lookat.setRange( coordinates.altitude() );
         d->m_widget->flyTo( lookat, Instant );
+    } else if ( d->m_map ) {
+        // Like MarbleWidget::flyTo(), the altitude is taken as range
+        if ( coordinates.altitude() > 0.0 ) {
+            const qreal distance = coordinates.altitude() * METER2KM;
+            d->m_map->setRadius( qRound( d->m_map->model()->planet()->radius() / ( distance * viewAngleTangent / 0.4 ) ) );
+        }
+        d->m_map->centerOn( coordinates.longitude( GeoDataCoordinates::Degree ),
+                            coordinates.latitude( GeoDataCoordinates::Degree ) );
     }
 }
 
@@ -167,7 +232,7 @@ void TourPlayback::setTour(GeoDataTour *tour)
 void TourPlayback::play()
 {
     d->m_pause = false;
-    GeoDataLookAt* lookat = new GeoDataLookAt( d->m_widget->lookAt() );
+    GeoDataLookAt* lookat = new GeoDataLookAt( d->lookAt() );
     lookat->setAltitude( lookat->range() );
     d->m_mapCenter.setView( lookat );
     d->m_mainTrack.play();
@@ -268,8 +333,8 @@ void TourPlayback::updateTracks()
             connect( track, SIGNAL(removed(const GeoDataFeature*)), this, SIGNAL(removed(const GeoDataFeature*)) );
         }
     }
-    Q_ASSERT( d->m_widget );
-    GeoDataLookAt* lookat = new GeoDataLookAt( d->m_widget->lookAt() );
+    Q_ASSERT( d->m_widget || d->m_map );
+    GeoDataLookAt* lookat = new GeoDataLookAt( d->lookAt() );
     lookat->setAltitude( lookat->range() );
     d->m_mapCenter.setView( lookat );
     PlaybackFlyToItem* mapCenterItem = new PlaybackFlyToItem( &d->m_mapCenter );
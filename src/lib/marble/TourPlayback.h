@@ -20,6 +20,7 @@ class QUrl;
 namespace Marble
 {
 
+class MarbleMap;
 class MarbleWidget;
 class GeoDataCoordinates;
 class GeoDataTour;
@@ -40,6 +41,13 @@ public:
     void setTour(GeoDataTour *tour);
     void setMarbleWidget( MarbleWidget *widget );
 
+    /**
+     * @brief Plays the tour on a map that is not shown in a widget
+     * The view of the map follows the tour, e.g. to render it offline
+     * frame by frame using seek(). Balloons are not shown.
+     */
+    void setMarbleMap( MarbleMap *map );
+
     /**
      * @brief setBaseUrl - sets base url for using in QWebView.
      */
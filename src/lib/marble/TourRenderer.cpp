@@ -0,0 +1,351 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2014 The Marble contributors
+//
+
+#include "TourRenderer.h"
+
+#include "MarbleDebug.h"
+#include "MarbleMap.h"
+#include "MarbleModel.h"
+#include "OffscreenRenderer.h"
+#include "TourPlayback.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QImage>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QProcess>
+#include <QQueue>
+#include <QThread>
+#include <QWaitCondition>
+
+#include <cmath>
+
+namespace Marble
+{
+
+namespace
+{
+
+QString findEncoder()
+{
+    QStringList const encoders = QStringList() << "avconv" << "ffmpeg";
+    foreach ( const QString &encoder, encoders ) {
+        QProcess process;
+        process.start( encoder, QStringList() << "-version" );
+        if ( process.waitForFinished() && !process.readAll().isEmpty() ) {
+            return encoder;
+        }
+    }
+    return QString();
+}
+
+}
+
+class TourRenderer::Private
+{
+public:
+    explicit Private( MarbleModel *model );
+
+    void setError( const QString &error );
+
+    QString frameFileName( int frame ) const;
+
+    MarbleMap m_map;
+    TourPlayback m_playback;
+    GeoDataTour *m_tour;
+    QSize m_size;
+    int m_fps;
+    QString m_outputFile;
+    int m_maximumWaitTime;
+
+    // Writes the images of a sequence and limits the number of frames waiting to be written
+    OffscreenRenderer m_offscreenRenderer;
+
+    mutable QMutex m_errorMutex;
+    QString m_errorString;
+
+    /**
+      * Feeds the frames of a movie to the encoder process in their order
+      */
+    class EncoderThread : public QThread
+    {
+    public:
+        EncoderThread( Private *renderer, const QString &encoder, const QStringList &arguments ) :
+            m_renderer( renderer ),
+            m_encoder( encoder ),
+            m_arguments( arguments ),
+            m_finished( false )
+        {
+        }
+
+        /** Queues a frame; blocks while the queue is full */
+        void enqueue( const QImage &image )
+        {
+            m_renderer->m_offscreenRenderer.acquirePendingImage();
+            QMutexLocker locker( &m_mutex );
+            m_frames.enqueue( image );
+            m_frameAvailable.wakeOne();
+        }
+
+        /** Lets the thread finish after the queued frames are written */
+        void finish()
+        {
+            QMutexLocker locker( &m_mutex );
+            m_finished = true;
+            m_frameAvailable.wakeOne();
+        }
+
+        virtual void run()
+        {
+            // The process is created here so that it belongs to this thread
+            QProcess process;
+            process.start( m_encoder, m_arguments );
+            if ( !process.waitForStarted() ) {
+                m_renderer->setError( QObject::tr( "Unable to start %1" ).arg( m_encoder ) );
+            }
+
+            while ( true ) {
+                QImage image;
+                {
+                    QMutexLocker locker( &m_mutex );
+                    while ( m_frames.isEmpty() && !m_finished ) {
+                        m_frameAvailable.wait( &m_mutex );
+                    }
+                    if ( m_frames.isEmpty() ) {
+                        break;
+                    }
+                    image = m_frames.dequeue();
+                }
+                m_renderer->m_offscreenRenderer.releasePendingImage();
+
+                if ( process.state() == QProcess::Running ) {
+                    write( process, image.convertToFormat( QImage::Format_RGB888 ) );
+                }
+            }
+
+            process.closeWriteChannel();
+            process.waitForFinished( -1 );
+            if ( process.exitStatus() != QProcess::NormalExit || process.exitCode() != 0 ) {
+                m_renderer->setError( QObject::tr( "%1 failed: %2" ).arg( m_encoder )
+                                      .arg( QString::fromLocal8Bit( process.readAllStandardError() ) ) );
+            }
+        }
+
+    private:
+        static void write( QProcess &process, const QImage &image )
+        {
+            // Scanlines are padded to 32 bit, the encoder expects them packed
+            const int lineLength = 3 * image.width();
+            if ( image.bytesPerLine() == lineLength ) {
+                process.write( reinterpret_cast<const char*>( image.constBits() ), image.byteCount() );
+            } else {
+                for ( int y = 0; y < image.height(); ++y ) {
+                    process.write( reinterpret_cast<const char*>( image.constScanLine( y ) ), lineLength );
+                }
+            }
+
+            while ( process.bytesToWrite() > 0 && process.waitForBytesWritten( -1 ) ) {
+                // Keeps the pipe to the encoder from growing without bound
+            }
+        }
+
+        Private *const m_renderer;
+        const QString m_encoder;
+        const QStringList m_arguments;
+        QMutex m_mutex;
+        QWaitCondition m_frameAvailable;
+        QQueue<QImage> m_frames;
+        bool m_finished;
+    };
+};
+
+TourRenderer::Private::Private( MarbleModel *model ) :
+    m_map( model ),
+    m_tour( 0 ),
+    m_size( 1280, 720 ),
+    m_fps( 30 ),
+    m_maximumWaitTime( 0 )
+{
+    m_map.setViewContext( Still );
+    m_map.setSize( m_size );
+    m_playback.setMarbleMap( &m_map );
+}
+
+void TourRenderer::Private::setError( const QString &error )
+{
+    mDebug() << error;
+    QMutexLocker locker( &m_errorMutex );
+    if ( m_errorString.isEmpty() ) {
+        m_errorString = error;
+    }
+}
+
+QString TourRenderer::Private::frameFileName( int frame ) const
+{
+    return m_outputFile.arg( frame, 6, 10, QChar( '0' ) );
+}
+
+TourRenderer::TourRenderer( MarbleModel *model, QObject *parent ) :
+    QObject( parent ),
+    d( new Private( model ) )
+{
+}
+
+TourRenderer::~TourRenderer()
+{
+    delete d;
+}
+
+MarbleMap *TourRenderer::map()
+{
+    return &d->m_map;
+}
+
+void TourRenderer::setTour( GeoDataTour *tour )
+{
+    d->m_tour = tour;
+}
+
+void TourRenderer::setSize( const QSize &size )
+{
+    d->m_size = size;
+    d->m_map.setSize( size );
+}
+
+QSize TourRenderer::size() const
+{
+    return d->m_size;
+}
+
+void TourRenderer::setFramesPerSecond( int fps )
+{
+    d->m_fps = qMax( 1, fps );
+}
+
+int TourRenderer::framesPerSecond() const
+{
+    return d->m_fps;
+}
+
+void TourRenderer::setOutputFile( const QString &fileName )
+{
+    d->m_outputFile = fileName;
+}
+
+QString TourRenderer::outputFile() const
+{
+    return d->m_outputFile;
+}
+
+void TourRenderer::setMaximumWaitTime( int msecs )
+{
+    d->m_maximumWaitTime = msecs;
+}
+
+void TourRenderer::setWriterThreadCount( int count )
+{
+    d->m_offscreenRenderer.setWriterThreadCount( count );
+}
+
+int TourRenderer::frameCount() const
+{
+    if ( !d->m_tour ) {
+        return 0;
+    }
+
+    TourPlayback playback;
+    playback.setMarbleMap( &d->m_map );
+    playback.setTour( d->m_tour );
+    return static_cast<int>( std::floor( playback.duration() * d->m_fps ) ) + 1;
+}
+
+bool TourRenderer::render()
+{
+    {
+        QMutexLocker locker( &d->m_errorMutex );
+        d->m_errorString.clear();
+    }
+    d->m_offscreenRenderer.clearWriteErrors();
+
+    if ( !d->m_tour || d->m_outputFile.isEmpty() ) {
+        d->setError( tr( "No tour or output file given" ) );
+        return false;
+    }
+
+    // The tour starts from the current view of the map
+    d->m_playback.setTour( d->m_tour );
+    const int frames = static_cast<int>( std::floor( d->m_playback.duration() * d->m_fps ) ) + 1;
+
+    const bool imageSequence = d->m_outputFile.contains( "%1" );
+    Private::EncoderThread *encoder = 0;
+    if ( imageSequence ) {
+        QDir().mkpath( QFileInfo( d->frameFileName( 0 ) ).absolutePath() );
+    } else {
+        const QString executable = findEncoder();
+        if ( executable.isEmpty() ) {
+            d->setError( tr( "Encoding movies requires avconv or ffmpeg" ) );
+            return false;
+        }
+
+        QStringList const arguments = QStringList()
+                << "-y"
+                << "-r" << QString::number( d->m_fps )
+                << "-f" << "rawvideo"
+                << "-pix_fmt" << "rgb24"
+                << "-s" << QString( "%1x%2" ).arg( d->m_size.width() ).arg( d->m_size.height() )
+                << "-i" << "pipe:"
+                << "-b" << "2000k"
+                << d->m_outputFile;
+        encoder = new Private::EncoderThread( d, executable, arguments );
+        encoder->start();
+    }
+
+    for ( int i = 0; i < frames; ++i ) {
+        // Fixed time steps make the movie independent of the rendering speed
+        d->m_playback.seek( qreal( i ) / d->m_fps );
+
+        QImage image( d->m_size, QImage::Format_ARGB32_Premultiplied );
+        OffscreenRenderer::paintComplete( &d->m_map, image, Qt::black, d->m_maximumWaitTime );
+
+        if ( encoder ) {
+            encoder->enqueue( image );
+        } else {
+            d->m_offscreenRenderer.write( image, d->frameFileName( i ) );
+        }
+
+        emit progress( i + 1, frames );
+    }
+
+    if ( encoder ) {
+        encoder->finish();
+        encoder->wait();
+        delete encoder;
+    }
+    d->m_offscreenRenderer.waitForDone();
+    d->m_playback.stop();
+
+    typedef QPair<QString, QString> WriteError;
+    foreach ( const WriteError &error, d->m_offscreenRenderer.writeErrors() ) {
+        d->setError( tr( "Unable to write %1: %2" ).arg( error.first ).arg( error.second ) );
+    }
+
+    return errorString().isEmpty();
+}
+
+QString TourRenderer::errorString() const
+{
+    QMutexLocker locker( &d->m_errorMutex );
+    return d->m_errorString;
+}
+
+}
+
+#include "TourRenderer.moc"
@@ -0,0 +1,123 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2014 The Marble contributors
+//
+
+#ifndef MARBLE_TOURRENDERER_H
+#define MARBLE_TOURRENDERER_H
+
+#include "marble_export.h"
+
+#include <QObject>
+#include <QSize>
+#include <QString>
+
+namespace Marble
+{
+
+class GeoDataTour;
+class MarbleMap;
+class MarbleModel;
+
+/**
+  * @short Renders a tour into a movie or an image sequence without a widget
+  *
+  * Unlike MovieCapture, which grabs the widget on a timer while the tour
+  * plays in real time, the tour is advanced by a fixed step of 1 / fps
+  * seconds for each frame. Every frame is painted completely, so the result
+  * does not depend on how fast the machine renders.
+  *
+  * Painting happens in the thread of the model, as the map and the model
+  * are not thread safe. Finished frames are handed over through a bounded
+  * queue: to a single encoder thread feeding avconv or ffmpeg in frame
+  * order, or to a pool of threads writing the images of a sequence. Both
+  * run in parallel to painting the next frames.
+  */
+class MARBLE_EXPORT TourRenderer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit TourRenderer( MarbleModel *model, QObject *parent = 0 );
+
+    ~TourRenderer();
+
+    /**
+     * @brief Returns the map used for painting, e.g. to set the map theme
+     * The current view of the map is where the tour starts.
+     */
+    MarbleMap *map();
+
+    void setTour( GeoDataTour *tour );
+
+    /**
+     * @brief Sets the size of the frames in pixels
+     */
+    void setSize( const QSize &size );
+
+    QSize size() const;
+
+    void setFramesPerSecond( int fps );
+
+    int framesPerSecond() const;
+
+    /**
+     * @brief Sets the file to write
+     *
+     * A file name containing "%1" is written as image sequence, with %1
+     * replaced by the zero padded frame number, e.g. "frames/tour-%1.png".
+     * Other file names are encoded as movie by avconv or ffmpeg, which pick
+     * the container format from the suffix.
+     */
+    void setOutputFile( const QString &fileName );
+
+    QString outputFile() const;
+
+    /**
+     * @brief Sets how long a frame may wait for missing tiles and documents
+     * The default of 0 paints each frame once with whatever is cached.
+     */
+    void setMaximumWaitTime( int msecs );
+
+    /**
+     * @brief Sets the number of threads writing the images of a sequence
+     */
+    void setWriterThreadCount( int count );
+
+    /**
+     * @brief Returns the number of frames the tour is rendered into
+     */
+    int frameCount() const;
+
+    /**
+     * @brief Renders all frames and returns when they are written
+     * @return whether all frames were written successfully
+     */
+    bool render();
+
+    /**
+     * @brief Returns the reason the last render() call failed
+     */
+    QString errorString() const;
+
+Q_SIGNALS:
+    /**
+     * Emitted after a frame was painted and handed over for writing
+     */
+    void progress( int frame, int frameCount );
+
+private:
+    Q_DISABLE_COPY( TourRenderer )
+
+    class Private;
+    Private *const d;
+};
+
+}
+
+#endif
@@ -127,9 +127,12 @@ void GeoDataBalloonStyle::unpack( QDataStream& stream )
 {
     GeoDataColorStyle::unpack( stream );
 
-    stream >> d->m_bgColor;
-    stream >> d->m_textColor;
+    QString bgColor, textColor;
+    stream >> bgColor;
+    stream >> textColor;
     stream >> d->m_text;
+    d->m_bgColor = QColor( bgColor );
+    d->m_textColor = QColor( textColor );
 }
 
 }
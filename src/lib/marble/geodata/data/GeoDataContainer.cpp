@@ -390,6 +390,7 @@ void GeoDataContainer::unpack( QDataStream& stream )
                 {
                 GeoDataFolder *folder = new GeoDataFolder;
                 folder->unpack( stream );
+                folder->setParent( this );
                 p()->m_vector.append( folder );
                 }
                 break;
@@ -397,6 +398,7 @@ void GeoDataContainer::unpack( QDataStream& stream )
                 {
                 GeoDataPlacemark *placemark = new GeoDataPlacemark;
                 placemark->unpack( stream );
+                placemark->setParent( this );
                 p()->m_vector.append( placemark );
                 }
                 break;
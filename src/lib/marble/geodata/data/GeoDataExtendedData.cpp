@@ -134,11 +134,29 @@ QList<GeoDataSchemaData> GeoDataExtendedData::schemaDataList() const
 void GeoDataExtendedData::pack( QDataStream& stream ) const
 {
     GeoDataObject::pack( stream );
+
+    stream << d->hash.size();
+    QHash<QString, GeoDataData>::const_iterator iter = d->hash.constBegin();
+    for ( ; iter != d->hash.constEnd(); ++iter ) {
+        stream << iter.key();
+        iter.value().pack( stream );
+    }
 }
 
 void GeoDataExtendedData::unpack( QDataStream& stream )
 {
     GeoDataObject::unpack( stream );
+
+    int size = 0;
+    stream >> size;
+    for ( int i = 0; i < size; ++i ) {
+        QString name;
+        stream >> name;
+        GeoDataData data;
+        data.unpack( stream );
+        data.setName( name );
+        d->hash.insert( name, data );
+    }
 }
 
 }
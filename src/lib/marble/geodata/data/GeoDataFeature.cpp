@@ -14,6 +14,9 @@
 #include "GeoDataFeature_p.h"
 
 #include <QDataStream>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSet>
 #include <QSize>
 #include <QPixmap>
 
@@ -38,6 +41,40 @@ QColor GeoDataFeaturePrivate::s_defaultLabelColor = QColor( Qt::black );
 bool GeoDataFeaturePrivate::s_defaultStyleInitialized = false;
 GeoDataStyle* GeoDataFeaturePrivate::s_defaultStyle[GeoDataFeature::LastIndex];
 QMap<QString, GeoDataFeature::GeoDataVisualCategory> GeoDataFeaturePrivate::s_visualCategories;
+const GeoDataFeatureExtra GeoDataFeaturePrivate::s_defaultExtra;
+
+namespace
+{
+
+class StringPool
+{
+public:
+    QMutex m_mutex;
+    QSet<QString> m_strings;
+};
+
+}
+
+Q_GLOBAL_STATIC( StringPool, stringPool )
+
+QString GeoDataFeaturePrivate::intern( const QString &string )
+{
+    if ( string.isEmpty() ) {
+        return string;
+    }
+
+    // Features are created by parsers running in several threads at once
+    StringPool *const pool = stringPool();
+    QMutexLocker locker( &pool->m_mutex );
+    QSet<QString>::const_iterator it = pool->m_strings.constFind( string );
+    if ( it != pool->m_strings.constEnd() ) {
+        return *it;
+    }
+    pool->m_strings.insert( string );
+    return string;
+}
+
+const QString GeoDataFeaturePrivate::s_defaultRole = GeoDataFeaturePrivate::intern( " " );
 
 GeoDataFeature::GeoDataFeature()
     : d( new GeoDataFeaturePrivate() )
@@ -91,58 +128,61 @@ GeoDataFeature& GeoDataFeature::operator=( const GeoDataFeature& other )
 
 bool GeoDataFeature::equals( const GeoDataFeature &other ) const
 {
+    const GeoDataFeatureExtra &extra = p()->extra();
+    const GeoDataFeatureExtra &otherExtra = other.p()->extra();
+
     if ( !GeoDataObject::equals(other) ||
          p()->m_name != other.p()->m_name ||
-         p()->m_snippet != other.p()->m_snippet ||
-         p()->m_description != other.p()->m_description ||
-         p()->m_descriptionCDATA != other.p()->m_descriptionCDATA ||
-         p()->m_address != other.p()->m_address ||
-         p()->m_phoneNumber != other.p()->m_phoneNumber ||
+         extra.m_snippet != otherExtra.m_snippet ||
+         extra.m_description != otherExtra.m_description ||
+         extra.m_descriptionCDATA != otherExtra.m_descriptionCDATA ||
+         extra.m_address != otherExtra.m_address ||
+         extra.m_phoneNumber != otherExtra.m_phoneNumber ||
          p()->m_styleUrl != other.p()->m_styleUrl ||
          p()->m_popularity != other.p()->m_popularity ||
          p()->m_zoomLevel != other.p()->m_zoomLevel ||
          p()->m_visible != other.p()->m_visible ||
          p()->m_role != other.p()->m_role ||
-         p()->m_extendedData != other.p()->m_extendedData ||
-         p()->m_timeSpan != other.p()->m_timeSpan ||
-         p()->m_timeStamp != other.p()->m_timeStamp ||
-         p()->m_region != other.p()->m_region ||
+         extra.m_extendedData != otherExtra.m_extendedData ||
+         extra.m_timeSpan != otherExtra.m_timeSpan ||
+         extra.m_timeStamp != otherExtra.m_timeStamp ||
+         extra.m_region != otherExtra.m_region ||
          *style() != *other.style() ) {
         return false;
     }
 
-    if ( (!p()->m_styleMap && other.p()->m_styleMap) ||
-         (p()->m_styleMap && !other.p()->m_styleMap) ) {
+    if ( (!extra.m_styleMap && otherExtra.m_styleMap) ||
+         (extra.m_styleMap && !otherExtra.m_styleMap) ) {
         return false;
     }
 
-    if ( (p()->m_styleMap && other.p()->m_styleMap) &&
-         (*p()->m_styleMap != *other.p()->m_styleMap) ) {
+    if ( (extra.m_styleMap && otherExtra.m_styleMap) &&
+         (*extra.m_styleMap != *otherExtra.m_styleMap) ) {
         return false;
     }
 
-    if ( !p()->m_abstractView && !other.p()->m_abstractView ) {
+    if ( !extra.m_abstractView && !otherExtra.m_abstractView ) {
         return true;
-    } else if ( (!p()->m_abstractView && other.p()->m_abstractView) ||
-                (p()->m_abstractView && !other.p()->m_abstractView) ) {
+    } else if ( (!extra.m_abstractView && otherExtra.m_abstractView) ||
+                (extra.m_abstractView && !otherExtra.m_abstractView) ) {
         return false;
     }
 
-    if ( p()->m_abstractView->nodeType() != other.p()->m_abstractView->nodeType() ) {
+    if ( extra.m_abstractView->nodeType() != otherExtra.m_abstractView->nodeType() ) {
         return false;
     }
 
-    if ( p()->m_abstractView->nodeType() == GeoDataTypes::GeoDataCameraType ) {
-        GeoDataCamera *thisCam = dynamic_cast<GeoDataCamera*>( p()->m_abstractView );
-        GeoDataCamera *otherCam = dynamic_cast<GeoDataCamera*>( other.p()->m_abstractView );
+    if ( extra.m_abstractView->nodeType() == GeoDataTypes::GeoDataCameraType ) {
+        GeoDataCamera *thisCam = dynamic_cast<GeoDataCamera*>( extra.m_abstractView );
+        GeoDataCamera *otherCam = dynamic_cast<GeoDataCamera*>( otherExtra.m_abstractView );
         Q_ASSERT(thisCam && otherCam);
 
         if ( *thisCam != *otherCam ) {
             return false;
         }
-    } else if ( p()->m_abstractView->nodeType() == GeoDataTypes::GeoDataLookAtType ) {
-        GeoDataLookAt *thisLookAt = dynamic_cast<GeoDataLookAt*>( p()->m_abstractView );
-        GeoDataLookAt *otherLookAt = dynamic_cast<GeoDataLookAt*>( other.p()->m_abstractView );
+    } else if ( extra.m_abstractView->nodeType() == GeoDataTypes::GeoDataLookAtType ) {
+        GeoDataLookAt *thisLookAt = dynamic_cast<GeoDataLookAt*>( extra.m_abstractView );
+        GeoDataLookAt *otherLookAt = dynamic_cast<GeoDataLookAt*>( otherExtra.m_abstractView );
         Q_ASSERT(thisLookAt && otherLookAt);
 
         if ( *thisLookAt != *otherLookAt ) {
@@ -554,62 +594,62 @@ void GeoDataFeature::setName( const QString &value )
 
 GeoDataSnippet GeoDataFeature::snippet() const
 {
-    return d->m_snippet;
+    return d->extra().m_snippet;
 }
 
 void GeoDataFeature::setSnippet( const GeoDataSnippet &snippet )
 {
     detach();
-    d->m_snippet = snippet;
+    d->editableExtra().m_snippet = snippet;
 }
 
 QString GeoDataFeature::address() const
 {
-    return d->m_address;
+    return d->extra().m_address;
 }
 
 void GeoDataFeature::setAddress( const QString &value)
 {
     detach();
-    d->m_address = value;
+    d->editableExtra().m_address = value;
 }
 
 QString GeoDataFeature::phoneNumber() const
 {
-    return d->m_phoneNumber;
+    return d->extra().m_phoneNumber;
 }
 
 void GeoDataFeature::setPhoneNumber( const QString &value)
 {
     detach();
-    d->m_phoneNumber = value;
+    d->editableExtra().m_phoneNumber = value;
 }
 
 QString GeoDataFeature::description() const
 {
-    return d->m_description;
+    return d->extra().m_description;
 }
 
 void GeoDataFeature::setDescription( const QString &value)
 {
     detach();
-    d->m_description = value;
+    d->editableExtra().m_description = value;
 }
 
 bool GeoDataFeature::descriptionIsCDATA() const
 {
-    return d->m_descriptionCDATA;
+    return d->extra().m_descriptionCDATA;
 }
 
 void GeoDataFeature::setDescriptionCDATA( bool cdata )
 {
     detach();
-    d->m_descriptionCDATA = cdata;
+    d->editableExtra().m_descriptionCDATA = cdata;
 }
 
 const GeoDataAbstractView* GeoDataFeature::abstractView() const
 {
-    return d->m_abstractView;
+    return d->extra().m_abstractView;
 }
 
 GeoDataAbstractView *GeoDataFeature::abstractView()
@@ -617,13 +657,13 @@ GeoDataAbstractView *GeoDataFeature::abstractView()
     // FIXME: Calling detach() doesn't help at all because the m_abstractView
     // object isn't actually copied in the Private class as well.
     // detach();
-    return d->m_abstractView;
+    return d->extra().m_abstractView;
 }
 
 void GeoDataFeature::setAbstractView( GeoDataAbstractView *abstractView )
 {
     detach();
-    d->m_abstractView = abstractView;
+    d->editableExtra().m_abstractView = abstractView;
 }
 
 QString GeoDataFeature::styleUrl() const
@@ -634,7 +674,7 @@ QString GeoDataFeature::styleUrl() const
 void GeoDataFeature::setStyleUrl( const QString &value)
 {
     detach();
-    d->m_styleUrl = value;
+    d->m_styleUrl = GeoDataFeaturePrivate::intern( value );
     QString styleUrl = value;
     styleUrl.remove('#');
     GeoDataObject *object = parent();
@@ -679,36 +719,36 @@ bool GeoDataFeature::isGloballyVisible() const
 
 const GeoDataTimeSpan &GeoDataFeature::timeSpan() const
 {
-    return d->m_timeSpan;
+    return d->extra().m_timeSpan;
 }
 
 GeoDataTimeSpan &GeoDataFeature::timeSpan()
 {
     detach();
-    return d->m_timeSpan;
+    return d->editableExtra().m_timeSpan;
 }
 
 void GeoDataFeature::setTimeSpan( const GeoDataTimeSpan &timeSpan )
 {
     detach();
-    d->m_timeSpan = timeSpan;
+    d->editableExtra().m_timeSpan = timeSpan;
 }
 
 const GeoDataTimeStamp &GeoDataFeature::timeStamp() const
 {
-    return d->m_timeStamp;
+    return d->extra().m_timeStamp;
 }
 
 GeoDataTimeStamp &GeoDataFeature::timeStamp()
 {
     detach();
-    return d->m_timeStamp;
+    return d->editableExtra().m_timeStamp;
 }
 
 void GeoDataFeature::setTimeStamp( const GeoDataTimeStamp &timeStamp )
 {
     detach();
-    d->m_timeStamp = timeStamp;
+    d->editableExtra().m_timeStamp = timeStamp;
 }
 
 const GeoDataStyle* GeoDataFeature::style() const
@@ -748,25 +788,30 @@ void GeoDataFeature::setStyle( GeoDataStyle* style )
 GeoDataExtendedData& GeoDataFeature::extendedData() const
 {
     // FIXME: Should call detach(). Maybe don't return reference.
-    return d->m_extendedData;
+    return d->editableExtra().m_extendedData;
+}
+
+bool GeoDataFeature::hasExtendedData() const
+{
+    return !d->extra().m_extendedData.isEmpty();
 }
 
 void GeoDataFeature::setExtendedData( const GeoDataExtendedData& extendedData )
 {
     detach();
-    d->m_extendedData = extendedData;
+    d->editableExtra().m_extendedData = extendedData;
 }
 
 GeoDataRegion& GeoDataFeature::region() const
 {
     // FIXME: Should call detach(). Maybe don't return reference.
-    return d->m_region;
+    return d->editableExtra().m_region;
 }
 
 void GeoDataFeature::setRegion( const GeoDataRegion& region )
 {
     detach();
-    d->m_region = region;
+    d->editableExtra().m_region = region;
 }
 
 GeoDataFeature::GeoDataVisualCategory GeoDataFeature::visualCategory() const
@@ -788,17 +833,17 @@ const QString GeoDataFeature::role() const
 void GeoDataFeature::setRole( const QString &role )
 {
     detach();
-    d->m_role = role;
+    d->m_role = GeoDataFeaturePrivate::intern( role );
 }
 
 const GeoDataStyleMap* GeoDataFeature::styleMap() const
 {
-    return d->m_styleMap;
+    return d->extra().m_styleMap;
 }
 
 void GeoDataFeature::setStyleMap( const GeoDataStyleMap* styleMap )
 {
-    d->m_styleMap = styleMap;
+    d->editableExtra().m_styleMap = styleMap;
 }
 
 int GeoDataFeature::zoomLevel() const
@@ -853,14 +898,29 @@ void GeoDataFeature::pack( QDataStream& stream ) const
     GeoDataObject::pack( stream );
 
     stream << d->m_name;
-    stream << d->m_address;
-    stream << d->m_phoneNumber;
-    stream << d->m_description;
+    stream << d->extra().m_address;
+    stream << d->extra().m_phoneNumber;
+    stream << d->extra().m_description;
     stream << d->m_visible;
 //    stream << d->m_visualCategory;
     stream << d->m_role;
     stream << d->m_popularity;
     stream << d->m_zoomLevel;
+    stream << d->m_styleUrl;
+    stream << (int)d->m_visualCategory;
+
+    // Styles referenced by the style url are restored from the document
+    const bool hasInlineStyle = d->m_style && d->m_styleUrl.isEmpty();
+    stream << hasInlineStyle;
+    if ( hasInlineStyle ) {
+        d->m_style->pack( stream );
+    }
+
+    const bool hasExtendedData = !d->extra().m_extendedData.isEmpty();
+    stream << hasExtendedData;
+    if ( hasExtendedData ) {
+        d->extra().m_extendedData.pack( stream );
+    }
 }
 
 void GeoDataFeature::unpack( QDataStream& stream )
@@ -868,15 +928,48 @@ void GeoDataFeature::unpack( QDataStream& stream )
     detach();
     GeoDataObject::unpack( stream );
 
+    QString address;
+    QString phoneNumber;
+    QString description;
+    QString role;
+
     stream >> d->m_name;
-    stream >> d->m_address;
-    stream >> d->m_phoneNumber;
-    stream >> d->m_description;
+    stream >> address;
+    stream >> phoneNumber;
+    stream >> description;
     stream >> d->m_visible;
 //    stream >> (int)d->m_visualCategory;
-    stream >> d->m_role;
+    stream >> role;
     stream >> d->m_popularity;
     stream >> d->m_zoomLevel;
+
+    QString styleUrl;
+    int visualCategory;
+    stream >> styleUrl;
+    stream >> visualCategory;
+    d->m_styleUrl = GeoDataFeaturePrivate::intern( styleUrl );
+    d->m_visualCategory = (GeoDataVisualCategory)visualCategory;
+
+    bool hasInlineStyle;
+    stream >> hasInlineStyle;
+    if ( hasInlineStyle ) {
+        GeoDataStyle *style = new GeoDataStyle;
+        style->unpack( stream );
+        setStyle( style );
+    }
+
+    bool hasExtendedData;
+    stream >> hasExtendedData;
+    if ( hasExtendedData ) {
+        d->editableExtra().m_extendedData.unpack( stream );
+    }
+
+    if ( !address.isEmpty() || !phoneNumber.isEmpty() || !description.isEmpty() ) {
+        d->editableExtra().m_address = address;
+        d->editableExtra().m_phoneNumber = phoneNumber;
+        d->editableExtra().m_description = description;
+    }
+    d->m_role = GeoDataFeaturePrivate::intern( role );
 }
 
 GeoDataFeature::GeoDataVisualCategory GeoDataFeature::OsmVisualCategory(const QString &keyValue )
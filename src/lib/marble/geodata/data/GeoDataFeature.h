@@ -403,6 +403,12 @@ class GEODATA_EXPORT GeoDataFeature : public GeoDataObject
      */
     GeoDataExtendedData& extendedData() const;
 
+    /**
+     * Return whether the feature has non-empty ExtendedData. Unlike
+     * extendedData() this does not allocate storage for it.
+     */
+    bool hasExtendedData() const;
+
     /**
      * Sets the ExtendedData of the feature.
      * @param  extendedData  the new ExtendedData to be used.
@@ -28,53 +28,74 @@
 namespace Marble
 {
 
-class GeoDataFeaturePrivate
+/**
+ * Members of a feature that most features leave at their default values.
+ * They live in a separate block that is only allocated when one of them
+ * is written to, which keeps plain placemarks (name, coordinate, category)
+ * small.
+ */
+class GeoDataFeatureExtra
 {
   public:
-    GeoDataFeaturePrivate() :
-        m_name(),
+    GeoDataFeatureExtra() :
         m_snippet(),
         m_description(),
         m_descriptionCDATA(),
         m_address(),
         m_phoneNumber(),
-        m_styleUrl(),
         m_abstractView( 0 ),
+        m_styleMap( 0 ),
+        m_extendedData(),
+        m_timeSpan(),
+        m_timeStamp(),
+        m_region()
+    {
+    }
+
+    GeoDataSnippet      m_snippet;      // Snippet of the feature.
+    QString             m_description;  // A longer textual description
+    bool                m_descriptionCDATA; // True if description should be considered CDATA
+    QString             m_address;      // The address.  Optional
+    QString             m_phoneNumber;  // Phone         Optional
+    GeoDataAbstractView* m_abstractView; // AbstractView  Optional
+
+    const GeoDataStyleMap* m_styleMap;
+
+    GeoDataExtendedData m_extendedData;
+
+    GeoDataTimeSpan  m_timeSpan;
+    GeoDataTimeStamp m_timeStamp;
+
+    GeoDataRegion m_region;
+};
+
+class GeoDataFeaturePrivate
+{
+  public:
+    GeoDataFeaturePrivate() :
+        m_name(),
+        m_styleUrl(),
         m_popularity( 0 ),
         m_zoomLevel( 1 ),
         m_visible( true ),
         m_visualCategory( GeoDataFeature::Default ),
-        m_role(" "),
+        m_role( s_defaultRole ),
         m_style( 0 ),
-        m_styleMap( 0 ),
-        m_extendedData(),
-        m_timeSpan(),
-        m_timeStamp(),
-        m_region(),
+        m_extra( 0 ),
         ref( 0 )
     {
     }
 
     GeoDataFeaturePrivate( const GeoDataFeaturePrivate& other ) :
         m_name( other.m_name ),
-        m_snippet( other.m_snippet ),
-        m_description( other.m_description ),
-        m_descriptionCDATA( other.m_descriptionCDATA),
-        m_address( other.m_address ),
-        m_phoneNumber( other.m_phoneNumber ),
         m_styleUrl( other.m_styleUrl ),
-        m_abstractView( other.m_abstractView ),
         m_popularity( other.m_popularity ),
         m_zoomLevel( other.m_zoomLevel ),
         m_visible( other.m_visible ),
         m_visualCategory( other.m_visualCategory ),
         m_role( other.m_role ),
         m_style( other.m_style ),               //FIXME: both style and stylemap need to be reworked internally!!!!
-        m_styleMap( other.m_styleMap ),
-        m_extendedData( other.m_extendedData ),
-        m_timeSpan( other.m_timeSpan ),
-        m_timeStamp( other.m_timeStamp ),
-        m_region( other.m_region ),
+        m_extra( other.m_extra ? new GeoDataFeatureExtra( *other.m_extra ) : 0 ),
         ref( 0 )
     {
     }
@@ -82,27 +103,49 @@ class GeoDataFeaturePrivate
     GeoDataFeaturePrivate& operator=( const GeoDataFeaturePrivate& other )
     {
         m_name = other.m_name;
-        m_snippet = other.m_snippet;
-        m_description = other.m_description;
-        m_descriptionCDATA = other.m_descriptionCDATA;
-        m_address = other.m_address;
-        m_phoneNumber = other.m_phoneNumber;
         m_styleUrl = other.m_styleUrl;
-        m_abstractView = other.m_abstractView;
         m_popularity = other.m_popularity;
         m_zoomLevel = other.m_zoomLevel;
         m_visible = other.m_visible;
         m_role = other.m_role;
         m_style = other.m_style;
-        m_styleMap = other.m_styleMap;
-        m_timeSpan = other.m_timeSpan;
-        m_timeStamp = other.m_timeStamp;
         m_visualCategory = other.m_visualCategory;
-        m_extendedData = other.m_extendedData;
-        m_region = other.m_region;
+        if ( other.m_extra ) {
+            editableExtra() = *other.m_extra;
+        } else {
+            delete m_extra;
+            m_extra = 0;
+        }
         return *this;
     }
-    
+
+    /**
+     * Returns the rarely used members, or shared default values if they
+     * were never set.
+     */
+    const GeoDataFeatureExtra& extra() const
+    {
+        return m_extra ? *m_extra : s_defaultExtra;
+    }
+
+    /**
+     * Returns the rarely used members, allocating them on first use.
+     */
+    GeoDataFeatureExtra& editableExtra()
+    {
+        if ( !m_extra ) {
+            m_extra = new GeoDataFeatureExtra;
+        }
+        return *m_extra;
+    }
+
+    /**
+     * Returns a string equal to @p string that shares its data with all
+     * other interned copies. Used for values that repeat across many
+     * features, such as roles and style urls. The pool is never pruned.
+     */
+    static QString intern( const QString &string );
+
     virtual GeoDataFeaturePrivate* copy()
     { 
         GeoDataFeaturePrivate* copy = new GeoDataFeaturePrivate;
@@ -117,6 +160,7 @@ class GeoDataFeaturePrivate
 
     virtual ~GeoDataFeaturePrivate()
     {
+        delete m_extra;
     }
 
     virtual const char* nodeType() const
@@ -182,13 +226,7 @@ class GeoDataFeaturePrivate
     }
 
     QString             m_name;         // Name of the feature. Is shown on screen
-    GeoDataSnippet      m_snippet;      // Snippet of the feature.
-    QString             m_description;  // A longer textual description
-    bool                m_descriptionCDATA; // True if description should be considered CDATA
-    QString             m_address;      // The address.  Optional
-    QString             m_phoneNumber;  // Phone         Optional
     QString             m_styleUrl;     // styleUrl     Url#tag to a document wide style
-    GeoDataAbstractView* m_abstractView; // AbstractView  Optional
     qint64              m_popularity;   // Population/Area/Altitude depending on placemark(!)
     int                 m_zoomLevel;    // Zoom Level of the feature
 
@@ -199,15 +237,9 @@ class GeoDataFeaturePrivate
     QString       m_role;
 
     const GeoDataStyle* m_style;
-    const GeoDataStyleMap* m_styleMap;
 
-    GeoDataExtendedData m_extendedData;
-
-    GeoDataTimeSpan  m_timeSpan;
-    GeoDataTimeStamp m_timeStamp;
+    GeoDataFeatureExtra* m_extra;
 
-    GeoDataRegion m_region;
-    
     QAtomicInt  ref;
 
     // Static members
@@ -218,6 +250,9 @@ class GeoDataFeaturePrivate
     static bool          s_defaultStyleInitialized;
 
     static QMap<QString, GeoDataFeature::GeoDataVisualCategory> s_visualCategories;
+
+    static const GeoDataFeatureExtra s_defaultExtra;
+    static const QString s_defaultRole;
 };
 
 } // namespace Marble
@@ -197,7 +197,9 @@ void GeoDataIconStyle::pack( QDataStream& stream ) const
     GeoDataColorStyle::pack( stream );
 
     stream << d->m_scale;
-    stream << d->m_icon;
+    stream << d->m_iconPath;
+    // icons without a path have been set directly and need to be stored
+    stream << ( d->m_iconPath.isEmpty() ? d->m_icon : QImage() );
     d->m_hotSpot.pack( stream );
 }
 
@@ -206,6 +208,7 @@ void GeoDataIconStyle::unpack( QDataStream& stream )
     GeoDataColorStyle::unpack( stream );
 
     stream >> d->m_scale;
+    stream >> d->m_iconPath;
     stream >> d->m_icon;
     d->m_hotSpot.unpack( stream );
 }
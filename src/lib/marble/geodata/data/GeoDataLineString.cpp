@@ -665,9 +665,7 @@ void GeoDataLineString::pack( QDataStream& stream ) const
           = p()->m_vector.constBegin();
          iterator != p()->m_vector.constEnd();
          ++iterator ) {
-        mDebug() << "innerRing: size" << p()->m_vector.size();
-        GeoDataCoordinates coord = ( *iterator );
-        coord.pack( stream );
+        iterator->pack( stream );
     }
 
 }
@@ -684,6 +682,7 @@ void GeoDataLineString::unpack( QDataStream& stream )
 
     p()->m_tessellationFlags = (TessellationFlags)(tessellationFlags);
 
+    p()->m_vector.reserve( p()->m_vector.size() + size );
     for(qint32 i = 0; i < size; i++ ) {
         GeoDataCoordinates coord;
         coord.unpack( stream );
@@ -246,6 +246,7 @@ void GeoDataMultiGeometry::unpack( QDataStream& stream )
                 {
                 GeoDataPoint *point = new GeoDataPoint;
                 point->unpack( stream );
+                point->setParent( this );
                 p()->m_vector.append( point );
                 }
                 break;
@@ -253,6 +254,7 @@ void GeoDataMultiGeometry::unpack( QDataStream& stream )
                 {
                 GeoDataLineString *lineString = new GeoDataLineString;
                 lineString->unpack( stream );
+                lineString->setParent( this );
                 p()->m_vector.append( lineString );
                 }
                 break;
@@ -260,6 +262,7 @@ void GeoDataMultiGeometry::unpack( QDataStream& stream )
                 {
                 GeoDataLinearRing *linearRing = new GeoDataLinearRing;
                 linearRing->unpack( stream );
+                linearRing->setParent( this );
                 p()->m_vector.append( linearRing );
                 }
                 break;
@@ -267,6 +270,7 @@ void GeoDataMultiGeometry::unpack( QDataStream& stream )
                 {
                 GeoDataPolygon *polygon = new GeoDataPolygon;
                 polygon->unpack( stream );
+                polygon->setParent( this );
                 p()->m_vector.append( polygon );
                 }
                 break;
@@ -274,6 +278,7 @@ void GeoDataMultiGeometry::unpack( QDataStream& stream )
                 {
                 GeoDataMultiGeometry *multiGeometry = new GeoDataMultiGeometry;
                 multiGeometry->unpack( stream );
+                multiGeometry->setParent( this );
                 p()->m_vector.append( multiGeometry );
                 }
                 break;
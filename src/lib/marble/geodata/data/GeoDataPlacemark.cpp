@@ -399,6 +399,7 @@ void GeoDataPlacemark::unpack( QDataStream& stream )
             break;
         default: break;
     };
+    p()->m_geometry->setParent( this );
 }
 
 }
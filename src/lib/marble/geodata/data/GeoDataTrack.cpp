@@ -18,17 +18,39 @@
 
 #include "GeoDataLineString.h"
 
-#include <QMap>
-#include <QLinkedList>
+#include <QVector>
+#include <QtAlgorithms>
 #include "GeoDataExtendedData.h"
 
 namespace Marble {
 
+namespace
+{
+
+/** Orders sample indices by time, keeping the insertion order of equal times */
+class TimeOrder
+{
+public:
+    explicit TimeOrder( const QVector<qint64> &msecs ) : m_msecs( msecs ) {}
+
+    bool operator()( int a, int b ) const
+    {
+        return m_msecs.at( a ) < m_msecs.at( b );
+    }
+
+private:
+    const QVector<qint64> &m_msecs;
+};
+
+}
+
 class GeoDataTrackPrivate : public GeoDataGeometryPrivate
 {
 public:
     GeoDataTrackPrivate()
         : m_lineStringNeedsUpdate( false ),
+          m_sorted( true ),
+          m_timeIndexNeedsUpdate( false ),
           m_interpolate( false )
     {
     }
@@ -41,17 +63,151 @@ public:
 
     void equalizeWhenSize()
     {
-        while ( m_when.size() < m_coordinates.size() ) {
+        while ( m_when.size() < m_lon.size() ) {
             //fill coordinates without time information with null QDateTime
-            m_when.append( QDateTime() );
+            appendWhen( QDateTime() );
+        }
+    }
+
+    void appendWhen( const QDateTime &when )
+    {
+        const qint64 msecs = when.isValid() ? when.toMSecsSinceEpoch() : 0;
+        if ( !when.isValid() || ( !m_whenMsecs.isEmpty() && msecs < m_whenMsecs.last() ) ) {
+            m_sorted = false;
+        }
+        m_when.append( when );
+        m_whenMsecs.append( msecs );
+        m_timeIndexNeedsUpdate = true;
+    }
+
+    GeoDataCoordinates coordinates( int index ) const
+    {
+        return GeoDataCoordinates( m_lon.at( index ), m_lat.at( index ), m_alt.at( index ) );
+    }
+
+    /** Rechecks whether all timestamps are valid and in chronological order */
+    void updateSorted()
+    {
+        m_sorted = true;
+        for ( int i = 0; i < m_when.size() && m_sorted; ++i ) {
+            m_sorted = m_when.at( i ).isValid() && ( i == 0 || m_whenMsecs.at( i - 1 ) <= m_whenMsecs.at( i ) );
+        }
+        m_timeIndexNeedsUpdate = true;
+    }
+
+    /**
+     * Samples which have both a valid time and coordinates, in chronological order.
+     * Only needs to be built for tracks whose timestamps are not sorted already.
+     */
+    void updateTimeIndex()
+    {
+        if ( !m_timeIndexNeedsUpdate ) {
+            return;
+        }
+
+        m_timeIndex.clear();
+        if ( !m_sorted ) {
+            const int count = qMin( m_when.size(), m_lon.size() );
+            for ( int i = 0; i < count; ++i ) {
+                if ( m_when.at( i ).isValid() ) {
+                    m_timeIndex.append( i );
+                }
+            }
+            qStableSort( m_timeIndex.begin(), m_timeIndex.end(), TimeOrder( m_whenMsecs ) );
+        }
+        m_timeIndexNeedsUpdate = false;
+    }
+
+    int timeCount() const
+    {
+        return m_sorted ? qMin( m_when.size(), m_lon.size() ) : m_timeIndex.size();
+    }
+
+    int indexAt( int k ) const
+    {
+        return m_sorted ? k : m_timeIndex.at( k );
+    }
+
+    qint64 msecsAt( int k ) const
+    {
+        return m_whenMsecs.at( indexAt( k ) );
+    }
+
+    /** Position of the first sample not before @p msecs in time order */
+    int lowerBound( qint64 msecs ) const
+    {
+        int first = 0;
+        int count = timeCount();
+        while ( count > 0 ) {
+            const int step = count / 2;
+            if ( msecsAt( first + step ) < msecs ) {
+                first += step + 1;
+                count -= step + 1;
+            } else {
+                count = step;
+            }
+        }
+        return first;
+    }
+
+    /** Position of the first sample after @p msecs in time order */
+    int upperBound( qint64 msecs ) const
+    {
+        int first = 0;
+        int count = timeCount();
+        while ( count > 0 ) {
+            const int step = count / 2;
+            if ( !( msecs < msecsAt( first + step ) ) ) {
+                first += step + 1;
+                count -= step + 1;
+            } else {
+                count = step;
+            }
+        }
+        return first;
+    }
+
+    void insert( int i, const QDateTime &when, const GeoDataCoordinates &coord )
+    {
+        m_when.insert( i, when );
+        m_whenMsecs.insert( i, when.isValid() ? when.toMSecsSinceEpoch() : 0 );
+        m_lon.insert( i, coord.longitude() );
+        m_lat.insert( i, coord.latitude() );
+        m_alt.insert( i, coord.altitude() );
+        m_timeIndexNeedsUpdate = true;
+    }
+
+    void remove( int i, int count )
+    {
+        m_when.remove( i, count );
+        m_whenMsecs.remove( i, count );
+        m_lon.remove( i, count );
+        m_lat.remove( i, count );
+        m_alt.remove( i, count );
+        m_lineStringNeedsUpdate = true;
+        if ( m_sorted ) {
+            m_timeIndexNeedsUpdate = true;
+        } else {
+            updateSorted();
         }
     }
 
     GeoDataLineString m_lineString;
     bool m_lineStringNeedsUpdate;
 
-    QList<QDateTime> m_when;
-    QList<GeoDataCoordinates> m_coordinates;
+    // One entry per sample in each column. There can be less timestamps than
+    // coordinates (or vice versa) while a track is being parsed.
+    QVector<QDateTime> m_when;
+    QVector<qint64> m_whenMsecs;
+    QVector<qreal> m_lon;
+    QVector<qreal> m_lat;
+    QVector<qreal> m_alt;
+
+    /** True if all timestamps are valid and in chronological order */
+    bool m_sorted;
+
+    QVector<int> m_timeIndex;
+    bool m_timeIndexNeedsUpdate;
 
     GeoDataExtendedData m_extendedData;
 
@@ -82,7 +238,9 @@ bool GeoDataTrack::operator==( const GeoDataTrack& other ) const
 {
     return equals(other) &&
            p()->m_when == other.p()->m_when &&
-           p()->m_coordinates == other.p()->m_coordinates &&
+           p()->m_lon == other.p()->m_lon &&
+           p()->m_lat == other.p()->m_lat &&
+           p()->m_alt == other.p()->m_alt &&
            p()->m_extendedData == other.p()->m_extendedData &&
            p()->m_interpolate == other.p()->m_interpolate;
 }
@@ -94,7 +252,7 @@ bool GeoDataTrack::operator!=( const GeoDataTrack& other ) const
 
 int GeoDataTrack::size() const
 {
-    return p()->m_coordinates.size();
+    return p()->m_lon.size();
 }
 
 bool GeoDataTrack::interpolate() const
@@ -129,12 +287,17 @@ QDateTime GeoDataTrack::lastWhen() const
 
 QList<GeoDataCoordinates> GeoDataTrack::coordinatesList() const
 {
-    return p()->m_coordinates;
+    QList<GeoDataCoordinates> result;
+    result.reserve( size() );
+    for ( int i = 0; i < size(); ++i ) {
+        result.append( p()->coordinates( i ) );
+    }
+    return result;
 }
 
 QList<QDateTime> GeoDataTrack::whenList() const
 {
-    return p()->m_when;
+    return p()->m_when.toList();
 }
 
 GeoDataCoordinates GeoDataTrack::coordinatesAt( const QDateTime &when ) const
@@ -143,49 +306,54 @@ GeoDataCoordinates GeoDataTrack::coordinatesAt( const QDateTime &when ) const
         return GeoDataCoordinates();
     }
 
-    if ( p()->m_when.contains( when ) ) {
-        //exact match found
-        int index = p()->m_when.indexOf( when );
-        if ( index < p()->m_coordinates.size() ) {
-            return p()->m_coordinates.at( index );
+    if ( !when.isValid() ) {
+        // only samples without time information can match
+        const int index = p()->m_when.indexOf( when );
+        if ( index >= 0 && index < size() ) {
+            return p()->coordinates( index );
         }
+        return GeoDataCoordinates();
     }
 
-    if ( !interpolate() ) {
-        return GeoDataCoordinates();
+    p()->updateTimeIndex();
+    const qint64 msecs = when.toMSecsSinceEpoch();
+    const int count = p()->timeCount();
+
+    const int match = p()->lowerBound( msecs );
+    if ( match < count && p()->msecsAt( match ) == msecs ) {
+        //exact match found
+        return p()->coordinates( p()->indexAt( match ) );
     }
 
-    typedef QMap<QDateTime, GeoDataCoordinates> PointMap;
-    PointMap pointMap;
-    for ( int i = 0; i < qMin( p()->m_when.size(), p()->m_coordinates.size() ); ++i) {
-        if ( p()->m_when.at( i ).isValid() ) {
-            pointMap[ p()->m_when.at( i ) ] = p()->m_coordinates.at( i );
-        }
+    if ( !interpolate() ) {
+        return GeoDataCoordinates();
     }
 
-    QMap<QDateTime, GeoDataCoordinates>::const_iterator nextEntry = const_cast<const PointMap&>(pointMap).upperBound( when );
+    int next = p()->upperBound( msecs );
 
     // No tracked point happened before "when"
-    if ( nextEntry == pointMap.constBegin() ) {
+    if ( next == 0 ) {
         mDebug() << "No tracked point before " << when;
         return GeoDataCoordinates();
     }
 
-    if ( nextEntry == pointMap.constEnd() ) {
+    if ( next == count ) {
         mDebug() << "No track point after" << when;
         return GeoDataCoordinates();
     }
 
-    QMap<QDateTime, GeoDataCoordinates>::const_iterator previousEntry = nextEntry - 1;
-    GeoDataCoordinates previousCoord = previousEntry.value();
+    // Of several samples with the same time, the last one is used
+    const int previous = next - 1;
+    while ( next + 1 < count && p()->msecsAt( next + 1 ) == p()->msecsAt( next ) ) {
+        ++next;
+    }
 
-    QDateTime previousWhen = previousEntry.key();
-    QDateTime nextWhen = nextEntry.key();
-    GeoDataCoordinates nextCoord = nextEntry.value();
+    const qint64 previousMsecs = p()->msecsAt( previous );
+    const qint64 nextMsecs = p()->msecsAt( next );
+    GeoDataCoordinates previousCoord = p()->coordinates( p()->indexAt( previous ) );
+    GeoDataCoordinates nextCoord = p()->coordinates( p()->indexAt( next ) );
 
-    int interval = previousWhen.msecsTo( nextWhen );
-    int position = previousWhen.msecsTo( when );
-    qreal t = (qreal)position / (qreal)interval;
+    qreal t = (qreal)( msecs - previousMsecs ) / (qreal)( nextMsecs - previousMsecs );
 
     const Quaternion interpolated = Quaternion::slerp( previousCoord.quaternion(), nextCoord.quaternion(), t );
     qreal lon, lat;
@@ -198,7 +366,7 @@ GeoDataCoordinates GeoDataTrack::coordinatesAt( const QDateTime &when ) const
 
 GeoDataCoordinates GeoDataTrack::coordinatesAt( int index ) const
 {
-    return p()->m_coordinates.at( index );
+    return p()->coordinates( index );
 }
 
 void GeoDataTrack::addPoint( const QDateTime &when, const GeoDataCoordinates &coord )
@@ -207,15 +375,27 @@ void GeoDataTrack::addPoint( const QDateTime &when, const GeoDataCoordinates &co
 
     p()->equalizeWhenSize();
     p()->m_lineStringNeedsUpdate = true;
-    int i=0;
-    while ( i < p()->m_when.size() ) {
-        if ( p()->m_when.at( i ) > when ) {
-            break;
+
+    int i = p()->m_when.size();
+    if ( p()->m_sorted && when.isValid() ) {
+        // chronological appends are the common case and take constant time
+        if ( !p()->m_whenMsecs.isEmpty() && p()->m_whenMsecs.last() > when.toMSecsSinceEpoch() ) {
+            i = p()->upperBound( when.toMSecsSinceEpoch() );
+        }
+    } else {
+        i = 0;
+        while ( i < p()->m_when.size() ) {
+            if ( p()->m_when.at( i ) > when ) {
+                break;
+            }
+            ++i;
+        }
+        if ( !when.isValid() ) {
+            p()->m_sorted = false;
         }
-        ++i;
     }
-    p()->m_when.insert(i, when );
-    p()->m_coordinates.insert(i, coord );
+
+    p()->insert( i, when, coord );
 }
 
 void GeoDataTrack::appendCoordinates( const GeoDataCoordinates &coord )
@@ -224,7 +404,10 @@ void GeoDataTrack::appendCoordinates( const GeoDataCoordinates &coord )
 
     p()->equalizeWhenSize();
     p()->m_lineStringNeedsUpdate = true;
-    p()->m_coordinates.append( coord );
+    p()->m_lon.append( coord.longitude() );
+    p()->m_lat.append( coord.latitude() );
+    p()->m_alt.append( coord.altitude() );
+    p()->m_timeIndexNeedsUpdate = true;
 }
 
 void GeoDataTrack::appendAltitude( qreal altitude )
@@ -232,18 +415,16 @@ void GeoDataTrack::appendAltitude( qreal altitude )
     detach();
 
     p()->m_lineStringNeedsUpdate = true;
-    Q_ASSERT( !p()->m_coordinates.isEmpty() );
-    if ( p()->m_coordinates.isEmpty() ) return;
-    GeoDataCoordinates coordinates = p()->m_coordinates.takeLast();
-    coordinates.setAltitude( altitude );
-    p()->m_coordinates.append( coordinates );
+    Q_ASSERT( !p()->m_alt.isEmpty() );
+    if ( p()->m_alt.isEmpty() ) return;
+    p()->m_alt.last() = altitude;
 }
 
 void GeoDataTrack::appendWhen( const QDateTime &when )
 {
     detach();
 
-    p()->m_when.append( when );
+    p()->appendWhen( when );
 }
 
 void GeoDataTrack::clear()
@@ -251,7 +432,12 @@ void GeoDataTrack::clear()
     detach();
 
     p()->m_when.clear();
-    p()->m_coordinates.clear();
+    p()->m_whenMsecs.clear();
+    p()->m_lon.clear();
+    p()->m_lat.clear();
+    p()->m_alt.clear();
+    p()->m_sorted = true;
+    p()->m_timeIndexNeedsUpdate = true;
     p()->m_lineStringNeedsUpdate = true;
 }
 
@@ -259,15 +445,23 @@ void GeoDataTrack::removeBefore( const QDateTime &when )
 {
     detach();
 
-    Q_ASSERT( p()->m_coordinates.size() == p()->m_when.size() );
+    Q_ASSERT( p()->m_lon.size() == p()->m_when.size() );
     if ( p()->m_when.isEmpty() ) {
         return;
     }
     p()->equalizeWhenSize();
 
-    while ( !p()->m_when.isEmpty() && p()->m_when.first() < when ) {
-        p()->m_when.takeFirst();
-        p()->m_coordinates.takeFirst();
+    int count = 0;
+    if ( p()->m_sorted && when.isValid() && p()->m_when.size() == p()->m_lon.size() ) {
+        count = p()->lowerBound( when.toMSecsSinceEpoch() );
+    } else {
+        while ( count < p()->m_when.size() && p()->m_when.at( count ) < when ) {
+            ++count;
+        }
+    }
+
+    if ( count > 0 ) {
+        p()->remove( 0, count );
     }
 }
 
@@ -275,15 +469,23 @@ void GeoDataTrack::removeAfter( const QDateTime &when )
 {
     detach();
 
-    Q_ASSERT( p()->m_coordinates.size() == p()->m_when.size() );
+    Q_ASSERT( p()->m_lon.size() == p()->m_when.size() );
     if ( p()->m_when.isEmpty() ) {
         return;
     }
     p()->equalizeWhenSize();
-    while ( !p()->m_when.isEmpty() && p()->m_when.last() > when ) {
-        p()->m_when.takeLast();
-        p()->m_coordinates.takeLast();
 
+    int first = p()->m_when.size();
+    if ( p()->m_sorted && when.isValid() && p()->m_when.size() == p()->m_lon.size() ) {
+        first = p()->upperBound( when.toMSecsSinceEpoch() );
+    } else {
+        while ( first > 0 && p()->m_when.at( first - 1 ) > when ) {
+            --first;
+        }
+    }
+
+    if ( first < p()->m_when.size() ) {
+        p()->remove( first, p()->m_when.size() - first );
     }
 }
 
@@ -291,8 +493,8 @@ const GeoDataLineString *GeoDataTrack::lineString() const
 {
     if ( p()->m_lineStringNeedsUpdate ) {
         p()->m_lineString = GeoDataLineString();
-        foreach ( const GeoDataCoordinates &coordinates, coordinatesList() ) {
-            p()->m_lineString.append( coordinates );
+        for ( int i = 0; i < size(); ++i ) {
+            p()->m_lineString.append( p()->coordinates( i ) );
         }
         p()->m_lineStringNeedsUpdate = false;
     }
@@ -25,6 +25,7 @@
 
 // Marble
 #include "MarbleDebug.h"
+#include "MarbleProfiler.h"
 
 // Geodata
 #include "GeoDocument.h"
@@ -73,6 +74,8 @@ static void dumpParentStack( const QString& name, int size, bool close )
 
 bool GeoParser::read( QIODevice* device )
 {
+    MARBLE_PROFILE_SCOPE( "GeoParser::read" );
+
     // Assert previous document got released.
     Q_ASSERT( !m_document );
     m_document = createDocument();
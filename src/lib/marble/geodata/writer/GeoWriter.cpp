@@ -11,6 +11,7 @@
 #include "GeoWriter.h"
 
 #include "GeoTagWriter.h"
+#include "GeoDataLineString.h"
 #include "KmlElementDictionary.h"
 #include "DgmlElementDictionary.h"
 
@@ -19,6 +20,20 @@
 namespace Marble
 {
 
+namespace
+{
+
+const qint64 powersOfTen[] = { 1LL, 10LL, 100LL, 1000LL, 10000LL, 100000LL, 1000000LL,
+                               10000000LL, 100000000LL, 1000000000LL, 10000000000LL };
+
+// Largest scaled value that is still represented exactly by a double
+const double maximumFixedValue = 9007199254740992.0;
+
+// Relative distance to a rounding tie below which the scaled value is not trusted
+const double tieTolerance = 1.0e-15;
+
+}
+
 GeoWriter::GeoWriter()
 {
     //FIXME: work out a standard way to do this.
@@ -102,4 +117,95 @@ void GeoWriter::writeOptionalElement( const QString &key, const QString &value,
     }
 }
 
+void GeoWriter::writeCoordinates( const GeoDataLineString &lineString )
+{
+    if ( m_coordinateBuffer.capacity() == 0 ) {
+        // resize() keeps reserved memory, so the buffer only grows once
+        m_coordinateBuffer.reserve( 4096 );
+    }
+    m_coordinateBuffer.resize( 0 );
+
+    bool hasAltitude = false;
+    QVector<GeoDataCoordinates>::ConstIterator it = lineString.constBegin();
+    QVector<GeoDataCoordinates>::ConstIterator const end = lineString.constEnd();
+    for ( ; it != end && !hasAltitude; ++it ) {
+        hasAltitude = it->altitude() != 0.0;
+    }
+
+    const bool closeRing = lineString.isClosed() && lineString.size() >= 3
+                           && lineString.first() != lineString.last();
+    const int size = closeRing ? lineString.size() + 1 : lineString.size();
+
+    for ( int i = 0; i < size; ++i ) {
+        const GeoDataCoordinates &coordinates = lineString.at( i % lineString.size() );
+        if ( i > 0 ) {
+            m_coordinateBuffer += QLatin1Char( ' ' );
+        }
+
+        appendNumber( m_coordinateBuffer, coordinates.longitude( GeoDataCoordinates::Degree ), 10 );
+        m_coordinateBuffer += QLatin1Char( ',' );
+        appendNumber( m_coordinateBuffer, coordinates.latitude( GeoDataCoordinates::Degree ), 10 );
+        if ( hasAltitude ) {
+            m_coordinateBuffer += QLatin1Char( ',' );
+            appendNumber( m_coordinateBuffer, coordinates.altitude(), 2 );
+        }
+    }
+
+    writeCharacters( m_coordinateBuffer );
+}
+
+void GeoWriter::appendNumber( QString &text, qreal value, int decimals )
+{
+    decimals = qBound( 0, decimals, 10 );
+    const double scaled = qAbs( double( value ) ) * powersOfTen[decimals];
+    if ( !( scaled < maximumFixedValue ) ) {
+        // Very large values, infinity and NaN
+        text += QString::number( value, 'f', decimals );
+        return;
+    }
+
+    // The product carries a rounding error of up to one unit in the last place. Values
+    // whose residue is that close to a tie are left to the correctly rounded conversion
+    // of QString::number, as are negative values that round to zero.
+    qint64 fixed = qint64( scaled );
+    const double residue = scaled - fixed;
+    if ( qAbs( residue - 0.5 ) <= qMax( scaled, 1.0 ) * tieTolerance ) {
+        text += QString::number( value, 'f', decimals );
+        return;
+    }
+    if ( residue > 0.5 ) {
+        ++fixed;
+    }
+    if ( fixed == 0 && value < 0.0 ) {
+        text += QString::number( value, 'f', decimals );
+        return;
+    }
+
+    qint64 integral = fixed / powersOfTen[decimals];
+    qint64 fraction = fixed % powersOfTen[decimals];
+
+    // Digits are filled in from the end of the buffer
+    char buffer[32];
+    char *const end = buffer + sizeof( buffer ) - 1;
+    char *digit = end;
+    *end = '\0';
+
+    for ( int i = 0; i < decimals; ++i ) {
+        *--digit = '0' + fraction % 10;
+        fraction /= 10;
+    }
+    if ( decimals > 0 ) {
+        *--digit = '.';
+    }
+    do {
+        *--digit = '0' + integral % 10;
+        integral /= 10;
+    } while ( integral > 0 );
+    if ( value < 0.0 ) {
+        *--digit = '-';
+    }
+
+    text += QLatin1String( digit );
+}
+
 }
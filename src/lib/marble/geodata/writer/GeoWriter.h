@@ -20,6 +20,8 @@
 namespace Marble
 {
 
+class GeoDataLineString;
+
 /**
  * @brief Standard Marble way of writing XML
  * This class is intended to be a standardised way of writing XML for marble.
@@ -75,12 +77,29 @@ public:
         }
     }
 
+    /**
+     * @brief Writes the points of a line string as KML coordinate tuples
+     * All tuples are formatted into a buffer that is reused between calls and
+     * passed to writeCharacters() at once. Altitudes are written for all
+     * points if any point has an altitude. Closed line strings that do not
+     * repeat their first point at the end get it appended.
+     */
+    void writeCoordinates( const GeoDataLineString &lineString );
+
+    /**
+     * @brief Appends @p value with @p decimals decimals to @p text
+     * The result equals QString::number( value, 'f', decimals ), but no
+     * temporary string is created for the common range of coordinates.
+     */
+    static void appendNumber( QString &text, qreal value, int decimals );
+
 private:
     friend class GeoTagWriter;
     bool writeElement( const GeoNode* object );
 
 private:
     QString m_documentType;
+    QString m_coordinateBuffer;
 };
 
 }
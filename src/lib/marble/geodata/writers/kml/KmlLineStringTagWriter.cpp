@@ -35,37 +35,7 @@ bool KmlLineStringTagWriter::write( const GeoNode *node, GeoWriter& writer ) con
         KmlObjectTagWriter::writeIdentifiers( writer, lineString );
         writer.writeOptionalElement( kml::kmlTag_extrude, QString::number( lineString->extrude() ), "0" );
         writer.writeStartElement( "coordinates" );
-
-        // Write altitude for *all* elements, if *any* element
-        // has altitude information (!= 0.0)
-        bool hasAltitude = false;
-        for ( int i = 0; i < lineString->size(); ++i ) {
-            if ( lineString->at( i ).altitude() ) {
-                hasAltitude = true;
-                break;
-            }
-        }
-
-        for ( int i = 0; i < lineString->size(); ++i ) {
-            GeoDataCoordinates coordinates = lineString->at( i );
-            if ( i > 0 )
-            {
-                writer.writeCharacters( " " );
-            }
-
-            qreal lon = coordinates.longitude( GeoDataCoordinates::Degree );
-            writer.writeCharacters( QString::number( lon, 'f', 10 ) );
-            writer.writeCharacters( "," );
-            qreal lat = coordinates.latitude( GeoDataCoordinates::Degree );
-            writer.writeCharacters( QString::number( lat, 'f', 10 ) );
-
-            if ( hasAltitude ) {
-                qreal alt = coordinates.altitude();
-                writer.writeCharacters( "," );
-                writer.writeCharacters( QString::number( alt, 'f', 2 ) );
-            }
-        }
-
+        writer.writeCoordinates( *lineString );
         writer.writeEndElement();
         writer.writeEndElement();
 
@@ -30,13 +30,19 @@ bool KmlTrackWriter::write( const GeoNode *node, GeoWriter &writer ) const
     KmlObjectTagWriter::writeIdentifiers( writer, track );
 
     int points = track->size();
+    const QList<QDateTime> whenList = track->whenList();
+    QString coord;
     for ( int i = 0; i < points; i++ ) {
-        writer.writeElement( "when", track->whenList().at( i ).toString( Qt::ISODate ) );
+        writer.writeElement( "when", whenList.at( i ).toString( Qt::ISODate ) );
 
         qreal lon, lat, alt;
-        track->coordinatesList().at( i ).geoCoordinates( lon, lat, alt, GeoDataCoordinates::Degree );
-        QString coord = QString::number( lon, 'f', 10 ) + ' '
-                        + QString::number( lat, 'f', 10 ) + ' ' + QString::number( alt, 'f', 10 );
+        track->coordinatesAt( i ).geoCoordinates( lon, lat, alt, GeoDataCoordinates::Degree );
+        coord.resize( 0 );
+        GeoWriter::appendNumber( coord, lon, 10 );
+        coord += QLatin1Char( ' ' );
+        GeoWriter::appendNumber( coord, lat, 10 );
+        coord += QLatin1Char( ' ' );
+        GeoWriter::appendNumber( coord, alt, 10 );
 
         writer.writeElement( "gx:coord", coord );
     }
@@ -26,7 +26,6 @@
 
 #include "PlacemarkLayout.h"
 
-class QAbstractItemModel;
 class QItemSelectionModel;
 class QString;
 
@@ -36,6 +35,7 @@ namespace Marble
 class GeoPainter;
 class GeoSceneLayer;
 class MarbleClock;
+class PlacemarkRegistry;
 class ViewportParams;
 class VisiblePlacemark;
 
@@ -44,7 +44,7 @@ class PlacemarkLayer : public QObject, public LayerInterface
     Q_OBJECT
 
  public:
-    PlacemarkLayer( QAbstractItemModel *placemarkModel,
+    PlacemarkLayer( const PlacemarkRegistry *placemarkRegistry,
                     QItemSelectionModel *selectionModel,
                     MarbleClock *clock,
                     QObject *parent = 0 );
@@ -13,9 +13,11 @@
 #include "TextureLayer.h"
 
 #include <qmath.h>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QTime>
 #include <QTimer>
 #include <QList>
-#include <QSortFilterProxyModel>
 
 #include "SphericalScanlineTextureMapper.h"
 #include "EquirectScanlineTextureMapper.h"
@@ -29,7 +31,7 @@
 #include "MergedLayerDecorator.h"
 #include "MarbleDebug.h"
 #include "MarbleDirs.h"
-#include "MarblePlacemarkModel.h"
+#include "PlacemarkRegistry.h"
 #include "StackedTile.h"
 #include "StackedTileLoader.h"
 #include "SunLocator.h"
@@ -47,15 +49,26 @@ class TextureLayer::Private
 public:
     Private( HttpDownloadManager *downloadManager,
              const SunLocator *sunLocator,
-             QAbstractItemModel *groundOverlayModel,
+             const PlacemarkRegistry *placemarkRegistry,
              TextureLayer *parent );
 
     void requestDelayedRepaint();
     void updateTextureLayers();
     void updateTile( const TileId &tileId, const QImage &tileImage );
 
-    void addGroundOverlays( QModelIndex parent, int first, int last );
-    void removeGroundOverlays( QModelIndex parent, int first, int last );
+    TextureMapperInterface *createTextureMapper( Projection projection );
+    bool supportsRefinement( Projection projection ) const;
+
+    void renderProgressive( GeoPainter *painter, const ViewportParams *viewport, const QRect &dirtyRect );
+    void startRefinement( const ViewportParams *viewport );
+    void finishRefinement( int generation );
+    void cancelRefinement();
+    void resetRefinement();
+
+    static bool isSameView( const ViewportParams *viewport, const ViewportParams *other );
+
+    void addGroundOverlays( const QVector<GeoDataGroundOverlay*> &groundOverlays );
+    void removeGroundOverlays( const QVector<GeoDataGroundOverlay*> &groundOverlays );
     void resetGroundOverlaysCache();
 
     void updateGroundOverlays();
@@ -65,6 +78,7 @@ public:
 public:
     TextureLayer  *const m_parent;
     const SunLocator *const m_sunLocator;
+    const PlacemarkRegistry *const m_placemarkRegistry;
     TileLoader m_loader;
     MergedLayerDecorator m_layerDecorator;
     StackedTileLoader    m_tileLoader;
@@ -75,19 +89,64 @@ public:
     QVector<const GeoSceneTextureTile *> m_textures;
     const GeoSceneGroup *m_textureLayerSettings;
     QString m_runtimeTrace;
-    QSortFilterProxyModel m_groundOverlayModel;
     QList<const GeoDataGroundOverlay *> m_groundOverlayCache;
     // For scheduling repaints
     QTimer           m_repaintTimer;
     RenderState m_renderState;
+
+    // Progressive rendering: a low quality preview is shown at once while
+    // a separate texture mapper refines the frame in m_refinementPool.
+    // The tile loader is not thread safe, hence the refinement is cancelled
+    // before the tile loader or the texture mapper are used again.
+    class RefinementJob;
+    bool m_progressiveRendering;
+    QThreadPool m_refinementPool;
+    TextureMapperInterface *m_refinementMapper;
+    ViewportParams *m_refinementViewport;
+    int m_refinementGeneration;
+    QImage m_refinementImage;
+    QImage m_refinedImage;
+    QImage m_previewImage;
+    QTime m_refinementTime;
+    int m_previewLatency;
+};
+
+class TextureLayer::Private::RefinementJob : public QRunnable
+{
+public:
+    RefinementJob( Private *parent, int tileZoomLevel, int generation ) :
+        m_parent( parent ),
+        m_tileZoomLevel( tileZoomLevel ),
+        m_generation( generation )
+    {
+    }
+
+    virtual void run()
+    {
+        const QRect rect( QPoint( 0, 0 ), m_parent->m_refinementViewport->size() );
+        {
+            GeoPainter painter( &m_parent->m_refinementImage, m_parent->m_refinementViewport, HighQuality );
+            m_parent->m_refinementMapper->mapTexture( &painter, m_parent->m_refinementViewport,
+                                                      m_tileZoomLevel, rect, m_parent->m_texcolorizer );
+        }
+
+        QMetaObject::invokeMethod( m_parent->m_parent, "finishRefinement", Qt::QueuedConnection,
+                                   Q_ARG( int, m_generation ) );
+    }
+
+private:
+    Private *const m_parent;
+    const int m_tileZoomLevel;
+    const int m_generation;
 };
 
 TextureLayer::Private::Private( HttpDownloadManager *downloadManager,
                                 const SunLocator *sunLocator,
-                                QAbstractItemModel *groundOverlayModel,
+                                const PlacemarkRegistry *placemarkRegistry,
                                 TextureLayer *parent )
     : m_parent( parent )
     , m_sunLocator( sunLocator )
+    , m_placemarkRegistry( placemarkRegistry )
     , m_loader( downloadManager, 0 )
     , m_layerDecorator( &m_loader, sunLocator )
     , m_tileLoader( &m_layerDecorator )
@@ -97,29 +156,37 @@ TextureLayer::Private::Private( HttpDownloadManager *downloadManager,
     , m_texcolorizer( 0 )
     , m_textureLayerSettings( 0 )
     , m_repaintTimer()
+    , m_progressiveRendering( false )
+    , m_refinementMapper( 0 )
+    , m_refinementViewport( 0 )
+    , m_refinementGeneration( 0 )
+    , m_previewLatency( 0 )
 {
-    m_groundOverlayModel.setSourceModel( groundOverlayModel );
-    m_groundOverlayModel.setDynamicSortFilter( true );
-    m_groundOverlayModel.setSortRole ( MarblePlacemarkModel::PopularityIndexRole );
-    m_groundOverlayModel.sort (0, Qt::AscendingOrder );
+    m_refinementPool.setMaxThreadCount( 1 );
 
-    connect( &m_groundOverlayModel, SIGNAL(rowsInserted(QModelIndex,int,int)),
-             m_parent,              SLOT(addGroundOverlays(QModelIndex,int,int)) );
+    connect( m_placemarkRegistry, SIGNAL(groundOverlaysAdded(QVector<GeoDataGroundOverlay*>)),
+             m_parent,            SLOT(addGroundOverlays(QVector<GeoDataGroundOverlay*>)) );
 
-    connect( &m_groundOverlayModel, SIGNAL(rowsAboutToBeRemoved(QModelIndex,int,int)),
-             m_parent,              SLOT(removeGroundOverlays(QModelIndex,int,int)) );
+    connect( m_placemarkRegistry, SIGNAL(groundOverlaysAboutToBeRemoved(QVector<GeoDataGroundOverlay*>)),
+             m_parent,            SLOT(removeGroundOverlays(QVector<GeoDataGroundOverlay*>)) );
 
-    connect( &m_groundOverlayModel, SIGNAL(dataChanged(QModelIndex,QModelIndex)),
-             m_parent,              SLOT(resetGroundOverlaysCache()) );
+    connect( m_placemarkRegistry, SIGNAL(reset()),
+             m_parent,            SLOT(resetGroundOverlaysCache()) );
 
-    connect( &m_groundOverlayModel, SIGNAL(modelReset()),
-             m_parent,              SLOT(resetGroundOverlaysCache()) );
+    foreach ( const GeoDataGroundOverlay *overlay, m_placemarkRegistry->groundOverlays() ) {
+        if ( !overlay->icon().isNull() ) {
+            int pos = qUpperBound( m_groundOverlayCache.begin(), m_groundOverlayCache.end(), overlay, drawOrderLessThan ) - m_groundOverlayCache.begin();
+            m_groundOverlayCache.insert( pos, overlay );
+        }
+    }
 
     updateGroundOverlays();
 }
 
 void TextureLayer::Private::requestDelayedRepaint()
 {
+    resetRefinement();
+
     if ( m_texmapper ) {
         m_texmapper->setRepaintNeeded();
     }
@@ -149,6 +216,7 @@ void TextureLayer::Private::updateTextureLayers()
 
     updateGroundOverlays();
 
+    resetRefinement();
     m_layerDecorator.setTextureLayers( result );
     m_tileLoader.clear();
 
@@ -160,27 +228,159 @@ void TextureLayer::Private::updateTile( const TileId &tileId, const QImage &tile
     if ( tileImage.isNull() )
         return; // keep tiles in cache to improve performance
 
+    resetRefinement();
     m_tileLoader.updateTile( tileId, tileImage );
 
     requestDelayedRepaint();
 }
 
+TextureMapperInterface *TextureLayer::Private::createTextureMapper( Projection projection )
+{
+    // FIXME: replace this with an approach based on the factory method pattern.
+    switch( projection ) {
+        case Spherical:
+            return new SphericalScanlineTextureMapper( &m_tileLoader );
+        case Equirectangular:
+            return new EquirectScanlineTextureMapper( &m_tileLoader );
+        case Mercator:
+            if ( m_tileLoader.tileProjection() == GeoSceneTiled::Mercator ) {
+                return new TileScalingTextureMapper( &m_tileLoader );
+            } else {
+                return new MercatorScanlineTextureMapper( &m_tileLoader );
+            }
+        case Gnomonic:
+        case Stereographic:
+        case LambertAzimuthal:
+        case AzimuthalEquidistant:
+        case VerticalPerspective:
+            return new GenericScanlineTextureMapper( &m_tileLoader );
+        default:
+            return 0;
+    }
+}
+
+bool TextureLayer::Private::supportsRefinement( Projection projection ) const
+{
+    // TileScalingTextureMapper caches scaled tiles as pixmaps, which must
+    // not be created outside the GUI thread
+    return projection != Mercator || m_tileLoader.tileProjection() != GeoSceneTiled::Mercator;
+}
+
+void TextureLayer::Private::renderProgressive( GeoPainter *painter, const ViewportParams *viewport, const QRect &dirtyRect )
+{
+    if ( m_refinementViewport && isSameView( m_refinementViewport, viewport ) ) {
+        if ( !m_refinedImage.isNull() ) {
+            painter->drawImage( dirtyRect, m_refinedImage, dirtyRect );
+        } else {
+            painter->drawImage( dirtyRect, m_previewImage, dirtyRect );
+            m_renderState.addChild( RenderState( "Texture Refinement", WaitingForUpdates ) );
+        }
+        return;
+    }
+
+    resetRefinement();
+
+    QTime time;
+    time.start();
+
+    if ( m_previewImage.size() != viewport->size() ) {
+        m_previewImage = QImage( viewport->size(), QImage::Format_ARGB32_Premultiplied );
+    }
+    m_previewImage.fill( Qt::transparent );
+    {
+        GeoPainter previewPainter( &m_previewImage, viewport, LowQuality );
+        m_texmapper->mapTexture( &previewPainter, viewport, m_tileZoomLevel, dirtyRect, m_texcolorizer );
+    }
+    painter->drawImage( dirtyRect, m_previewImage, dirtyRect );
+
+    m_renderState.addChild( m_tileLoader.renderState() );
+    m_renderState.addChild( RenderState( "Texture Refinement", WaitingForUpdates ) );
+
+    m_previewLatency = time.elapsed();
+    m_refinementTime = time;
+
+    startRefinement( viewport );
+}
+
+void TextureLayer::Private::startRefinement( const ViewportParams *viewport )
+{
+    Q_ASSERT( !m_refinementMapper );
+
+    m_refinementViewport = new ViewportParams( viewport->projection(),
+                                               viewport->centerLongitude(), viewport->centerLatitude(),
+                                               viewport->radius(), viewport->size() );
+    m_refinementMapper = createTextureMapper( viewport->projection() );
+    m_refinementImage = QImage( viewport->size(), QImage::Format_ARGB32_Premultiplied );
+    m_refinementImage.fill( Qt::transparent );
+
+    ++m_refinementGeneration;
+    m_refinementPool.start( new RefinementJob( this, m_tileZoomLevel, m_refinementGeneration ) );
+}
+
+void TextureLayer::Private::finishRefinement( int generation )
+{
+    // Results of cancelled refinements may still be queued
+    if ( generation != m_refinementGeneration || !m_refinementMapper ) {
+        return;
+    }
+
+    m_refinementPool.waitForDone();
+    delete m_refinementMapper;
+    m_refinementMapper = 0;
+
+    m_refinedImage = m_refinementImage;
+    m_refinementImage = QImage();
+
+    emit m_parent->frameLatency( m_previewLatency, m_refinementTime.elapsed() );
+    emit m_parent->repaintNeeded();
+}
+
+void TextureLayer::Private::cancelRefinement()
+{
+    if ( !m_refinementMapper ) {
+        return;
+    }
+
+    m_refinementMapper->cancel();
+    m_refinementPool.waitForDone();
+    ++m_refinementGeneration;
+
+    delete m_refinementMapper;
+    m_refinementMapper = 0;
+    m_refinementImage = QImage();
+}
+
+void TextureLayer::Private::resetRefinement()
+{
+    cancelRefinement();
+
+    delete m_refinementViewport;
+    m_refinementViewport = 0;
+    m_refinedImage = QImage();
+}
+
+bool TextureLayer::Private::isSameView( const ViewportParams *viewport, const ViewportParams *other )
+{
+    return viewport->projection() == other->projection()
+        && viewport->centerLongitude() == other->centerLongitude()
+        && viewport->centerLatitude() == other->centerLatitude()
+        && viewport->radius() == other->radius()
+        && viewport->size() == other->size();
+}
+
 bool TextureLayer::Private::drawOrderLessThan( const GeoDataGroundOverlay* o1, const GeoDataGroundOverlay* o2 )
 {
     return o1->drawOrder() < o2->drawOrder();
 }
 
-void TextureLayer::Private::addGroundOverlays( QModelIndex parent, int first, int last )
+void TextureLayer::Private::addGroundOverlays( const QVector<GeoDataGroundOverlay*> &groundOverlays )
 {
-    for ( int i = first; i <= last; ++i ) {
-        QModelIndex index = m_groundOverlayModel.index( i, 0, parent );
-        const GeoDataGroundOverlay *overlay = static_cast<GeoDataGroundOverlay *>( qvariant_cast<GeoDataObject *>( index.data( MarblePlacemarkModel::ObjectPointerRole ) ) );
-
+    foreach ( const GeoDataGroundOverlay *overlay, groundOverlays ) {
         if ( overlay->icon().isNull() ) {
             continue;
         }
 
-        int pos = qLowerBound( m_groundOverlayCache.begin(), m_groundOverlayCache.end(), overlay, drawOrderLessThan ) - m_groundOverlayCache.begin();
+        int pos = qUpperBound( m_groundOverlayCache.begin(), m_groundOverlayCache.end(), overlay, drawOrderLessThan ) - m_groundOverlayCache.begin();
         m_groundOverlayCache.insert( pos, overlay );
     }
 
@@ -189,16 +389,10 @@ void TextureLayer::Private::addGroundOverlays( QModelIndex parent, int first, in
     m_parent->reset();
 }
 
-void TextureLayer::Private::removeGroundOverlays( QModelIndex parent, int first, int last )
+void TextureLayer::Private::removeGroundOverlays( const QVector<GeoDataGroundOverlay*> &groundOverlays )
 {
-    for ( int i = first; i <= last; ++i ) {
-        QModelIndex index = m_groundOverlayModel.index( i, 0, parent );
-        const GeoDataGroundOverlay *overlay = static_cast<GeoDataGroundOverlay *>( qvariant_cast<GeoDataObject *>( index.data( MarblePlacemarkModel::ObjectPointerRole ) ) );
-
-        int pos = qLowerBound( m_groundOverlayCache.begin(), m_groundOverlayCache.end(), overlay, drawOrderLessThan ) - m_groundOverlayCache.begin();
-        if (pos >= 0 && pos < m_groundOverlayCache.size() ) {
-            m_groundOverlayCache.removeAt( pos );
-        }
+    foreach ( const GeoDataGroundOverlay *overlay, groundOverlays ) {
+        m_groundOverlayCache.removeOne( overlay );
     }
 
     updateGroundOverlays();
@@ -209,10 +403,7 @@ void TextureLayer::Private::removeGroundOverlays( QModelIndex parent, int first,
 void TextureLayer::Private::resetGroundOverlaysCache()
 {
     m_groundOverlayCache.clear();
-
-    updateGroundOverlays();
-
-    m_parent->reset();
+    addGroundOverlays( m_placemarkRegistry->groundOverlays() );
 }
 
 void TextureLayer::Private::updateGroundOverlays()
@@ -228,9 +419,9 @@ void TextureLayer::Private::updateGroundOverlays()
 
 TextureLayer::TextureLayer( HttpDownloadManager *downloadManager,
                             const SunLocator *sunLocator,
-                            QAbstractItemModel *groundOverlayModel )
+                            const PlacemarkRegistry *placemarkRegistry )
     : QObject()
-    , d( new Private( downloadManager, sunLocator, groundOverlayModel, this ) )
+    , d( new Private( downloadManager, sunLocator, placemarkRegistry, this ) )
 {
     connect( &d->m_loader, SIGNAL(tileCompleted(TileId,QImage)),
              this, SLOT(updateTile(TileId,QImage)) );
@@ -244,6 +435,7 @@ TextureLayer::TextureLayer( HttpDownloadManager *downloadManager,
 
 TextureLayer::~TextureLayer()
 {
+    d->resetRefinement();
     delete d->m_texmapper;
     delete d->m_texcolorizer;
     delete d;
@@ -257,6 +449,7 @@ QStringList TextureLayer::renderPosition() const
 void TextureLayer::addSeaDocument( const GeoDataDocument *seaDocument )
 {
     if( d->m_texcolorizer ) {
+        d->resetRefinement();
         d->m_texcolorizer->addSeaDocument( seaDocument );
         reset();
     }
@@ -265,6 +458,7 @@ void TextureLayer::addSeaDocument( const GeoDataDocument *seaDocument )
 void TextureLayer::addLandDocument( const GeoDataDocument *landDocument )
 {
     if( d->m_texcolorizer ) {
+        d->resetRefinement();
         d->m_texcolorizer->addLandDocument( landDocument );
         reset();
     }
@@ -303,7 +497,7 @@ bool TextureLayer::render( GeoPainter *painter, ViewportParams *viewport,
          d->m_centerCoordinates.latitude() != viewport->centerLatitude() ) {
         d->m_centerCoordinates.setLongitude( viewport->centerLongitude() );
         d->m_centerCoordinates.setLatitude( viewport->centerLatitude() );
-        d->m_texmapper->setRepaintNeeded();
+        d->m_texmapper->setCenterChanged();
     }
 
     // choose the smaller dimension for selecting the tile level, leading to higher-resolution results
@@ -328,6 +522,13 @@ bool TextureLayer::render( GeoPainter *painter, ViewportParams *viewport,
     }
 
     const QRect dirtyRect = QRect( QPoint( 0, 0), viewport->size() );
+    if ( d->m_progressiveRendering && painter->mapQuality() == HighQuality
+         && d->supportsRefinement( viewport->projection() ) ) {
+        d->renderProgressive( painter, viewport, dirtyRect );
+        return true;
+    }
+
+    d->resetRefinement();
     d->m_texmapper->mapTexture( painter, viewport, d->m_tileZoomLevel, dirtyRect, d->m_texcolorizer );
     d->m_renderState.addChild( d->m_tileLoader.renderState() );
     d->m_runtimeTrace = QString("Texture Cache: %1 ").arg(d->m_tileLoader.tileCount());
@@ -356,6 +557,7 @@ void TextureLayer::setShowSunShading( bool show )
                  this,       SLOT(reset()) );
     }
 
+    d->resetRefinement();
     d->m_layerDecorator.setShowSunShading( show );
 
     reset();
@@ -363,6 +565,7 @@ void TextureLayer::setShowSunShading( bool show )
 
 void TextureLayer::setShowCityLights( bool show )
 {
+    d->resetRefinement();
     d->m_layerDecorator.setShowCityLights( show );
 
     reset();
@@ -370,6 +573,7 @@ void TextureLayer::setShowCityLights( bool show )
 
 void TextureLayer::setShowTileId( bool show )
 {
+    d->resetRefinement();
     d->m_layerDecorator.setShowTileId( show );
 
     reset();
@@ -381,38 +585,17 @@ void TextureLayer::setProjection( Projection projection )
         return;
     }
 
-    // FIXME: replace this with an approach based on the factory method pattern.
+    d->resetRefinement();
     delete d->m_texmapper;
 
-    switch( projection ) {
-        case Spherical:
-            d->m_texmapper = new SphericalScanlineTextureMapper( &d->m_tileLoader );
-            break;
-        case Equirectangular:
-            d->m_texmapper = new EquirectScanlineTextureMapper( &d->m_tileLoader );
-            break;
-        case Mercator:
-            if ( d->m_tileLoader.tileProjection() == GeoSceneTiled::Mercator ) {
-                d->m_texmapper = new TileScalingTextureMapper( &d->m_tileLoader );
-            } else {
-                d->m_texmapper = new MercatorScanlineTextureMapper( &d->m_tileLoader );
-            }
-            break;
-        case Gnomonic:
-        case Stereographic:
-        case LambertAzimuthal:
-        case AzimuthalEquidistant:
-        case VerticalPerspective:
-            d->m_texmapper = new GenericScanlineTextureMapper( &d->m_tileLoader );
-            break;
-        default:
-            d->m_texmapper = 0;
-    }
+    d->m_texmapper = d->createTextureMapper( projection );
     Q_ASSERT( d->m_texmapper );
 }
 
 void TextureLayer::setNeedsUpdate()
 {
+    d->resetRefinement();
+
     if ( d->m_texmapper ) {
         d->m_texmapper->setRepaintNeeded();
     }
@@ -422,6 +605,7 @@ void TextureLayer::setNeedsUpdate()
 
 void TextureLayer::setVolatileCacheLimit( quint64 kilobytes )
 {
+    d->resetRefinement();
     d->m_tileLoader.setVolatileCacheLimit( kilobytes );
 }
 
@@ -429,12 +613,15 @@ void TextureLayer::reset()
 {
     mDebug() << Q_FUNC_INFO;
 
+    d->resetRefinement();
     d->m_tileLoader.clear();
     setNeedsUpdate();
 }
 
 void TextureLayer::reload()
 {
+    d->resetRefinement();
+
     foreach ( const TileId &id, d->m_tileLoader.visibleTiles() ) {
         // it's debatable here, whether DownloadBulk or DownloadBrowse should be used
         // but since "reload" or "refresh" seems to be a common action of a browser and it
@@ -450,6 +637,7 @@ void TextureLayer::downloadStackedTile( const TileId &stackedTileId )
 
 void TextureLayer::setMapTheme( const QVector<const GeoSceneTextureTile *> &textures, const GeoSceneGroup *textureLayerSettings, const QString &seaFile, const QString &landFile )
 {
+    d->resetRefinement();
     delete d->m_texcolorizer;
     d->m_texcolorizer = 0;
 
@@ -531,6 +719,21 @@ RenderState TextureLayer::renderState() const
     return d->m_renderState;
 }
 
+void TextureLayer::setProgressiveRendering( bool enabled )
+{
+    if ( d->m_progressiveRendering == enabled ) {
+        return;
+    }
+
+    d->resetRefinement();
+    d->m_progressiveRendering = enabled;
+}
+
+bool TextureLayer::progressiveRendering() const
+{
+    return d->m_progressiveRendering;
+}
+
 }
 
 #include "TextureLayer.moc"
@@ -19,7 +19,6 @@
 
 #include <QSize>
 
-class QAbstractItemModel;
 class QImage;
 class QRegion;
 class QRect;
@@ -29,9 +28,11 @@ namespace Marble
 
 class GeoPainter;
 class GeoDataDocument;
+class GeoDataGroundOverlay;
 class GeoSceneGroup;
 class GeoSceneTextureTile;
 class HttpDownloadManager;
+class PlacemarkRegistry;
 class SunLocator;
 class ViewportParams;
 
@@ -42,7 +43,7 @@ class MARBLE_EXPORT TextureLayer : public QObject, public LayerInterface
  public:
     TextureLayer( HttpDownloadManager *downloadManager,
                   const SunLocator *sunLocator,
-                  QAbstractItemModel *groundOverlayModel );
+                  const PlacemarkRegistry *placemarkRegistry );
 
     ~TextureLayer();
 
@@ -75,6 +76,18 @@ class MARBLE_EXPORT TextureLayer : public QObject, public LayerInterface
 
     RenderState renderState() const;
 
+    /**
+     * @brief Enables progressive rendering of high quality frames
+     *
+     * If enabled, a high quality frame is shown as a low quality preview at
+     * once and mapped in high quality on a worker thread afterwards. The
+     * refined frame replaces the preview when done, or is discarded if the
+     * view changes before. Disabled by default.
+     */
+    void setProgressiveRendering( bool enabled );
+
+    bool progressiveRendering() const;
+
     virtual QString runtimeTrace() const;
 
     virtual bool render( GeoPainter *painter, ViewportParams *viewport,
@@ -112,13 +125,22 @@ public Q_SLOTS:
     void tileLevelChanged( int );
     void repaintNeeded();
 
+    /**
+     * Emitted when a progressively rendered frame got refined.
+     * @param previewLatency milliseconds taken to show the preview
+     * @param refinedLatency milliseconds from starting the preview until the
+     *        refined frame was ready
+     */
+    void frameLatency( int previewLatency, int refinedLatency );
+
  private:
     Q_PRIVATE_SLOT( d, void requestDelayedRepaint() )
     Q_PRIVATE_SLOT( d, void updateTextureLayers() )
     Q_PRIVATE_SLOT( d, void updateTile( const TileId &tileId, const QImage &tileImage ) )
-    Q_PRIVATE_SLOT( d, void addGroundOverlays( QModelIndex parent, int first, int last ) )
-    Q_PRIVATE_SLOT( d, void removeGroundOverlays( QModelIndex parent, int first, int last ) )
+    Q_PRIVATE_SLOT( d, void addGroundOverlays( const QVector<GeoDataGroundOverlay*> &groundOverlays ) )
+    Q_PRIVATE_SLOT( d, void removeGroundOverlays( const QVector<GeoDataGroundOverlay*> &groundOverlays ) )
     Q_PRIVATE_SLOT( d, void resetGroundOverlaysCache() )
+    Q_PRIVATE_SLOT( d, void finishRefinement( int generation ) )
 
  private:
     class Private;
@@ -18,6 +18,7 @@
 #include "GeoDataLineString.h"
 #include "GeoDataCoordinates.h"
 #include "ViewportParams.h"
+#include "MarbleProfiler.h"
 
 namespace Marble {
 
@@ -45,6 +46,7 @@ bool AzimuthalProjection::screenCoordinates( const GeoDataLineString &lineString
                                                   const ViewportParams *viewport,
                                                   QVector<QPolygonF *> &polygons ) const
 {
+    MARBLE_PROFILE_SCOPE( "AzimuthalProjection::screenCoordinates" );
 
     Q_D( const AzimuthalProjection );
     // Compare bounding box size of the line string with the angularResolution
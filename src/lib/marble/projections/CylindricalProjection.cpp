@@ -20,6 +20,7 @@
 #include "GeoDataLineString.h"
 #include "GeoDataCoordinates.h"
 #include "ViewportParams.h"
+#include "MarbleProfiler.h"
 
 // Maximum amount of nodes that are created automatically between actual nodes.
 static const int maxTessellationNodes = 200;
@@ -82,6 +83,7 @@ bool CylindricalProjection::screenCoordinates( const GeoDataLineString &lineStri
                                                   const ViewportParams *viewport,
                                                   QVector<QPolygonF *> &polygons ) const
 {
+    MARBLE_PROFILE_SCOPE( "CylindricalProjection::screenCoordinates" );
 
     Q_D( const CylindricalProjection );
     // Compare bounding box size of the line string with the angularResolution
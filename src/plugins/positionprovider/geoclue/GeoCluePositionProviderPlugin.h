@@ -29,7 +29,7 @@ namespace Marble
 class GeoCluePositionProviderPlugin: public PositionProviderPlugin
 {
     Q_OBJECT
-    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.GeoCluePositionProviderPlugin" )
+    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.GeoCluePositionProviderPlugin" FILE "GeoCluePositionProviderPlugin.json" )
     Q_INTERFACES( Marble::PositionProviderPluginInterface )
 
  public:
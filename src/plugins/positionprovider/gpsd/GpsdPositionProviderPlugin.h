@@ -25,7 +25,7 @@ class GpsdThread;
 class GpsdPositionProviderPlugin: public PositionProviderPlugin
 {
     Q_OBJECT
-    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.GpsdPositionProviderPlugin" )
+    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.GpsdPositionProviderPlugin" FILE "GpsdPositionProviderPlugin.json" )
     Q_INTERFACES( Marble::PositionProviderPluginInterface )
 
  public:
@@ -21,7 +21,7 @@ class WlocatePositionProviderPluginPrivate;
 class WlocatePositionProviderPlugin: public PositionProviderPlugin
 {
     Q_OBJECT
-    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.WlocatePositionProviderPlugin" )
+    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.WlocatePositionProviderPlugin" FILE "WlocatePositionProviderPlugin.json" )
     Q_INTERFACES( Marble::PositionProviderPluginInterface )
 
 public:
@@ -43,7 +43,7 @@
 #include "KmlElementDictionary.h"
 #include "MarbleDirs.h"
 #include "MarbleModel.h"
-#include "MarblePlacemarkModel.h"
+#include "PlacemarkRegistry.h"
 #include "MarbleWidget.h"
 #include "AreaAnnotation.h"
 #include "PlacemarkTextAnnotation.h"
@@ -296,11 +296,7 @@ void AnnotatePlugin::removeFocusItem()
 {
     // Ground Overlays will always be a special case..
     if ( m_focusItem->graphicType() == SceneGraphicsTypes::SceneGraphicGroundOverlay ) {
-        for ( int i = 0; i < m_groundOverlayModel.rowCount(); ++i ) {
-            const QModelIndex index = m_groundOverlayModel.index( i, 0 );
-            GeoDataGroundOverlay *overlay = dynamic_cast<GeoDataGroundOverlay*>(
-               qvariant_cast<GeoDataObject*>( index.data( MarblePlacemarkModel::ObjectPointerRole ) ) );
-
+        foreach ( GeoDataGroundOverlay *overlay, m_marbleWidget->model()->placemarkRegistry()->groundOverlays() ) {
             m_marbleWidget->model()->treeModel()->removeFeature( overlay );
         }
 
@@ -420,7 +416,6 @@ bool AnnotatePlugin::eventFilter( QObject *watched, QEvent *event )
             m_marbleWidget = marbleWidget;
 
             addContextItems();
-            setupGroundOverlayModel();
             setupOverlayRmbMenu();
             setupPolygonRmbMenu();
             setupPolylineRmbMenu();
@@ -514,7 +509,8 @@ bool AnnotatePlugin::eventFilter( QObject *watched, QEvent *event )
 
     // It is important to deal with Ground Overlay mouse release event here because it uses the
     // texture layer in order to make the rendering more efficient.
-    if ( mouseEvent->type() == QEvent::MouseButtonRelease && m_groundOverlayModel.rowCount() ) {
+    if ( mouseEvent->type() == QEvent::MouseButtonRelease &&
+         !m_marbleWidget->model()->placemarkRegistry()->groundOverlays().isEmpty() ) {
         handleReleaseOverlay( mouseEvent );
     }
 
@@ -646,11 +642,7 @@ void AnnotatePlugin::handleReleaseOverlay( QMouseEvent *mouseEvent )
                                     GeoDataCoordinates::Radian );
     const GeoDataCoordinates coords( lon, lat );
 
-    for ( int i = 0; i < m_groundOverlayModel.rowCount(); ++i ) {
-        const QModelIndex index = m_groundOverlayModel.index( i, 0 );
-        GeoDataGroundOverlay *overlay = dynamic_cast<GeoDataGroundOverlay*>(
-           qvariant_cast<GeoDataObject*>( index.data( MarblePlacemarkModel::ObjectPointerRole ) ) );
-
+    foreach ( GeoDataGroundOverlay *overlay, m_marbleWidget->model()->placemarkRegistry()->groundOverlays() ) {
         if ( overlay->latLonBox().contains( coords ) ) {
             if ( mouseEvent->button() == Qt::LeftButton ) {
                 displayOverlayFrame( overlay );
@@ -1076,15 +1068,6 @@ void AnnotatePlugin::stopEditingTextAnnotation( int result )
     m_editingDialogIsShown = false;
 }
 
-void AnnotatePlugin::setupGroundOverlayModel()
-{
-    m_editingDialogIsShown = false;
-    m_groundOverlayModel.setSourceModel( m_marbleWidget->model()->groundOverlayModel() );
-    m_groundOverlayModel.setDynamicSortFilter( true );
-    m_groundOverlayModel.setSortRole( MarblePlacemarkModel::PopularityIndexRole );
-    m_groundOverlayModel.sort( 0, Qt::AscendingOrder );
-}
-
 void AnnotatePlugin::setupOverlayRmbMenu()
 {
     QAction *editOverlay = new QAction( tr( "Properties" ), m_overlayRmbMenu );
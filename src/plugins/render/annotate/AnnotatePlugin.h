@@ -21,7 +21,6 @@
 
 #include <QObject>
 #include <QMenu>
-#include <QSortFilterProxyModel>
 
 
 class QNetworkAccessManager;
@@ -47,7 +46,7 @@ class PlacemarkTextAnnotation;
 class AnnotatePlugin :  public RenderPlugin
 {
     Q_OBJECT
-    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.AnnotatePlugin" )
+    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.AnnotatePlugin" FILE "AnnotatePlugin.json" )
     Q_INTERFACES( Marble::RenderPluginInterface )
     MARBLE_PLUGIN( AnnotatePlugin )
 
@@ -143,7 +142,6 @@ private:
     void setupTextAnnotationRmbMenu();
     void showTextAnnotationRmbMenu( qreal x, qreal y );
 
-    void setupGroundOverlayModel();
     void setupOverlayRmbMenu();
     void showOverlayRmbMenu( GeoDataGroundOverlay *overlay, qreal x, qreal y );
     void displayOverlayFrame( GeoDataGroundOverlay *overlay );
@@ -183,7 +181,6 @@ private:
     QMenu *m_polylineRmbMenu;
 
     QList<QActionGroup*> m_actions;
-    QSortFilterProxyModel m_groundOverlayModel;
     QMap<GeoDataGroundOverlay*, SceneGraphicsItem*> m_groundOverlayFrames;
 
     GeoDataDocument* m_annotationDocument;
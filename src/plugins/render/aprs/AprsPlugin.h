@@ -38,7 +38,7 @@ namespace Marble
     class AprsPlugin : public RenderPlugin, public DialogConfigurationInterface
     {
         Q_OBJECT
-    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.AprsPlugin" )
+    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.AprsPlugin" FILE "AprsPlugin.json" )
         Q_INTERFACES( Marble::RenderPluginInterface )
         Q_INTERFACES( Marble::DialogConfigurationInterface )
         MARBLE_PLUGIN( AprsPlugin )
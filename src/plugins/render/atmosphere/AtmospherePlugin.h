@@ -20,7 +20,7 @@ namespace Marble
 class AtmospherePlugin : public RenderPlugin
 {
     Q_OBJECT
-    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.AtmospherePlugin" )
+    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.AtmospherePlugin" FILE "AtmospherePlugin.json" )
     Q_INTERFACES( Marble::RenderPluginInterface )
     MARBLE_PLUGIN( AtmospherePlugin )
 
@@ -33,7 +33,7 @@ namespace Marble
 class CompassFloatItem  : public AbstractFloatItem, public DialogConfigurationInterface
 {
     Q_OBJECT
-    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.CompassFloatItem" )
+    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.CompassFloatItem" FILE "CompassFloatItem.json" )
     Q_INTERFACES( Marble::RenderPluginInterface )
     Q_INTERFACES( Marble::DialogConfigurationInterface )
     MARBLE_PLUGIN( CompassFloatItem )
@@ -39,7 +39,7 @@ namespace Marble
 class CrosshairsPlugin : public RenderPlugin, public DialogConfigurationInterface
 {
     Q_OBJECT
-    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.CrosshairsPlugin" )
+    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.CrosshairsPlugin" FILE "CrosshairsPlugin.json" )
     Q_INTERFACES( Marble::RenderPluginInterface )
     Q_INTERFACES( Marble::DialogConfigurationInterface )
     MARBLE_PLUGIN(CrosshairsPlugin)
@@ -12,12 +12,13 @@
 
 #include "MarbleDebug.h"
 
+#include <QDataStream>
 #include <QIcon>
 
 namespace Marble
 {
 
-EclipsesItem::EclipsesItem( EclSolar *ecl, int index, QObject *parent )
+EclipsesItem::EclipsesItem( const EclSolar &ecl, int index, QObject *parent )
     : QObject( parent ),
       m_ecl( ecl ),
       m_index( index ),
@@ -36,6 +37,23 @@ EclipsesItem::EclipsesItem( EclSolar *ecl, int index, QObject *parent )
     initialize();
 }
 
+EclipsesItem::EclipsesItem( QObject *parent )
+    : QObject( parent ),
+      m_index( 0 ),
+      m_calculationsNeedUpdate( true ),
+      m_isTotal( false ),
+      m_phase( TotalSun ),
+      m_magnitude( 0. ),
+      m_centralLine(Tessellate),
+      m_umbra( Tessellate ),
+      m_southernPenumbra( Tessellate ),
+      m_northernPenumbra( Tessellate ),
+      m_shadowConeUmbra( Tessellate ),
+      m_shadowConePenumbra( Tessellate ),
+      m_shadowCone60MagPenumbra( Tessellate )
+{
+}
+
 EclipsesItem::~EclipsesItem()
 {
 }
@@ -219,7 +237,7 @@ void EclipsesItem::initialize()
     int year, month, day, hour, min, phase;
     double secs, tz;
 
-    phase = m_ecl->getEclYearInfo( m_index, year, month, day,
+    phase = m_ecl.getEclYearInfo( m_index, year, month, day,
                                             hour, min, secs,
                                             tz, m_magnitude );
 
@@ -246,14 +264,14 @@ void EclipsesItem::initialize()
     // get global start/end date of eclipse
 
     double mjd_start, mjd_end;
-    m_ecl->putEclSelect( m_index );
+    m_ecl.putEclSelect( m_index );
 
-    if( m_ecl->getPartial( mjd_start, mjd_end ) != 0 ) {
-        m_ecl->getDatefromMJD( mjd_start, year, month, day, hour, min, secs );
+    if( m_ecl.getPartial( mjd_start, mjd_end ) != 0 ) {
+        m_ecl.getDatefromMJD( mjd_start, year, month, day, hour, min, secs );
         m_startDatePartial = QDateTime( QDate( year, month, day ),
                                         QTime( hour, min, secs ),
                                         Qt::LocalTime );
-        m_ecl->getDatefromMJD( mjd_end, year, month, day, hour, min, secs );
+        m_ecl.getDatefromMJD( mjd_end, year, month, day, hour, min, secs );
         m_endDatePartial = QDateTime( QDate( year, month, day ),
                                       QTime( hour, min, secs ),
                                       Qt::LocalTime );
@@ -263,13 +281,13 @@ void EclipsesItem::initialize()
         m_endDatePartial = m_dateMaximum;
     }
 
-    m_isTotal = ( m_ecl->getTotal( mjd_start, mjd_end ) != 0 );
+    m_isTotal = ( m_ecl.getTotal( mjd_start, mjd_end ) != 0 );
     if( m_isTotal ) {
-        m_ecl->getDatefromMJD( mjd_start, year, month, day, hour, min, secs );
+        m_ecl.getDatefromMJD( mjd_start, year, month, day, hour, min, secs );
         m_startDateTotal = QDateTime( QDate( year, month, day ),
                                       QTime( hour, min, secs ),
                                       Qt::LocalTime );
-        m_ecl->getDatefromMJD( mjd_end, year, month, day, hour, min, secs );
+        m_ecl.getDatefromMJD( mjd_end, year, month, day, hour, min, secs );
         m_endDateTotal = QDateTime( QDate( year, month, day ),
                                     QTime( hour, min, secs ),
                                     Qt::LocalTime );
@@ -285,17 +303,17 @@ void EclipsesItem::calculate()
     double lat1, lng1, lat2, lng2, lat3, lng3, lat4, lng4;
     double ltf[60], lnf[60];
 
-    m_ecl->putEclSelect( m_index );
+    m_ecl.putEclSelect( m_index );
 
     // FIXME: set observer location
-    m_ecl->getMaxPos( lat1, lng1 );
-    m_ecl->setLocalPos( lat1, lng1, 0 );
+    m_ecl.getMaxPos( lat1, lng1 );
+    m_ecl.setLocalPos( lat1, lng1, 0 );
 
     // eclipse's maximum location
     m_maxLocation = GeoDataCoordinates( lng1, lat1, 0., GeoDataCoordinates::Degree );
 
     // calculate central line
-    np = m_ecl->eclPltCentral( true, lat1, lng1 );
+    np = m_ecl.eclPltCentral( true, lat1, lng1 );
     kp = np;
     m_centralLine.clear();
     m_centralLine << GeoDataCoordinates( GeoDataCoordinates::normalizeLon(lng1, GeoDataCoordinates::Degree),
@@ -304,7 +322,7 @@ void EclipsesItem::calculate()
 
     if( np > 3 ) { // central eclipse
         while( np > 3 ) {
-            np = m_ecl->eclPltCentral( false, lat1, lng1 );
+            np = m_ecl.eclPltCentral( false, lat1, lng1 );
             if( np > 3 ) {
                 m_centralLine << GeoDataCoordinates( GeoDataCoordinates::normalizeLon(lng1, GeoDataCoordinates::Degree),
                                                      GeoDataCoordinates::normalizeLon(lat1, GeoDataCoordinates::Degree),
@@ -318,7 +336,7 @@ void EclipsesItem::calculate()
     m_umbra.clear();
     if( np > 3 ) { // total or annual eclipse
         // northern /southern boundaries of umbra
-        np = m_ecl->centralBound( true, lat1, lng1, lat2, lng2 );
+        np = m_ecl.centralBound( true, lat1, lng1, lat2, lng2 );
 
         GeoDataLinearRing lowerUmbra( Tessellate ), upperUmbra( Tessellate );
         lowerUmbra << GeoDataCoordinates( GeoDataCoordinates::normalizeLon(lng1, GeoDataCoordinates::Degree),
@@ -329,7 +347,7 @@ void EclipsesItem::calculate()
                                           0., GeoDataCoordinates::Degree );
 
         while( np > 0 ) {
-            np = m_ecl->centralBound( false, lat1, lng1, lat2, lng2 );
+            np = m_ecl.centralBound( false, lat1, lng1, lat2, lng2 );
             if( lat1 <= 90. ) {
                 lowerUmbra << GeoDataCoordinates( GeoDataCoordinates::normalizeLon(lng1, GeoDataCoordinates::Degree),
                                                   GeoDataCoordinates::normalizeLon(lat1, GeoDataCoordinates::Degree),
@@ -358,9 +376,9 @@ void EclipsesItem::calculate()
     m_shadowConePenumbra.clear();
     m_shadowCone60MagPenumbra.clear();
 
-    m_ecl->getLocalMax( lat2, lat3, lat4 );
+    m_ecl.getLocalMax( lat2, lat3, lat4 );
 
-    m_ecl->getShadowCone( lat2, true, 40, ltf, lnf );
+    m_ecl.getShadowCone( lat2, true, 40, ltf, lnf );
     for( j = 0; j < 40; ++j ) {
         if( ltf[j] < 100. ) {
             m_shadowConeUmbra << GeoDataCoordinates( GeoDataCoordinates::normalizeLon(lnf[j], GeoDataCoordinates::Degree),
@@ -369,8 +387,8 @@ void EclipsesItem::calculate()
         }
     }
 
-    m_ecl->setPenumbraAngle( 1., 0 );
-    m_ecl->getShadowCone( lat2, false, 60, ltf, lnf );
+    m_ecl.setPenumbraAngle( 1., 0 );
+    m_ecl.getShadowCone( lat2, false, 60, ltf, lnf );
     for( j = 0; j < 60; ++j ) {
         if( ltf[j] < 100. ) {
             m_shadowConePenumbra << GeoDataCoordinates( GeoDataCoordinates::normalizeLon(lnf[j], GeoDataCoordinates::Degree),
@@ -379,8 +397,8 @@ void EclipsesItem::calculate()
         }
     }
 
-    m_ecl->setPenumbraAngle( 0.6, 1 );
-    m_ecl->getShadowCone( lat2, false, 60, ltf, lnf );
+    m_ecl.setPenumbraAngle( 0.6, 1 );
+    m_ecl.getShadowCone( lat2, false, 60, ltf, lnf );
     for( j = 0; j < 60; ++j ) {
         if( ltf[j] < 100. ) {
             m_shadowCone60MagPenumbra << GeoDataCoordinates( GeoDataCoordinates::normalizeLon(lnf[j], GeoDataCoordinates::Degree),
@@ -389,15 +407,15 @@ void EclipsesItem::calculate()
         }
     }
 
-    m_ecl->setPenumbraAngle( 1., 0 );
+    m_ecl.setPenumbraAngle( 1., 0 );
 
     // eclipse boundaries
     m_southernPenumbra.clear();
     m_northernPenumbra.clear();
 
-    np = m_ecl->GNSBound( true, true, lat1, lng2 );
+    np = m_ecl.GNSBound( true, true, lat1, lng2 );
     while( np > 0 ) {
-        np = m_ecl->GNSBound( false, true, lat1, lng1 );
+        np = m_ecl.GNSBound( false, true, lat1, lng1 );
         if( ( np > 0 ) && ( lat1 <= 90. ) ) {
             m_southernPenumbra << GeoDataCoordinates( GeoDataCoordinates::normalizeLon(lng1, GeoDataCoordinates::Degree),
                                                       GeoDataCoordinates::normalizeLon(lat1, GeoDataCoordinates::Degree),
@@ -405,9 +423,9 @@ void EclipsesItem::calculate()
         }
     }
 
-    np = m_ecl->GNSBound( true, false, lat1, lng1 );
+    np = m_ecl.GNSBound( true, false, lat1, lng1 );
     while( np > 0 ) {
-        np = m_ecl->GNSBound( false, false, lat1, lng1 );
+        np = m_ecl.GNSBound( false, false, lat1, lng1 );
         if( ( np > 0 ) && ( lat1 <= 90. ) ) {
             m_northernPenumbra << GeoDataCoordinates( GeoDataCoordinates::normalizeLon(lng1, GeoDataCoordinates::Degree),
                                                       GeoDataCoordinates::normalizeLon(lat1, GeoDataCoordinates::Degree),
@@ -418,7 +436,7 @@ void EclipsesItem::calculate()
     // sunrise / sunset boundaries
 
     QList<GeoDataLinearRing*> sunBoundaries;
-    np = m_ecl->GRSBound( true, lat1, lng1, lat3, lng3 );
+    np = m_ecl.GRSBound( true, lat1, lng1, lat3, lng3 );
 
     GeoDataLinearRing *lowerBoundary = new GeoDataLinearRing( Tessellate );
     *lowerBoundary << GeoDataCoordinates( GeoDataCoordinates::normalizeLon(lng1, GeoDataCoordinates::Degree),
@@ -433,7 +451,7 @@ void EclipsesItem::calculate()
     m_sunBoundaries.clear();
 
     while ( np > 0 ) {
-        np = m_ecl->GRSBound( false, lat2, lng2, lat4, lng4 );
+        np = m_ecl.GRSBound( false, lat2, lng2, lat4, lng4 );
         bool pline = fabs( lng1 - lng2 ) < 10.; // during partial eclipses, the Rise/Set
                                                 // lines switch at one stage.
                                                 // This will prevent an ugly line between
@@ -557,6 +575,67 @@ void EclipsesItem::calculate()
     m_calculationsNeedUpdate = false;
 }
 
+void EclipsesItem::pack( QDataStream &stream ) const
+{
+    Q_ASSERT( !m_calculationsNeedUpdate );
+
+    stream << qint32( m_index ) << m_isTotal << qint32( m_phase ) << m_magnitude;
+    stream << m_dateMaximum << m_startDatePartial << m_endDatePartial
+           << m_startDateTotal << m_endDateTotal;
+
+    m_maxLocation.pack( stream );
+    m_centralLine.pack( stream );
+    m_umbra.pack( stream );
+    m_southernPenumbra.pack( stream );
+    m_northernPenumbra.pack( stream );
+    m_shadowConeUmbra.pack( stream );
+    m_shadowConePenumbra.pack( stream );
+    m_shadowCone60MagPenumbra.pack( stream );
+
+    stream << qint32( m_sunBoundaries.size() );
+    foreach( const GeoDataLinearRing &boundary, m_sunBoundaries ) {
+        boundary.pack( stream );
+    }
+}
+
+void EclipsesItem::unpack( QDataStream &stream )
+{
+    qint32 index, phase;
+    stream >> index >> m_isTotal >> phase >> m_magnitude;
+    m_index = index;
+    m_phase = EclipsesItem::EclipsePhase( phase );
+    stream >> m_dateMaximum >> m_startDatePartial >> m_endDatePartial
+           >> m_startDateTotal >> m_endDateTotal;
+
+    m_maxLocation.unpack( stream );
+    m_centralLine.clear();
+    m_centralLine.unpack( stream );
+    m_umbra.clear();
+    m_umbra.unpack( stream );
+    m_southernPenumbra.clear();
+    m_southernPenumbra.unpack( stream );
+    m_northernPenumbra.clear();
+    m_northernPenumbra.unpack( stream );
+    m_shadowConeUmbra.clear();
+    m_shadowConeUmbra.unpack( stream );
+    m_shadowConePenumbra.clear();
+    m_shadowConePenumbra.unpack( stream );
+    m_shadowCone60MagPenumbra.clear();
+    m_shadowCone60MagPenumbra.unpack( stream );
+
+    qint32 count;
+    stream >> count;
+    m_sunBoundaries.clear();
+    for( int i = 0; i < count && stream.status() == QDataStream::Ok; ++i ) {
+        GeoDataLinearRing boundary( Tessellate );
+        boundary.unpack( stream );
+        m_sunBoundaries << boundary;
+    }
+
+    // the backend is not set up for this eclipse
+    m_calculationsNeedUpdate = false;
+}
+
 } // Namespace Marble
 
 #include "EclipsesItem.moc"
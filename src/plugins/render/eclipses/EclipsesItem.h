@@ -20,6 +20,8 @@
 
 #include <eclsolar.h>
 
+class QDataStream;
+
 namespace Marble
 {
 
@@ -31,8 +33,9 @@ namespace Marble
  * Expensive calculations like boundary polygons are done the first time
  * they are requested.
  *
- * The calculations are done using the eclsolar backend that has to be
- * passed to the constructor.
+ * The calculations are done using a copy of the eclsolar backend that is
+ * passed to the constructor. Since items do not share a backend, different
+ * items may be calculated in different threads at the same time.
  */
 class EclipsesItem : public QObject
 {
@@ -57,10 +60,16 @@ public:
 
     /**
      * @brief Construct the EclipseItem object and trigger basic calculations
-     * @param ecl The EclSolar backend
+     * @param ecl The EclSolar backend, set up for the year of the eclipse
      * @param parent The parent object
      */
-    explicit EclipsesItem( EclSolar *ecl, int index, QObject *parent = 0 );
+    explicit EclipsesItem( const EclSolar &ecl, int index, QObject *parent = 0 );
+
+    /**
+     * @brief Construct an empty EclipseItem object to be filled by unpack()
+     * @param parent The parent object
+     */
+    explicit EclipsesItem( QObject *parent = 0 );
 
     ~EclipsesItem();
 
@@ -219,6 +228,30 @@ public:
      */
     GeoDataLinearRing shadowCone60MagPenumbra();
 
+    /**
+     * @brief Do detailed calculations
+     *
+     * Do the expensive calculations (like shadow cones) for this eclipse
+     * event. This is normally called on the first request of such data,
+     * but can be called in advance from a worker thread as long as the
+     * item is not used elsewhere meanwhile.
+     */
+    void calculate();
+
+    /**
+     * @brief Serialize the item including its detailed calculations
+     * @param stream The stream to write to
+     * @see unpack
+     */
+    void pack( QDataStream &stream ) const;
+
+    /**
+     * @brief Restore an item serialized by pack()
+     * @param stream The stream to read from
+     * @see pack
+     */
+    void unpack( QDataStream &stream );
+
 private:
     /**
      * @brief Initialize the eclipse item
@@ -230,15 +263,7 @@ private:
      */
     void initialize();
 
-    /**
-     * @brief Do detailed calculations
-     *
-     * Do the expensive calculations (like shadow cones) for this eclipse
-     * event. This is normally called on the first request of such data.
-     */
-    void calculate();
-
-    EclSolar *m_ecl;
+    EclSolar m_ecl;
     int m_index;
     bool m_calculationsNeedUpdate;
     bool m_isTotal;
@@ -13,22 +13,111 @@
 #include "EclipsesItem.h"
 #include "MarbleDebug.h"
 #include "MarbleClock.h"
+#include "MarbleDirs.h"
 
 #include <eclsolar.h>
 
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
 #include <QIcon>
+#include <QMutexLocker>
+#include <QRunnable>
+
+#include <algorithm>
 
 namespace Marble
 {
 
+namespace
+{
+
+const quint32 CacheMagic = 0x45434c53;
+const qint32 CacheVersion = 1;
+
+bool itemIndexLessThan( const EclipsesItem *a, const EclipsesItem *b )
+{
+    return a->index() < b->index();
+}
+
+}
+
+/**
+ * Calculates the eclipses of a year and starts an EclipseJob for each
+ */
+class EclipsesModel::YearJob : public QRunnable
+{
+public:
+    YearJob( EclipsesModel *model, const EclSolar &ecl, int generation ) :
+        m_model( model ),
+        m_ecl( ecl ),
+        m_generation( generation )
+    {
+    }
+
+    virtual void run()
+    {
+        if ( !m_model->isCurrent( m_generation ) ) {
+            return;
+        }
+
+        const int count = m_ecl.getNumberEclYear();
+        m_model->setItemCount( m_generation, count );
+        for( int i = 1; i <= count; ++i ) {
+            m_model->m_threadPool.start( new EclipseJob( m_model, m_ecl, i, m_generation ) );
+        }
+    }
+
+private:
+    EclipsesModel *const m_model;
+    EclSolar m_ecl;
+    const int m_generation;
+};
+
+/**
+ * Creates the item of a single eclipse including its detailed calculations
+ */
+class EclipsesModel::EclipseJob : public QRunnable
+{
+public:
+    EclipseJob( EclipsesModel *model, const EclSolar &ecl, int index, int generation ) :
+        m_model( model ),
+        m_ecl( ecl ),
+        m_index( index ),
+        m_generation( generation )
+    {
+    }
+
+    virtual void run()
+    {
+        if ( !m_model->isCurrent( m_generation ) ) {
+            return;
+        }
+
+        EclipsesItem *item = new EclipsesItem( m_ecl, m_index );
+        item->calculate();
+        m_model->addCalculatedItem( m_generation, item );
+    }
+
+private:
+    EclipsesModel *const m_model;
+    const EclSolar m_ecl;
+    const int m_index;
+    const int m_generation;
+};
+
 EclipsesModel::EclipsesModel( const MarbleModel *model, QObject *parent )
     : QAbstractItemModel( parent ),
       m_marbleModel( model ),
       m_currentYear( 0 ),
-      m_withLunarEclipses( false )
+      m_withLunarEclipses( false ),
+      m_timezone( model->clock()->timezone() ),
+      m_generation( 0 ),
+      m_itemCount( -1 )
 {
     m_ecl = new EclSolar();
-    m_ecl->setTimezone( model->clock()->timezone() / 3600. );
+    m_ecl->setTimezone( m_timezone / 3600. );
     m_ecl->setLunarEcl( m_withLunarEclipses );
 
     // oberservation point defaults to home location
@@ -41,6 +130,13 @@ EclipsesModel::EclipsesModel( const MarbleModel *model, QObject *parent )
 
 EclipsesModel::~EclipsesModel()
 {
+    {
+        QMutexLocker locker( &m_calculationMutex );
+        ++m_generation;
+    }
+    m_threadPool.waitForDone();
+    qDeleteAll( m_calculatedItems );
+
     clear();
     delete m_ecl;
 }
@@ -176,11 +272,6 @@ QVariant EclipsesModel::headerData( int section, Qt::Orientation orientation,
     return QVariant();
 }
 
-void EclipsesModel::addItem( EclipsesItem *item )
-{
-    m_items.append( item );
-}
-
 void EclipsesModel::clear()
 {
     beginResetModel();
@@ -195,15 +286,150 @@ void EclipsesModel::update()
 {
     clear();
 
-    beginInsertRows( QModelIndex(), 0, rowCount() );
+    int generation;
+    {
+        QMutexLocker locker( &m_calculationMutex );
+        generation = ++m_generation;
+        m_itemCount = -1;
+        qDeleteAll( m_calculatedItems );
+        m_calculatedItems.clear();
+    }
+
+    if( loadCache() ) {
+        return;
+    }
+
+    // the eclipses of the year are calculated on the copy of the backend
+    m_threadPool.start( new YearJob( this, *m_ecl, generation ) );
+}
+
+bool EclipsesModel::isCurrent( int generation ) const
+{
+    QMutexLocker locker( &m_calculationMutex );
+    return generation == m_generation;
+}
+
+void EclipsesModel::setItemCount( int generation, int count )
+{
+    {
+        QMutexLocker locker( &m_calculationMutex );
+        if( generation != m_generation ) {
+            return;
+        }
+        m_itemCount = count;
+    }
+
+    QMetaObject::invokeMethod( this, "collectItems", Qt::QueuedConnection );
+}
+
+void EclipsesModel::addCalculatedItem( int generation, EclipsesItem *item )
+{
+    {
+        QMutexLocker locker( &m_calculationMutex );
+        if( generation == m_generation ) {
+            item->moveToThread( thread() );
+            m_calculatedItems << item;
+            item = 0;
+        }
+    }
 
-    int num = m_ecl->getNumberEclYear();
-    for( int i = 1; i <= num; ++i ) {
-        EclipsesItem *item = new EclipsesItem( m_ecl, i );
-        addItem( item );
+    if( item ) {
+        // outdated, the item still belongs to the calling thread
+        delete item;
+        return;
+    }
+
+    QMetaObject::invokeMethod( this, "collectItems", Qt::QueuedConnection );
+}
+
+void EclipsesModel::collectItems()
+{
+    QList<EclipsesItem*> items;
+    {
+        QMutexLocker locker( &m_calculationMutex );
+        if( m_itemCount < 0 || m_calculatedItems.size() < m_itemCount ) {
+            return;
+        }
+        items = m_calculatedItems;
+        m_calculatedItems.clear();
+        m_itemCount = -1;
     }
 
-    endInsertRows();
+    std::sort( items.begin(), items.end(), itemIndexLessThan );
+
+    beginResetModel();
+    qDeleteAll( m_items );
+    m_items = items;
+    endResetModel();
+
+    saveCache();
+}
+
+QString EclipsesModel::cacheFileName() const
+{
+    return MarbleDirs::localPath() + "/cache/eclipses/" +
+           QString( "%1-%2-%3.dat" ).arg( m_currentYear )
+                                    .arg( m_withLunarEclipses ? "all" : "solar" )
+                                    .arg( m_timezone );
+}
+
+bool EclipsesModel::loadCache()
+{
+    QFile file( cacheFileName() );
+    if( !file.open( QIODevice::ReadOnly ) ) {
+        return false;
+    }
+
+    QDataStream stream( &file );
+    stream.setVersion( QDataStream::Qt_4_2 );
+
+    quint32 magic;
+    qint32 version;
+    qint32 count;
+    stream >> magic >> version >> count;
+    if( magic != CacheMagic || version != CacheVersion || stream.status() != QDataStream::Ok ) {
+        mDebug() << "Ignoring invalid eclipses cache" << file.fileName();
+        return false;
+    }
+
+    QList<EclipsesItem*> items;
+    for( int i = 0; i < count && stream.status() == QDataStream::Ok; ++i ) {
+        EclipsesItem *item = new EclipsesItem;
+        item->unpack( stream );
+        items << item;
+    }
+
+    if( stream.status() != QDataStream::Ok ) {
+        mDebug() << "Ignoring truncated eclipses cache" << file.fileName();
+        qDeleteAll( items );
+        return false;
+    }
+
+    beginResetModel();
+    m_items = items;
+    endResetModel();
+
+    return true;
+}
+
+void EclipsesModel::saveCache() const
+{
+    const QString fileName = cacheFileName();
+    QDir().mkpath( QFileInfo( fileName ).absolutePath() );
+
+    QFile file( fileName );
+    if( !file.open( QIODevice::WriteOnly ) ) {
+        mDebug() << "Unable to write eclipses cache" << fileName;
+        return;
+    }
+
+    QDataStream stream( &file );
+    stream.setVersion( QDataStream::Qt_4_2 );
+
+    stream << CacheMagic << CacheVersion << qint32( m_items.size() );
+    foreach( const EclipsesItem *item, m_items ) {
+        item->pack( stream );
+    }
 }
 
 } // namespace Marble
@@ -13,7 +13,9 @@
 
 #include <QAbstractItemModel>
 #include <QDateTime>
+#include <QMutex>
 #include <QPixmap>
+#include <QThreadPool>
 
 #include "GeoDataCoordinates.h"
 #include "MarbleModel.h"
@@ -32,6 +34,12 @@ class EclipsesItem;
  * of this class hold EclipseItem objects for every eclipse event of a given
  * year. Furthermore, it implements QTs AbstractItemModel interface and can
  * be used with QTs view classes.
+ *
+ * The eclipses of a year are calculated in worker threads, one eclipse per
+ * job, each with its own copy of the backend. The model is reset with the
+ * complete list of items once all of them are calculated. The results are
+ * cached on disk per year, so later requests for the same year are served
+ * without calculating again.
  */
 class EclipsesModel : public QAbstractItemModel
 {
@@ -72,7 +80,8 @@ public:
      * @param year The year
      *
      * Sets the year to @p year. This clears all items in the model and
-     * fills it with all eclipse items for the given year.
+     * fills it with all eclipse items for the given year, either right away
+     * from the disk cache or after calculating them in the background.
      *
      * @see year
      */
@@ -150,29 +159,58 @@ public Q_SLOTS:
      * This forces an update of the current list of eclipse items by
      * calculating all eclipse events for the currently set year and
      * adding them to the model. All previously added items are
-     * cleared before.
+     * cleared before. Calculations still running for a previous update
+     * are discarded.
      *
      * @see clear
      */
     void update();
 
+private Q_SLOTS:
+    /**
+     * @brief Add the calculated items to the model once all are done
+     */
+    void collectItems();
+
 private:
+    class YearJob;
+    class EclipseJob;
+
     /**
-     * @brief Add an item to the model
-     * @param item the item to add
+     * @brief Return whether @p generation is the one of the latest update
      *
-     * Adds @p item to the model.
+     * May be called from any thread.
+     */
+    bool isCurrent( int generation ) const;
+
+    /**
+     * @brief Set the number of items the update @p generation calculates
      *
-     * @see clear
+     * May be called from any thread.
+     */
+    void setItemCount( int generation, int count );
+
+    /**
+     * @brief Hand over an item calculated for the update @p generation
+     *
+     * Takes ownership of @p item. May be called from any thread.
+     */
+    void addCalculatedItem( int generation, EclipsesItem *item );
+
+    QString cacheFileName() const;
+
+    /**
+     * @brief Fill the model from the disk cache of the current year
+     * @return true if the cache was found and read
      */
-    void addItem( EclipsesItem *item );
+    bool loadCache();
+
+    void saveCache() const;
 
     /**
      * @brief Clears all items
      *
      * Clear the model by removing all items.
-     *
-     * @see addItem
      */
     void clear();
 
@@ -181,7 +219,15 @@ private:
     QList<EclipsesItem*> m_items;
     int m_currentYear;
     bool m_withLunarEclipses;
+    int m_timezone;
     GeoDataCoordinates m_observationPoint;
+
+    QThreadPool m_threadPool;
+    mutable QMutex m_calculationMutex;
+    // guarded by m_calculationMutex
+    int m_generation;
+    int m_itemCount;
+    QList<EclipsesItem*> m_calculatedItems;
 };
 
 }
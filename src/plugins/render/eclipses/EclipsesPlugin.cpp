@@ -40,6 +40,7 @@ EclipsesPlugin::EclipsesPlugin()
       m_eclipsesMenuAction( 0 ),
       m_eclipsesListMenu( 0 ),
       m_menuYear( 0 ),
+      m_pendingEclipseIndex( 0 ),
       m_configDialog( 0 ),
       m_configWidget( 0 ),
       m_browserDialog( 0 ),
@@ -57,6 +58,7 @@ EclipsesPlugin::EclipsesPlugin( const MarbleModel *marbleModel )
      m_eclipsesMenuAction( 0 ),
      m_eclipsesListMenu( 0 ),
      m_menuYear( 0 ),
+     m_pendingEclipseIndex( 0 ),
      m_configDialog( 0 ),
      m_configWidget( 0 ),
      m_browserDialog( 0 ),
@@ -203,6 +205,8 @@ void EclipsesPlugin::initialize()
 
     // initialize eclipses model
     m_model = new EclipsesModel( marbleModel() );
+    connect( m_model, SIGNAL(modelReset()),
+             this, SLOT(updateMenu()) );
 
     connect( marbleModel()->clock(), SIGNAL(timeChanged()),
              this, SLOT(updateEclipses()) );
@@ -430,13 +434,9 @@ void EclipsesPlugin::updateEclipses()
 
     if( ( m_menuYear != year ) || ( m_model->withLunarEclipses() != lun ) ) {
 
-        // remove old menus
-        foreach( QAction *action, m_eclipsesListMenu->actions() ) {
-            m_eclipsesListMenu->removeAction( action );
-            delete action;
-        }
-
-        // update year and create menus for this year's eclipse events
+        // update year, the menus for this year's eclipse events are created
+        // by updateMenu() once they are calculated
+        m_eclipsesListMenu->setTitle( tr("Eclipses in %1").arg( year ) );
         if( m_model->year() != year ) {
             m_model->setYear( year );
         }
@@ -446,17 +446,29 @@ void EclipsesPlugin::updateEclipses()
         if( m_model->withLunarEclipses() != lun ) {
             m_model->setWithLunarEclipses( lun );
         }
+    }
+}
 
-        m_eclipsesListMenu->setTitle( tr("Eclipses in %1").arg( year ) );
+void EclipsesPlugin::updateMenu()
+{
+    // remove old menus
+    foreach( QAction *action, m_eclipsesListMenu->actions() ) {
+        m_eclipsesListMenu->removeAction( action );
+        delete action;
+    }
 
-        foreach( EclipsesItem *item, m_model->items() ) {
-            QAction *action = m_eclipsesListMenu->addAction(
-                        item->dateMaximum().date().toString() );
-            action->setData( QVariant( 1000 * item->dateMaximum().date().year() +  item->index() ) );
-            action->setIcon( item->icon() );
-        }
+    foreach( EclipsesItem *item, m_model->items() ) {
+        QAction *action = m_eclipsesListMenu->addAction(
+                    item->dateMaximum().date().toString() );
+        action->setData( QVariant( 1000 * item->dateMaximum().date().year() +  item->index() ) );
+        action->setIcon( item->icon() );
+    }
+
+    emit actionGroupsChanged();
+    emit repaintNeeded();
 
-        emit actionGroupsChanged();
+    if( m_pendingEclipseIndex > 0 && m_model->eclipseWithIndex( m_pendingEclipseIndex ) ) {
+        showEclipse( m_model->year(), m_pendingEclipseIndex );
     }
 }
 
@@ -482,12 +494,15 @@ void EclipsesPlugin::showEclipse( int year, int index )
     }
 
     EclipsesItem *item = m_model->eclipseWithIndex( index );
-    Q_ASSERT( item );
-
-    if( item ) {
-        m_marbleWidget->model()->clock()->setDateTime( item->dateMaximum() );
-        m_marbleWidget->centerOn( item->maxLocation() );
+    if( !item ) {
+        // shown by updateMenu() once the eclipses of the year are calculated
+        m_pendingEclipseIndex = index;
+        return;
     }
+    m_pendingEclipseIndex = 0;
+
+    m_marbleWidget->model()->clock()->setDateTime( item->dateMaximum() );
+    m_marbleWidget->centerOn( item->maxLocation() );
 }
 
 void EclipsesPlugin::showEclipseFromMenu( QAction *action )
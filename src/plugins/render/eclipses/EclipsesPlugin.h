@@ -41,7 +41,7 @@ class EclipsesPlugin : public RenderPlugin,
                        public DialogConfigurationInterface
 {
     Q_OBJECT
-    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.EclipsesPlugin" )
+    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.EclipsesPlugin" FILE "EclipsesPlugin.json" )
 
     Q_INTERFACES( Marble::RenderPluginInterface )
     Q_INTERFACES( Marble::DialogConfigurationInterface )
@@ -127,6 +127,15 @@ private Q_SLOTS:
      */
     void updateMenuItemState();
 
+    /**
+     * @brief Update the menu of eclipses
+     *
+     * Fills the menu with the eclipses currently in the model. Called
+     * whenever the model has been reset, e.g. when the eclipses of a new
+     * year have been calculated.
+     */
+    void updateMenu();
+
 private:
     bool renderItem( GeoPainter *painter, EclipsesItem *item ) const;
 
@@ -142,6 +151,7 @@ private:
     QAction *m_eclipsesMenuAction;
     QMenu *m_eclipsesListMenu;
     int m_menuYear;
+    int m_pendingEclipseIndex;
 
     // dialogs
     QDialog *m_configDialog;
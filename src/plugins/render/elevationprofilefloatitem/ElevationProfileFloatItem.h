@@ -48,7 +48,7 @@ class RoutingModel;
 class ElevationProfileFloatItem : public AbstractFloatItem, public DialogConfigurationInterface
 {
     Q_OBJECT
-    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.ElevationProfileFloatItem" )
+    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.ElevationProfileFloatItem" FILE "ElevationProfileFloatItem.json" )
 
     Q_INTERFACES( Marble::RenderPluginInterface )
     Q_INTERFACES( Marble::DialogConfigurationInterface )
@@ -27,7 +27,7 @@ class GeoDataPlacemark;
 class ElevationProfileMarker : public RenderPlugin
 {
     Q_OBJECT
-    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.ElevationProfileMarker" )
+    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.ElevationProfileMarker" FILE "ElevationProfileMarker.json" )
 
     Q_INTERFACES( Marble::RenderPluginInterface )
 
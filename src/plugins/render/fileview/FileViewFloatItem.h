@@ -31,7 +31,7 @@ class MarbleWidget;
 class FileViewFloatItem: public AbstractFloatItem
 {
     Q_OBJECT
-    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.FileViewFloatItem" )
+    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.FileViewFloatItem" FILE "FileViewFloatItem.json" )
     Q_INTERFACES( Marble::RenderPluginInterface )
     MARBLE_PLUGIN(FileViewFloatItem)
 
@@ -37,7 +37,7 @@ class MarbleLocale;
 class GpsInfo : public AbstractFloatItem
 {
     Q_OBJECT
-    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.GpsInfo" )
+    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.GpsInfo" FILE "GpsInfo.json" )
     Q_INTERFACES( Marble::RenderPluginInterface )
     MARBLE_PLUGIN( GpsInfo )
     
@@ -192,6 +192,7 @@ void GraticulePlugin::setSettings( const QHash<QString,QVariant> &settings )
     m_showSecondaryLabels = secondaryLabels;
 
     readSettings();
+    emit repaintNeeded( QRegion() );
 }
 
 
@@ -298,6 +299,11 @@ qreal GraticulePlugin::zValue() const
     return 1.0;
 }
 
+LayerInterface::CacheInputs GraticulePlugin::cacheInputs() const
+{
+    return ViewportInput | ModelInput;
+}
+
 void GraticulePlugin::renderGrid( GeoPainter *painter, ViewportParams *viewport,
                                   const QPen& equatorCirclePen,
                                   const QPen& tropicsCirclePen,
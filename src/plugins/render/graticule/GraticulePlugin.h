@@ -54,7 +54,7 @@ class GeoDataLatLonAltBox;
 class GraticulePlugin : public RenderPlugin, public DialogConfigurationInterface
 {
     Q_OBJECT
-    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.GraticulePlugin" )
+    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.GraticulePlugin" FILE "GraticulePlugin.json" )
     Q_INTERFACES( Marble::RenderPluginInterface )
     Q_INTERFACES( Marble::DialogConfigurationInterface )
     MARBLE_PLUGIN( GraticulePlugin )
@@ -96,6 +96,8 @@ class GraticulePlugin : public RenderPlugin, public DialogConfigurationInterface
 
     virtual qreal zValue() const;
 
+    virtual CacheInputs cacheInputs() const;
+
     virtual QHash<QString,QVariant> settings() const;
 
     virtual void setSettings( const QHash<QString,QVariant> &settings );
@@ -26,7 +26,7 @@ class InhibitScreensaverPlugin : public RenderPlugin
 {
 
 Q_OBJECT
-    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.InhibitScreensaverPlugin" )
+    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.InhibitScreensaverPlugin" FILE "InhibitScreensaverPlugin.json" )
 Q_INTERFACES( Marble::RenderPluginInterface )
 
 MARBLE_PLUGIN( InhibitScreensaverPlugin )
@@ -32,7 +32,7 @@ namespace Marble
 class MapScaleFloatItem : public AbstractFloatItem, public DialogConfigurationInterface
 {
     Q_OBJECT
-    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.MapScaleFloatItem" )
+    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.MapScaleFloatItem" FILE "MapScaleFloatItem.json" )
     Q_INTERFACES( Marble::RenderPluginInterface )
     Q_INTERFACES( Marble::DialogConfigurationInterface )
     MARBLE_PLUGIN( MapScaleFloatItem )
@@ -35,7 +35,7 @@ class MeasureConfigDialog;
 class MeasureToolPlugin : public RenderPlugin, public DialogConfigurationInterface
 {
     Q_OBJECT
-    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.MeasureToolPlugin" )
+    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.MeasureToolPlugin" FILE "MeasureToolPlugin.json" )
     Q_INTERFACES( Marble::RenderPluginInterface )
     Q_INTERFACES( Marble::DialogConfigurationInterface )
     MARBLE_PLUGIN( MeasureToolPlugin )
@@ -33,7 +33,7 @@ namespace Marble
 class OpenCachingComPlugin : public AbstractDataPlugin
 {
     Q_OBJECT
-    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.OpenCachingComPlugin" )
+    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.OpenCachingComPlugin" FILE "OpenCachingComPlugin.json" )
 
     Q_INTERFACES( Marble::RenderPluginInterface )
 
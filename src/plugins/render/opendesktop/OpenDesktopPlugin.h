@@ -26,7 +26,7 @@ class OpenDesktopPlugin : public AbstractDataPlugin, public DialogConfigurationI
 {
 
     Q_OBJECT
-    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.OpenDesktopPlugin" )
+    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.OpenDesktopPlugin" FILE "OpenDesktopPlugin.json" )
 
     Q_INTERFACES(Marble::RenderPluginInterface)
     Q_INTERFACES(Marble::DialogConfigurationInterface)
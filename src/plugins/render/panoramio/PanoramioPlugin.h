@@ -19,7 +19,7 @@ namespace Marble
 class PanoramioPlugin : public AbstractDataPlugin
 {
     Q_OBJECT
-    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.PanoramioPlugin" )
+    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.PanoramioPlugin" FILE "PanoramioPlugin.json" )
     Q_INTERFACES( Marble::RenderPluginInterface )
     MARBLE_PLUGIN( PanoramioPlugin )
 
@@ -27,7 +27,7 @@ namespace Marble
 class ProgressFloatItem  : public AbstractFloatItem
 {
     Q_OBJECT
-    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.ProgressFloatItem" )
+    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.ProgressFloatItem" FILE "ProgressFloatItem.json" )
 
     Q_INTERFACES( Marble::RenderPluginInterface )
 
@@ -23,7 +23,7 @@ class PositionProviderPlugin;
 class RoutingPlugin : public AbstractFloatItem, public DialogConfigurationInterface
 {
     Q_OBJECT
-    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.RoutingPlugin" )
+    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.RoutingPlugin" FILE "RoutingPlugin.json" )
 
     Q_INTERFACES( Marble::RenderPluginInterface )
     Q_INTERFACES( Marble::DialogConfigurationInterface )
@@ -32,7 +32,7 @@ class SatellitesPlugin : public RenderPlugin,
                          public DialogConfigurationInterface
 {
     Q_OBJECT
-    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.SatellitesPlugin" )
+    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.SatellitesPlugin" FILE "SatellitesPlugin.json" )
     Q_INTERFACES( Marble::RenderPluginInterface )
     Q_INTERFACES( Marble::DialogConfigurationInterface )
     MARBLE_PLUGIN( SatellitesPlugin )
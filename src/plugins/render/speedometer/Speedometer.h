@@ -37,7 +37,7 @@ class MarbleLocale;
 class Speedometer : public AbstractFloatItem
 {
     Q_OBJECT
-    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.Speedometer" )
+    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.Speedometer" FILE "Speedometer.json" )
     Q_INTERFACES( Marble::RenderPluginInterface )
     MARBLE_PLUGIN( Speedometer )
     
@@ -35,9 +35,27 @@
 
 #include "src/lib/astro/solarsystem.h"
 
+#include <algorithm>
+
 namespace Marble
 {
 
+namespace
+{
+
+// Number of star pixmap sizes, see StarsPlugin::magnitudeBand()
+const int StarPixmapBands = 9;
+
+// Number of declination bands of the star catalogue index
+const int SkyCellBands = 18;
+
+bool starMagnitudeLessThan( const StarPoint &a, const StarPoint &b )
+{
+    return a.magnitude() < b.magnitude();
+}
+
+}
+
 StarsPlugin::StarsPlugin( const MarbleModel *marbleModel )
     : RenderPlugin( marbleModel ),
       m_nameIndex( 0 ),
@@ -262,31 +280,55 @@ void StarsPlugin::setSettings( const QHash<QString, QVariant> &settings )
     m_eclipticBrush = QColor( readSetting<QRgb>( settings, "eclipticBrush", defaultColor.rgb() ) );
     m_celestialEquatorBrush = QColor( readSetting<QRgb>( settings, "celestialEquatorBrush", defaultColor.rgb() ) );
     m_celestialPoleBrush = QColor( readSetting<QRgb>( settings, "celestialPoleBrush", defaultColor.rgb() ) );
+
+    requestRepaint();
+}
+
+const QPixmap &StarsPlugin::starPixmap(qreal mag, int colorId) const
+{
+    return starPixmap(magnitudeBand(mag), colorId);
 }
 
-QPixmap StarsPlugin::starPixmap(qreal mag, int colorId) const
+const QPixmap &StarsPlugin::starPixmap(int band, int colorId) const
 {
-   if ( mag < -1 ) {
+   switch ( band ) {
+   case 0:
        return m_pixN1Stars.at(colorId);
-   } else if ( mag < 0 ) {
+   case 1:
        return m_pixP0Stars.at(colorId);
-   } else if ( mag < 1 ) {
+   case 2:
        return m_pixP1Stars.at(colorId);
-   } else if ( mag < 2 ) {
+   case 3:
        return m_pixP2Stars.at(colorId);
-   } else if ( mag < 3 ) {
+   case 4:
        return m_pixP3Stars.at(colorId);
-   } else if ( mag < 4 ) {
+   case 5:
        return m_pixP4Stars.at(colorId);
-   } else if ( mag < 5 ) {
+   case 6:
        return m_pixP5Stars.at(colorId);
-   } else if ( mag < 6 ) {
+   case 7:
        return m_pixP6Stars.at(colorId);
-   } else {
+   default:
        return m_pixP7Stars.at(colorId);
    }
+}
 
-   return QPixmap();
+int StarsPlugin::magnitudeBand(qreal mag)
+{
+    // Bands of one magnitude: below -1, [-1,0), [0,1), ..., [5,6) and 6 or fainter
+    return qBound( 0, qFloor( mag ) + 2, StarPixmapBands - 1 );
+}
+
+int StarsPlugin::skyCellIndex(qreal ra, qreal decl)
+{
+    // Declination bands of equal height, split into right ascension cells of
+    // roughly equal area
+    const int band = qBound( 0, int( ( decl + M_PI / 2 ) / M_PI * SkyCellBands ), SkyCellBands - 1 );
+    const qreal bandCenter = ( band + 0.5 ) * M_PI / SkyCellBands - M_PI / 2;
+    const int cells = qMax( 1, qRound( 2 * SkyCellBands * cos( bandCenter ) ) );
+    const qreal rect = ra - 2 * M_PI * qFloor( ra / ( 2 * M_PI ) );
+    const int cell = qBound( 0, int( rect / ( 2 * M_PI ) * cells ), cells - 1 );
+    return band * 2 * SkyCellBands + cell;
 }
 
 void StarsPlugin::prepareNames()
@@ -534,6 +576,8 @@ void StarsPlugin::loadStars()
     //mDebug() << Q_FUNC_INFO;
     // Load star data
     m_stars.clear();
+    m_skyCells.clear();
+    m_idHash.clear();
 
     QFile starFile( MarbleDirs::path( "stars/stars.dat" ) );
     starFile.open( QIODevice::ReadOnly );
@@ -561,7 +605,6 @@ void StarsPlugin::loadStars()
 
     int maxid = 0;
     int id = 0;
-    int starIndex = 0;
     double ra;
     double de;
     double mag;
@@ -569,6 +612,7 @@ void StarsPlugin::loadStars()
 
     mDebug() << "Star Catalog Version " << version;
 
+    QVector<QVector<StarPoint> > cellStars( 2 * SkyCellBands * SkyCellBands );
     while ( !in.atEnd() ) {
         if ( version >= 2 ) {
             in >> id;
@@ -585,13 +629,49 @@ void StarsPlugin::loadStars()
         }
 
         StarPoint star( id, ( qreal )( ra ), ( qreal )( de ), ( qreal )( mag ), colorId );
-        // Create entry in stars database
-        m_stars << star;
-        // Create key,value pair in idHash table to map from star id to
-        // index in star database vector
-        m_idHash[id] = starIndex;
-        // Increment Index for use in hash
-        ++starIndex;
+        cellStars[skyCellIndex( ra, de )] << star;
+    }
+
+    // Create the stars database grouped by sky cells, brightest first within
+    // each cell, so that rendering can skip whole cells and stop at the
+    // magnitude limit
+    for ( int c = 0; c < cellStars.size(); ++c ) {
+        QVector<StarPoint> &stars = cellStars[c];
+        if ( stars.isEmpty() ) {
+            continue;
+        }
+        std::stable_sort( stars.begin(), stars.end(), starMagnitudeLessThan );
+
+        qreal x = 0.0;
+        qreal y = 0.0;
+        qreal z = 0.0;
+        foreach ( const StarPoint &star, stars ) {
+            x += star.quaternion().v[Q_X];
+            y += star.quaternion().v[Q_Y];
+            z += star.quaternion().v[Q_Z];
+        }
+        const qreal length = sqrt( x * x + y * y + z * z );
+        SkyCell cell;
+        cell.center = length > 0.0 ? Quaternion( 0.0, x / length, y / length, z / length )
+                                   : stars.first().quaternion();
+        cell.chord = 0.0;
+        cell.begin = m_stars.size();
+
+        foreach ( const StarPoint &star, stars ) {
+            const Quaternion &q = star.quaternion();
+            const qreal dx = q.v[Q_X] - cell.center.v[Q_X];
+            const qreal dy = q.v[Q_Y] - cell.center.v[Q_Y];
+            const qreal dz = q.v[Q_Z] - cell.center.v[Q_Z];
+            cell.chord = qMax( cell.chord, sqrt( dx * dx + dy * dy + dz * dz ) );
+
+            // Create key,value pair in idHash table to map from star id to
+            // index in star database vector
+            m_idHash[star.id()] = m_stars.size();
+            m_stars << star;
+        }
+
+        cell.end = m_stars.size();
+        m_skyCells << cell;
     }
 
     // load the Sun pixmap
@@ -778,6 +858,112 @@ void StarsPlugin::loadDsos()
     m_dsosLoaded = true;
 }
 
+LayerInterface::CacheInputs StarsPlugin::cacheInputs() const
+{
+    return ViewportInput | ClockInput | ModelInput;
+}
+
+void StarsPlugin::renderStars( GeoPainter *painter, ViewportParams *viewport,
+                               qreal skyRadius, matrix &skyAxisMatrix )
+{
+    const int colorCount = m_pixP7Stars.size();
+    m_starFragments.resize( StarPixmapBands * colorCount );
+
+    const qreal earthRadius = viewport->radius();
+    // Half the screen size plus a pixel for rounding star positions
+    const qreal halfWidth = viewport->width() / 2 + 1;
+    const qreal halfHeight = viewport->height() / 2 + 1;
+
+    foreach ( const SkyCell &cell, m_skyCells ) {
+        // The brightest star of the cell is its first one
+        if ( m_stars.at( cell.begin ).magnitude() >= m_magnitudeLimit ) {
+            continue;
+        }
+
+        Quaternion center = cell.center;
+        center.rotateAroundAxis( skyAxisMatrix );
+
+        // Skip cells on the far side of the sky sphere...
+        if ( center.v[Q_Z] - cell.chord > 0 ) {
+            continue;
+        }
+
+        // ... outside the screen area ...
+        const qreal extent = skyRadius * cell.chord;
+        const qreal centerX = skyRadius * center.v[Q_X];
+        const qreal centerY = skyRadius * center.v[Q_Y];
+        if ( centerX + extent < -halfWidth || centerX - extent >= halfWidth
+             || centerY + extent < -halfHeight || centerY - extent >= halfHeight ) {
+            continue;
+        }
+
+        // ... and behind the earth
+        const qreal centerDistance = sqrt( centerX * centerX + centerY * centerY );
+        if ( center.v[Q_Z] + cell.chord < 0 && centerDistance + extent < earthRadius ) {
+            continue;
+        }
+
+        for ( int s = cell.begin; s < cell.end; ++s ) {
+            const StarPoint &star = m_stars.at( s );
+
+            // Show star if it is brighter than magnitude threshold
+            if ( star.magnitude() >= m_magnitudeLimit ) {
+                break;
+            }
+
+            Quaternion qpos = star.quaternion();
+            qpos.rotateAroundAxis( skyAxisMatrix );
+
+            if ( qpos.v[Q_Z] > 0 ) {
+                continue;
+            }
+
+            qreal  earthCenteredX = qpos.v[Q_X] * skyRadius;
+            qreal  earthCenteredY = qpos.v[Q_Y] * skyRadius;
+
+            // Don't draw high placemarks (e.g. satellites) that aren't visible.
+            if ( qpos.v[Q_Z] < 0
+                    && ( ( earthCenteredX * earthCenteredX
+                           + earthCenteredY * earthCenteredY )
+                         < earthRadius * earthRadius ) ) {
+                continue;
+            }
+
+            // Let (x, y) be the position on the screen of the placemark..
+            const int x = ( int )( viewport->width()  / 2 + skyRadius * qpos.v[Q_X] );
+            const int y = ( int )( viewport->height() / 2 - skyRadius * qpos.v[Q_Y] );
+
+            // Skip placemarks that are outside the screen area
+            if ( x < 0 || x >= viewport->width()
+                    || y < 0 || y >= viewport->height() )
+                continue;
+
+            // colorId is used to select which pixmap in vector to display
+            const int band = magnitudeBand( star.magnitude() );
+            const QPixmap &pixmap = starPixmap( band, star.colorId() );
+            const int sizeX = pixmap.width();
+            const int sizeY = pixmap.height();
+            m_starFragments[band * colorCount + star.colorId()]
+                    << QPainter::PixmapFragment::create( QPointF( x - sizeX / 2 + 0.5 * sizeX,
+                                                                  y - sizeY / 2 + 0.5 * sizeY ),
+                                                         pixmap.rect() );
+        }
+    }
+
+    // Draw all stars sharing a pixmap at once, faint ones first so that
+    // bright stars stay on top
+    for ( int band = StarPixmapBands - 1; band >= 0; --band ) {
+        for ( int colorId = 0; colorId < colorCount; ++colorId ) {
+            QVector<QPainter::PixmapFragment> &fragments = m_starFragments[band * colorCount + colorId];
+            if ( !fragments.isEmpty() ) {
+                painter->drawPixmapFragments( fragments.constData(), fragments.size(),
+                                              starPixmap( band, colorId ) );
+                fragments.resize( 0 );
+            }
+        }
+    }
+}
+
 bool StarsPlugin::render( GeoPainter *painter, ViewportParams *viewport,
                           const QString& renderPos, GeoSceneLayer * layer )
 {
@@ -1064,47 +1250,7 @@ bool StarsPlugin::render( GeoPainter *painter, ViewportParams *viewport,
         }
 
         // Render Stars
-
-        for ( int s = 0; s < m_stars.size(); ++s  ) {
-            Quaternion  qpos = m_stars.at(s).quaternion();
-
-            qpos.rotateAroundAxis( skyAxisMatrix );
-
-            if ( qpos.v[Q_Z] > 0 ) {
-                continue;
-            }
-
-            qreal  earthCenteredX = qpos.v[Q_X] * skyRadius;
-            qreal  earthCenteredY = qpos.v[Q_Y] * skyRadius;
-
-            // Don't draw high placemarks (e.g. satellites) that aren't visible.
-            if ( qpos.v[Q_Z] < 0
-                    && ( ( earthCenteredX * earthCenteredX
-                           + earthCenteredY * earthCenteredY )
-                         < earthRadius * earthRadius ) ) {
-                continue;
-            }
-
-            // Let (x, y) be the position on the screen of the placemark..
-            const int x = ( int )( viewport->width()  / 2 + skyRadius * qpos.v[Q_X] );
-            const int y = ( int )( viewport->height() / 2 - skyRadius * qpos.v[Q_Y] );
-
-            // Skip placemarks that are outside the screen area
-            if ( x < 0 || x >= viewport->width()
-                    || y < 0 || y >= viewport->height() )
-                continue;
-
-            // Show star if it is brighter than magnitude threshold
-            if ( m_stars.at(s).magnitude() < m_magnitudeLimit ) {
-
-                // colorId is used to select which pixmap in vector to display
-                int colorId = m_stars.at(s).colorId();
-                QPixmap s_pixmap = starPixmap(m_stars.at(s).magnitude(), colorId);
-                int sizeX = s_pixmap.width();
-                int sizeY = s_pixmap.height();
-                painter->drawPixmap( x-sizeX/2, y-sizeY/2 ,s_pixmap );
-            }
-        }
+        renderStars( painter, viewport, skyRadius, skyAxisMatrix );
 
         if ( m_renderSun ) {
             // sun
@@ -20,6 +20,7 @@
 #include <QVariant>
 #include <QHash>
 #include <QBrush>
+#include <QPainter>
 
 #include "RenderPlugin.h"
 #include "Quaternion.h"
@@ -126,7 +127,7 @@ class Constellation;
 class StarsPlugin : public RenderPlugin, public DialogConfigurationInterface
 {
     Q_OBJECT
-    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.StarsPlugin" )
+    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.StarsPlugin" FILE "StarsPlugin.json" )
     Q_INTERFACES(Marble::RenderPluginInterface)
     Q_INTERFACES( Marble::DialogConfigurationInterface )
     MARBLE_PLUGIN(StarsPlugin)
@@ -164,6 +165,8 @@ public:
 
     bool render( GeoPainter *painter, ViewportParams *viewport, const QString& renderPos, GeoSceneLayer * layer = 0 );
 
+    CacheInputs cacheInputs() const;
+
     QDialog *configDialog();
 
     QHash<QString,QVariant> settings() const;
@@ -203,7 +206,15 @@ private:
         return settings[key].value<T>();
     }
 
-    QPixmap starPixmap(qreal mag, int colorId) const;
+    const QPixmap &starPixmap(qreal mag, int colorId) const;
+
+    const QPixmap &starPixmap(int band, int colorId) const;
+
+    static int magnitudeBand(qreal mag);
+
+    static int skyCellIndex(qreal ra, qreal decl);
+
+    void renderStars(GeoPainter *painter, ViewportParams *viewport, qreal skyRadius, matrix &skyAxisMatrix);
 
     void prepareNames();
     QHash<QString, QString> m_abbrHash;
@@ -240,6 +251,22 @@ private:
     bool m_zoomSunMoon;
     bool m_viewSolarSystemLabel;
     QVector<StarPoint> m_stars;
+
+    /**
+     * A patch of the sky covering the stars m_stars[begin, end), which are
+     * sorted by magnitude, brightest first. All stars of the cell are at most
+     * chord away from the unit vector center.
+     */
+    struct SkyCell
+    {
+        Quaternion center;
+        qreal chord;
+        int begin;
+        int end;
+    };
+    QVector<SkyCell> m_skyCells;
+    // Star positions collected per pixmap while rendering, drawn at once
+    QVector<QVector<QPainter::PixmapFragment> > m_starFragments;
     QPixmap m_pixmapSun;
     QPixmap m_pixmapMoon;
     QVector<Constellation> m_constellations;
@@ -27,7 +27,7 @@ namespace Marble
 class SunPlugin : public RenderPlugin
 {
     Q_OBJECT
-    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.SunPlugin" )
+    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.SunPlugin" FILE "SunPlugin.json" )
     Q_INTERFACES( Marble::RenderPluginInterface )
     MARBLE_PLUGIN( SunPlugin )
  public:
@@ -30,7 +30,7 @@ namespace Marble
 class TestPlugin : public RenderPlugin
 {
     Q_OBJECT
-    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.TestPlugin" )
+    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.TestPlugin" FILE "TestPlugin.json" )
     Q_INTERFACES( Marble::RenderPluginInterface )
     MARBLE_PLUGIN( TestPlugin )
 
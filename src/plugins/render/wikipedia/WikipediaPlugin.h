@@ -30,7 +30,7 @@ namespace Marble
 class WikipediaPlugin : public AbstractDataPlugin, public DialogConfigurationInterface
 {
     Q_OBJECT
-    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.WikipediaPlugin" )
+    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.WikipediaPlugin" FILE "WikipediaPlugin.json" )
     Q_INTERFACES( Marble::RenderPluginInterface )
     Q_INTERFACES( Marble::DialogConfigurationInterface )
     MARBLE_PLUGIN( WikipediaPlugin )
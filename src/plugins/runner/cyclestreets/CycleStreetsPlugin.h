@@ -20,7 +20,7 @@ namespace Marble
 class CycleStreetsPlugin : public RoutingRunnerPlugin
 {
     Q_OBJECT
-    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.CycleStreetsPlugin" )
+    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.CycleStreetsPlugin" FILE "CycleStreetsPlugin.json" )
     Q_INTERFACES( Marble::RoutingRunnerPlugin )
 
 public:
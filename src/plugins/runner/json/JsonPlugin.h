@@ -19,7 +19,7 @@ namespace Marble
 class JsonPlugin : public ParseRunnerPlugin
 {
     Q_OBJECT
-    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.JsonPlugin" )
+    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.JsonPlugin" FILE "JsonPlugin.json" )
     Q_INTERFACES( Marble::ParseRunnerPlugin )
 
 public:
@@ -18,7 +18,7 @@ namespace Marble
 class KmlPlugin : public ParseRunnerPlugin
 {
     Q_OBJECT
-    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.KmlPlugin" )
+    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.KmlPlugin" FILE "KmlPlugin.json" )
     Q_INTERFACES( Marble::ParseRunnerPlugin )
 
 public:
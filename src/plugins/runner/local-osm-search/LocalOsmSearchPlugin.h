@@ -24,7 +24,7 @@ namespace Marble
 class LocalOsmSearchPlugin : public SearchRunnerPlugin
 {
     Q_OBJECT
-    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.LocalOsmSearchPlugin" )
+    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.LocalOsmSearchPlugin" FILE "LocalOsmSearchPlugin.json" )
     Q_INTERFACES( Marble::SearchRunnerPlugin )
 
 public:
@@ -25,6 +25,8 @@
 #include <QRegExp>
 #include <QVariant>
 #include <QTime>
+#include <QRunnable>
+#include <QThreadPool>
 
 #include <QSqlDatabase>
 #include <QSqlQuery>
@@ -71,6 +73,49 @@ private:
 
 }
 
+/**
+  * Searches a single database file with its own connection
+  */
+class OsmDatabase::DatabaseSearch : public QRunnable
+{
+public:
+    DatabaseSearch( const QString &databaseFile, const QString &connectionName,
+                    const DatabaseQuery *userQuery, QVector<OsmPlacemark> *result ) :
+        m_databaseFile( databaseFile ),
+        m_connectionName( connectionName ),
+        m_userQuery( userQuery ),
+        m_result( result )
+    {
+    }
+
+    virtual void run()
+    {
+        {
+            QSqlDatabase database = QSqlDatabase::addDatabase( "QSQLITE", m_connectionName );
+            database.setDatabaseName( m_databaseFile );
+            if ( database.open() ) {
+                QTime timer;
+                timer.start();
+                *m_result = OsmDatabase::findInDatabase( database, *m_userQuery );
+                mDebug() << Q_FUNC_INFO << "query in" << m_databaseFile << "took" << timer.elapsed()
+                         << "ms for" << m_result->size() << "results";
+                database.close();
+            } else {
+                qWarning() << "Failed to connect to database" << m_databaseFile;
+            }
+        }
+
+        // All QSqlDatabase instances of the connection must be gone before it is removed
+        QSqlDatabase::removeDatabase( m_connectionName );
+    }
+
+private:
+    const QString m_databaseFile;
+    const QString m_connectionName;
+    const DatabaseQuery *const m_userQuery;
+    QVector<OsmPlacemark> *const m_result;
+};
+
 OsmDatabase::OsmDatabase( const QStringList &databaseFiles ) :
     m_databaseFiles( databaseFiles )
 {
@@ -82,141 +127,338 @@ QVector<OsmPlacemark> OsmDatabase::find( const DatabaseQuery &userQuery )
         return QVector<OsmPlacemark>();
     }
 
-    QSqlDatabase database = QSqlDatabase::addDatabase( "QSQLITE", QString( "marble/local-osm-search-%1" ).arg( reinterpret_cast<size_t>( this ) ) );
-
-    QVector<OsmPlacemark> result;
     QTime timer;
     timer.start();
-    foreach( const QString &databaseFile, m_databaseFiles ) {
-        database.setDatabaseName( databaseFile );
-        if ( !database.open() ) {
-            qWarning() << "Failed to connect to database" << databaseFile;
+
+    // Database connections cannot be shared between threads, each search opens its own
+    QVector< QVector<OsmPlacemark> > results( m_databaseFiles.size() );
+    {
+        QThreadPool pool;
+        for ( int i = 0; i < m_databaseFiles.size(); ++i ) {
+            QString const connectionName = QString( "marble/local-osm-search-%1-%2" ).arg( reinterpret_cast<size_t>( this ) ).arg( i );
+            pool.start( new DatabaseSearch( m_databaseFiles.at( i ), connectionName, &userQuery, &results[i] ) );
         }
+        pool.waitForDone();
+    }
 
-        QString regionRestriction;
-        if ( !userQuery.region().isEmpty() ) {
-            QTime regionTimer;
-            regionTimer.start();
-            // Nested set model to support region hierarchies, see http://en.wikipedia.org/wiki/Nested_set_model
-            const QString regionsQueryString = "SELECT lft, rgt FROM regions WHERE name LIKE '%" + userQuery.region() + "%';";
-            QSqlQuery regionsQuery( regionsQueryString, database );
-            if ( regionsQuery.lastError().isValid() ) {
-                qWarning() << regionsQuery.lastError() << "in" << databaseFile << "with query" << regionsQuery.lastQuery();
-            }
-            regionRestriction = " AND (";
-            int regionCount = 0;
-            while ( regionsQuery.next() ) {
-                if ( regionCount > 0 ) {
-                    regionRestriction += " OR ";
-                }
-                regionRestriction += " (regions.lft >= " + regionsQuery.value( 0 ).toString();
-                regionRestriction += " AND regions.lft <= " + regionsQuery.value( 1 ).toString() + ')';
-                regionCount++;
-            }
-            regionRestriction += ')';
+    /** @todo: sort/filter results from several databases */
+    QVector<OsmPlacemark> result;
+    foreach( const QVector<OsmPlacemark> &databaseResult, results ) {
+        result += databaseResult;
+    }
+
+    mDebug() << "Offline OSM search query took" << timer.elapsed() << "ms for" << result.count() << "results.";
+
+    qSort( result.begin(), result.end() );
+    makeUnique( result );
+
+    if ( userQuery.position().isValid() ) {
+        const PlacemarkSmallerDistance placemarkSmallerDistance( userQuery.position() );
+        qSort( result.begin(), result.end(), placemarkSmallerDistance );
+    } else {
+        const PlacemarkHigherScore placemarkHigherScore( &userQuery );
+        qSort( result.begin(), result.end(), placemarkHigherScore );
+    }
 
-            mDebug() << Q_FUNC_INFO << "region query in" << databaseFile << "with query" << regionsQueryString
-                     << "took" << regionTimer.elapsed() << "ms for" << regionCount << "results";
+    if ( result.size() > 50 ) {
+        result.remove( 50, result.size()-50 );
+    }
 
-            if ( regionCount == 0 ) {
-                continue;
+    return result;
+}
+
+QVector<OsmPlacemark> OsmDatabase::findInDatabase( QSqlDatabase &database, const DatabaseQuery &userQuery )
+{
+    QVector<OsmPlacemark> result;
+    bool const indexed = hasSearchIndexes( database );
+
+    QString regionRestriction;
+    if ( !userQuery.region().isEmpty() ) {
+        QTime regionTimer;
+        regionTimer.start();
+        // Nested set model to support region hierarchies, see http://en.wikipedia.org/wiki/Nested_set_model
+        QSqlQuery regionsQuery( database );
+        regionsQuery.setForwardOnly( true );
+        if ( !execQuery( regionsQuery, "SELECT lft, rgt FROM regions WHERE name LIKE ?;",
+                         QVariantList() << QString( '%' + userQuery.region() + '%' ) ) ) {
+            return result;
+        }
+
+        // The bounds are integers read from the database, so they can be part of the query
+        regionRestriction = " AND (";
+        int regionCount = 0;
+        while ( regionsQuery.next() ) {
+            if ( regionCount > 0 ) {
+                regionRestriction += " OR ";
             }
+            regionRestriction += " (regions.lft >= " + QString::number( regionsQuery.value( 0 ).toLongLong() );
+            regionRestriction += " AND regions.lft <= " + QString::number( regionsQuery.value( 1 ).toLongLong() ) + ')';
+            regionCount++;
         }
+        regionRestriction += ')';
 
-        QString queryString;
+        mDebug() << Q_FUNC_INFO << "region query in" << database.databaseName() << "for" << userQuery.region()
+                 << "took" << regionTimer.elapsed() << "ms for" << regionCount << "results";
 
-        queryString = " SELECT regions.name,"
-                " places.name, places.number,"
-                " places.category, places.lon, places.lat"
-                " FROM regions, places";
+        if ( regionCount == 0 ) {
+            return result;
+        }
+    }
 
-        if ( userQuery.queryType() == DatabaseQuery::CategorySearch ) {
-            queryString += " WHERE regions.id = places.region";
-            if( userQuery.category() == OsmPlacemark::UnknownCategory ) {
-                // search for all pois which are not street nor address
-                queryString += " AND places.category <> 0 AND places.category <> 6";
-            } else {
-                // search for specific category
-                queryString += " AND places.category = %1";
-                queryString = queryString.arg( (qint32) userQuery.category() );
+    QString queryString = " SELECT regions.name,"
+            " places.name, places.number,"
+            " places.category, places.lon, places.lat"
+            " FROM regions, places"
+            " WHERE regions.id = places.region";
+    QVariantList bindValues;
+
+    QSqlQuery query( database );
+    query.setForwardOnly( true );
+
+    if ( userQuery.queryType() == DatabaseQuery::CategorySearch ) {
+        if( userQuery.category() == OsmPlacemark::UnknownCategory ) {
+            // search for all pois which are not street nor address
+            queryString += " AND places.category <> 0 AND places.category <> 6";
+        } else {
+            // search for specific category
+            queryString += " AND places.category = ?";
+            bindValues << ( qint32 ) userQuery.category();
+        }
+
+        if ( userQuery.position().isValid() && userQuery.region().isEmpty() ) {
+            // sort by distance
+            qreal const lon = userQuery.position().longitude( GeoDataCoordinates::Degree );
+            qreal const lat = userQuery.position().latitude( GeoDataCoordinates::Degree );
+            QVariantList const orderValues = QVariantList() << lat << lat << lon << lon;
+            QString const order = " ORDER BY ((places.lat-?)*(places.lat-?)+(places.lon-?)*(places.lon-?)) LIMIT 50;";
+
+            if ( !indexed ) {
+                if ( execQuery( query, queryString + order, bindValues + orderValues ) ) {
+                    appendResults( query, userQuery, result );
+                }
+                return result;
             }
-            if ( userQuery.position().isValid() && userQuery.region().isEmpty() ) {
-                // sort by distance
-                queryString += " ORDER BY ((places.lat-%1)*(places.lat-%1)+(places.lon-%2)*(places.lon-%2))";
-                GeoDataCoordinates position = userQuery.position();
-                queryString = queryString.arg( position.latitude( GeoDataCoordinates::Degree ), 0, 'f', 8 )
-                        .arg( position.longitude( GeoDataCoordinates::Degree ), 0, 'f', 8 );
-            } else {
-                queryString += regionRestriction;
+
+            // Look for the nearest places in a growing box around the position. The result
+            // is complete once the box contains a circle around all of the nearest places.
+            for ( qreal radius = 0.02; radius < 180.0; radius *= 4 ) {
+                QString const boxRestriction = " AND places.id IN (SELECT id FROM placemarksRtree"
+                        " WHERE minLon >= ? AND maxLon <= ? AND minLat >= ? AND maxLat <= ?)";
+                QVariantList const boxValues = QVariantList() << lon - radius << lon + radius << lat - radius << lat + radius;
+                if ( !execQuery( query, queryString + boxRestriction + order, bindValues + boxValues + orderValues ) ) {
+                    return result;
+                }
+
+                QVector<OsmPlacemark> boxResult;
+                appendResults( query, userQuery, boxResult );
+                if ( boxResult.size() == 50 ) {
+                    const OsmPlacemark &farthest = boxResult.last();
+                    qreal const dLon = farthest.longitude() - lon;
+                    qreal const dLat = farthest.latitude() - lat;
+                    if ( dLon * dLon + dLat * dLat <= radius * radius ) {
+                        return boxResult;
+                    }
+                }
             }
-        } else if ( userQuery.queryType() == DatabaseQuery::BroadSearch ) {
-            queryString += " WHERE regions.id = places.region"
-                    " AND places.name " + wildcardQuery( userQuery.searchTerm() );
-        } else {
-            queryString += " WHERE regions.id = places.region"
-                    "   AND places.name " + wildcardQuery( userQuery.street() );
-            if ( !userQuery.houseNumber().isEmpty() ) {
-                queryString += " AND places.number " + wildcardQuery( userQuery.houseNumber() );
-            } else {
-                queryString += " AND places.number IS NULL";
+
+            if ( execQuery( query, queryString + order, bindValues + orderValues ) ) {
+                appendResults( query, userQuery, result );
             }
-            queryString += regionRestriction;
+            return result;
         }
 
-        queryString += " LIMIT 50;";
+        queryString += regionRestriction;
+    } else if ( userQuery.queryType() == DatabaseQuery::BroadSearch ) {
+        queryString += nameRestriction( "places.name", userQuery.searchTerm(), indexed, bindValues );
+    } else {
+        queryString += nameRestriction( "places.name", userQuery.street(), indexed, bindValues );
+        if ( !userQuery.houseNumber().isEmpty() ) {
+            queryString += nameRestriction( "places.number", userQuery.houseNumber(), false, bindValues );
+        } else {
+            queryString += " AND places.number IS NULL";
+        }
+        queryString += regionRestriction;
+    }
+
+    queryString += " LIMIT 50;";
 
-        /** @todo: sort/filter results from several databases */
+    if ( execQuery( query, queryString, bindValues ) ) {
+        appendResults( query, userQuery, result );
+    }
+
+    return result;
+}
 
+void OsmDatabase::createTables( QSqlDatabase &database )
+{
+    QStringList statements;
+    statements << "DROP TABLE IF EXISTS placemarks;";
+    statements << "CREATE TABLE placemarks ("
+                  " id INTEGER PRIMARY KEY,"
+                  " regionId INTEGER,"
+                  " nameId INTEGER,"
+                  " number VARCHAR(8),"
+                  " category INTEGER,"
+                  " lon FLOAT(8),"
+                  " lat FLOAT(8) )";
+    statements << "DROP TABLE IF EXISTS names";
+    statements << "CREATE TABLE names ("
+                  " id INTEGER PRIMARY KEY,"
+                  " name VARCHAR(50) )";
+    statements << "DROP TABLE IF EXISTS regions";
+    statements << "CREATE TABLE regions ("
+                  " id INTEGER PRIMARY KEY,"
+                  " parent INTEGER NOT NULL,"
+                  " lft INTEGER NOT NULL,"
+                  " rgt INTEGER NOT NULL,"
+                  " name VARCHAR(50),"
+                  " lon FLOAT(8),"
+                  " lat FLOAT(8) )";
+    statements << "DROP VIEW IF EXISTS places";
+    statements << "CREATE VIEW places AS "
+                  " SELECT"
+                  "  placemarks.id AS id,"
+                  "  placemarks.regionId AS region,"
+                  "  placemarks.nameId AS nameId,"
+                  "  names.name AS name,"
+                  "  placemarks.number AS number,"
+                  "  placemarks.category AS category,"
+                  "  placemarks.lon AS lon,"
+                  "  placemarks.lat AS lat"
+                  " FROM names"
+                  " INNER JOIN placemarks"
+                  " ON names.id=placemarks.nameId";
+    statements << "DROP TABLE IF EXISTS namesFts";
+    statements << "DROP TABLE IF EXISTS placemarksRtree";
+
+    foreach( const QString &statement, statements ) {
+        QSqlQuery query( database );
+        execQuery( query, statement, QVariantList() );
+    }
+}
+
+void OsmDatabase::createIndexes( QSqlDatabase &database )
+{
+    QStringList statements;
+    statements << "CREATE INDEX namesIndex ON names(name)";
+    statements << "CREATE INDEX placemarksIndex ON placemarks(regionId,nameId,category)";
+    statements << "CREATE INDEX placemarksCategoryIndex ON placemarks(category)";
+    statements << "CREATE INDEX regionsIndex ON regions(name,parent,lft,rgt)";
+
+    foreach( const QString &statement, statements ) {
         QSqlQuery query( database );
-        query.setForwardOnly( true );
-        QTime queryTimer;
-        queryTimer.start();
-        if ( !query.exec( queryString ) ) {
-            qWarning() << query.lastError() << "in" << databaseFile << "with query" << query.lastQuery();
-            continue;
+        execQuery( query, statement, QVariantList() );
+    }
+}
+
+bool OsmDatabase::createSearchIndexes( QSqlDatabase &database )
+{
+    QSqlQuery query( database );
+    // Prefix indexes speed up the short prefixes typed while searching as you type
+    if ( !execQuery( query, "CREATE VIRTUAL TABLE namesFts USING fts4(name, prefix=\"2,3,4\")", QVariantList() )
+         || !execQuery( query, "CREATE VIRTUAL TABLE placemarksRtree USING rtree(id, minLon, maxLon, minLat, maxLat)", QVariantList() ) ) {
+        execQuery( query, "DROP TABLE IF EXISTS namesFts", QVariantList() );
+        execQuery( query, "DROP TABLE IF EXISTS placemarksRtree", QVariantList() );
+        return false;
+    }
+
+    return execQuery( query, "INSERT INTO namesFts(docid, name) SELECT id, name FROM names", QVariantList() )
+        && execQuery( query, "INSERT INTO placemarksRtree SELECT id, lon, lon, lat, lat FROM placemarks", QVariantList() );
+}
+
+bool OsmDatabase::hasSearchIndexes( const QSqlDatabase &database )
+{
+    QStringList const tables = database.tables();
+    return tables.contains( "namesFts" ) && tables.contains( "placemarksRtree" );
+}
+
+QString OsmDatabase::nameRestriction( const QString &column, const QString &term, bool fullTextSearch, QVariantList &bindValues )
+{
+    if ( !term.contains( '*' ) ) {
+        bindValues << term;
+        return " AND " + column + " = ?";
+    }
+
+    QString pattern = term;
+    bindValues << pattern.replace( '*', '%' );
+    QString result = " AND " + column + " LIKE ?";
+
+    // The full text index narrows down the candidates, LIKE keeps the exact semantics
+    QString const match = fullTextSearch ? fullTextQuery( term ) : QString();
+    if ( !match.isEmpty() ) {
+        bindValues << match;
+        result += " AND places.nameId IN (SELECT docid FROM namesFts WHERE namesFts MATCH ?)";
+    }
+
+    return result;
+}
+
+QString OsmDatabase::fullTextQuery( const QString &term )
+{
+    // Split like the simple tokenizer of SQLite: tokens are ASCII letters and digits
+    // and all non-ASCII characters
+    QStringList tokens;
+    int start = -1;
+    for ( int i = 0; i <= term.size(); ++i ) {
+        bool isTokenCharacter = false;
+        if ( i < term.size() ) {
+            QChar const c = term.at( i );
+            isTokenCharacter = c.unicode() >= 128 || c.isLetterOrNumber();
         }
 
-        int resultCount = 0;
-        while ( query.next() ) {
-            OsmPlacemark placemark;
-            if ( userQuery.resultFormat() == DatabaseQuery::DistanceFormat ) {
-                GeoDataCoordinates coordinates( query.value(4).toFloat(), query.value(5).toFloat(), 0.0, GeoDataCoordinates::Degree );
-                placemark.setAdditionalInformation( formatDistance( coordinates, userQuery.position() ) );
-            } else {
-                placemark.setAdditionalInformation( query.value( 0 ).toString() );
+        if ( isTokenCharacter && start < 0 ) {
+            start = i;
+        } else if ( !isTokenCharacter && start >= 0 ) {
+            // A token with a leading wildcard may be the end of a longer token, it cannot be searched for
+            bool const leadingWildcard = start > 0 && term.at( start - 1 ) == '*';
+            bool const trailingWildcard = i < term.size() && term.at( i ) == '*';
+            if ( !leadingWildcard ) {
+                tokens << '"' + term.mid( start, i - start ) + ( trailingWildcard ? "*\"" : "\"" );
             }
-            placemark.setName( query.value(1).toString() );
-            placemark.setHouseNumber( query.value(2).toString() );
-            placemark.setCategory( (OsmPlacemark::OsmCategory) query.value(3).toInt() );
-            placemark.setLongitude( query.value(4).toFloat() );
-            placemark.setLatitude( query.value(5).toFloat() );
-
-            result.push_back( placemark );
-            resultCount++;
+            start = -1;
         }
-
-        mDebug() << Q_FUNC_INFO << "query in" << databaseFile << "with query" << queryString
-                 << "took" << queryTimer.elapsed() << "ms for" << resultCount << "results";
     }
 
-    mDebug() << "Offline OSM search query took" << timer.elapsed() << "ms for" << result.count() << "results.";
+    return tokens.join( " " );
+}
 
-    qSort( result.begin(), result.end() );
-    makeUnique( result );
+bool OsmDatabase::execQuery( QSqlQuery &query, const QString &queryString, const QVariantList &bindValues )
+{
+    if ( !query.prepare( queryString ) ) {
+        qWarning() << query.lastError() << "when preparing query" << queryString;
+        return false;
+    }
 
-    if ( userQuery.position().isValid() ) {
-        const PlacemarkSmallerDistance placemarkSmallerDistance( userQuery.position() );
-        qSort( result.begin(), result.end(), placemarkSmallerDistance );
-    } else {
-        const PlacemarkHigherScore placemarkHigherScore( &userQuery );
-        qSort( result.begin(), result.end(), placemarkHigherScore );
+    foreach( const QVariant &value, bindValues ) {
+        query.addBindValue( value );
     }
 
-    if ( result.size() > 50 ) {
-        result.remove( 50, result.size()-50 );
+    if ( !query.exec() ) {
+        qWarning() << query.lastError() << "with query" << queryString;
+        return false;
     }
 
-    return result;
+    return true;
+}
+
+void OsmDatabase::appendResults( QSqlQuery &query, const DatabaseQuery &userQuery, QVector<OsmPlacemark> &result )
+{
+    while ( query.next() ) {
+        OsmPlacemark placemark;
+        if ( userQuery.resultFormat() == DatabaseQuery::DistanceFormat ) {
+            GeoDataCoordinates coordinates( query.value(4).toFloat(), query.value(5).toFloat(), 0.0, GeoDataCoordinates::Degree );
+            placemark.setAdditionalInformation( formatDistance( coordinates, userQuery.position() ) );
+        } else {
+            placemark.setAdditionalInformation( query.value( 0 ).toString() );
+        }
+        placemark.setName( query.value(1).toString() );
+        placemark.setHouseNumber( query.value(2).toString() );
+        placemark.setCategory( (OsmPlacemark::OsmCategory) query.value(3).toInt() );
+        placemark.setLongitude( query.value(4).toFloat() );
+        placemark.setLatitude( query.value(5).toFloat() );
+
+        result.push_back( placemark );
+    }
 }
 
 void OsmDatabase::makeUnique( QVector<OsmPlacemark> &placemarks )
@@ -297,14 +539,4 @@ qreal OsmDatabase::bearing( const GeoDataCoordinates &a, const GeoDataCoordinate
                        cos( lat1 ) * sin( lat2 ) - sin( lat1 ) * cos( lat2 ) * cos ( delta ) ), 2 * M_PI );
 }
 
-QString OsmDatabase::wildcardQuery( const QString &term )
-{
-    QString result = term;
-    if ( term.contains( '*' ) ) {
-        return " LIKE '" + result.replace( '*', '%' ) + '\'';
-    } else {
-        return " = '" + result + '\'';
-    }
-}
-
 }
@@ -16,6 +16,10 @@
 
 #include <QString>
 #include <QStringList>
+#include <QVariant>
+
+class QSqlDatabase;
+class QSqlQuery;
 
 namespace Marble {
 
@@ -29,11 +33,42 @@ public:
 
     // Methods for read access
 
-    /** Search the database for matching regions and placemarks */
+    /**
+     * Search the database for matching regions and placemarks.
+     * All database files are searched concurrently.
+     */
     QVector<OsmPlacemark> find( const DatabaseQuery &userQuery );
 
+    // Methods for write access
+
+    /** Creates the tables and views of an empty database, dropping existing ones */
+    static void createTables( QSqlDatabase &database );
+
+    /** Creates the indexes of the tables. Call it once all regions and placemarks are inserted */
+    static void createIndexes( QSqlDatabase &database );
+
+    /**
+     * Creates a full text index over the names and an r-tree over the positions
+     * of the placemarks. Call it once all regions and placemarks are inserted.
+     * @return false if the SQLite library lacks the FTS4 or R*Tree module.
+     * The database can still be searched, just more slowly.
+     */
+    static bool createSearchIndexes( QSqlDatabase &database );
+
 private:
-    static QString wildcardQuery( const QString &term );
+    class DatabaseSearch;
+
+    static QVector<OsmPlacemark> findInDatabase( QSqlDatabase &database, const DatabaseQuery &userQuery );
+
+    static bool hasSearchIndexes( const QSqlDatabase &database );
+
+    static QString nameRestriction( const QString &column, const QString &term, bool fullTextSearch, QVariantList &bindValues );
+
+    static QString fullTextQuery( const QString &term );
+
+    static bool execQuery( QSqlQuery &query, const QString &queryString, const QVariantList &bindValues );
+
+    static void appendResults( QSqlQuery &query, const DatabaseQuery &userQuery, QVector<OsmPlacemark> &result );
 
     static void makeUnique( QVector<OsmPlacemark> &placemarks );
 
@@ -18,7 +18,7 @@ namespace Marble
 class LogfilePlugin : public ParseRunnerPlugin
 {
     Q_OBJECT
-    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.LogPlugin" )
+    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.LogPlugin" FILE "LogPlugin.json" )
     Q_INTERFACES( Marble::ParseRunnerPlugin )
 
 public:
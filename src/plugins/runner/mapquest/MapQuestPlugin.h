@@ -20,7 +20,7 @@ namespace Marble
 class MapQuestPlugin : public RoutingRunnerPlugin
 {
     Q_OBJECT
-    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.MapQuestPlugin" )
+    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.MapQuestPlugin" FILE "MapQuestPlugin.json" )
     Q_INTERFACES( Marble::RoutingRunnerPlugin )
 
 public:
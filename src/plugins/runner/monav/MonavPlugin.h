@@ -23,7 +23,7 @@ class RouteRequest;
 class MonavPlugin : public RoutingRunnerPlugin
 {
     Q_OBJECT
-    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.MonavPlugin" )
+    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.MonavPlugin" FILE "MonavPlugin.json" )
     Q_INTERFACES( Marble::RoutingRunnerPlugin )
 
 public:
@@ -21,7 +21,7 @@ namespace Marble
 class NominatimPlugin : public ReverseGeocodingRunnerPlugin
 {
     Q_OBJECT
-    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.NominatimReverseGeocodingPlugin" )
+    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.NominatimReverseGeocodingPlugin" FILE "NominatimReverseGeocodingPlugin.json" )
     Q_INTERFACES( Marble::ReverseGeocodingRunnerPlugin )
 
 public:
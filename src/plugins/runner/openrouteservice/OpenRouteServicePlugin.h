@@ -20,7 +20,7 @@ namespace Marble
 class OpenRouteServicePlugin : public RoutingRunnerPlugin
 {
     Q_OBJECT
-    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.OpenRouteServicePlugin" )
+    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.OpenRouteServicePlugin" FILE "OpenRouteServicePlugin.json" )
     Q_INTERFACES( Marble::RoutingRunnerPlugin )
 
 public:
@@ -0,0 +1,695 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2014 The Marble contributors
+//
+
+#include "OsmPbfParser.h"
+
+#include "fileformat.pb.h"
+#include "osmformat.pb.h"
+
+#include "GeoDataCoordinates.h"
+#include "GeoDataDocument.h"
+#include "GeoDataLinearRing.h"
+#include "GeoDataLineString.h"
+#include "GeoDataPlacemark.h"
+#include "GeoDataPoint.h"
+#include "GeoDataPolygon.h"
+#include "MarbleDebug.h"
+#include "MarbleGlobal.h"
+
+#include <QDataStream>
+#include <QIODevice>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QTime>
+
+#include <zlib.h>
+
+namespace Marble
+{
+
+struct OsmPbfNode
+{
+    OsmPbfCoordinate coordinate;
+    OsmPbfTags tags;
+};
+
+struct OsmPbfWay
+{
+    QVector<quint64> nodes;
+    OsmPbfTags tags;
+};
+
+/**
+  * Data of one file block. The decoder fills in the nodes and ways, the way
+  * resolver the geometries of the ways.
+  */
+class OsmPbfBlock
+{
+public:
+    OsmPbfBlock() : m_valid( false ) {}
+
+    QByteArray m_blobData;
+    bool m_valid;
+    QString m_errorString;
+
+    QVector<quint64> m_nodeIds;
+    QVector<OsmPbfCoordinate> m_nodeCoordinates;
+    QVector<OsmPbfNode> m_pois;
+    QVector<OsmPbfWay> m_ways;
+    QVector<GeoDataLineString> m_wayGeometries;
+};
+
+namespace
+{
+
+// Upper limit of the (inflated) size of a blob defined by the file format
+int const MaximumBlobSize = 32 * 1024 * 1024;
+
+// Tags that are never displayed
+bool isBlackListed( const QString &key )
+{
+    return key == "created_by";
+}
+
+bool readBlob( QDataStream &stream, OSMPBF::BlobHeader &blobHeader, QByteArray &blobData )
+{
+    qint32 size = -1;
+    stream >> size;
+    if ( size < 0 || size > 64 * 1024 ) {
+        return false;
+    }
+
+    QByteArray buffer;
+    buffer.resize( size );
+    if ( stream.readRawData( buffer.data(), size ) != size
+         || !blobHeader.ParseFromArray( buffer.constData(), size ) ) {
+        return false;
+    }
+
+    int const dataSize = blobHeader.datasize();
+    if ( dataSize < 0 || dataSize > MaximumBlobSize ) {
+        return false;
+    }
+
+    blobData.resize( dataSize );
+    return stream.readRawData( blobData.data(), dataSize ) == dataSize;
+}
+
+bool inflateBlob( const QByteArray &blobData, QByteArray &buffer, QString &errorString )
+{
+    OSMPBF::Blob blob;
+    if ( !blob.ParseFromArray( blobData.constData(), blobData.size() ) ) {
+        errorString = QObject::tr( "Invalid blob" );
+        return false;
+    }
+
+    if ( blob.has_raw() ) {
+        if ( blob.raw().size() > size_t( MaximumBlobSize ) ) {
+            errorString = QObject::tr( "Invalid blob size" );
+            return false;
+        }
+        buffer = QByteArray( blob.raw().data(), blob.raw().size() );
+        return true;
+    }
+
+    if ( !blob.has_zlib_data() ) {
+        errorString = QObject::tr( "Unsupported blob compression" );
+        return false;
+    }
+
+    // The size is taken from the file, don't trust it blindly
+    if ( !blob.has_raw_size() || blob.raw_size() < 0 || blob.raw_size() > MaximumBlobSize ) {
+        errorString = QObject::tr( "Invalid blob size" );
+        return false;
+    }
+
+    buffer.resize( blob.raw_size() );
+    z_stream zStream;
+    zStream.next_in = ( unsigned char* ) blob.zlib_data().data();
+    zStream.avail_in = blob.zlib_data().size();
+    zStream.next_out = ( unsigned char* ) buffer.data();
+    zStream.avail_out = buffer.size();
+    zStream.zalloc = Z_NULL;
+    zStream.zfree = Z_NULL;
+    zStream.opaque = Z_NULL;
+    if ( inflateInit( &zStream ) != Z_OK ) {
+        errorString = QObject::tr( "Failed to initialize zlib" );
+        return false;
+    }
+
+    int const result = inflate( &zStream, Z_FINISH );
+    uLong const inflatedSize = zStream.total_out;
+    inflateEnd( &zStream );
+    if ( result != Z_STREAM_END || inflatedSize != uLong( buffer.size() ) ) {
+        errorString = QObject::tr( "Failed to inflate blob" );
+        return false;
+    }
+
+    return true;
+}
+
+/**
+  * Converts the strings of a block on first use only
+  */
+class OsmPbfStringTable
+{
+public:
+    explicit OsmPbfStringTable( const OSMPBF::StringTable &table ) :
+        m_table( table ),
+        m_strings( table.s_size() )
+    {
+    }
+
+    /**
+      * Returns whether @p index, as read from the file, refers to a string of the table
+      */
+    bool contains( qint64 index ) const
+    {
+        return index >= 0 && index < m_strings.size();
+    }
+
+    /**
+      * Returns the string at @p index, which must be checked with contains() first
+      */
+    const QString &operator[]( int index )
+    {
+        QString &string = m_strings[index];
+        if ( string.isNull() ) {
+            const std::string &data = m_table.s( index );
+            string = QString::fromUtf8( data.data(), data.size() );
+        }
+        return string;
+    }
+
+private:
+    const OSMPBF::StringTable &m_table;
+    QVector<QString> m_strings;
+};
+
+/**
+  * Returns whether a node with the given tags results in a placemark
+  */
+bool isPoi( const OsmPbfTags &tags )
+{
+    for ( int i = 0; i < tags.size(); ++i ) {
+        if ( tags[i].first == "name"
+             || GeoDataFeature::OsmVisualCategory( tags[i].first + '=' + tags[i].second ) ) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+class OsmPbfBlockDecoder : public QRunnable
+{
+public:
+    explicit OsmPbfBlockDecoder( OsmPbfBlock *block ) : m_block( block ) {}
+
+    virtual void run()
+    {
+        QByteArray buffer;
+        bool const inflated = inflateBlob( m_block->m_blobData, buffer, m_block->m_errorString );
+        m_block->m_blobData.clear();
+        if ( !inflated ) {
+            return;
+        }
+
+        OSMPBF::PrimitiveBlock primitiveBlock;
+        if ( !primitiveBlock.ParseFromArray( buffer.constData(), buffer.size() ) ) {
+            m_block->m_errorString = QObject::tr( "Invalid primitive block" );
+            return;
+        }
+        buffer.clear();
+
+        // A malformed block is reported, decoding it further could read out of range
+        OsmPbfStringTable strings( primitiveBlock.stringtable() );
+        for ( int i = 0; i < primitiveBlock.primitivegroup_size(); ++i ) {
+            const OSMPBF::PrimitiveGroup &group = primitiveBlock.primitivegroup( i );
+            if ( !decodeNodes( primitiveBlock, group, strings )
+                 || !decodeDenseNodes( primitiveBlock, group, strings )
+                 || !decodeWays( group, strings ) ) {
+                return;
+            }
+        }
+
+        m_block->m_valid = true;
+    }
+
+private:
+    void addNode( quint64 id, qreal lon, qreal lat, const OsmPbfTags &tags )
+    {
+        OsmPbfCoordinate coordinate;
+        coordinate.lon = lon * DEG2RAD;
+        coordinate.lat = lat * DEG2RAD;
+        m_block->m_nodeIds << id;
+        m_block->m_nodeCoordinates << coordinate;
+
+        if ( !tags.isEmpty() && isPoi( tags ) ) {
+            OsmPbfNode node;
+            node.coordinate = coordinate;
+            node.tags = tags;
+            m_block->m_pois << node;
+        }
+    }
+
+    bool fail( const QString &errorString )
+    {
+        m_block->m_errorString = errorString;
+        return false;
+    }
+
+    bool decodeNodes( const OSMPBF::PrimitiveBlock &primitiveBlock, const OSMPBF::PrimitiveGroup &group, OsmPbfStringTable &strings )
+    {
+        for ( int i = 0; i < group.nodes_size(); ++i ) {
+            const OSMPBF::Node &node = group.nodes( i );
+            if ( node.keys_size() != node.vals_size() ) {
+                return fail( QObject::tr( "Node %1 has a different number of tag keys and values" ).arg( node.id() ) );
+            }
+
+            OsmPbfTags tags;
+            for ( int tag = 0; tag < node.keys_size(); ++tag ) {
+                if ( !strings.contains( node.keys( tag ) ) || !strings.contains( node.vals( tag ) ) ) {
+                    return fail( QObject::tr( "Invalid string table index" ) );
+                }
+
+                const QString &key = strings[node.keys( tag )];
+                if ( !isBlackListed( key ) ) {
+                    tags << qMakePair( key, strings[node.vals( tag )] );
+                }
+            }
+
+            qreal const lon = ( qreal( node.lon() ) * primitiveBlock.granularity() + primitiveBlock.lon_offset() ) / 1.0e9;
+            qreal const lat = ( qreal( node.lat() ) * primitiveBlock.granularity() + primitiveBlock.lat_offset() ) / 1.0e9;
+            addNode( node.id(), lon, lat, tags );
+        }
+
+        return true;
+    }
+
+    bool decodeDenseNodes( const OSMPBF::PrimitiveBlock &primitiveBlock, const OSMPBF::PrimitiveGroup &group, OsmPbfStringTable &strings )
+    {
+        if ( !group.has_dense() ) {
+            return true;
+        }
+
+        const OSMPBF::DenseNodes &dense = group.dense();
+        if ( dense.lon_size() != dense.id_size() || dense.lat_size() != dense.id_size() ) {
+            return fail( QObject::tr( "Dense nodes have a different number of ids and positions" ) );
+        }
+
+        qint64 id = 0;
+        qint64 lon = 0;
+        qint64 lat = 0;
+        int tag = 0;
+        OsmPbfTags tags;
+
+        for ( int i = 0; i < dense.id_size(); ++i ) {
+            id += dense.id( i );
+            lon += dense.lon( i );
+            lat += dense.lat( i );
+
+            // Tags of all nodes are stored in one array, separated by 0
+            tags.clear();
+            while ( tag < dense.keys_vals_size() ) {
+                int const keyIndex = dense.keys_vals( tag );
+                if ( keyIndex == 0 ) {
+                    ++tag;
+                    break;
+                }
+
+                if ( tag + 1 >= dense.keys_vals_size() ) {
+                    return fail( QObject::tr( "Node %1 has a tag key without value" ).arg( id ) );
+                }
+
+                int const valueIndex = dense.keys_vals( tag + 1 );
+                if ( !strings.contains( keyIndex ) || !strings.contains( valueIndex ) ) {
+                    return fail( QObject::tr( "Invalid string table index" ) );
+                }
+
+                const QString &key = strings[keyIndex];
+                if ( !isBlackListed( key ) ) {
+                    tags << qMakePair( key, strings[valueIndex] );
+                }
+                tag += 2;
+            }
+
+            addNode( id,
+                     ( qreal( lon ) * primitiveBlock.granularity() + primitiveBlock.lon_offset() ) / 1.0e9,
+                     ( qreal( lat ) * primitiveBlock.granularity() + primitiveBlock.lat_offset() ) / 1.0e9,
+                     tags );
+        }
+
+        return true;
+    }
+
+    bool decodeWays( const OSMPBF::PrimitiveGroup &group, OsmPbfStringTable &strings )
+    {
+        for ( int i = 0; i < group.ways_size(); ++i ) {
+            const OSMPBF::Way &inputWay = group.ways( i );
+            if ( inputWay.keys_size() != inputWay.vals_size() ) {
+                return fail( QObject::tr( "Way %1 has a different number of tag keys and values" ).arg( inputWay.id() ) );
+            }
+
+            OsmPbfWay way;
+            for ( int tag = 0; tag < inputWay.keys_size(); ++tag ) {
+                if ( !strings.contains( inputWay.keys( tag ) ) || !strings.contains( inputWay.vals( tag ) ) ) {
+                    return fail( QObject::tr( "Invalid string table index" ) );
+                }
+
+                const QString &key = strings[inputWay.keys( tag )];
+                if ( !isBlackListed( key ) ) {
+                    way.tags << qMakePair( key, strings[inputWay.vals( tag )] );
+                }
+            }
+
+            // Ways without tags are only visible as part of relations
+            if ( way.tags.isEmpty() ) {
+                continue;
+            }
+
+            way.nodes.reserve( inputWay.refs_size() );
+            qint64 ref = 0;
+            for ( int j = 0; j < inputWay.refs_size(); ++j ) {
+                ref += inputWay.refs( j );
+                way.nodes << ref;
+            }
+
+            m_block->m_ways << way;
+        }
+
+        return true;
+    }
+
+    OsmPbfBlock *const m_block;
+};
+
+/**
+  * Looks up the node positions of the ways of one block
+  */
+class OsmPbfWayResolver : public QRunnable
+{
+public:
+    OsmPbfWayResolver( OsmPbfBlock *block, const QHash<quint64, OsmPbfCoordinate> *nodes ) :
+        m_block( block ),
+        m_nodes( nodes )
+    {
+    }
+
+    virtual void run()
+    {
+        m_block->m_wayGeometries.resize( m_block->m_ways.size() );
+        for ( int i = 0; i < m_block->m_ways.size(); ++i ) {
+            const OsmPbfWay &way = m_block->m_ways[i];
+            GeoDataLineString &line = m_block->m_wayGeometries[i];
+            foreach( quint64 id, way.nodes ) {
+                QHash<quint64, OsmPbfCoordinate>::const_iterator const node = m_nodes->constFind( id );
+                if ( node != m_nodes->constEnd() ) {
+                    line.append( GeoDataCoordinates( node->lon, node->lat ) );
+                }
+            }
+        }
+    }
+
+private:
+    OsmPbfBlock *const m_block;
+    const QHash<quint64, OsmPbfCoordinate> *const m_nodes;
+};
+
+}
+
+OsmPbfParser::OsmPbfParser() :
+    m_document( 0 )
+{
+    GOOGLE_PROTOBUF_VERIFY_VERSION;
+
+    // Keep in sync with the OsmParser of the osm plugin
+    m_areaTags.insert( "landuse=forest" );
+    m_areaTags.insert( "natural=wood" );
+    m_areaTags.insert( "area=yes" );
+    m_areaTags.insert( "waterway=riverbank" );
+    m_areaTags.insert( "building=yes" );
+    m_areaTags.insert( "amenity=parking" );
+    m_areaTags.insert( "leisure=park" );
+
+    m_areaTags.insert( "landuse=allotments" );
+    m_areaTags.insert( "landuse=basin" );
+    m_areaTags.insert( "landuse=brownfield" );
+    m_areaTags.insert( "landuse=cemetery" );
+    m_areaTags.insert( "landuse=commercial" );
+    m_areaTags.insert( "landuse=construction" );
+    m_areaTags.insert( "landuse=farm" );
+    m_areaTags.insert( "landuse=farmland" );
+    m_areaTags.insert( "landuse=farmyard" );
+    m_areaTags.insert( "landuse=garages" );
+    m_areaTags.insert( "landuse=greenfield" );
+    m_areaTags.insert( "landuse=industrial" );
+    m_areaTags.insert( "landuse=landfill" );
+    m_areaTags.insert( "landuse=meadow" );
+    m_areaTags.insert( "landuse=military" );
+    m_areaTags.insert( "landuse=orchard" );
+    m_areaTags.insert( "landuse=quarry" );
+    m_areaTags.insert( "landuse=railway" );
+    m_areaTags.insert( "landuse=reservoir" );
+    m_areaTags.insert( "landuse=residential" );
+    m_areaTags.insert( "landuse=retail" );
+}
+
+OsmPbfParser::~OsmPbfParser()
+{
+    qDeleteAll( m_blocks );
+    delete m_document;
+}
+
+QString OsmPbfParser::errorString() const
+{
+    return m_errorString;
+}
+
+GeoDataDocument *OsmPbfParser::releaseDocument()
+{
+    GeoDataDocument *document = m_document;
+    m_document = 0;
+    return document;
+}
+
+bool OsmPbfParser::read( QIODevice *device )
+{
+    QTime timer;
+    timer.start();
+
+    delete m_document;
+    m_document = new GeoDataDocument;
+    m_nodes.clear();
+    qDeleteAll( m_blocks );
+    m_blocks.clear();
+
+    // Set up the lookup table before the decoders share it
+    GeoDataFeature::OsmVisualCategory( QString() );
+
+    if ( !readBlocks( device ) ) {
+        return false;
+    }
+
+    int nodeCount = 0;
+    foreach( const OsmPbfBlock *block, m_blocks ) {
+        nodeCount += block->m_nodeIds.size();
+    }
+
+    m_nodes.reserve( nodeCount );
+    foreach( const OsmPbfBlock *block, m_blocks ) {
+        for ( int i = 0; i < block->m_nodeIds.size(); ++i ) {
+            m_nodes.insert( block->m_nodeIds[i], block->m_nodeCoordinates[i] );
+        }
+    }
+
+    QThreadPool pool;
+    foreach( OsmPbfBlock *block, m_blocks ) {
+        block->m_nodeIds.clear();
+        block->m_nodeCoordinates.clear();
+        pool.start( new OsmPbfWayResolver( block, &m_nodes ) );
+    }
+    pool.waitForDone();
+    m_nodes.clear();
+
+    // Placemarks are created in file order, like the XML parser does
+    foreach( const OsmPbfBlock *block, m_blocks ) {
+        foreach( const OsmPbfNode &node, block->m_pois ) {
+            createPoi( node.tags, GeoDataCoordinates( node.coordinate.lon, node.coordinate.lat ) );
+        }
+        for ( int i = 0; i < block->m_ways.size(); ++i ) {
+            createWay( block->m_ways[i].tags, block->m_wayGeometries[i] );
+        }
+    }
+
+    mDebug() << "Parsed" << m_blocks.size() << "blocks with" << nodeCount << "nodes in" << timer.elapsed() << "ms";
+
+    qDeleteAll( m_blocks );
+    m_blocks.clear();
+    return true;
+}
+
+bool OsmPbfParser::readBlocks( QIODevice *device )
+{
+    QDataStream stream( device );
+    stream.setByteOrder( QDataStream::BigEndian );
+
+    OSMPBF::BlobHeader blobHeader;
+    QByteArray blobData;
+    if ( !readBlob( stream, blobHeader, blobData ) || blobHeader.type() != "OSMHeader" ) {
+        m_errorString = QObject::tr( "The file is not an OpenStreetMap PBF file" );
+        return false;
+    }
+
+    QByteArray buffer;
+    OSMPBF::HeaderBlock headerBlock;
+    if ( !inflateBlob( blobData, buffer, m_errorString )
+         || !headerBlock.ParseFromArray( buffer.constData(), buffer.size() ) ) {
+        m_errorString = QObject::tr( "Invalid OpenStreetMap PBF header" );
+        return false;
+    }
+
+    for ( int i = 0; i < headerBlock.required_features_size(); ++i ) {
+        const std::string &feature = headerBlock.required_features( i );
+        if ( feature != "OsmSchema-V0.6" && feature != "DenseNodes" ) {
+            m_errorString = QObject::tr( "Unsupported feature %1" ).arg( QString::fromUtf8( feature.c_str() ) );
+            return false;
+        }
+    }
+
+    // Blocks are decoded in parallel while the file is read
+    QThreadPool pool;
+    bool success = true;
+    while ( !stream.atEnd() ) {
+        if ( !readBlob( stream, blobHeader, blobData ) ) {
+            m_errorString = QObject::tr( "The file is truncated or corrupt" );
+            success = false;
+            break;
+        }
+
+        // Unknown blob types must be skipped according to the file format
+        if ( blobHeader.type() != "OSMData" ) {
+            continue;
+        }
+
+        OsmPbfBlock *block = new OsmPbfBlock;
+        block->m_blobData = blobData;
+        m_blocks << block;
+        pool.start( new OsmPbfBlockDecoder( block ) );
+    }
+    pool.waitForDone();
+
+    foreach( const OsmPbfBlock *block, m_blocks ) {
+        if ( success && !block->m_valid ) {
+            m_errorString = block->m_errorString;
+            success = false;
+        }
+    }
+
+    return success;
+}
+
+void OsmPbfParser::createPoi( const OsmPbfTags &tags, const GeoDataCoordinates &coordinates )
+{
+    GeoDataPlacemark *placemark = 0;
+
+    for ( int i = 0; i < tags.size(); ++i ) {
+        const QString &key = tags[i].first;
+        const QString &value = tags[i].second;
+
+        if ( !placemark && ( key == "name" || GeoDataFeature::OsmVisualCategory( key + '=' + value ) ) ) {
+            placemark = new GeoDataPlacemark;
+            placemark->setGeometry( new GeoDataPoint( coordinates ) );
+            placemark->setVisible( false );
+            placemark->setZoomLevel( 18 );
+            m_document->append( placemark );
+        }
+
+        if ( !placemark ) {
+            continue;
+        }
+
+        if ( key == "name" ) {
+            placemark->setName( value );
+            continue;
+        }
+
+        if ( GeoDataFeature::OsmVisualCategory( key + '=' + value ) ) {
+            placemark->setVisible( true );
+        }
+
+        applyVisualCategory( placemark, key, value );
+    }
+}
+
+void OsmPbfParser::createWay( const OsmPbfTags &tags, const GeoDataLineString &line )
+{
+    GeoDataPlacemark *placemark = new GeoDataPlacemark;
+    placemark->setGeometry( new GeoDataLineString( line ) );
+    // Only tags decide whether the way is displayed
+    placemark->setVisible( false );
+    m_document->append( placemark );
+
+    bool isArea = false;
+    for ( int i = 0; i < tags.size(); ++i ) {
+        const QString &key = tags[i].first;
+        const QString &value = tags[i].second;
+
+        if ( key == "name" ) {
+            placemark->setName( value );
+            continue;
+        }
+
+        if ( !isArea && m_areaTags.contains( key + '=' + value ) ) {
+            isArea = true;
+            GeoDataPolygon *polygon = new GeoDataPolygon;
+            polygon->setOuterBoundary( GeoDataLinearRing( line ) );
+            placemark->setGeometry( polygon );
+        }
+
+        if ( key == "building" && value == "yes" && placemark->visualCategory() == GeoDataFeature::Default ) {
+            placemark->setVisualCategory( GeoDataFeature::Building );
+            placemark->setVisible( true );
+        }
+
+        applyVisualCategory( placemark, key, value );
+    }
+}
+
+void OsmPbfParser::applyVisualCategory( GeoDataPlacemark *placemark, const QString &key, const QString &value )
+{
+    // Additional categories are represented by copies of the placemark
+    GeoDataFeature::GeoDataVisualCategory category = GeoDataFeature::OsmVisualCategory( key + '=' + value );
+    bool const keyValueCategory = category != GeoDataFeature::None;
+    if ( !keyValueCategory ) {
+        category = GeoDataFeature::OsmVisualCategory( key );
+    }
+
+    if ( category == GeoDataFeature::None ) {
+        return;
+    }
+
+    bool const hasCategory = placemark->visualCategory() != GeoDataFeature::Default
+            && ( !keyValueCategory || placemark->visualCategory() != GeoDataFeature::Building );
+    if ( hasCategory ) {
+        GeoDataPlacemark *copy = new GeoDataPlacemark( *placemark );
+        copy->setVisualCategory( category );
+        copy->setStyle( 0 );
+        copy->setVisible( true );
+        m_document->append( copy );
+    } else {
+        // Remove the assigned style (i.e. the building style)
+        placemark->setStyle( 0 );
+        placemark->setVisualCategory( category );
+        placemark->setVisible( true );
+    }
+}
+
+}
@@ -0,0 +1,91 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2014 The Marble contributors
+//
+
+#ifndef MARBLE_OSMPBFPARSER_H
+#define MARBLE_OSMPBFPARSER_H
+
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QSet>
+#include <QString>
+#include <QVector>
+
+class QIODevice;
+
+namespace Marble
+{
+
+class GeoDataCoordinates;
+class GeoDataDocument;
+class GeoDataLineString;
+class GeoDataPlacemark;
+
+typedef QVector< QPair<QString, QString> > OsmPbfTags;
+
+/**
+  * Position of a node in radian
+  */
+struct OsmPbfCoordinate
+{
+    qreal lon;
+    qreal lat;
+};
+
+class OsmPbfBlock;
+
+/**
+  * @short Reads OpenStreetMap binary (.osm.pbf) files into a GeoDataDocument
+  *
+  * The blocks of the file are inflated and decoded in parallel. Once all node
+  * positions are known, the geometries of the ways are resolved in parallel as
+  * well. Placemarks are created in file order with the same rules as the XML
+  * based OsmParser of the osm plugin uses. Relations are not supported yet.
+  */
+class OsmPbfParser
+{
+public:
+    OsmPbfParser();
+    ~OsmPbfParser();
+
+    /**
+     * @brief Reads the whole file from @p device
+     * @return false if the file is not a valid OSM PBF file, see errorString()
+     */
+    bool read( QIODevice *device );
+
+    QString errorString() const;
+
+    /**
+     * @brief Hands over the ownership of the parsed document to the caller
+     */
+    GeoDataDocument *releaseDocument();
+
+private:
+    Q_DISABLE_COPY( OsmPbfParser )
+
+    bool readBlocks( QIODevice *device );
+
+    void createPoi( const OsmPbfTags &tags, const GeoDataCoordinates &coordinates );
+
+    void createWay( const OsmPbfTags &tags, const GeoDataLineString &line );
+
+    void applyVisualCategory( GeoDataPlacemark *placemark, const QString &key, const QString &value );
+
+    GeoDataDocument *m_document;
+    QString m_errorString;
+    QList<OsmPbfBlock*> m_blocks;
+    QHash<quint64, OsmPbfCoordinate> m_nodes;
+    QSet<QString> m_areaTags;
+};
+
+}
+
+#endif // MARBLE_OSMPBFPARSER_H
@@ -0,0 +1,71 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2014 The Marble contributors
+
+#include "OsmPbfPlugin.h"
+#include "OsmPbfRunner.h"
+
+namespace Marble
+{
+
+OsmPbfPlugin::OsmPbfPlugin( QObject *parent ) :
+    ParseRunnerPlugin( parent )
+{
+}
+
+QString OsmPbfPlugin::name() const
+{
+    return tr( "Osm Pbf File Parser" );
+}
+
+QString OsmPbfPlugin::nameId() const
+{
+    return "OsmPbf";
+}
+
+QString OsmPbfPlugin::version() const
+{
+    return "1.0";
+}
+
+QString OsmPbfPlugin::description() const
+{
+    return tr( "Create GeoDataDocument from binary Osm Files" );
+}
+
+QString OsmPbfPlugin::copyrightYears() const
+{
+    return "2014";
+}
+
+QList<PluginAuthor> OsmPbfPlugin::pluginAuthors() const
+{
+    return QList<PluginAuthor>()
+            << PluginAuthor( "The Marble contributors", "marble-devel@kde.org" );
+}
+
+QString OsmPbfPlugin::fileFormatDescription() const
+{
+    return tr( "OpenStreetMap Binary Data" );
+}
+
+QStringList OsmPbfPlugin::fileExtensions() const
+{
+    return QStringList() << "pbf";
+}
+
+ParsingRunner* OsmPbfPlugin::newRunner() const
+{
+    return new OsmPbfRunner;
+}
+
+}
+
+Q_EXPORT_PLUGIN2( OsmPbfPlugin, Marble::OsmPbfPlugin )
+
+#include "OsmPbfPlugin.moc"
@@ -0,0 +1,54 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2014 The Marble contributors
+
+#include "OsmPbfRunner.h"
+
+#include "GeoDataDocument.h"
+#include "OsmPbfParser.h"
+
+#include <QFile>
+
+namespace Marble
+{
+
+OsmPbfRunner::OsmPbfRunner( QObject *parent ) :
+    ParsingRunner( parent )
+{
+}
+
+OsmPbfRunner::~OsmPbfRunner()
+{
+}
+
+void OsmPbfRunner::parseFile( const QString &fileName, DocumentRole role = UnknownDocument )
+{
+    QFile file( fileName );
+    if ( !file.open( QIODevice::ReadOnly ) ) {
+        emit parsingFinished( 0, file.errorString() );
+        return;
+    }
+
+    OsmPbfParser parser;
+    if ( !parser.read( &file ) ) {
+        emit parsingFinished( 0, parser.errorString() );
+        return;
+    }
+
+    GeoDataDocument* document = parser.releaseDocument();
+    Q_ASSERT( document );
+    document->setDocumentRole( role );
+    document->setFileName( fileName );
+
+    file.close();
+    emit parsingFinished( document );
+}
+
+}
+
+#include "OsmPbfRunner.moc"
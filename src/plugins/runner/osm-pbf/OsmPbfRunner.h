@@ -0,0 +1,28 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2014 The Marble contributors
+
+#ifndef MARBLEOSMPBFRUNNER_H
+#define MARBLEOSMPBFRUNNER_H
+
+#include "ParsingRunner.h"
+
+namespace Marble
+{
+
+class OsmPbfRunner : public ParsingRunner
+{
+    Q_OBJECT
+public:
+    explicit OsmPbfRunner( QObject *parent = 0 );
+    ~OsmPbfRunner();
+    virtual void parseFile( const QString &fileName, DocumentRole role );
+};
+
+}
+#endif // MARBLEOSMPBFRUNNER_H
@@ -18,7 +18,7 @@ namespace Marble
 class OsmPlugin : public ParseRunnerPlugin
 {
     Q_OBJECT
-    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.OsmPlugin" )
+    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.OsmPlugin" FILE "OsmPlugin.json" )
     Q_INTERFACES( Marble::ParseRunnerPlugin )
 
 public:
@@ -18,7 +18,7 @@ namespace Marble
 class PntPlugin : public ParseRunnerPlugin
 {
     Q_OBJECT
-    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.PntPlugin" )
+    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.PntPlugin" FILE "PntPlugin.json" )
     Q_INTERFACES( Marble::ParseRunnerPlugin )
 
 public:
@@ -13,6 +13,7 @@
 #include "AbstractDataPluginModel.h"
 
 #include "AbstractDataPluginItem.h"
+#include "GeoDataCoordinates.h"
 #include "MarbleModel.h"
 #include "ViewportParams.h"
 
@@ -92,6 +93,10 @@ public:
 
     void itemsVersusSetSticky();
 
+    void itemsVersusCollision();
+
+    void itemsVersusViewport();
+
  private:
     const MarbleModel m_marbleModel;
     static const ViewportParams fullViewport;
@@ -341,6 +346,73 @@ void AbstractDataPluginModelTest::itemsVersusSetSticky()
     QVERIFY( !model.items( &fullViewport, 1 ).contains( item ) );
 }
 
+void AbstractDataPluginModelTest::itemsVersusCollision()
+{
+    const ViewportParams zoomedViewport( Equirectangular, 0, 0, 10000, QSize( 230, 230 ) );
+
+    TestDataPluginItem *first = new TestDataPluginItem;
+    first->setInitialized( true );
+    first->setSize( QSizeF( 20, 20 ) );
+    first->setCoordinate( GeoDataCoordinates( 0, 0, 0, GeoDataCoordinates::Degree ) );
+
+    TestDataPluginItem *overlapping = new TestDataPluginItem;
+    overlapping->setInitialized( true );
+    overlapping->setSize( QSizeF( 20, 20 ) );
+    overlapping->setCoordinate( GeoDataCoordinates( 0.05, 0, 0, GeoDataCoordinates::Degree ) );
+
+    TestDataPluginItem *separate = new TestDataPluginItem;
+    separate->setInitialized( true );
+    separate->setSize( QSizeF( 20, 20 ) );
+    separate->setCoordinate( GeoDataCoordinates( 0.3, 0.3, 0, GeoDataCoordinates::Degree ) );
+
+    TestDataPluginModel model( &m_marbleModel );
+    model.addItemToList( first );
+    model.addItemToList( overlapping );
+    model.addItemToList( separate );
+
+    const QList<AbstractDataPluginItem *> items = model.items( &zoomedViewport, 10 );
+    QCOMPARE( items.size(), 2 );
+    QVERIFY( items.contains( separate ) );
+    QVERIFY( items.contains( first ) != items.contains( overlapping ) );
+
+    // items that are already displayed keep their place
+    QCOMPARE( model.items( &zoomedViewport, 10 ).toSet(), items.toSet() );
+}
+
+void AbstractDataPluginModelTest::itemsVersusViewport()
+{
+    const ViewportParams zoomedViewport( Equirectangular, 0, 0, 10000, QSize( 230, 230 ) );
+
+    TestDataPluginItem *inside = new TestDataPluginItem;
+    inside->setInitialized( true );
+    inside->setSize( QSizeF( 20, 20 ) );
+    inside->setCoordinate( GeoDataCoordinates( 0.3, 0, 0, GeoDataCoordinates::Degree ) );
+
+    TestDataPluginItem *outside = new TestDataPluginItem;
+    outside->setInitialized( true );
+    outside->setSize( QSizeF( 20, 20 ) );
+    outside->setCoordinate( GeoDataCoordinates( 10, 0, 0, GeoDataCoordinates::Degree ) );
+
+    TestDataPluginItem *dateLine = new TestDataPluginItem;
+    dateLine->setInitialized( true );
+    dateLine->setSize( QSizeF( 20, 20 ) );
+    dateLine->setCoordinate( GeoDataCoordinates( -179.7, 0, 0, GeoDataCoordinates::Degree ) );
+
+    TestDataPluginModel model( &m_marbleModel );
+    model.addItemToList( inside );
+    model.addItemToList( outside );
+    model.addItemToList( dateLine );
+
+    const QList<AbstractDataPluginItem *> items = model.items( &zoomedViewport, 10 );
+    QCOMPARE( items.size(), 1 );
+    QVERIFY( items.contains( inside ) );
+
+    const ViewportParams dateLineViewport( Equirectangular, M_PI, 0, 10000, QSize( 230, 230 ) );
+    const QList<AbstractDataPluginItem *> dateLineItems = model.items( &dateLineViewport, 10 );
+    QCOMPARE( dateLineItems.size(), 1 );
+    QVERIFY( dateLineItems.contains( dateLine ) );
+}
+
 QTEST_MAIN( AbstractDataPluginModelTest )
 
 #include "AbstractDataPluginModelTest.moc"
@@ -0,0 +1,195 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2014 The Marble contributors
+//
+
+#include "BatchRenderer.h"
+#include "MarbleDirs.h"
+#include "MarbleMap.h"
+#include "MarbleModel.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QImage>
+#include <QSignalSpy>
+#include <QTest>
+
+namespace Marble
+{
+
+class BatchRendererTest : public QObject
+{
+    Q_OBJECT
+
+ private Q_SLOTS:
+    void initTestCase();
+
+    void render_data();
+
+    /**
+     * @brief render checks that all jobs are written with their size
+     */
+    void render();
+
+    /**
+     * @brief writeFailure checks that images which cannot be written are reported
+     */
+    void writeFailure();
+
+    /**
+     * @brief mapState checks that render threads paint with the state of map()
+     */
+    void mapState();
+
+    void cleanupTestCase();
+
+ private:
+    static void removeDirectory( const QString &path );
+
+    MarbleModel *m_model;
+    QString m_directory;
+};
+
+void BatchRendererTest::initTestCase()
+{
+    MarbleDirs::setMarbleDataPath( DATA_PATH );
+    MarbleDirs::setMarblePluginPath( PLUGIN_PATH );
+    m_model = new MarbleModel;
+    m_directory = QCoreApplication::applicationDirPath() + "/BatchRendererTest";
+    QDir().mkpath( m_directory );
+}
+
+void BatchRendererTest::cleanupTestCase()
+{
+    removeDirectory( m_directory );
+    delete m_model;
+}
+
+void BatchRendererTest::removeDirectory( const QString &path )
+{
+    QDir directory( path );
+    foreach ( const QString &subdirectory, directory.entryList( QDir::Dirs | QDir::NoDotAndDotDot ) ) {
+        removeDirectory( directory.filePath( subdirectory ) );
+    }
+    foreach ( const QString &fileName, directory.entryList( QDir::Files ) ) {
+        directory.remove( fileName );
+    }
+    QDir().rmdir( path );
+}
+
+void BatchRendererTest::render_data()
+{
+    QTest::addColumn<int>( "renderThreads" );
+
+    QTest::newRow( "one thread" ) << 1;
+    QTest::newRow( "three threads" ) << 3;
+}
+
+void BatchRendererTest::render()
+{
+    QFETCH( int, renderThreads );
+
+    BatchRenderer renderer( m_model );
+    renderer.setRenderThreadCount( renderThreads );
+    renderer.setWriterThreadCount( 2 );
+
+    const GeoDataCoordinates berlin( 13.4, 52.5, 0.0, GeoDataCoordinates::Degree );
+    const GeoDataCoordinates newYork( -74.0, 40.7, 0.0, GeoDataCoordinates::Degree );
+    QList<BatchRenderJob> jobs;
+    jobs << BatchRenderJob( "earth/plain/plain.dgml", Spherical, berlin, 1500, QSize( 160, 120 ),
+                            QString( "%1/%2-berlin.png" ).arg( m_directory ).arg( renderThreads ) );
+    jobs << BatchRenderJob( "earth/plain/plain.dgml", Mercator, newYork, 1200, QSize( 100, 200 ),
+                            QString( "%1/%2-newyork.png" ).arg( m_directory ).arg( renderThreads ) );
+    jobs << BatchRenderJob( "earth/plain/plain.dgml", Equirectangular, berlin, 1000, QSize( 64, 64 ),
+                            QString( "%1/%2-world.png" ).arg( m_directory ).arg( renderThreads ) );
+    jobs << BatchRenderJob( "earth/srtm/srtm.dgml", Spherical, newYork, 1800, QSize( 120, 90 ),
+                            QString( "%1/%2-srtm.png" ).arg( m_directory ).arg( renderThreads ) );
+    foreach ( const BatchRenderJob &job, jobs ) {
+        renderer.addJob( job );
+    }
+    QCOMPARE( renderer.jobCount(), jobs.size() );
+
+    QSignalSpy progressSpy( &renderer, SIGNAL(progress(int,int)) );
+    QSignalSpy failureSpy( &renderer, SIGNAL(writeFailed(QString,QString)) );
+
+    QVERIFY( renderer.render() );
+    QCOMPARE( renderer.jobCount(), 0 );
+    QVERIFY( renderer.failedFiles().isEmpty() );
+    QCOMPARE( failureSpy.count(), 0 );
+    QCOMPARE( progressSpy.count(), jobs.size() );
+    QCOMPARE( progressSpy.last().at( 0 ).toInt(), jobs.size() );
+    QCOMPARE( progressSpy.last().at( 1 ).toInt(), jobs.size() );
+    QVERIFY( renderer.jobsPerSecond() > 0.0 );
+
+    foreach ( const BatchRenderJob &job, jobs ) {
+        const QImage image( job.outputFile() );
+        QVERIFY( !image.isNull() );
+        QCOMPARE( image.size(), job.size() );
+    }
+}
+
+void BatchRendererTest::writeFailure()
+{
+    BatchRenderer renderer( m_model );
+
+    const GeoDataCoordinates center( 0.0, 0.0, 0.0, GeoDataCoordinates::Degree );
+    const QString written = m_directory + "/written.png";
+    const QString missingDirectory = m_directory + "/missing/image.png";
+    renderer.addJob( BatchRenderJob( "earth/plain/plain.dgml", Spherical, center, 1000, QSize( 50, 50 ), written ) );
+    renderer.addJob( BatchRenderJob( "earth/plain/plain.dgml", Spherical, center, 1000, QSize( 50, 50 ), missingDirectory ) );
+
+    QSignalSpy failureSpy( &renderer, SIGNAL(writeFailed(QString,QString)) );
+
+    QVERIFY( !renderer.render() );
+    QCOMPARE( renderer.failedFiles(), QStringList() << missingDirectory );
+    QCOMPARE( failureSpy.count(), 1 );
+    QCOMPARE( failureSpy.first().at( 0 ).toString(), missingDirectory );
+    QVERIFY( !failureSpy.first().at( 1 ).toString().isEmpty() );
+    QVERIFY( !QImage( written ).isNull() );
+}
+
+void BatchRendererTest::mapState()
+{
+    MarbleModel model;
+    model.setClockDateTime( QDateTime( QDate( 2014, 6, 21 ), QTime( 12, 0 ), Qt::UTC ) );
+    model.setClockSpeed( 0 );
+
+    const GeoDataCoordinates center( 13.4, 52.5, 0.0, GeoDataCoordinates::Degree );
+    QStringList files[2];
+    for ( int i = 0; i < 2; ++i ) {
+        BatchRenderer renderer( &model );
+        renderer.setRenderThreadCount( i == 0 ? 1 : 3 );
+        renderer.map()->setMapThemeId( "earth/plain/plain.dgml" );
+        renderer.map()->setShowCities( false );
+        renderer.map()->setShowGrid( true );
+        renderer.map()->setShowSunShading( true );
+
+        // Every thread switches to the other theme, which must keep the properties
+        for ( int job = 0; job < 6; ++job ) {
+            const QString fileName = QString( "%1/state-%2-%3.png" ).arg( m_directory ).arg( i ).arg( job );
+            const QString theme = job % 2 == 0 ? "earth/srtm/srtm.dgml" : "earth/plain/plain.dgml";
+            renderer.addJob( BatchRenderJob( theme, Spherical, center, 1400 + 50 * job, QSize( 80, 60 ), fileName ) );
+            files[i] << fileName;
+        }
+
+        QVERIFY( renderer.render() );
+    }
+
+    for ( int job = 0; job < files[0].size(); ++job ) {
+        const QImage expected( files[0][job] );
+        QVERIFY( !expected.isNull() );
+        QCOMPARE( QImage( files[1][job] ), expected );
+    }
+}
+
+}
+
+QTEST_MAIN( Marble::BatchRendererTest )
+
+#include "BatchRendererTest.moc"
@@ -9,15 +9,48 @@
 //
 
 #include "GeoPainter.h"
+#include "LayerInterface.h"
+#include "MarbleClock.h"
 #include "MarbleMap.h"
 #include "MarbleModel.h"
 #include "TestUtils.h"
 
+#include <QImage>
 #include <QThreadPool>
 
 namespace Marble
 {
 
+class CountingLayer : public LayerInterface
+{
+ public:
+    explicit CountingLayer( CacheInputs inputs )
+        : m_inputs( inputs ),
+          m_renderCount( 0 )
+    {}
+
+    QStringList renderPosition() const { return QStringList() << "USER_TOOLS"; }
+
+    bool render( GeoPainter *painter, ViewportParams *viewport, const QString &renderPos, GeoSceneLayer *layer )
+    {
+        Q_UNUSED( viewport );
+        Q_UNUSED( renderPos );
+        Q_UNUSED( layer );
+
+        painter->fillRect( QRect( 0, 0, 10, 10 ), Qt::red );
+        ++m_renderCount;
+        return true;
+    }
+
+    CacheInputs cacheInputs() const { return m_inputs; }
+
+    int renderCount() const { return m_renderCount; }
+
+ private:
+    const CacheInputs m_inputs;
+    int m_renderCount;
+};
+
 class MarbleMapTest : public QObject
 {
     Q_OBJECT
@@ -66,7 +99,15 @@ class MarbleMapTest : public QObject
     void paint_data();
     void paint();
 
+    /**
+     * @brief layerCache checks that cached layers are only rendered again after one of
+     * their declared inputs changed
+     */
+    void layerCache();
+
  private:
+    static void paintMap( MarbleMap *map, QImage *image );
+
     MarbleModel m_model;
 };
 
@@ -594,6 +635,90 @@ void MarbleMapTest::paint()
     QThreadPool::globalInstance()->waitForDone();  // wait for all runners to terminate
 }
 
+void MarbleMapTest::paintMap( MarbleMap *map, QImage *image )
+{
+    image->fill( Qt::transparent );
+    GeoPainter painter( image, map->viewport(), map->mapQuality() );
+    map->paint( painter, image->rect() );
+}
+
+void MarbleMapTest::layerCache()
+{
+    MarbleModel model;
+    MarbleMap map( &model );
+    map.setMapThemeId( "earth/plain/plain.dgml" );
+    map.setSize( 200, 200 );
+
+    CountingLayer viewportLayer( LayerInterface::ViewportInput );
+    CountingLayer clockLayer( LayerInterface::ClockInput );
+    CountingLayer modelLayer( LayerInterface::ModelInput );
+    map.addLayer( &viewportLayer );
+    map.addLayer( &clockLayer );
+    map.addLayer( &modelLayer );
+
+    QImage image( map.size(), QImage::Format_ARGB32_Premultiplied );
+
+    // disabled by default
+    QVERIFY( !map.isLayerCacheEnabled() );
+    paintMap( &map, &image );
+    paintMap( &map, &image );
+    QCOMPARE( viewportLayer.renderCount(), 2 );
+    QCOMPARE( clockLayer.renderCount(), 2 );
+    QCOMPARE( modelLayer.renderCount(), 2 );
+    QCOMPARE( map.layerCacheMisses( &viewportLayer ), 0 );
+    QCOMPARE( map.layerCacheHits( &viewportLayer ), 0 );
+
+    map.setLayerCacheEnabled( true );
+    QVERIFY( map.isLayerCacheEnabled() );
+    paintMap( &map, &image );
+    paintMap( &map, &image );
+    QCOMPARE( viewportLayer.renderCount(), 3 );
+    QCOMPARE( clockLayer.renderCount(), 3 );
+    QCOMPARE( modelLayer.renderCount(), 3 );
+    QCOMPARE( map.layerCacheMisses( &viewportLayer ), 1 );
+    QCOMPARE( map.layerCacheHits( &viewportLayer ), 1 );
+
+    // the cached image is composited
+    QCOMPARE( image.pixel( 5, 5 ), QColor( Qt::red ).rgba() );
+
+    map.centerOn( 10.0, 20.0 );
+    paintMap( &map, &image );
+    QCOMPARE( viewportLayer.renderCount(), 4 );
+    QCOMPARE( clockLayer.renderCount(), 3 );
+    QCOMPARE( modelLayer.renderCount(), 3 );
+
+    model.clock()->setDateTime( model.clock()->dateTime().addSecs( 3600 ) );
+    paintMap( &map, &image );
+    QCOMPARE( viewportLayer.renderCount(), 4 );
+    QCOMPARE( clockLayer.renderCount(), 4 );
+    QCOMPARE( modelLayer.renderCount(), 3 );
+
+    map.invalidateLayerCache( &modelLayer );
+    paintMap( &map, &image );
+    QCOMPARE( viewportLayer.renderCount(), 4 );
+    QCOMPARE( clockLayer.renderCount(), 4 );
+    QCOMPARE( modelLayer.renderCount(), 4 );
+
+    map.invalidateLayerCache();
+    paintMap( &map, &image );
+    QCOMPARE( viewportLayer.renderCount(), 4 );
+    QCOMPARE( clockLayer.renderCount(), 4 );
+    QCOMPARE( modelLayer.renderCount(), 5 );
+
+    QCOMPARE( map.layerCacheMisses( &modelLayer ), 3 );
+    QCOMPARE( map.layerCacheHits( &modelLayer ), 3 );
+
+    map.resetLayerCacheStatistics();
+    QCOMPARE( map.layerCacheMisses( &modelLayer ), 0 );
+    QCOMPARE( map.layerCacheHits( &modelLayer ), 0 );
+
+    map.removeLayer( &viewportLayer );
+    map.removeLayer( &clockLayer );
+    map.removeLayer( &modelLayer );
+
+    QThreadPool::globalInstance()->waitForDone();  // wait for all runners to terminate
+}
+
 }
 
 QTEST_MAIN( Marble::MarbleMapTest )
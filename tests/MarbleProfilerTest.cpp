@@ -0,0 +1,122 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2014 The Marble contributors
+//
+
+#include "MarbleProfiler.h"
+
+#include <QThread>
+#include <QTest>
+
+namespace Marble
+{
+
+class ProfiledThread : public QThread
+{
+protected:
+    void run()
+    {
+        MARBLE_PROFILE_SCOPE( "worker" );
+    }
+};
+
+class MarbleProfilerTest : public QObject
+{
+    Q_OBJECT
+
+ private slots:
+    void cleanup();
+
+    void disabledByDefault();
+    void nestedScopes();
+    void threads();
+    void clear();
+    void ringBufferOverflow();
+};
+
+void MarbleProfilerTest::cleanup()
+{
+    MarbleProfiler::setEnabled( false );
+    MarbleProfiler::clear();
+}
+
+void MarbleProfilerTest::disabledByDefault()
+{
+    QVERIFY( !MarbleProfiler::isEnabled() );
+
+    {
+        MARBLE_PROFILE_SCOPE( "disabled" );
+    }
+
+    QVERIFY( !MarbleProfiler::chromeTrace().contains( "\"disabled\"" ) );
+}
+
+void MarbleProfilerTest::nestedScopes()
+{
+    MarbleProfiler::setEnabled( true );
+
+    {
+        MARBLE_PROFILE_SCOPE( "outer" );
+        MARBLE_PROFILE_SCOPE( "inner" );
+    }
+
+    const QByteArray trace = MarbleProfiler::chromeTrace();
+    QVERIFY( trace.startsWith( "{\"traceEvents\":[" ) );
+    QVERIFY( trace.contains( "\"name\":\"outer\"" ) );
+    QVERIFY( trace.contains( "\"name\":\"inner\"" ) );
+    QVERIFY( trace.contains( "\"ph\":\"X\"" ) );
+}
+
+void MarbleProfilerTest::threads()
+{
+    MarbleProfiler::setEnabled( true );
+
+    ProfiledThread thread;
+    thread.setObjectName( "Profiled Thread" );
+    thread.start();
+    QVERIFY( thread.wait() );
+
+    const QByteArray trace = MarbleProfiler::chromeTrace();
+    QVERIFY( trace.contains( "\"name\":\"worker\"" ) );
+    QVERIFY( trace.contains( "\"name\":\"Profiled Thread\"" ) );
+}
+
+void MarbleProfilerTest::clear()
+{
+    MarbleProfiler::setEnabled( true );
+
+    {
+        MARBLE_PROFILE_SCOPE( "cleared" );
+    }
+
+    MarbleProfiler::clear();
+    QVERIFY( !MarbleProfiler::chromeTrace().contains( "\"cleared\"" ) );
+
+    MarbleProfiler::addEvent( MarbleProfiler::internedName( "interned" ), 0, 1000 );
+    QVERIFY( MarbleProfiler::chromeTrace().contains( "\"name\":\"interned\"" ) );
+}
+
+void MarbleProfilerTest::ringBufferOverflow()
+{
+    MarbleProfiler::setEnabled( true );
+
+    MarbleProfiler::addEvent( "oldest", 0, 1 );
+    for ( int i = 0; i < 100000; ++i ) {
+        MarbleProfiler::addEvent( "newer", i, 1 );
+    }
+
+    const QByteArray trace = MarbleProfiler::chromeTrace();
+    QVERIFY( !trace.contains( "\"oldest\"" ) );
+    QVERIFY( trace.contains( "\"newer\"" ) );
+}
+
+}
+
+QTEST_MAIN( Marble::MarbleProfilerTest )
+
+#include "MarbleProfilerTest.moc"
@@ -0,0 +1,117 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2014 The Marble contributors
+//
+
+#include "MarbleDirs.h"
+#include "MarbleMap.h"
+#include "MarbleQuickItem.h"
+
+#include <QImage>
+#include <QQuickWindow>
+#include <QSignalSpy>
+#include <QTest>
+
+namespace Marble
+{
+
+class TestQuickItem : public MarbleQuickItem
+{
+ public:
+    MarbleMap *testMap() { return map(); }
+};
+
+class MarbleQuickItemTest : public QObject
+{
+    Q_OBJECT
+
+ private Q_SLOTS:
+    void initTestCase();
+
+    /**
+     * @brief renderMode checks that changes of the render mode are notified
+     */
+    void renderMode();
+
+    /**
+     * @brief textureRendering checks that frames are painted in the render thread and shown
+     */
+    void textureRendering();
+
+ private:
+    static bool isBlank( const QImage &image );
+};
+
+void MarbleQuickItemTest::initTestCase()
+{
+    MarbleDirs::setMarbleDataPath( DATA_PATH );
+    MarbleDirs::setMarblePluginPath( PLUGIN_PATH );
+}
+
+bool MarbleQuickItemTest::isBlank( const QImage &image )
+{
+    for ( int y = 0; y < image.height(); ++y ) {
+        for ( int x = 0; x < image.width(); ++x ) {
+            if ( image.pixel( x, y ) != image.pixel( 0, 0 ) ) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void MarbleQuickItemTest::renderMode()
+{
+    TestQuickItem item;
+    QCOMPARE( item.renderMode(), MarbleQuickItem::PaintedRendering );
+
+    QSignalSpy spy( &item, SIGNAL(renderModeChanged(RenderMode)) );
+    item.setRenderMode( MarbleQuickItem::TextureRendering );
+    QCOMPARE( item.renderMode(), MarbleQuickItem::TextureRendering );
+    QCOMPARE( spy.count(), 1 );
+
+    item.setRenderMode( MarbleQuickItem::TextureRendering );
+    QCOMPARE( spy.count(), 1 );
+
+    item.setRenderMode( MarbleQuickItem::PaintedRendering );
+    QCOMPARE( item.renderMode(), MarbleQuickItem::PaintedRendering );
+    QCOMPARE( spy.count(), 2 );
+}
+
+void MarbleQuickItemTest::textureRendering()
+{
+    QQuickWindow window;
+    window.resize( 200, 150 );
+
+    TestQuickItem item;
+    item.setParentItem( window.contentItem() );
+    item.setSize( QSizeF( 200, 150 ) );
+    item.testMap()->setMapThemeId( "earth/plain/plain.dgml" );
+    item.setRenderMode( MarbleQuickItem::TextureRendering );
+
+    // The map of the item is only used for input handling and as the source of the state
+    QSignalSpy itemPaintSpy( item.testMap(), SIGNAL(framesPerSecond(qreal)) );
+
+    window.show();
+    QVERIFY( QTest::qWaitForWindowExposed( &window ) );
+    QTRY_VERIFY_WITH_TIMEOUT( !isBlank( window.grabWindow() ), 10000 );
+    QCOMPARE( itemPaintSpy.count(), 0 );
+
+    // Panning shows the previous frame moved until the next one arrives
+    item.testMap()->centerOn( 40.0, 10.0 );
+    item.update();
+    QTest::qWait( 100 );
+    QVERIFY( !isBlank( window.grabWindow() ) );
+    QCOMPARE( itemPaintSpy.count(), 0 );
+}
+
+}
+
+QTEST_MAIN( Marble::MarbleQuickItemTest )
+
+#include "MarbleQuickItemTest.moc"
@@ -0,0 +1,214 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2014 The Marble contributors
+//
+
+#include "OsmDatabase.h"
+
+#include "DatabaseQuery.h"
+#include "GeoDataLatLonBox.h"
+
+#include <QDir>
+#include <QFile>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QStringList>
+#include <QTest>
+#include <QVariant>
+
+using namespace Marble;
+
+class OsmDatabaseTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void findVersusUnindexed_data();
+    void findVersusUnindexed();
+
+    void benchmarkFind_data();
+    void benchmarkFind();
+
+private:
+    static void generateDatabase( const QString &fileName, bool searchIndexes );
+
+    static void addQueries();
+
+    QString m_indexedFile;
+    QString m_plainFile;
+};
+
+namespace
+{
+
+const char *const words[] = { "Haupt", "Linden", "Bahnhof", "Kirch", "Schul", "Berg", "Wald", "Garten",
+                              "Rosen", "Eichen", "Birken", "Mühlen", "Brunnen", "Markt", "Post", "Tal",
+                              "Feld", "Wiesen", "Sonnen", "Kastanien" };
+const int wordCount = sizeof( words ) / sizeof( words[0] );
+
+const char *const suffixes[] = { "strasse", "weg", "allee", "platz", "gasse" };
+const int suffixCount = sizeof( suffixes ) / sizeof( suffixes[0] );
+
+const int placemarkCount = 200000;
+
+GeoDataLatLonBox preferredBox()
+{
+    return GeoDataLatLonBox( 49.05, 48.95, 8.45, 8.35, GeoDataCoordinates::Degree );
+}
+
+}
+
+void OsmDatabaseTest::generateDatabase( const QString &fileName, bool searchIndexes )
+{
+    QFile::remove( fileName );
+    {
+        QSqlDatabase database = QSqlDatabase::addDatabase( "QSQLITE", "OsmDatabaseTest" );
+        database.setDatabaseName( fileName );
+        QVERIFY( database.open() );
+
+        OsmDatabase::createTables( database );
+
+        QSqlQuery query( database );
+        QVERIFY( query.exec( "BEGIN TRANSACTION" ) );
+
+        // Nested set of regions
+        QVERIFY( query.exec( "INSERT INTO regions VALUES (1, 0, 1, 6, 'Baden-Wuerttemberg', 8.5, 49.0)" ) );
+        QVERIFY( query.exec( "INSERT INTO regions VALUES (2, 1, 2, 3, 'Karlsruhe', 8.4, 49.0)" ) );
+        QVERIFY( query.exec( "INSERT INTO regions VALUES (3, 1, 4, 5, 'Mannheim', 8.5, 49.5)" ) );
+
+        QVERIFY( query.prepare( "INSERT INTO names (id, name) VALUES (?, ?)" ) );
+        int nameId = 0;
+        for ( int i = 0; i < wordCount; ++i ) {
+            for ( int j = 0; j < wordCount; ++j ) {
+                for ( int k = 0; k < wordCount; ++k ) {
+                    for ( int l = 0; l < suffixCount; ++l ) {
+                        QString const name = QString::fromUtf8( words[i] ) + QString::fromUtf8( words[j] ).toLower()
+                                + QString::fromUtf8( words[k] ).toLower() + suffixes[l];
+                        query.addBindValue( ++nameId );
+                        query.addBindValue( name );
+                        QVERIFY( query.exec() );
+                    }
+                }
+            }
+        }
+
+        QVERIFY( query.prepare( "INSERT INTO placemarks (regionId, nameId, number, category, lon, lat) VALUES (?, ?, ?, ?, ?, ?)" ) );
+        qsrand( 42 );
+        for ( int i = 0; i < placemarkCount; ++i ) {
+            int const type = qrand() % 10;
+            OsmPlacemark::OsmCategory const category = type < 6 ? OsmPlacemark::Address
+                    : type < 9 ? OsmPlacemark::UnknownCategory
+                    : ( qrand() % 2 ? OsmPlacemark::AccomodationHotel : OsmPlacemark::FoodRestaurant );
+            qreal const lon = 8.0 + qrand() / qreal( RAND_MAX );
+            qreal const lat = 48.5 + qrand() / qreal( RAND_MAX );
+            query.addBindValue( lat < 49.2 ? 2 : 3 );
+            query.addBindValue( 1 + qrand() % nameId );
+            query.addBindValue( category == OsmPlacemark::Address ? QVariant( QString::number( 1 + qrand() % 99 ) ) : QVariant( QVariant::String ) );
+            query.addBindValue( ( int ) category );
+            query.addBindValue( lon );
+            query.addBindValue( lat );
+            QVERIFY( query.exec() );
+        }
+
+        QVERIFY( query.exec( "END TRANSACTION" ) );
+
+        OsmDatabase::createIndexes( database );
+        if ( searchIndexes ) {
+            QVERIFY( OsmDatabase::createSearchIndexes( database ) );
+        }
+    }
+
+    QSqlDatabase::removeDatabase( "OsmDatabaseTest" );
+}
+
+void OsmDatabaseTest::initTestCase()
+{
+    m_indexedFile = QDir::temp().filePath( "marble-osmdatabasetest-indexed.sqlite" );
+    m_plainFile = QDir::temp().filePath( "marble-osmdatabasetest-plain.sqlite" );
+
+    generateDatabase( m_indexedFile, true );
+    generateDatabase( m_plainFile, false );
+}
+
+void OsmDatabaseTest::cleanupTestCase()
+{
+    QFile::remove( m_indexedFile );
+    QFile::remove( m_plainFile );
+}
+
+void OsmDatabaseTest::addQueries()
+{
+    QTest::addColumn<QString>( "searchTerm" );
+    QTest::addColumn<bool>( "preferPosition" );
+
+    // Each name is used by five places on average. The terms are chosen to match
+    // less than 50 places, so that the results do not depend on the order in
+    // which the database scans the places.
+    QTest::newRow( "exact" ) << "Hauptlindenbergweg" << false;
+    QTest::newRow( "prefix" ) << "Hauptlindenberg*" << false;
+    QTest::newRow( "prefix lowercase" ) << "hauptlindenberg*" << false;
+    QTest::newRow( "infix" ) << "Hauptlinden*bergallee" << false;
+    QTest::newRow( "leading wildcard" ) << "*dentalrosenweg" << false;
+    QTest::newRow( "address wildcard" ) << "Kirchberg* 1*, Karlsruhe" << false;
+    QTest::newRow( "street in region" ) << "Markttal*gasse, Mannheim" << false;
+    QTest::newRow( "near hotels" ) << "hotel" << true;
+    QTest::newRow( "near pois" ) << "pois" << true;
+    QTest::newRow( "hotels in region" ) << "hotel, Mannheim" << true;
+}
+
+void OsmDatabaseTest::findVersusUnindexed_data()
+{
+    addQueries();
+}
+
+void OsmDatabaseTest::findVersusUnindexed()
+{
+    QFETCH( QString, searchTerm );
+    QFETCH( bool, preferPosition );
+
+    const DatabaseQuery query( 0, searchTerm, preferPosition ? preferredBox() : GeoDataLatLonBox() );
+
+    OsmDatabase indexed( QStringList() << m_indexedFile );
+    OsmDatabase plain( QStringList() << m_plainFile );
+
+    const QVector<OsmPlacemark> expected = plain.find( query );
+    const QVector<OsmPlacemark> result = indexed.find( query );
+
+    QCOMPARE( result.size(), expected.size() );
+    for ( int i = 0; i < result.size(); ++i ) {
+        QCOMPARE( result[i].name(), expected[i].name() );
+        QCOMPARE( result[i].houseNumber(), expected[i].houseNumber() );
+        QCOMPARE( result[i].longitude(), expected[i].longitude() );
+        QCOMPARE( result[i].latitude(), expected[i].latitude() );
+    }
+}
+
+void OsmDatabaseTest::benchmarkFind_data()
+{
+    addQueries();
+}
+
+void OsmDatabaseTest::benchmarkFind()
+{
+    QFETCH( QString, searchTerm );
+    QFETCH( bool, preferPosition );
+
+    const DatabaseQuery query( 0, searchTerm, preferPosition ? preferredBox() : GeoDataLatLonBox() );
+    OsmDatabase database( QStringList() << m_indexedFile << m_indexedFile );
+
+    QBENCHMARK {
+        database.find( query );
+    }
+}
+
+QTEST_MAIN( OsmDatabaseTest )
+
+#include "OsmDatabaseTest.moc"
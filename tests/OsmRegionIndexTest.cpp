@@ -0,0 +1,184 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2014 The Marble contributors
+//
+
+#include "OsmRegion.h"
+#include "OsmRegionIndex.h"
+#include "OsmRegionTree.h"
+
+#include "GeoDataLinearRing.h"
+
+#include <QTest>
+
+#include <cmath>
+
+namespace Marble
+{
+
+class OsmRegionIndexTest : public QObject
+{
+    Q_OBJECT
+
+ private slots:
+    void initTestCase();
+
+    void sameResultsAsTree();
+    void parallelLookup();
+
+    void benchmarkTree();
+    void benchmarkIndex();
+
+ private:
+    static GeoDataLinearRing jaggedSquare( qreal west, qreal south, qreal size );
+
+    static OsmRegion region( int parent, int adminLevel, const GeoDataPolygon &polygon );
+
+    OsmRegionTree m_tree;
+    QVector<GeoDataCoordinates> m_positions;
+};
+
+GeoDataLinearRing OsmRegionIndexTest::jaggedSquare( qreal west, qreal south, qreal size )
+{
+    // Square with wobbly edges and many vertices, similar to administrative boundaries
+    int const pointsPerSide = 64;
+    GeoDataLinearRing ring;
+    for ( int i = 0; i < pointsPerSide; ++i ) {
+        qreal const t = size * i / pointsPerSide;
+        qreal const wobble = 0.02 * size * sin( i * 1.7 );
+        ring << GeoDataCoordinates( west + t, south + wobble, 0.0, GeoDataCoordinates::Degree );
+    }
+    for ( int i = 0; i < pointsPerSide; ++i ) {
+        qreal const t = size * i / pointsPerSide;
+        qreal const wobble = 0.02 * size * sin( i * 2.3 );
+        ring << GeoDataCoordinates( west + size + wobble, south + t, 0.0, GeoDataCoordinates::Degree );
+    }
+    for ( int i = 0; i < pointsPerSide; ++i ) {
+        qreal const t = size * i / pointsPerSide;
+        qreal const wobble = 0.02 * size * sin( i * 1.1 );
+        ring << GeoDataCoordinates( west + size - t, south + size + wobble, 0.0, GeoDataCoordinates::Degree );
+    }
+    for ( int i = 0; i < pointsPerSide; ++i ) {
+        qreal const t = size * i / pointsPerSide;
+        qreal const wobble = 0.02 * size * sin( i * 2.9 );
+        ring << GeoDataCoordinates( west + wobble, south + size - t, 0.0, GeoDataCoordinates::Degree );
+    }
+
+    return ring;
+}
+
+OsmRegion OsmRegionIndexTest::region( int parent, int adminLevel, const GeoDataPolygon &polygon )
+{
+    OsmRegion result;
+    result.setParentIdentifier( parent );
+    result.setAdminLevel( adminLevel );
+    result.setGeometry( polygon );
+    return result;
+}
+
+static bool moreImportantAdminArea( const OsmRegion &a, const OsmRegion &b )
+{
+    return a.adminLevel() < b.adminLevel();
+}
+
+void OsmRegionIndexTest::initTestCase()
+{
+    // Synthetic region set: one country with 8x8 states of 4x4 districts each.
+    // Every third district has a hole.
+    OsmRegion mainArea;
+    mainArea.setIdentifier( 0 );
+    mainArea.setAdminLevel( 1 );
+
+    QList<OsmRegion> regions;
+
+    GeoDataPolygon countryPolygon;
+    countryPolygon.setOuterBoundary( jaggedSquare( 0.0, 0.0, 40.0 ) );
+    OsmRegion const country = region( 0, 2, countryPolygon );
+    regions << country;
+
+    int districtCount = 0;
+    for ( int x = 0; x < 8; ++x ) {
+        for ( int y = 0; y < 8; ++y ) {
+            GeoDataPolygon statePolygon;
+            statePolygon.setOuterBoundary( jaggedSquare( x * 5.0, y * 5.0, 5.0 ) );
+            OsmRegion const state = region( country.identifier(), 4, statePolygon );
+            regions << state;
+
+            for ( int i = 0; i < 4; ++i ) {
+                for ( int j = 0; j < 4; ++j ) {
+                    qreal const west = x * 5.0 + i * 1.25;
+                    qreal const south = y * 5.0 + j * 1.25;
+                    GeoDataPolygon districtPolygon;
+                    districtPolygon.setOuterBoundary( jaggedSquare( west, south, 1.25 ) );
+                    if ( ++districtCount % 3 == 0 ) {
+                        districtPolygon.appendInnerBoundary( jaggedSquare( west + 0.4, south + 0.4, 0.4 ) );
+                    }
+                    regions << region( state.identifier(), 6, districtPolygon );
+                }
+            }
+        }
+    }
+
+    qSort( regions.begin(), regions.end(), moreImportantAdminArea );
+    m_tree = OsmRegionTree( mainArea );
+    m_tree.append( regions );
+    QVERIFY( regions.isEmpty() );
+    int left = 0;
+    m_tree.traverse( left );
+
+    qsrand( 42 );
+    for ( int i = 0; i < 20000; ++i ) {
+        qreal const lon = -2.0 + 44.0 * qrand() / RAND_MAX;
+        qreal const lat = -2.0 + 44.0 * qrand() / RAND_MAX;
+        m_positions << GeoDataCoordinates( lon, lat, 0.0, GeoDataCoordinates::Degree );
+    }
+}
+
+void OsmRegionIndexTest::sameResultsAsTree()
+{
+    OsmRegionIndex const index( m_tree );
+
+    foreach( const GeoDataCoordinates &position, m_positions ) {
+        QCOMPARE( index.smallestRegionId( position ), m_tree.smallestRegionId( position ) );
+    }
+}
+
+void OsmRegionIndexTest::parallelLookup()
+{
+    OsmRegionIndex const index( m_tree );
+
+    QVector<int> const regionIds = index.smallestRegionIds( m_positions );
+    QCOMPARE( regionIds.size(), m_positions.size() );
+    for ( int i = 0; i < m_positions.size(); ++i ) {
+        QCOMPARE( regionIds[i], m_tree.smallestRegionId( m_positions[i] ) );
+    }
+}
+
+void OsmRegionIndexTest::benchmarkTree()
+{
+    QBENCHMARK {
+        foreach( const GeoDataCoordinates &position, m_positions ) {
+            m_tree.smallestRegionId( position );
+        }
+    }
+}
+
+void OsmRegionIndexTest::benchmarkIndex()
+{
+    OsmRegionIndex const index( m_tree );
+
+    QBENCHMARK {
+        index.smallestRegionIds( m_positions );
+    }
+}
+
+}
+
+QTEST_MAIN( Marble::OsmRegionIndexTest )
+
+#include "OsmRegionIndexTest.moc"
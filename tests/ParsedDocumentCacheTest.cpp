@@ -0,0 +1,293 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2014 The Marble contributors
+//
+
+#include "GeoDataData.h"
+#include "GeoDataDocument.h"
+#include "GeoDataExtendedData.h"
+#include "GeoDataFolder.h"
+#include "GeoDataParser.h"
+#include "GeoDataPlacemark.h"
+#include "GeoDataStyle.h"
+#include "GeoDataTypes.h"
+#include "ParsedDocumentCache.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTest>
+
+namespace Marble
+{
+
+class ParsedDocumentCacheTest : public QObject
+{
+    Q_OBJECT
+
+ private Q_SLOTS:
+    void initTestCase();
+
+    /**
+     * @brief roundTrip checks that a cached document matches the parsed one
+     */
+    void roundTrip();
+
+    /**
+     * @brief invalidation checks that a changed source file is parsed again
+     */
+    void invalidation();
+
+    /**
+     * @brief notCacheable checks that documents pack() cannot store are skipped
+     */
+    void notCacheable();
+
+    /**
+     * @brief pruning checks that the least recently used snapshots are removed first
+     */
+    void pruning();
+
+    void benchmarkParse();
+    void benchmarkCacheLoad();
+
+    void cleanupTestCase();
+
+ private:
+    static QString createKml( int placemarkCount );
+
+    static bool writeFile( const QString &fileName, const QString &content );
+
+    static GeoDataDocument *parse( const QString &fileName );
+
+    QString m_directory;
+    QString m_largeFile;
+};
+
+QString ParsedDocumentCacheTest::createKml( int placemarkCount )
+{
+    QString kml = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+                  "<kml xmlns=\"http://www.opengis.net/kml/2.2\"><Document><name>Test</name>"
+                  "<Style id=\"line\"><LineStyle><color>ff0000ff</color><width>3</width></LineStyle></Style>"
+                  "<Folder><name>Places</name>";
+    for ( int i = 0; i < placemarkCount; ++i ) {
+        kml += QString( "<Placemark><name>Place %1</name><styleUrl>#line</styleUrl>"
+                        "<ExtendedData><Data name=\"index\"><value>%1</value></Data></ExtendedData>"
+                        "<LineString><coordinates>%2,%3 %4,%5</coordinates></LineString></Placemark>" )
+                .arg( i )
+                .arg( -180.0 + ( i % 3600 ) * 0.1 )
+                .arg( -90.0 + ( i / 3600 ) * 0.1 )
+                .arg( -180.0 + ( i % 3600 ) * 0.1 + 0.05 )
+                .arg( -90.0 + ( i / 3600 ) * 0.1 + 0.05 );
+    }
+    kml += "</Folder></Document></kml>";
+    return kml;
+}
+
+bool ParsedDocumentCacheTest::writeFile( const QString &fileName, const QString &content )
+{
+    QFile file( fileName );
+    if ( !file.open( QIODevice::WriteOnly ) ) {
+        return false;
+    }
+    return file.write( content.toUtf8() ) > 0;
+}
+
+GeoDataDocument *ParsedDocumentCacheTest::parse( const QString &fileName )
+{
+    QFile file( fileName );
+    if ( !file.open( QIODevice::ReadOnly ) ) {
+        return 0;
+    }
+
+    GeoDataParser parser( GeoData_KML );
+    if ( !parser.read( &file ) ) {
+        return 0;
+    }
+
+    GeoDataDocument *document = static_cast<GeoDataDocument*>( parser.releaseDocument() );
+    document->setFileName( fileName );
+    document->setBaseUri( fileName );
+    return document;
+}
+
+void ParsedDocumentCacheTest::initTestCase()
+{
+    m_directory = QCoreApplication::applicationDirPath() + "/ParsedDocumentCacheTest";
+    QDir().mkpath( m_directory );
+
+    m_largeFile = m_directory + "/large.kml";
+    QVERIFY( writeFile( m_largeFile, createKml( 50000 ) ) );
+}
+
+void ParsedDocumentCacheTest::cleanupTestCase()
+{
+    QDir directory( m_directory );
+    foreach ( const QString &fileName, directory.entryList( QDir::Files ) ) {
+        directory.remove( fileName );
+    }
+    QDir().rmdir( m_directory );
+}
+
+void ParsedDocumentCacheTest::roundTrip()
+{
+    const QString fileName = m_directory + "/roundtrip.kml";
+    QVERIFY( writeFile( fileName, createKml( 10 ) ) );
+
+    GeoDataDocument *parsed = parse( fileName );
+    QVERIFY( parsed );
+
+    ParsedDocumentCache cache( m_directory );
+    QVERIFY( ParsedDocumentCache::isCacheable( parsed ) );
+    QVERIFY( cache.save( fileName, parsed ) );
+
+    GeoDataDocument *cached = cache.load( fileName );
+    QVERIFY( cached );
+    QCOMPARE( cached->fileName(), fileName );
+    QCOMPARE( cached->name(), parsed->name() );
+    QCOMPARE( cached->size(), 1 );
+    QCOMPARE( cached->at( 0 ).nodeType(), GeoDataTypes::GeoDataFolderType );
+
+    const GeoDataFolder *parsedFolder = parsed->folderList().first();
+    const GeoDataFolder *cachedFolder = cached->folderList().first();
+    QCOMPARE( cachedFolder->size(), parsedFolder->size() );
+
+    for ( int i = 0; i < parsedFolder->size(); ++i ) {
+        const GeoDataPlacemark *expected = parsedFolder->placemarkList().at( i );
+        const GeoDataPlacemark *actual = cachedFolder->placemarkList().at( i );
+        QCOMPARE( actual->name(), expected->name() );
+        QCOMPARE( actual->styleUrl(), expected->styleUrl() );
+        QCOMPARE( actual->style()->lineStyle().width(), expected->style()->lineStyle().width() );
+        QCOMPARE( actual->style()->lineStyle().color(), expected->style()->lineStyle().color() );
+        QCOMPARE( actual->extendedData().value( "index" ).value(), expected->extendedData().value( "index" ).value() );
+        QCOMPARE( actual->geometry()->nodeType(), GeoDataTypes::GeoDataLineStringType );
+        QVERIFY( actual->geometry()->latLonAltBox() == expected->geometry()->latLonAltBox() );
+        QVERIFY( actual->parent() == cachedFolder );
+    }
+
+    delete parsed;
+    delete cached;
+}
+
+void ParsedDocumentCacheTest::invalidation()
+{
+    const QString fileName = m_directory + "/invalidation.kml";
+    QVERIFY( writeFile( fileName, createKml( 3 ) ) );
+
+    GeoDataDocument *parsed = parse( fileName );
+    QVERIFY( parsed );
+
+    ParsedDocumentCache cache( m_directory );
+    QVERIFY( cache.save( fileName, parsed ) );
+    delete parsed;
+
+    GeoDataDocument *cached = cache.load( fileName );
+    QVERIFY( cached );
+    delete cached;
+
+    QVERIFY( writeFile( fileName, createKml( 4 ) ) );
+    QVERIFY( cache.load( fileName ) == 0 );
+
+    QFile::remove( fileName );
+    QVERIFY( cache.load( fileName ) == 0 );
+}
+
+void ParsedDocumentCacheTest::notCacheable()
+{
+    const QString fileName = m_directory + "/overlay.kml";
+    QVERIFY( writeFile( fileName,
+                        "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+                        "<kml xmlns=\"http://www.opengis.net/kml/2.2\"><Document>"
+                        "<GroundOverlay><name>Overlay</name><Icon><href>overlay.png</href></Icon>"
+                        "<LatLonBox><north>1</north><south>0</south><east>1</east><west>0</west></LatLonBox>"
+                        "</GroundOverlay></Document></kml>" ) );
+
+    GeoDataDocument *parsed = parse( fileName );
+    QVERIFY( parsed );
+
+    ParsedDocumentCache cache( m_directory );
+    QVERIFY( !ParsedDocumentCache::isCacheable( parsed ) );
+    QVERIFY( !cache.save( fileName, parsed ) );
+    QVERIFY( !QFile::exists( cache.cacheFileName( fileName ) ) );
+    QVERIFY( cache.load( fileName ) == 0 );
+
+    delete parsed;
+}
+
+void ParsedDocumentCacheTest::pruning()
+{
+    const QString directory = m_directory + "/pruning";
+    QStringList fileNames;
+    for ( int i = 0; i < 3; ++i ) {
+        fileNames << m_directory + QString( "/pruning%1.kml" ).arg( i );
+        QVERIFY( writeFile( fileNames.last(), createKml( 100 ) ) );
+    }
+
+    ParsedDocumentCache cache( directory );
+    for ( int i = 0; i < 2; ++i ) {
+        GeoDataDocument *parsed = parse( fileNames.at( i ) );
+        QVERIFY( cache.save( fileNames.at( i ), parsed ) );
+        delete parsed;
+    }
+    const qint64 snapshotSize = QFileInfo( cache.cacheFileName( fileNames.at( 0 ) ) ).size();
+    QVERIFY( snapshotSize > 0 );
+
+    // Modification times mark the use of snapshots, wait for them to differ
+    QTest::qSleep( 1100 );
+    GeoDataDocument *cached = cache.load( fileNames.at( 0 ) );
+    QVERIFY( cached );
+    delete cached;
+    QTest::qSleep( 1100 );
+
+    // Room for two snapshots: the second one is the least recently used
+    cache.setMaximumSize( 2 * snapshotSize + snapshotSize / 2 );
+    GeoDataDocument *parsed = parse( fileNames.at( 2 ) );
+    QVERIFY( cache.save( fileNames.at( 2 ), parsed ) );
+    delete parsed;
+
+    QVERIFY( QFile::exists( cache.cacheFileName( fileNames.at( 0 ) ) ) );
+    QVERIFY( !QFile::exists( cache.cacheFileName( fileNames.at( 1 ) ) ) );
+    QVERIFY( QFile::exists( cache.cacheFileName( fileNames.at( 2 ) ) ) );
+
+    QDir pruningDirectory( directory );
+    foreach ( const QString &fileName, pruningDirectory.entryList( QDir::Files ) ) {
+        pruningDirectory.remove( fileName );
+    }
+    QDir().rmdir( directory );
+}
+
+void ParsedDocumentCacheTest::benchmarkParse()
+{
+    QBENCHMARK_ONCE {
+        GeoDataDocument *document = parse( m_largeFile );
+        QVERIFY( document );
+        delete document;
+    }
+}
+
+void ParsedDocumentCacheTest::benchmarkCacheLoad()
+{
+    ParsedDocumentCache cache( m_directory );
+    GeoDataDocument *parsed = parse( m_largeFile );
+    QVERIFY( parsed );
+    QVERIFY( cache.save( m_largeFile, parsed ) );
+    delete parsed;
+
+    QBENCHMARK_ONCE {
+        GeoDataDocument *document = cache.load( m_largeFile );
+        QVERIFY( document );
+        delete document;
+    }
+}
+
+}
+
+QTEST_MAIN( Marble::ParsedDocumentCacheTest )
+
+#include "ParsedDocumentCacheTest.moc"
@@ -0,0 +1,137 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2014 The Marble contributors
+//
+
+#include "GeoDataDocument.h"
+#include "GeoDataLabelStyle.h"
+#include "GeoDataPlacemark.h"
+#include "GeoDataStyle.h"
+#include "GeoDataTreeModel.h"
+#include "MarbleClock.h"
+#include "MarbleDirs.h"
+#include "MarbleGlobal.h"
+#include "PlacemarkLayout.h"
+#include "PlacemarkRegistry.h"
+#include "ViewportParams.h"
+
+#include <QItemSelectionModel>
+#include <QTest>
+
+namespace Marble
+{
+
+class PlacemarkLayoutTest : public QObject
+{
+    Q_OBJECT
+
+ private Q_SLOTS:
+    void initTestCase();
+
+    /**
+     * @brief popularLabelsWin checks that the more popular of two colliding labels is shown
+     */
+    void popularLabelsWin();
+
+    /**
+     * @brief popularLabelsWinAfterUpdate checks the same after the registry reordered the placemarks
+     */
+    void popularLabelsWinAfterUpdate();
+
+    void cleanupTestCase();
+
+ private:
+    GeoDataPlacemark *createPlacemark( const QString &name, qint64 popularity );
+
+    static QStringList layout( PlacemarkLayout &placemarkLayout );
+
+    GeoDataStyle *m_style;
+};
+
+void PlacemarkLayoutTest::initTestCase()
+{
+    MarbleDirs::setMarbleDataPath( DATA_PATH );
+    MarbleDirs::setMarblePluginPath( PLUGIN_PATH );
+
+    // Centered labels at the same position always collide
+    m_style = new GeoDataStyle;
+    m_style->labelStyle().setAlignment( GeoDataLabelStyle::Center );
+}
+
+void PlacemarkLayoutTest::cleanupTestCase()
+{
+    delete m_style;
+}
+
+GeoDataPlacemark *PlacemarkLayoutTest::createPlacemark( const QString &name, qint64 popularity )
+{
+    GeoDataPlacemark *placemark = new GeoDataPlacemark( name );
+    placemark->setCoordinate( GeoDataCoordinates( 10.0, 20.0, 0.0, GeoDataCoordinates::Degree ) );
+    placemark->setZoomLevel( 1 );
+    placemark->setPopularity( popularity );
+    placemark->setStyle( m_style );
+    return placemark;
+}
+
+QStringList PlacemarkLayoutTest::layout( PlacemarkLayout &placemarkLayout )
+{
+    const ViewportParams viewport( Spherical, 10.0 * DEG2RAD, 20.0 * DEG2RAD, 1000, QSize( 400, 300 ) );
+
+    placemarkLayout.generateLayout( &viewport );
+
+    // All placemarks are at the center of the viewport
+    QStringList names;
+    foreach ( const GeoDataFeature *feature, placemarkLayout.whichPlacemarkAt( QPoint( 200, 150 ) ) ) {
+        names << feature->name();
+    }
+    return names;
+}
+
+void PlacemarkLayoutTest::popularLabelsWin()
+{
+    GeoDataTreeModel treeModel;
+    const PlacemarkRegistry registry( &treeModel );
+    QItemSelectionModel selectionModel( &treeModel );
+    MarbleClock clock;
+    PlacemarkLayout placemarkLayout( &registry, &selectionModel, &clock );
+
+    // The document order puts the less popular placemark first
+    GeoDataDocument *document = new GeoDataDocument;
+    document->append( createPlacemark( "Village", 100 ) );
+    document->append( createPlacemark( "Metropolis", 10000000 ) );
+    document->append( createPlacemark( "Town", 10000 ) );
+    treeModel.addDocument( document );
+
+    QCOMPARE( layout( placemarkLayout ), QStringList() << "Metropolis" );
+}
+
+void PlacemarkLayoutTest::popularLabelsWinAfterUpdate()
+{
+    GeoDataTreeModel treeModel;
+    const PlacemarkRegistry registry( &treeModel );
+    QItemSelectionModel selectionModel( &treeModel );
+    MarbleClock clock;
+    PlacemarkLayout placemarkLayout( &registry, &selectionModel, &clock );
+
+    GeoDataDocument *document = new GeoDataDocument;
+    GeoDataPlacemark *metropolis = createPlacemark( "Metropolis", 10000000 );
+    document->append( metropolis );
+    document->append( createPlacemark( "Village", 100 ) );
+    treeModel.addDocument( document );
+    QCOMPARE( layout( placemarkLayout ), QStringList() << "Metropolis" );
+
+    // Updated placemarks are moved to the end of the registry
+    treeModel.updateFeature( metropolis );
+    QCOMPARE( layout( placemarkLayout ), QStringList() << "Metropolis" );
+}
+
+}
+
+QTEST_MAIN( Marble::PlacemarkLayoutTest )
+
+#include "PlacemarkLayoutTest.moc"
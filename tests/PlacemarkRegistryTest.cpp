@@ -0,0 +1,156 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2014 The Marble contributors
+//
+
+#include <QSignalSpy>
+#include <QTest>
+
+#include "PlacemarkRegistry.h"
+
+#include "GeoDataDocument.h"
+#include "GeoDataFolder.h"
+#include "GeoDataGroundOverlay.h"
+#include "GeoDataPlacemark.h"
+#include "GeoDataTreeModel.h"
+
+Q_DECLARE_METATYPE( QVector<Marble::GeoDataPlacemark*> )
+Q_DECLARE_METATYPE( QVector<Marble::GeoDataGroundOverlay*> )
+
+namespace Marble
+{
+
+class PlacemarkRegistryTest : public QObject
+{
+    Q_OBJECT
+
+ private Q_SLOTS:
+    void initTestCase();
+
+    void addDocument();
+    void removeDocument();
+    void updateFeature();
+    void setRootDocument();
+
+ private:
+    static GeoDataDocument *createDocument( int placemarkCount );
+};
+
+GeoDataDocument *PlacemarkRegistryTest::createDocument( int placemarkCount )
+{
+    GeoDataDocument *document = new GeoDataDocument;
+    GeoDataFolder *folder = new GeoDataFolder;
+    for ( int i = 0; i < placemarkCount; ++i ) {
+        // alternate between the document and the nested folder
+        GeoDataContainer *container = i % 2 ? static_cast<GeoDataContainer*>( folder ) : document;
+        container->append( new GeoDataPlacemark( QString::number( i ) ) );
+    }
+    document->append( folder );
+    document->append( new GeoDataGroundOverlay );
+    return document;
+}
+
+void PlacemarkRegistryTest::initTestCase()
+{
+    qRegisterMetaType<QVector<GeoDataPlacemark*> >( "QVector<GeoDataPlacemark*>" );
+    qRegisterMetaType<QVector<GeoDataGroundOverlay*> >( "QVector<GeoDataGroundOverlay*>" );
+}
+
+void PlacemarkRegistryTest::addDocument()
+{
+    GeoDataTreeModel treeModel;
+    const PlacemarkRegistry registry( &treeModel );
+    QCOMPARE( registry.placemarks().size(), 0 );
+    QCOMPARE( registry.groundOverlays().size(), 0 );
+
+    QSignalSpy placemarksAdded( &registry, SIGNAL(placemarksAdded(QVector<GeoDataPlacemark*>)) );
+    QSignalSpy groundOverlaysAdded( &registry, SIGNAL(groundOverlaysAdded(QVector<GeoDataGroundOverlay*>)) );
+    QSignalSpy changed( &registry, SIGNAL(changed()) );
+
+    treeModel.addDocument( createDocument( 10 ) );
+
+    QCOMPARE( registry.placemarks().size(), 10 );
+    QCOMPARE( registry.groundOverlays().size(), 1 );
+
+    // the whole document is reported at once
+    QCOMPARE( placemarksAdded.count(), 1 );
+    QCOMPARE( placemarksAdded.first().first().value<QVector<GeoDataPlacemark*> >().size(), 10 );
+    QCOMPARE( groundOverlaysAdded.count(), 1 );
+    QCOMPARE( changed.count(), 1 );
+}
+
+void PlacemarkRegistryTest::removeDocument()
+{
+    GeoDataTreeModel treeModel;
+    const PlacemarkRegistry registry( &treeModel );
+
+    GeoDataDocument *first = createDocument( 20 );
+    GeoDataDocument *second = createDocument( 3 );
+    treeModel.addDocument( first );
+    treeModel.addDocument( second );
+    QCOMPARE( registry.placemarks().size(), 23 );
+
+    QSignalSpy placemarksAboutToBeRemoved( &registry, SIGNAL(placemarksAboutToBeRemoved(QVector<GeoDataPlacemark*>)) );
+    QSignalSpy groundOverlaysAboutToBeRemoved( &registry, SIGNAL(groundOverlaysAboutToBeRemoved(QVector<GeoDataGroundOverlay*>)) );
+
+    treeModel.removeDocument( first );
+
+    QCOMPARE( placemarksAboutToBeRemoved.count(), 1 );
+    QCOMPARE( groundOverlaysAboutToBeRemoved.count(), 1 );
+    QCOMPARE( registry.placemarks().size(), 3 );
+    QCOMPARE( registry.groundOverlays().size(), 1 );
+    foreach ( GeoDataFeature *feature, first->featureList() ) {
+        GeoDataPlacemark *placemark = dynamic_cast<GeoDataPlacemark*>( feature );
+        QVERIFY( !placemark || !registry.placemarks().contains( placemark ) );
+    }
+
+    delete first;
+}
+
+void PlacemarkRegistryTest::updateFeature()
+{
+    GeoDataTreeModel treeModel;
+    const PlacemarkRegistry registry( &treeModel );
+
+    GeoDataDocument *document = createDocument( 4 );
+    treeModel.addDocument( document );
+
+    GeoDataFeature *placemark = document->child( 0 );
+    treeModel.updateFeature( placemark );
+
+    // updated features are moved to the end
+    QCOMPARE( registry.placemarks().size(), 4 );
+    QCOMPARE( static_cast<GeoDataFeature*>( registry.placemarks().last() ), placemark );
+}
+
+void PlacemarkRegistryTest::setRootDocument()
+{
+    GeoDataTreeModel treeModel;
+    const PlacemarkRegistry registry( &treeModel );
+    treeModel.addDocument( createDocument( 5 ) );
+
+    QSignalSpy reset( &registry, SIGNAL(reset()) );
+
+    GeoDataDocument *root = createDocument( 2 );
+    treeModel.setRootDocument( root );
+
+    QCOMPARE( reset.count(), 1 );
+    QCOMPARE( registry.placemarks().size(), 2 );
+    QCOMPARE( registry.groundOverlays().size(), 1 );
+
+    treeModel.setRootDocument( 0 );
+    delete root;
+
+    QCOMPARE( registry.placemarks().size(), 0 );
+}
+
+}
+
+QTEST_MAIN( Marble::PlacemarkRegistryTest )
+
+#include "PlacemarkRegistryTest.moc"
@@ -0,0 +1,188 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2014 The Marble contributors
+//
+
+#include <QStringList>
+#include <QTest>
+
+#include "PlacemarkSearchIndex.h"
+
+#include "GeoDataDocument.h"
+#include "GeoDataLatLonBox.h"
+#include "GeoDataPlacemark.h"
+#include "GeoDataTreeModel.h"
+#include "PlacemarkRegistry.h"
+
+namespace Marble
+{
+
+class PlacemarkSearchIndexTest : public QObject
+{
+    Q_OBJECT
+
+ public:
+    PlacemarkSearchIndexTest();
+
+ private Q_SLOTS:
+    void init();
+    void cleanup();
+
+    void search_data();
+    void search();
+
+    void preferredBox();
+    void limit();
+    void addDocument();
+    void removeDocument();
+    void updateFeature();
+
+ private:
+    static GeoDataPlacemark *createPlacemark( const QString &name, qreal lon, qreal lat, int zoomLevel, qint64 population );
+    static QStringList names( const QVector<GeoDataPlacemark*> &placemarks );
+
+    GeoDataTreeModel *m_treeModel;
+    PlacemarkRegistry *m_registry;
+    GeoDataDocument *m_document;
+};
+
+PlacemarkSearchIndexTest::PlacemarkSearchIndexTest() :
+    m_treeModel( 0 ),
+    m_registry( 0 ),
+    m_document( 0 )
+{
+}
+
+GeoDataPlacemark *PlacemarkSearchIndexTest::createPlacemark( const QString &name, qreal lon, qreal lat, int zoomLevel, qint64 population )
+{
+    GeoDataPlacemark *placemark = new GeoDataPlacemark( name );
+    placemark->setCoordinate( lon, lat, 0, GeoDataCoordinates::Degree );
+    placemark->setZoomLevel( zoomLevel );
+    placemark->setPopulation( population );
+    return placemark;
+}
+
+QStringList PlacemarkSearchIndexTest::names( const QVector<GeoDataPlacemark*> &placemarks )
+{
+    QStringList result;
+    foreach ( const GeoDataPlacemark *placemark, placemarks ) {
+        result << placemark->name();
+    }
+    qDeleteAll( placemarks );
+    return result;
+}
+
+void PlacemarkSearchIndexTest::init()
+{
+    m_treeModel = new GeoDataTreeModel;
+    m_registry = new PlacemarkRegistry( m_treeModel );
+
+    m_document = new GeoDataDocument;
+    m_document->append( createPlacemark( "Berlin", 13.4, 52.5, 3, 3400000 ) );
+    m_document->append( createPlacemark( "Bern", 7.4, 46.9, 5, 130000 ) );
+    m_document->append( createPlacemark( "Bernau", 13.6, 52.7, 8, 36000 ) );
+    m_document->append( createPlacemark( "Berchtesgaden", 13.0, 47.6, 8, 7600 ) );
+    m_document->append( createPlacemark( QString::fromUtf8( "München" ), 11.6, 48.1, 3, 1400000 ) );
+    m_document->append( createPlacemark( QString::fromUtf8( "Münster" ), 7.6, 52.0, 5, 300000 ) );
+    m_treeModel->addDocument( m_document );
+}
+
+void PlacemarkSearchIndexTest::cleanup()
+{
+    delete m_registry;
+    delete m_treeModel;
+    m_registry = 0;
+    m_treeModel = 0;
+    m_document = 0;
+}
+
+void PlacemarkSearchIndexTest::search_data()
+{
+    QTest::addColumn<QString>( "searchTerm" );
+    QTest::addColumn<QStringList>( "expected" );
+
+    QTest::newRow( "exact" ) << "Bernau" << ( QStringList() << "Bernau" );
+    QTest::newRow( "ranked" ) << "Ber" << ( QStringList() << "Berlin" << "Bern" << "Bernau" << "Berchtesgaden" );
+    QTest::newRow( "case insensitive" ) << "bERN" << ( QStringList() << "Bern" << "Bernau" );
+    QTest::newRow( "accent" ) << QString::fromUtf8( "Mün" ) << ( QStringList() << QString::fromUtf8( "München" ) << QString::fromUtf8( "Münster" ) );
+    QTest::newRow( "deaccented" ) << "munc" << ( QStringList() << QString::fromUtf8( "München" ) );
+    QTest::newRow( "no match" ) << "Hamburg" << QStringList();
+}
+
+void PlacemarkSearchIndexTest::search()
+{
+    QFETCH( QString, searchTerm );
+    QFETCH( QStringList, expected );
+
+    const PlacemarkSearchIndex index( m_registry );
+    QCOMPARE( index.size(), 6 );
+
+    QCOMPARE( names( index.search( searchTerm, GeoDataLatLonBox() ) ), expected );
+}
+
+void PlacemarkSearchIndexTest::preferredBox()
+{
+    const PlacemarkSearchIndex index( m_registry );
+
+    // Northern Germany
+    const GeoDataLatLonBox box( 55.0, 51.0, 15.0, 6.0, GeoDataCoordinates::Degree );
+
+    QCOMPARE( names( index.search( "Ber", box ) ), QStringList() << "Berlin" << "Bernau" );
+    QCOMPARE( names( index.search( QString::fromUtf8( "Mün" ), box ) ), QStringList() << QString::fromUtf8( "Münster" ) );
+}
+
+void PlacemarkSearchIndexTest::limit()
+{
+    const PlacemarkSearchIndex index( m_registry );
+
+    QCOMPARE( names( index.search( "Ber", GeoDataLatLonBox(), 2 ) ), QStringList() << "Berlin" << "Bern" );
+    QCOMPARE( names( index.search( "Ber", GeoDataLatLonBox(), 0 ) ), QStringList() );
+}
+
+void PlacemarkSearchIndexTest::addDocument()
+{
+    const PlacemarkSearchIndex index( m_registry );
+
+    GeoDataDocument *document = new GeoDataDocument;
+    document->append( createPlacemark( "Bergen", 5.3, 60.4, 5, 280000 ) );
+    m_treeModel->addDocument( document );
+
+    QCOMPARE( index.size(), 7 );
+    QCOMPARE( names( index.search( "Berg", GeoDataLatLonBox() ) ), QStringList() << "Bergen" );
+}
+
+void PlacemarkSearchIndexTest::removeDocument()
+{
+    const PlacemarkSearchIndex index( m_registry );
+
+    m_treeModel->removeDocument( m_document );
+    delete m_document;
+    m_document = 0;
+
+    QCOMPARE( index.size(), 0 );
+    QCOMPARE( names( index.search( "Ber", GeoDataLatLonBox() ) ), QStringList() );
+}
+
+void PlacemarkSearchIndexTest::updateFeature()
+{
+    const PlacemarkSearchIndex index( m_registry );
+
+    GeoDataPlacemark *placemark = static_cast<GeoDataPlacemark*>( m_document->child( 2 ) );
+    placemark->setName( "Potsdam" );
+    m_treeModel->updateFeature( placemark );
+
+    QCOMPARE( index.size(), 6 );
+    QCOMPARE( names( index.search( "Bern", GeoDataLatLonBox() ) ), QStringList() << "Bern" );
+    QCOMPARE( names( index.search( "Pots", GeoDataLatLonBox() ) ), QStringList() << "Potsdam" );
+}
+
+}
+
+QTEST_MAIN( Marble::PlacemarkSearchIndexTest )
+
+#include "PlacemarkSearchIndexTest.moc"
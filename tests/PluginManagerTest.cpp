@@ -11,8 +11,13 @@
 
 #include "MarbleDirs.h"
 #include "PluginManager.h"
+#include "RenderPlugin.h"
 
+#include <QPluginLoader>
 #include <QTest>
+#if QT_VERSION >= 0x050000
+#include <QJsonObject>
+#endif
 
 namespace Marble
 {
@@ -21,14 +26,105 @@ class PluginManagerTest : public QObject
 {
     Q_OBJECT
     private slots:
+        void initTestCase();
+
+        // Libraries stay loaded within the process, so these have to run
+        // first. Run a single benchmark to compare the startup times, e.g.
+        // PluginManagerTest benchmarkEagerStartup
+        void lazyLoading();
+        void lazyRenderPlugins();
+        void benchmarkLazyStartup();
+        void benchmarkEagerStartup();
+
         void loadPlugins();
 };
 
-void PluginManagerTest::loadPlugins()
+void PluginManagerTest::initTestCase()
 {
     MarbleDirs::setMarbleDataPath( DATA_PATH );
     MarbleDirs::setMarblePluginPath( PLUGIN_PATH );
+}
+
+void PluginManagerTest::lazyLoading()
+{
+#if QT_VERSION >= 0x050000
+    PluginManager pm;
+    QVERIFY( !pm.parsingRunnerPlugins( QStringList() << "kml" ).isEmpty() );
+
+    int renderPlugins = 0;
+    foreach ( const QString &fileName, MarbleDirs::pluginEntryList( "", QDir::Files ) ) {
+        QPluginLoader loader( MarbleDirs::pluginPath( fileName ) );
+        const QJsonObject metaData = loader.metaData().value( "MetaData" ).toObject();
+        if ( metaData.value( "Type" ).toString() == "RenderPlugin" ) {
+            QVERIFY2( !loader.isLoaded(), qPrintable( fileName ) );
+            ++renderPlugins;
+        }
+    }
+    QVERIFY( renderPlugins > 0 );
+#else
+    QSKIP( "Plugin metadata requires Qt 5", SkipAll );
+#endif
+}
+
+void PluginManagerTest::lazyRenderPlugins()
+{
+#if QT_VERSION >= 0x050000
+    PluginManager pm;
+    const QList<RenderPluginMetaData> listed = pm.renderPluginMetaData();
+    QVERIFY( !listed.isEmpty() );
 
+    const QString nameId = listed.first().nameId;
+    const RenderPlugin *const plugin = pm.renderPlugin( nameId );
+    QVERIFY( plugin );
+    QCOMPARE( plugin->nameId(), nameId );
+    QVERIFY( !pm.renderPlugin( "no-such-plugin" ) );
+
+    // Listing the render plugins reads their metadata, only the requested one is loaded
+    int loaded = 0;
+    foreach ( const QString &fileName, MarbleDirs::pluginEntryList( "", QDir::Files ) ) {
+        QPluginLoader loader( MarbleDirs::pluginPath( fileName ) );
+        const QJsonObject metaData = loader.metaData().value( "MetaData" ).toObject();
+        if ( metaData.value( "Type" ).toString() == "RenderPlugin" && loader.isLoaded() ) {
+            QCOMPARE( metaData.value( "Name" ).toString(), nameId );
+            ++loaded;
+        }
+    }
+    QCOMPARE( loaded, 1 );
+#else
+    QSKIP( "Plugin metadata requires Qt 5", SkipAll );
+#endif
+}
+
+void PluginManagerTest::benchmarkLazyStartup()
+{
+    // What a map needs before showing the first frame: render plugins that
+    // start disabled are listed from their metadata, but not loaded
+    QBENCHMARK_ONCE {
+        PluginManager pm;
+        foreach ( const RenderPluginMetaData &metaData, pm.renderPluginMetaData() ) {
+            if ( metaData.enabledByDefault ) {
+                pm.renderPlugin( metaData.nameId );
+            }
+        }
+        pm.positionProviderPlugins();
+    }
+}
+
+void PluginManagerTest::benchmarkEagerStartup()
+{
+    QBENCHMARK_ONCE {
+        PluginManager pm;
+        pm.renderPlugins();
+        pm.positionProviderPlugins();
+        pm.searchRunnerPlugins();
+        pm.reverseGeocodingRunnerPlugins();
+        pm.routingRunnerPlugins();
+        pm.parsingRunnerPlugins();
+    }
+}
+
+void PluginManagerTest::loadPlugins()
+{
     const int pluginNumber = MarbleDirs::pluginEntryList( "", QDir::Files ).size();
 
     PluginManager pm;
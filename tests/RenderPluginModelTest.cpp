@@ -11,6 +11,8 @@
 
 #include "RenderPluginModel.h"
 #include "MarbleMap.h"
+#include "MarbleWidget.h"
+#include "PluginManager.h"
 #include "TestUtils.h"
 
 namespace Marble
@@ -31,6 +33,7 @@ class RenderPluginModelTest : public QObject
 
     void construct();
     void setRenderPlugins();
+    void setMarbleWidget();
 
  private:
     MarbleMap *m_map;
@@ -51,6 +54,32 @@ void RenderPluginModelTest::setRenderPlugins()
     QCOMPARE( model.rowCount(), m_map->renderPlugins().count() );
 }
 
+void RenderPluginModelTest::setMarbleWidget()
+{
+    MarbleWidget widget;
+    const int created = widget.renderPlugins().count();
+    const QList<RenderPluginMetaData> unloaded = widget.unloadedRenderPlugins();
+
+    RenderPluginModel model;
+    model.setRenderPlugins( &widget );
+
+    // Plugins that start disabled are listed, but not created
+    QCOMPARE( model.rowCount(), created + unloaded.count() );
+    QCOMPARE( widget.renderPlugins().count(), created );
+
+    // Enabling a listed plugin creates it
+    foreach ( const RenderPluginMetaData &metaData, unloaded ) {
+        const QModelIndexList found = model.match( model.index( 0, 0 ), RenderPluginModel::NameId,
+                                                   metaData.nameId, -1, Qt::MatchExactly );
+        QCOMPARE( found.size(), 1 );
+        model.itemFromIndex( found.first() )->setCheckState( Qt::Checked );
+    }
+    model.applyPluginState();
+    QCOMPARE( widget.renderPlugins().count(), created + unloaded.count() );
+    QVERIFY( widget.unloadedRenderPlugins().isEmpty() );
+    QCOMPARE( model.rowCount(), created + unloaded.count() );
+}
+
 }
 
 QTEST_MAIN( Marble::RenderPluginModelTest )
@@ -0,0 +1,299 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2014 The Marble contributors
+//
+
+#include <QHash>
+#include <QImage>
+#include <QRegExp>
+#include <QSignalSpy>
+#include <QTest>
+
+#include "GeoPainter.h"
+#include "MarbleDirs.h"
+#include "MarbleMap.h"
+#include "MarbleModel.h"
+#include "MarbleProfiler.h"
+
+Q_DECLARE_METATYPE( Marble::Projection )
+
+namespace Marble
+{
+
+class ScanlineTextureMapperTest : public QObject
+{
+    Q_OBJECT
+
+ private Q_SLOTS:
+    void initTestCase();
+
+    void benchmarkBusyRatio_data();
+
+    /**
+     * @brief benchmarkBusyRatio paints the bluemarble theme at several zoom
+     * levels and reports the frame time and the share of the texture mapping
+     * time each render thread was busy.
+     */
+    void benchmarkBusyRatio();
+
+    void scrollReuse_data();
+
+    /**
+     * @brief scrollReuse checks that panning a cylindrical projection by
+     * whole pixels gives the same image as painting the new view at once.
+     */
+    void scrollReuse();
+
+    void benchmarkPanning_data();
+
+    /**
+     * @brief benchmarkPanning pans a 4K map horizontally by a few pixels
+     * per frame as kinetic scrolling does.
+     */
+    void benchmarkPanning();
+
+    /**
+     * @brief progressiveRendering checks that a still frame is shown as a
+     * preview first and replaced by the refined frame when it is ready.
+     */
+    void progressiveRendering();
+
+    void cleanupTestCase();
+
+ private:
+    static void paint( MarbleMap *map, QImage *image );
+
+    MarbleModel *m_model;
+};
+
+void ScanlineTextureMapperTest::paint( MarbleMap *map, QImage *image )
+{
+    image->fill( Qt::transparent );
+    GeoPainter painter( image, map->viewport(), map->mapQuality() );
+    map->paint( painter, image->rect() );
+}
+
+void ScanlineTextureMapperTest::initTestCase()
+{
+    MarbleDirs::setMarbleDataPath( DATA_PATH );
+    MarbleDirs::setMarblePluginPath( PLUGIN_PATH );
+    m_model = new MarbleModel;
+}
+
+void ScanlineTextureMapperTest::cleanupTestCase()
+{
+    MarbleProfiler::setEnabled( false );
+    delete m_model;
+}
+
+void ScanlineTextureMapperTest::benchmarkBusyRatio_data()
+{
+    QTest::addColumn<Projection>( "projection" );
+    QTest::addColumn<int>( "radius" );
+
+    QTest::newRow( "spherical 150" ) << Spherical << 150;
+    QTest::newRow( "spherical 400" ) << Spherical << 400;
+    QTest::newRow( "spherical 1500" ) << Spherical << 1500;
+    QTest::newRow( "spherical 6000" ) << Spherical << 6000;
+    QTest::newRow( "equirectangular 150" ) << Equirectangular << 150;
+    QTest::newRow( "equirectangular 1500" ) << Equirectangular << 1500;
+    QTest::newRow( "mercator 150" ) << Mercator << 150;
+    QTest::newRow( "mercator 1500" ) << Mercator << 1500;
+    QTest::newRow( "gnomonic 1500" ) << Gnomonic << 1500;
+}
+
+void ScanlineTextureMapperTest::benchmarkBusyRatio()
+{
+    QFETCH( Projection, projection );
+    QFETCH( int, radius );
+
+    MarbleMap map( m_model );
+    map.setMapThemeId( "earth/bluemarble/bluemarble.dgml" );
+    map.setProjection( projection );
+    map.setSize( 1024, 768 );
+    map.setRadius( radius );
+    map.centerOn( 13.4, 52.5 );
+
+    QImage image( map.size(), QImage::Format_ARGB32_Premultiplied );
+
+    MarbleProfiler::clear();
+    MarbleProfiler::setEnabled( true );
+    int frames = 0;
+    QBENCHMARK {
+        paint( &map, &image );
+        ++frames;
+    }
+    MarbleProfiler::setEnabled( false );
+
+    // {"name":"...","cat":"marble","ph":"X","pid":1,"tid":N,"ts":T,"dur":D}
+    QRegExp event( "\"name\":\"([^\"]*)\".*\"tid\":(\\d+).*\"dur\":(\\d+)" );
+    qint64 mapTextureTime = 0;
+    QHash<int, qint64> busyTime;
+    foreach ( const QByteArray &line, MarbleProfiler::chromeTrace().split( '\n' ) ) {
+        if ( event.indexIn( QString::fromUtf8( line ) ) < 0 ) {
+            continue;
+        }
+        const QString name = event.cap( 1 );
+        const qint64 duration = event.cap( 3 ).toLongLong();
+        if ( name.endsWith( "ScanlineTextureMapper::mapTexture" ) ) {
+            mapTextureTime += duration;
+        } else if ( name.endsWith( "ScanlineTextureMapper::RenderJob" ) ) {
+            busyTime[event.cap( 2 ).toInt()] += duration;
+        }
+    }
+    MarbleProfiler::clear();
+
+    QVERIFY( frames > 0 );
+    QVERIFY( mapTextureTime > 0 );
+    QVERIFY( !busyTime.isEmpty() );
+
+    qDebug() << "frame time:" << mapTextureTime / frames / 1000.0 << "ms texture mapping";
+    foreach ( int thread, busyTime.keys() ) {
+        qDebug() << "thread" << thread << "busy ratio:" << qreal( busyTime.value( thread ) ) / mapTextureTime;
+    }
+}
+
+void ScanlineTextureMapperTest::scrollReuse_data()
+{
+    QTest::addColumn<Projection>( "projection" );
+    QTest::addColumn<int>( "dx" );
+    QTest::addColumn<int>( "dy" );
+
+    QTest::newRow( "equirectangular east" ) << Equirectangular << 17 << 0;
+    QTest::newRow( "equirectangular south west" ) << Equirectangular << -9 << 23;
+    QTest::newRow( "mercator west" ) << Mercator << -31 << 0;
+    QTest::newRow( "mercator north" ) << Mercator << 0 << -12;
+}
+
+void ScanlineTextureMapperTest::scrollReuse()
+{
+    QFETCH( Projection, projection );
+    QFETCH( int, dx );
+    QFETCH( int, dy );
+
+    MarbleMap scrolled( m_model );
+    MarbleMap reference( m_model );
+    foreach ( MarbleMap *map, QList<MarbleMap*>() << &scrolled << &reference ) {
+        map->setMapThemeId( "earth/bluemarble/bluemarble.dgml" );
+        map->setProjection( projection );
+        map->setSize( 800, 600 );
+        map->setRadius( 400 );
+        map->setShowOverviewMap( false );
+        map->setShowScaleBar( false );
+        map->setShowCompass( false );
+        map->setShowGrid( false );
+    }
+
+    QImage image( scrolled.size(), QImage::Format_ARGB32_Premultiplied );
+    scrolled.centerOn( 10.0, 20.0 );
+    paint( &scrolled, &image );
+
+    qreal lon;
+    qreal lat;
+    QVERIFY( scrolled.geoCoordinates( scrolled.width() / 2 + dx, scrolled.height() / 2 + dy,
+                                      lon, lat, GeoDataCoordinates::Degree ) );
+    scrolled.centerOn( lon, lat );
+    reference.centerOn( lon, lat );
+    paint( &scrolled, &image );
+
+    QImage expected( reference.size(), QImage::Format_ARGB32_Premultiplied );
+    paint( &reference, &expected );
+
+    // allow for rounding differences of the interpolation
+    int differentPixels = 0;
+    for ( int y = 0; y < image.height(); ++y ) {
+        for ( int x = 0; x < image.width(); ++x ) {
+            const QRgb a = image.pixel( x, y );
+            const QRgb b = expected.pixel( x, y );
+            if ( qAbs( qRed( a ) - qRed( b ) ) > 8 || qAbs( qGreen( a ) - qGreen( b ) ) > 8
+                 || qAbs( qBlue( a ) - qBlue( b ) ) > 8 ) {
+                ++differentPixels;
+            }
+        }
+    }
+    QVERIFY( differentPixels < image.width() * image.height() / 100 );
+}
+
+void ScanlineTextureMapperTest::benchmarkPanning_data()
+{
+    QTest::addColumn<Projection>( "projection" );
+
+    QTest::newRow( "equirectangular" ) << Equirectangular;
+    QTest::newRow( "mercator" ) << Mercator;
+}
+
+void ScanlineTextureMapperTest::benchmarkPanning()
+{
+    QFETCH( Projection, projection );
+
+    MarbleMap map( m_model );
+    map.setMapThemeId( "earth/bluemarble/bluemarble.dgml" );
+    map.setProjection( projection );
+    map.setSize( 3840, 2160 );
+    map.setRadius( 3000 );
+    map.setViewContext( Animation );
+    map.centerOn( 0.0, 0.0 );
+
+    QImage image( map.size(), QImage::Format_ARGB32_Premultiplied );
+    paint( &map, &image );
+
+    QBENCHMARK {
+        qreal lon;
+        qreal lat;
+        map.geoCoordinates( map.width() / 2 + 8, map.height() / 2, lon, lat, GeoDataCoordinates::Degree );
+        map.centerOn( lon, lat );
+        paint( &map, &image );
+    }
+}
+
+void ScanlineTextureMapperTest::progressiveRendering()
+{
+    MarbleMap map( m_model );
+    map.setMapThemeId( "earth/bluemarble/bluemarble.dgml" );
+    map.setProjection( Spherical );
+    map.setSize( 800, 600 );
+    map.setRadius( 1000 );
+    map.setViewContext( Still );
+    map.setProgressiveRendering( true );
+    QVERIFY( map.progressiveRendering() );
+
+    QSignalSpy frameLatency( &map, SIGNAL(frameLatency(int,int)) );
+
+    QImage preview( map.size(), QImage::Format_ARGB32_Premultiplied );
+    paint( &map, &preview );
+
+    for ( int i = 0; i < 100 && frameLatency.isEmpty(); ++i ) {
+        QTest::qWait( 100 );
+    }
+    QCOMPARE( frameLatency.count(), 1 );
+    const int previewLatency = frameLatency.first().at( 0 ).toInt();
+    const int refinedLatency = frameLatency.first().at( 1 ).toInt();
+    QVERIFY( previewLatency <= refinedLatency );
+    qDebug() << "preview latency:" << previewLatency << "ms, refined latency:" << refinedLatency << "ms";
+
+    QImage refined( map.size(), QImage::Format_ARGB32_Premultiplied );
+    paint( &map, &refined );
+
+    QImage expected( map.size(), QImage::Format_ARGB32_Premultiplied );
+    map.setProgressiveRendering( false );
+    paint( &map, &expected );
+
+    QCOMPARE( refined, expected );
+
+    // moving the map discards the refined frame
+    map.setProgressiveRendering( true );
+    map.centerOn( 20.0, 10.0 );
+    paint( &map, &preview );
+    QVERIFY( map.renderStatus() != Complete );
+}
+
+}
+
+QTEST_MAIN( Marble::ScanlineTextureMapperTest )
+
+#include "ScanlineTextureMapperTest.moc"
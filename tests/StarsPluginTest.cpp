@@ -0,0 +1,160 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2014 The Marble contributors
+//
+
+#include <QImage>
+#include <QTest>
+
+#include "GeoPainter.h"
+#include "MarbleDirs.h"
+#include "MarbleMap.h"
+#include "MarbleModel.h"
+#include "RenderPlugin.h"
+
+namespace Marble
+{
+
+class StarsPluginTest : public QObject
+{
+    Q_OBJECT
+
+ private Q_SLOTS:
+    void initTestCase();
+
+    /**
+     * @brief magnitudeLimit checks that lowering the magnitude limit paints
+     * fewer stars.
+     */
+    void magnitudeLimit();
+
+    void benchmarkFrameTime_data();
+
+    /**
+     * @brief benchmarkFrameTime paints the sky around a small globe for
+     * several magnitude limits.
+     */
+    void benchmarkFrameTime();
+
+    void cleanupTestCase();
+
+ private:
+    void setUpMap( MarbleMap *map, int magnitudeLimit );
+
+    static int paint( MarbleMap *map, QImage *image );
+
+    MarbleModel *m_model;
+};
+
+void StarsPluginTest::setUpMap( MarbleMap *map, int magnitudeLimit )
+{
+    map->setMapThemeId( "earth/bluemarble/bluemarble.dgml" );
+    map->setProjection( Spherical );
+    map->setSize( 1024, 768 );
+    map->setRadius( 100 );
+    map->centerOn( 13.4, 52.5 );
+
+    foreach ( RenderPlugin *plugin, map->renderPlugins() ) {
+        const bool isStars = plugin->nameId() == "stars";
+        plugin->setEnabled( isStars );
+        plugin->setVisible( isStars );
+        if ( isStars ) {
+            QHash<QString, QVariant> settings = plugin->settings();
+            settings["magnitudeLimit"] = magnitudeLimit;
+            plugin->setSettings( settings );
+        }
+    }
+}
+
+int StarsPluginTest::paint( MarbleMap *map, QImage *image )
+{
+    image->fill( Qt::transparent );
+    {
+        GeoPainter painter( image, map->viewport(), map->mapQuality() );
+        map->paint( painter, image->rect() );
+    }
+
+    // Counts the painted pixels outside the globe
+    const QPoint center = image->rect().center();
+    const int radius = map->radius() + 1;
+    int count = 0;
+    for ( int y = 0; y < image->height(); ++y ) {
+        const QRgb *line = reinterpret_cast<const QRgb*>( image->constScanLine( y ) );
+        for ( int x = 0; x < image->width(); ++x ) {
+            const int dx = x - center.x();
+            const int dy = y - center.y();
+            if ( dx * dx + dy * dy > radius * radius && qAlpha( line[x] ) > 0 ) {
+                ++count;
+            }
+        }
+    }
+    return count;
+}
+
+void StarsPluginTest::initTestCase()
+{
+    MarbleDirs::setMarbleDataPath( DATA_PATH );
+    MarbleDirs::setMarblePluginPath( PLUGIN_PATH );
+    m_model = new MarbleModel;
+}
+
+void StarsPluginTest::cleanupTestCase()
+{
+    delete m_model;
+}
+
+void StarsPluginTest::magnitudeLimit()
+{
+    MarbleMap map( m_model );
+    QImage image( 1024, 768, QImage::Format_ARGB32_Premultiplied );
+
+    setUpMap( &map, 3 );
+    const int brightStars = paint( &map, &image );
+
+    setUpMap( &map, 6 );
+    const int allStars = paint( &map, &image );
+
+    QVERIFY( brightStars > 0 );
+    QVERIFY( allStars > brightStars );
+}
+
+void StarsPluginTest::benchmarkFrameTime_data()
+{
+    QTest::addColumn<int>( "magnitudeLimit" );
+
+    QTest::newRow( "magnitude 3" ) << 3;
+    QTest::newRow( "magnitude 6" ) << 6;
+    QTest::newRow( "no limit" ) << 100;
+}
+
+void StarsPluginTest::benchmarkFrameTime()
+{
+    QFETCH( int, magnitudeLimit );
+
+    MarbleMap map( m_model );
+    setUpMap( &map, magnitudeLimit );
+
+    // Repainting the same view would only composite the cached stars layer
+    map.setLayerCacheEnabled( false );
+
+    QImage image( map.size(), QImage::Format_ARGB32_Premultiplied );
+    // loads the star catalogue
+    paint( &map, &image );
+
+    QBENCHMARK {
+        image.fill( Qt::transparent );
+        GeoPainter painter( &image, map.viewport(), map.mapQuality() );
+        map.paint( painter, image.rect() );
+    }
+}
+
+}
+
+QTEST_MAIN( Marble::StarsPluginTest )
+
+#include "StarsPluginTest.moc"
@@ -0,0 +1,153 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2014 The Marble contributors
+//
+
+#include <QObject>
+
+#include "GeoDataDocument.h"
+#include "GeoDataPlacemark.h"
+#include "TestUtils.h"
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+namespace Marble
+{
+
+class TestFeatureMemory : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    /**
+     * @brief sparseMembers checks that rarely used members read back their
+     * defaults and are not shared between detached copies.
+     */
+    void sparseMembers();
+
+    /**
+     * @brief internedStrings checks that equal roles and style urls of
+     * different features share their string data.
+     */
+    void internedStrings();
+
+    /**
+     * @brief benchmarkLoad parses a large KML file of plain placemarks and
+     * reports the heap used per placemark.
+     */
+    void benchmarkLoad();
+
+private:
+    static QString createKml( int placemarkCount );
+
+    static qint64 heapUsage();
+
+    QString m_kml;
+};
+
+QString TestFeatureMemory::createKml( int placemarkCount )
+{
+    QString kml = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+                  "<kml xmlns=\"http://www.opengis.net/kml/2.2\"><Document>"
+                  "<Style id=\"poi\"><IconStyle><scale>0.5</scale></IconStyle></Style>";
+    for ( int i = 0; i < placemarkCount; ++i ) {
+        kml += QString( "<Placemark><name>Place %1</name><styleUrl>#poi</styleUrl>"
+                        "<Point><coordinates>%2,%3</coordinates></Point></Placemark>" )
+                .arg( i )
+                .arg( -180.0 + ( i % 3600 ) * 0.1 )
+                .arg( -90.0 + ( i / 3600 ) * 0.1 );
+    }
+    kml += "</Document></kml>";
+    return kml;
+}
+
+qint64 TestFeatureMemory::heapUsage()
+{
+#ifdef __GLIBC__
+    return mallinfo().uordblks;
+#else
+    return -1;
+#endif
+}
+
+void TestFeatureMemory::initTestCase()
+{
+    m_kml = createKml( 100000 );
+}
+
+void TestFeatureMemory::sparseMembers()
+{
+    GeoDataPlacemark placemark( "Berlin" );
+    QVERIFY( placemark.description().isEmpty() );
+    QVERIFY( placemark.address().isEmpty() );
+    QVERIFY( !placemark.descriptionIsCDATA() );
+    QVERIFY( placemark.abstractView() == 0 );
+    QVERIFY( placemark.styleMap() == 0 );
+    QVERIFY( !placemark.timeSpan().isValid() );
+    QVERIFY( !placemark.timeStamp().when().isValid() );
+
+    GeoDataPlacemark copy = placemark;
+    copy.setDescription( "Capital" );
+    QCOMPARE( copy.description(), QString( "Capital" ) );
+    QVERIFY( placemark.description().isEmpty() );
+
+    GeoDataPlacemark other = copy;
+    other.setAddress( "Unter den Linden" );
+    QCOMPARE( other.description(), QString( "Capital" ) );
+    QVERIFY( copy.address().isEmpty() );
+    QVERIFY( copy != other );
+
+    other.setAddress( QString() );
+    QVERIFY( copy == other );
+}
+
+void TestFeatureMemory::internedStrings()
+{
+    GeoDataDocument *document = parseKml( createKml( 2 ) );
+    QCOMPARE( document->placemarkList().size(), 2 );
+
+    const GeoDataPlacemark *first = document->placemarkList().at( 0 );
+    const GeoDataPlacemark *second = document->placemarkList().at( 1 );
+    QCOMPARE( first->styleUrl(), QString( "#poi" ) );
+    QVERIFY( first->styleUrl().constData() == second->styleUrl().constData() );
+    QVERIFY( first->role().constData() == second->role().constData() );
+
+    GeoDataPlacemark placemark;
+    placemark.setRole( QString( "C" ) );
+    GeoDataPlacemark city;
+    city.setRole( QString( "C" ) );
+    QVERIFY( placemark.role().constData() == city.role().constData() );
+
+    delete document;
+}
+
+void TestFeatureMemory::benchmarkLoad()
+{
+    QBENCHMARK_ONCE {
+        const qint64 before = heapUsage();
+        GeoDataDocument *document = parseKml( m_kml );
+        const qint64 after = heapUsage();
+
+        QCOMPARE( document->size(), 100000 );
+        if ( before >= 0 ) {
+            qDebug() << "heap per placemark:" << ( after - before ) / document->size() << "bytes";
+        }
+
+        delete document;
+    }
+}
+
+}
+
+QTEST_MAIN( Marble::TestFeatureMemory )
+
+#include "TestFeatureMemory.moc"
@@ -38,6 +38,8 @@ private slots:
     void removeAfterTest();
     void extendedDataParseTest();
     void withoutTimeTest();
+    void unsortedTimeTest();
+    void benchmarkScrubbing();
 };
 
 void TestGeoDataTrack::initTestCase()
@@ -357,6 +359,57 @@ void TestGeoDataTrack::withoutTimeTest()
     delete dataDocument;
 }
 
+void TestGeoDataTrack::unsortedTimeTest()
+{
+    GeoDataTrack track;
+    track.setInterpolate( true );
+
+    const QDateTime start( QDate( 2014, 8, 16 ), QTime( 8, 0, 0 ), Qt::UTC );
+    track.appendWhen( start.addSecs( 20 ) );
+    track.appendCoordinates( GeoDataCoordinates( 20.0, 0.0, 200, GeoDataCoordinates::Degree ) );
+    track.appendWhen( start );
+    track.appendCoordinates( GeoDataCoordinates( 0.0, 0.0, 0, GeoDataCoordinates::Degree ) );
+    track.appendWhen( start.addSecs( 10 ) );
+    track.appendCoordinates( GeoDataCoordinates( 10.0, 0.0, 100, GeoDataCoordinates::Degree ) );
+
+    QCOMPARE( track.coordinatesAt( start.addSecs( 10 ) ), GeoDataCoordinates( 10.0, 0.0, 100, GeoDataCoordinates::Degree ) );
+    QFUZZYCOMPARE( track.coordinatesAt( start.addSecs( 15 ) ).altitude(), 150.0, 0.0001 );
+    QFUZZYCOMPARE( track.coordinatesAt( start.addSecs( 5 ) ).longitude( GeoDataCoordinates::Degree ), 5.0, 0.0001 );
+    QCOMPARE( track.coordinatesAt( start.addSecs( 25 ) ), GeoDataCoordinates() );
+
+    // only trailing samples are removed, even if the track is not sorted
+    track.removeAfter( start.addSecs( 5 ) );
+    QCOMPARE( track.size(), 2 );
+    QFUZZYCOMPARE( track.coordinatesAt( start.addSecs( 10 ) ).altitude(), 100.0, 0.0001 );
+}
+
+void TestGeoDataTrack::benchmarkScrubbing()
+{
+    const int samples = 1000000;
+    const QDateTime start( QDate( 2014, 8, 16 ), QTime( 8, 0, 0 ), Qt::UTC );
+
+    GeoDataTrack track;
+    track.setInterpolate( true );
+    for ( int i = 0; i < samples; ++i ) {
+        track.addPoint( start.addMSecs( qint64( i ) * 1000 ),
+                        GeoDataCoordinates( 0.00001 * i, 0.00002 * i, i, GeoDataCoordinates::Degree ) );
+    }
+    QCOMPARE( track.size(), samples );
+
+    // Scrub back and forth through the track like a time slider does
+    QBENCHMARK {
+        for ( int i = 0; i < 1000; ++i ) {
+            const qint64 position = ( qint64( i ) * 7919 % samples ) * 1000 + 500;
+            track.coordinatesAt( start.addMSecs( position ) );
+        }
+    }
+
+    track.removeBefore( start.addSecs( samples / 2 ) );
+    QCOMPARE( track.size(), samples / 2 );
+    track.removeAfter( start.addSecs( samples / 2 + 9 ) );
+    QCOMPARE( track.size(), 10 );
+}
+
 QTEST_MAIN( TestGeoDataTrack )
 
 #include "TestGeoDataTrack.moc"
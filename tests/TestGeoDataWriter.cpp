@@ -13,6 +13,8 @@
 #include "GeoDataParser.h"
 #include "GeoDataDocument.h"
 #include "GeoDataColorStyle.h"
+#include "GeoDataLineString.h"
+#include "GeoDataPlacemark.h"
 #include "GeoWriter.h"
 #include <geodata/handlers/kml/KmlElementDictionary.h>
 
@@ -21,6 +23,8 @@
 #include <QTest>
 #include <QTextStream>
 #include <QBuffer>
+#include <QTime>
+#include <qmath.h>
 
 using namespace Marble;
 
@@ -38,6 +42,10 @@ private slots:
     void saveAndCompare();
     void saveAndCompareEquality_data();
     void saveAndCompareEquality();
+    void appendNumber_data();
+    void appendNumber();
+    void appendNumberRandom();
+    void benchmarkWriteLineStrings();
     void cleanupTestCase();
 private:
     QDir dataDir;
@@ -209,6 +217,90 @@ void TestGeoDataWriter::saveAndCompareEquality()
     QVERIFY( *initialDoc == *otherDoc );
 }
 
+void TestGeoDataWriter::appendNumber_data()
+{
+    QTest::addColumn<qreal>( "value" );
+    QTest::addColumn<int>( "decimals" );
+
+    QTest::newRow( "zero" ) << 0.0 << 10;
+    QTest::newRow( "longitude" ) << 13.3777041 << 10;
+    QTest::newRow( "negative latitude" ) << -33.8567844 << 10;
+    QTest::newRow( "rounding" ) << 0.00000000006 << 10;
+    QTest::newRow( "negative fraction" ) << -0.25 << 10;
+    QTest::newRow( "date line" ) << -180.0 << 10;
+    QTest::newRow( "altitude" ) << 1500.1234567890 << 2;
+    QTest::newRow( "integral" ) << 8848.0 << 0;
+    QTest::newRow( "large" ) << 1.0e12 << 10;
+    QTest::newRow( "below tie" ) << 0.15 << 1;
+    QTest::newRow( "above tie" ) << 0.35 << 1;
+    QTest::newRow( "exact tie" ) << 0.125 << 2;
+    QTest::newRow( "negative tie" ) << -2.675 << 2;
+    QTest::newRow( "negative zero" ) << -0.00000000004 << 10;
+}
+
+void TestGeoDataWriter::appendNumber()
+{
+    QFETCH( qreal, value );
+    QFETCH( int, decimals );
+
+    QString text = "x";
+    GeoWriter::appendNumber( text, value, decimals );
+    QCOMPARE( text, "x" + QString::number( value, 'f', decimals ) );
+}
+
+void TestGeoDataWriter::appendNumberRandom()
+{
+    qsrand( 42 );
+
+    for ( int i = 0; i < 100000; ++i ) {
+        const int decimals = qrand() % 11;
+        const qreal unit = qPow( 10.0, -decimals );
+
+        // Arbitrary coordinates, and values at or next to a rounding tie
+        const qreal coordinate = 360.0 * qrand() / RAND_MAX - 180.0;
+        const qreal tie = ( qrand() % 2000000 - 1000000 + 0.5 ) * unit;
+        const qreal nearTie = tie + ( qrand() % 3 - 1 ) * unit * 1.0e-6;
+
+        foreach ( qreal value, QList<qreal>() << coordinate << tie << nearTie ) {
+            QString text;
+            GeoWriter::appendNumber( text, value, decimals );
+            QCOMPARE( text, QString::number( value, 'f', decimals ) );
+        }
+    }
+}
+
+void TestGeoDataWriter::benchmarkWriteLineStrings()
+{
+    GeoDataDocument document;
+    for ( int i = 0; i < 1000; ++i ) {
+        GeoDataLineString *lineString = new GeoDataLineString;
+        for ( int j = 0; j < 1000; ++j ) {
+            lineString->append( GeoDataCoordinates( -180.0 + i * 0.36, -90.0 + j * 0.18, j,
+                                                    GeoDataCoordinates::Degree ) );
+        }
+        GeoDataPlacemark *placemark = new GeoDataPlacemark;
+        placemark->setGeometry( lineString );
+        document.append( placemark );
+    }
+
+    QByteArray data;
+    QBuffer buffer( &data );
+    GeoWriter writer;
+    writer.setDocumentType( kml::kmlTag_nameSpaceOgc22 );
+
+    QTime time;
+    time.start();
+    QBENCHMARK_ONCE {
+        buffer.open( QIODevice::WriteOnly );
+        QVERIFY( writer.write( &buffer, &document ) );
+        buffer.close();
+    }
+
+    const qreal megabytes = data.size() / ( 1024.0 * 1024.0 );
+    qDebug() << "Wrote" << megabytes << "MB with" << 1000 * 1000 << "coordinates at"
+             << megabytes * 1000.0 / qMax( 1, time.elapsed() ) << "MB/s";
+}
+
 void TestGeoDataWriter::cleanupTestCase()
 {
     QMap<QString, QSharedPointer<GeoDataParser> >::iterator itpoint = parsers.begin();
@@ -0,0 +1,168 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2014 The Marble contributors
+//
+
+#include "GeoDataDocument.h"
+#include "GeoDataParser.h"
+#include "GeoDataTour.h"
+#include "MarbleDirs.h"
+#include "MarbleMap.h"
+#include "MarbleModel.h"
+#include "TourRenderer.h"
+
+#include <QBuffer>
+#include <QCoreApplication>
+#include <QDir>
+#include <QImage>
+#include <QTest>
+
+namespace Marble
+{
+
+class TourRendererTest : public QObject
+{
+    Q_OBJECT
+
+ private Q_SLOTS:
+    void initTestCase();
+
+    /**
+     * @brief frameCount checks that the tour is split into fixed time steps
+     */
+    void frameCount();
+
+    /**
+     * @brief deterministic checks that rendering a tour twice gives the same frames
+     */
+    void deterministic();
+
+    void cleanupTestCase();
+
+ private:
+    QStringList render( const QString &directory );
+
+    static void removeDirectory( const QString &path );
+
+    MarbleModel *m_model;
+    GeoDataDocument *m_document;
+    GeoDataTour *m_tour;
+    QString m_directory;
+};
+
+void TourRendererTest::initTestCase()
+{
+    MarbleDirs::setMarbleDataPath( DATA_PATH );
+    MarbleDirs::setMarblePluginPath( PLUGIN_PATH );
+    m_model = new MarbleModel;
+    m_directory = QCoreApplication::applicationDirPath() + "/TourRendererTest";
+
+    // The first FlyTo is reached instantly, the tour lasts two seconds
+    const QString kml =
+            "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+            "<kml xmlns=\"http://www.opengis.net/kml/2.2\" xmlns:gx=\"http://www.google.com/kml/ext/2.2\">"
+            "<Document><gx:Tour><name>Test</name><gx:Playlist>"
+            "<gx:FlyTo><gx:duration>1</gx:duration><gx:flyToMode>bounce</gx:flyToMode>"
+            "<LookAt><longitude>13.4</longitude><latitude>52.5</latitude><altitude>10000000</altitude><range>10000000</range></LookAt></gx:FlyTo>"
+            "<gx:FlyTo><gx:duration>2</gx:duration><gx:flyToMode>bounce</gx:flyToMode>"
+            "<LookAt><longitude>-74.0</longitude><latitude>40.7</latitude><altitude>5000000</altitude><range>5000000</range></LookAt></gx:FlyTo>"
+            "</gx:Playlist></gx:Tour></Document></kml>";
+
+    GeoDataParser parser( GeoData_KML );
+    QByteArray data = kml.toUtf8();
+    QBuffer buffer( &data );
+    buffer.open( QIODevice::ReadOnly );
+    QVERIFY( parser.read( &buffer ) );
+    m_document = static_cast<GeoDataDocument*>( parser.releaseDocument() );
+    QVERIFY( m_document );
+    QCOMPARE( m_document->size(), 1 );
+    m_tour = dynamic_cast<GeoDataTour*>( m_document->child( 0 ) );
+    QVERIFY( m_tour );
+}
+
+void TourRendererTest::cleanupTestCase()
+{
+    removeDirectory( m_directory );
+    delete m_document;
+    delete m_model;
+}
+
+void TourRendererTest::removeDirectory( const QString &path )
+{
+    QDir directory( path );
+    foreach ( const QString &subdirectory, directory.entryList( QDir::Dirs | QDir::NoDotAndDotDot ) ) {
+        removeDirectory( directory.filePath( subdirectory ) );
+    }
+    foreach ( const QString &fileName, directory.entryList( QDir::Files ) ) {
+        directory.remove( fileName );
+    }
+    QDir().rmdir( path );
+}
+
+QStringList TourRendererTest::render( const QString &directory )
+{
+    TourRenderer renderer( m_model );
+    renderer.map()->setMapThemeId( "earth/plain/plain.dgml" );
+    renderer.map()->setProjection( Spherical );
+    renderer.map()->centerOn( 0.0, 0.0 );
+    renderer.setSize( QSize( 160, 120 ) );
+    renderer.setFramesPerSecond( 5 );
+    renderer.setTour( m_tour );
+    renderer.setOutputFile( directory + "/frame-%1.png" );
+
+    if ( !renderer.render() ) {
+        return QStringList();
+    }
+
+    QStringList files;
+    foreach ( const QString &fileName, QDir( directory ).entryList( QDir::Files, QDir::Name ) ) {
+        files << directory + '/' + fileName;
+    }
+    return files;
+}
+
+void TourRendererTest::frameCount()
+{
+    TourRenderer renderer( m_model );
+    renderer.setFramesPerSecond( 5 );
+    QCOMPARE( renderer.frameCount(), 0 );
+
+    renderer.setTour( m_tour );
+    QCOMPARE( renderer.frameCount(), 11 );
+
+    renderer.setFramesPerSecond( 30 );
+    QCOMPARE( renderer.frameCount(), 61 );
+}
+
+void TourRendererTest::deterministic()
+{
+    const QStringList first = render( m_directory + "/first" );
+    const QStringList second = render( m_directory + "/second" );
+
+    QCOMPARE( first.size(), 11 );
+    QCOMPARE( second.size(), first.size() );
+    QVERIFY( first.first().endsWith( "frame-000000.png" ) );
+    QVERIFY( first.last().endsWith( "frame-000010.png" ) );
+
+    for ( int i = 0; i < first.size(); ++i ) {
+        const QImage a( first.at( i ) );
+        const QImage b( second.at( i ) );
+        QVERIFY( !a.isNull() );
+        QCOMPARE( a.size(), QSize( 160, 120 ) );
+        QVERIFY( a == b );
+    }
+
+    // The view moves between the first and the last frame
+    QVERIFY( QImage( first.first() ) != QImage( first.last() ) );
+}
+
+}
+
+QTEST_MAIN( Marble::TourRendererTest )
+
+#include "TourRendererTest.moc"
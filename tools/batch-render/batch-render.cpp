@@ -0,0 +1,113 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2014 The Marble contributors
+//
+
+// Renders a list of map images without a window, e.g. for thumbnails.
+// Each line of the job file describes one image:
+//   <maptheme> <projection> <lon> <lat> <zoom> <width> <height> <outputfile>
+// Empty lines and lines starting with '#' are ignored.
+
+#include <BatchRenderer.h>
+#include <MarbleModel.h>
+
+#include <QApplication>
+#include <QDebug>
+#include <QFile>
+#include <QStringList>
+#include <QTextStream>
+#include <QThread>
+
+using namespace Marble;
+
+bool parseProjection( const QString &name, Projection &projection )
+{
+    static const char *const names[] = { "spherical", "equirectangular", "mercator", "gnomonic",
+                                         "stereographic", "lambert", "azimuthal", "perspective" };
+    static const Projection projections[] = { Spherical, Equirectangular, Mercator, Gnomonic,
+                                              Stereographic, LambertAzimuthal, AzimuthalEquidistant,
+                                              VerticalPerspective };
+    for ( unsigned int i = 0; i < sizeof( projections ) / sizeof( projections[0] ); ++i ) {
+        if ( name.toLower() == names[i] ) {
+            projection = projections[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+int intArgument( const QStringList &arguments, const QString &name, int defaultValue )
+{
+    int const index = arguments.indexOf( name );
+    if ( index > 0 && index + 1 < arguments.size() ) {
+        return arguments.at( index + 1 ).toInt();
+    }
+    return defaultValue;
+}
+
+int main(int argc, char** argv)
+{
+    QApplication app(argc,argv);
+
+    QString jobFilename;
+    int jobIndex = app.arguments().indexOf( "-j" );
+    if ( jobIndex > 0 && jobIndex + 1 < argc ) {
+        jobFilename = app.arguments().at( jobIndex + 1 );
+    } else {
+        qDebug( " Syntax: batch-render -j jobfile [-r render-threads] [-t writer-threads] [-w max-wait-msecs] [-q image-quality]" );
+        qDebug( " Job file lines: maptheme projection lon lat zoom width height outputfile" );
+        qDebug( " Projections: spherical, equirectangular, mercator, gnomonic, stereographic, lambert, azimuthal, perspective" );
+        return 1;
+    }
+
+    QFile jobFile( jobFilename );
+    if ( !jobFile.open( QIODevice::ReadOnly ) ) {
+        qDebug() << "Unable to open " << jobFile.fileName();
+        return 2;
+    }
+
+    MarbleModel model;
+    BatchRenderer renderer( &model );
+    renderer.setRenderThreadCount( intArgument( app.arguments(), "-r", QThread::idealThreadCount() ) );
+    renderer.setWriterThreadCount( intArgument( app.arguments(), "-t", QThread::idealThreadCount() ) );
+    renderer.setMaximumWaitTime( intArgument( app.arguments(), "-w", 0 ) );
+    renderer.setImageQuality( intArgument( app.arguments(), "-q", -1 ) );
+
+    QTextStream stream( &jobFile );
+    int lineNumber = 0;
+    while ( !stream.atEnd() ) {
+        QString const line = stream.readLine().trimmed();
+        ++lineNumber;
+        if ( line.isEmpty() || line.startsWith( '#' ) ) {
+            continue;
+        }
+
+        QStringList const fields = line.split( ' ', QString::SkipEmptyParts );
+        Projection projection = Spherical;
+        if ( fields.size() != 8 || !parseProjection( fields.at( 1 ), projection ) ) {
+            qDebug() << "Skipping invalid job in line" << lineNumber << ":" << line;
+            continue;
+        }
+
+        GeoDataCoordinates const center( fields.at( 2 ).toDouble(), fields.at( 3 ).toDouble(),
+                                         0.0, GeoDataCoordinates::Degree );
+        QSize const size( fields.at( 5 ).toInt(), fields.at( 6 ).toInt() );
+        renderer.addJob( BatchRenderJob( fields.at( 0 ), projection, center,
+                                         fields.at( 4 ).toInt(), size, fields.at( 7 ) ) );
+    }
+
+    int const jobCount = renderer.jobCount();
+    bool const success = renderer.render();
+
+    foreach ( const QString &fileName, renderer.failedFiles() ) {
+        qDebug() << "Failed to write" << fileName;
+    }
+    qDebug() << "Rendered" << jobCount << "jobs," << renderer.jobsPerSecond() << "jobs/sec";
+
+    return success ? 0 : 3;
+}
@@ -60,3 +60,53 @@ QRgb BilinearInterpolation::interpolate( double const x, double const y )
 
     return qRgba( round( red ), round( green ), round( blue ), round( alpha ));
 }
+
+void BilinearInterpolation::interpolateLine( double const * const x, double const y,
+                                             int const count, QRgb * const line )
+{
+    if ( count <= 0 )
+        return;
+
+    // fetch both source rows once, same formulas as interpolate()
+    int const firstColumn = x[ 0 ];
+    int const lastColumn = static_cast<int>( x[ count - 1 ] ) + 1;
+    int const columns = lastColumn - firstColumn + 1;
+    int const y1 = y;
+    m_lowerRow.resize( columns );
+    m_upperRow.resize( columns );
+    m_mapImage->pixelRow( firstColumn, y1, columns, m_lowerRow.data() );
+    m_mapImage->pixelRow( firstColumn, y1 + 1, columns, m_upperRow.data() );
+
+    QRgb const * const lowerRow = m_lowerRow.constData();
+    QRgb const * const upperRow = m_upperRow.constData();
+    double const fractionY = y - y1;
+
+    for ( int i = 0; i < count; ++i ) {
+        double const xi = x[ i ];
+        int const x1 = xi;
+        int const index = x1 - firstColumn;
+        double const fractionX = xi - x1;
+
+        QRgb const lowerLeftPixel = lowerRow[ index ];
+        QRgb const lowerRightPixel = lowerRow[ index + 1 ];
+        QRgb const upperLeftPixel = upperRow[ index ];
+        QRgb const upperRightPixel = upperRow[ index + 1 ];
+
+        double const lowerMidRed   = ( 1.0 - fractionX ) * qRed( lowerLeftPixel )   + fractionX * qRed( lowerRightPixel );
+        double const lowerMidGreen = ( 1.0 - fractionX ) * qGreen( lowerLeftPixel ) + fractionX * qGreen( lowerRightPixel );
+        double const lowerMidBlue  = ( 1.0 - fractionX ) * qBlue( lowerLeftPixel )  + fractionX * qBlue( lowerRightPixel );
+        double const lowerMidAlpha = ( 1.0 - fractionX ) * qAlpha( lowerLeftPixel ) + fractionX * qAlpha( lowerRightPixel );
+
+        double const upperMidRed   = ( 1.0 - fractionX ) * qRed( upperLeftPixel )   + fractionX * qRed( upperRightPixel );
+        double const upperMidGreen = ( 1.0 - fractionX ) * qGreen( upperLeftPixel ) + fractionX * qGreen( upperRightPixel );
+        double const upperMidBlue  = ( 1.0 - fractionX ) * qBlue( upperLeftPixel )  + fractionX * qBlue( upperRightPixel );
+        double const upperMidAlpha = ( 1.0 - fractionX ) * qAlpha( upperLeftPixel ) + fractionX * qAlpha( upperRightPixel );
+
+        double const red   = ( 1.0 - fractionY ) * lowerMidRed   + fractionY * upperMidRed;
+        double const green = ( 1.0 - fractionY ) * lowerMidGreen + fractionY * upperMidGreen;
+        double const blue  = ( 1.0 - fractionY ) * lowerMidBlue  + fractionY * upperMidBlue;
+        double const alpha = ( 1.0 - fractionY ) * lowerMidAlpha + fractionY * upperMidAlpha;
+
+        line[ i ] = qRgba( round( red ), round( green ), round( blue ), round( alpha ));
+    }
+}
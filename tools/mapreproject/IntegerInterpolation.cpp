@@ -11,3 +11,19 @@ QRgb IntegerInterpolation::interpolate( double const x, double const y )
 {
     return m_mapImage->pixel( static_cast<int>( x ), static_cast<int>( y ));
 }
+
+void IntegerInterpolation::interpolateLine( double const * const x, double const y,
+                                            int const count, QRgb * const line )
+{
+    if ( count <= 0 )
+        return;
+
+    int const firstColumn = static_cast<int>( x[ 0 ] );
+    int const lastColumn = static_cast<int>( x[ count - 1 ] );
+    m_row.resize( lastColumn - firstColumn + 1 );
+    m_mapImage->pixelRow( firstColumn, static_cast<int>( y ), m_row.size(), m_row.data() );
+
+    QRgb const * const row = m_row.constData();
+    for ( int i = 0; i < count; ++i )
+        line[ i ] = row[ static_cast<int>( x[ i ] ) - firstColumn ];
+}
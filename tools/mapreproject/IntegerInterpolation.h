@@ -3,6 +3,8 @@
 
 #include "InterpolationMethod.h"
 
+#include <QVector>
+
 class ReadOnlyMapImage;
 
 class IntegerInterpolation: public InterpolationMethod
@@ -11,6 +13,11 @@ public:
     explicit IntegerInterpolation( ReadOnlyMapImage * const mapImage = NULL );
 
     virtual QRgb interpolate( double const x, double const y );
+    virtual void interpolateLine( double const * const x, double const y,
+                                  int const count, QRgb * const line );
+
+private:
+    QVector<QRgb> m_row;
 };
 
 #endif
@@ -8,3 +8,10 @@ InterpolationMethod::InterpolationMethod( ReadOnlyMapImage * const mapImage )
 InterpolationMethod::~InterpolationMethod()
 {
 }
+
+void InterpolationMethod::interpolateLine( double const * const x, double const y,
+                                           int const count, QRgb * const line )
+{
+    for ( int i = 0; i < count; ++i )
+        line[ i ] = interpolate( x[ i ], y );
+}
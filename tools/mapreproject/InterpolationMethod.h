@@ -12,6 +12,13 @@ public:
     virtual ~InterpolationMethod();
 
     virtual QRgb interpolate( double const x, double const y ) = 0;
+
+    // Interpolates count pixels of source row y at the ascending columns x[0..count-1].
+    // The default implementation calls interpolate() for each pixel, subclasses fetch
+    // the needed source rows at once instead.
+    virtual void interpolateLine( double const * const x, double const y,
+                                  int const count, QRgb * const line );
+
     void setMapImage( ReadOnlyMapImage * const mapImage );
 
 protected:
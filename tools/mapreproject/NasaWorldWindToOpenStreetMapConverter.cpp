@@ -1,12 +1,15 @@
 #include "NasaWorldWindToOpenStreetMapConverter.h"
 
+#include "NwwTileCache.h"
 #include "OsmTileClusterRenderer.h"
 #include "Thread.h"
+#include "TileClusterQueue.h"
 
 #include <QDebug>
 #include <QMetaObject>
 #include <QString>
 #include <QThread>
+#include <QTimer>
 
 #include <cmath>
 
@@ -16,9 +19,18 @@ NasaWorldWindToOpenStreetMapConverter::NasaWorldWindToOpenStreetMapConverter( QO
       m_osmTileLevel(),
       m_osmTileClusterEdgeLengthTiles(),
       m_osmMapEdgeLengthClusters(),
-      m_nextClusterX(),
-      m_nextClusterY()
+      m_tileQueue(),
+      m_finishedRendererCount(),
+      m_progressTimer( new QTimer( this )),
+      m_startTime()
 {
+    m_progressTimer->setInterval( 10000 );
+    connect( m_progressTimer, SIGNAL(timeout()), this, SLOT(reportProgress()));
+}
+
+NasaWorldWindToOpenStreetMapConverter::~NasaWorldWindToOpenStreetMapConverter()
+{
+    delete m_tileQueue;
 }
 
 void NasaWorldWindToOpenStreetMapConverter::setMapSources( QVector<ReadOnlyMapDefinition> const & mapSources )
@@ -61,6 +73,12 @@ QVector<QPair<Thread*, OsmTileClusterRenderer*> > NasaWorldWindToOpenStreetMapCo
     if ( osmMapEdgeLengthTiles % m_osmTileClusterEdgeLengthTiles != 0 )
         qFatal("Bad tile cluster size");
 
+    // all threads share the cluster queue, threads which finished their clusters
+    // early steal tiles from the others
+    delete m_tileQueue;
+    m_tileQueue = new TileClusterQueue( m_osmMapEdgeLengthClusters, m_osmTileClusterEdgeLengthTiles );
+    m_finishedRendererCount = 0;
+
     QVector<QPair<Thread*, OsmTileClusterRenderer*> > renderThreads;
 
     for ( int i = 0; i < m_threadCount; ++i ) {
@@ -70,17 +88,19 @@ QVector<QPair<Thread*, OsmTileClusterRenderer*> > NasaWorldWindToOpenStreetMapCo
         renderer->setMapSources( m_mapSources );
         renderer->setOsmBaseDirectory( m_osmBaseDirectory );
         renderer->setOsmTileLevel( m_osmTileLevel );
-        QObject::connect( renderer, SIGNAL(clusterRendered(OsmTileClusterRenderer*)),
-                          this, SLOT(assignNextCluster(OsmTileClusterRenderer*)) );
+        renderer->setTileQueue( m_tileQueue );
+        QObject::connect( renderer, SIGNAL(finished(OsmTileClusterRenderer*)),
+                          this, SLOT(rendererFinished(OsmTileClusterRenderer*)) );
 
         Thread * const thread = new Thread;
         thread->launchWorker( renderer );
         QMetaObject::invokeMethod( renderer, "initMapSources", Qt::QueuedConnection );
-        QMetaObject::invokeMethod( renderer, "renderOsmTileCluster", Qt::QueuedConnection,
-                                   Q_ARG( int, m_nextClusterX ), Q_ARG( int, m_nextClusterY ));
-        incNextCluster();
+        QMetaObject::invokeMethod( renderer, "renderOsmTiles", Qt::QueuedConnection );
         renderThreads.push_back( qMakePair( thread, renderer ));
     }
+
+    m_startTime.start();
+    m_progressTimer->start();
     return renderThreads;
 }
 
@@ -113,14 +133,39 @@ void NasaWorldWindToOpenStreetMapConverter::testReprojection()
 //    qDebug() << -M_PI / 2.0 << "->" << latRadToNwwPixelY( -M_PI / 2.0 );
 }
 
-void NasaWorldWindToOpenStreetMapConverter::assignNextCluster( OsmTileClusterRenderer * renderer )
+void NasaWorldWindToOpenStreetMapConverter::rendererFinished( OsmTileClusterRenderer * )
 {
-    if ( m_nextClusterX == m_osmMapEdgeLengthClusters || m_nextClusterY == m_osmMapEdgeLengthClusters )
+    ++m_finishedRendererCount;
+    if ( m_finishedRendererCount < m_threadCount )
         return;
 
-    QMetaObject::invokeMethod( renderer, "renderOsmTileCluster", Qt::QueuedConnection,
-                               Q_ARG( int, m_nextClusterX ), Q_ARG( int, m_nextClusterY ));
-    incNextCluster();
+    m_progressTimer->stop();
+    reportProgress();
+    emit finished();
+}
+
+void NasaWorldWindToOpenStreetMapConverter::reportProgress()
+{
+    int const processed = m_tileQueue->processedTileCount();
+    int const total = m_tileQueue->tileCount();
+    int const elapsedMs = qMax( 1, m_startTime.elapsed() );
+    double const tilesPerSecond = static_cast<double>( processed ) * 1000.0 / static_cast<double>( elapsedMs );
+
+    qDebug() << "processed" << processed << "of" << total << "tiles,"
+             << m_tileQueue->savedTileCount() << "saved, in" << elapsedMs / 1000 << "s =>"
+             << tilesPerSecond << "tiles/s";
+
+    QVector<ReadOnlyMapDefinition>::const_iterator pos = m_mapSources.constBegin();
+    QVector<ReadOnlyMapDefinition>::const_iterator const end = m_mapSources.constEnd();
+    for (; pos != end; ++pos ) {
+        QSharedPointer<NwwTileCache> const cache = (*pos).tileCache();
+        qint64 const hits = cache->hitCount();
+        qint64 const lookups = hits + cache->missCount();
+        if ( lookups == 0 )
+            continue;
+        qDebug() << "  source tile cache:" << cache->totalCostBytes() / ( 1024 * 1024 ) << "MB used,"
+                 << "hit rate" << 100.0 * static_cast<double>( hits ) / static_cast<double>( lookups ) << "%";
+    }
 }
 
 void NasaWorldWindToOpenStreetMapConverter::checkAndCreateLevelDirectory() const
@@ -136,15 +181,4 @@ void NasaWorldWindToOpenStreetMapConverter::checkAndCreateLevelDirectory() const
     }
 }
 
-void NasaWorldWindToOpenStreetMapConverter::incNextCluster()
-{
-    ++m_nextClusterY;
-    if ( m_nextClusterY == m_osmMapEdgeLengthClusters ) {
-        m_nextClusterY = 0;
-        ++m_nextClusterX;
-        if ( m_nextClusterX == m_osmMapEdgeLengthClusters )
-            emit finished();
-    }
-}
-
 #include "NasaWorldWindToOpenStreetMapConverter.moc"
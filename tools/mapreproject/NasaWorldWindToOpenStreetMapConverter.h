@@ -7,10 +7,13 @@
 #include <QDir>
 #include <QObject>
 #include <QPair>
+#include <QTime>
 #include <QVector>
 
 class OsmTileClusterRenderer;
 class Thread;
+class TileClusterQueue;
+class QTimer;
 
 // Abbreviations used:
 //   Nww, nww: NASA WorldWind
@@ -25,6 +28,7 @@ class NasaWorldWindToOpenStreetMapConverter: public QObject
 
 public:
     explicit NasaWorldWindToOpenStreetMapConverter( QObject * const parent = NULL );
+    ~NasaWorldWindToOpenStreetMapConverter();
 
     void setMapSources( QVector<ReadOnlyMapDefinition> const & mapSources );
     void setOsmBaseDirectory( QDir const & nwwBaseDirectory );
@@ -40,11 +44,11 @@ signals:
     void finished();
 
 public slots:
-    void assignNextCluster( OsmTileClusterRenderer * );
+    void rendererFinished( OsmTileClusterRenderer * );
+    void reportProgress();
 
 private:
     void checkAndCreateLevelDirectory() const;
-    void incNextCluster();
 
     int m_threadCount;
     QVector<ReadOnlyMapDefinition> m_mapSources;
@@ -53,8 +57,11 @@ private:
 
     int m_osmTileClusterEdgeLengthTiles;
     int m_osmMapEdgeLengthClusters;
-    int m_nextClusterX;
-    int m_nextClusterY;
+
+    TileClusterQueue * m_tileQueue;
+    int m_finishedRendererCount;
+    QTimer * m_progressTimer;
+    QTime m_startTime;
 };
 
 #endif
@@ -15,3 +15,21 @@ QRgb NearestNeighborInterpolation::interpolate( double const x, double const y )
     int const yr = round( y );
     return m_mapImage->pixel( xr, yr );
 }
+
+void NearestNeighborInterpolation::interpolateLine( double const * const x, double const y,
+                                                    int const count, QRgb * const line )
+{
+    if ( count <= 0 )
+        return;
+
+    int const firstColumn = round( x[ 0 ] );
+    int const lastColumn = round( x[ count - 1 ] );
+    m_row.resize( lastColumn - firstColumn + 1 );
+    m_mapImage->pixelRow( firstColumn, round( y ), m_row.size(), m_row.data() );
+
+    QRgb const * const row = m_row.constData();
+    for ( int i = 0; i < count; ++i ) {
+        int const xr = round( x[ i ] );
+        line[ i ] = row[ xr - firstColumn ];
+    }
+}
@@ -1,9 +1,11 @@
 #include "NwwMapImage.h"
 
 #include "InterpolationMethod.h"
+#include "NwwTileCache.h"
 
 #include <QDebug>
 #include <cmath>
+#include <cstring>
 
 NwwMapImage::NwwMapImage( QDir const & baseDirectory, int const tileLevel )
     : m_tileEdgeLengthPixel( 512 ),
@@ -15,7 +17,10 @@ NwwMapImage::NwwMapImage( QDir const & baseDirectory, int const tileLevel )
       m_mapWidthPixel( m_mapWidthTiles * m_tileEdgeLengthPixel ),
       m_mapHeightPixel( m_mapHeightTiles * m_tileEdgeLengthPixel ),
       m_interpolationMethod(),
-      m_tileCache( DefaultCacheSizeBytes )
+      m_tileCache( new NwwTileCache ),
+      m_currentTileKey( -1 ),
+      m_currentTileValid( false ),
+      m_currentTile()
 {
     if ( !m_baseDirectory.exists() )
         qFatal( "Base directory '%s' does not exist.", m_baseDirectory.path().toStdString().c_str() );
@@ -36,20 +41,60 @@ QRgb NwwMapImage::pixel( double const lonRad, double const latRad )
 
 QRgb NwwMapImage::pixel( int const x, int const y )
 {
+    if ( x < 0 || y < 0 )
+        return m_emptyPixel;
+
     int const tileX = x / m_tileEdgeLengthPixel;
     int const tileY = y / m_tileEdgeLengthPixel;
 
-    // fast check if tile is missing
-    int const tileKey = tileId( tileX, tileY );
-    if ( m_tileMissing.contains( tileKey ))
-        return m_emptyPixel;
-
-    QPair<QImage, bool> potentialTile = tile( tileX, tileY );
-    if ( !potentialTile.second )
+    QImage const * const potentialTile = tile( tileX, tileY );
+    if ( !potentialTile )
         return m_emptyPixel;
     else
-        return potentialTile.first.pixel( x % m_tileEdgeLengthPixel,
-                                          m_tileEdgeLengthPixel - y % m_tileEdgeLengthPixel - 1 );
+        return potentialTile->pixel( x % m_tileEdgeLengthPixel,
+                                     m_tileEdgeLengthPixel - y % m_tileEdgeLengthPixel - 1 );
+}
+
+void NwwMapImage::scanLine( double const * const lonRad, double const latRad,
+                            int const count, QRgb * const line )
+{
+    // same conversion as pixel( lonRad, latRad ) for each pixel
+    m_lineX.resize( count );
+    for ( int i = 0; i < count; ++i )
+        m_lineX[ i ] = lonRadToPixelX( lonRad[ i ] );
+    double const y = latRadToPixelY( latRad );
+    m_interpolationMethod->interpolateLine( m_lineX.constData(), y, count, line );
+}
+
+void NwwMapImage::pixelRow( int const x, int const y, int const count, QRgb * const row )
+{
+    int const tileY = y / m_tileEdgeLengthPixel;
+    int const tileRow = m_tileEdgeLengthPixel - y % m_tileEdgeLengthPixel - 1;
+
+    // copy the row in segments of one tile each
+    int i = 0;
+    while ( i < count ) {
+        int const pixelX = x + i;
+        if ( pixelX < 0 || y < 0 ) {
+            row[ i ] = m_emptyPixel;
+            ++i;
+            continue;
+        }
+
+        int const tileX = pixelX / m_tileEdgeLengthPixel;
+        int const tileColumn = pixelX % m_tileEdgeLengthPixel;
+        int const segmentLength = qMin( count - i, m_tileEdgeLengthPixel - tileColumn );
+
+        QImage const * const potentialTile = tile( tileX, tileY );
+        if ( !potentialTile ) {
+            for ( int j = 0; j < segmentLength; ++j )
+                row[ i + j ] = m_emptyPixel;
+        } else {
+            QRgb const * const tileLine = reinterpret_cast<QRgb const *>( potentialTile->constScanLine( tileRow ));
+            memcpy( row + i, tileLine + tileColumn, segmentLength * sizeof( QRgb ));
+        }
+        i += segmentLength;
+    }
 }
 
 void NwwMapImage::setBaseDirectory( QDir const & baseDirectory )
@@ -57,9 +102,12 @@ void NwwMapImage::setBaseDirectory( QDir const & baseDirectory )
     m_baseDirectory = baseDirectory;
 }
 
-void NwwMapImage::setCacheSizeBytes(const int cacheSizeBytes)
+void NwwMapImage::setTileCache( QSharedPointer<NwwTileCache> const & tileCache )
 {
-    m_tileCache.setMaxCost( cacheSizeBytes );
+    m_tileCache = tileCache;
+    m_currentTileKey = -1;
+    m_currentTileValid = false;
+    m_currentTile = QImage();
 }
 
 void NwwMapImage::setInterpolationMethod( InterpolationMethod * const method )
@@ -82,14 +130,24 @@ inline int NwwMapImage::tileId( int const tileX, int const tileY )
     return (tileX << 16) + tileY;
 }
 
-QPair<QImage, bool> NwwMapImage::tile( int const tileX, int const tileY )
+QImage const * NwwMapImage::tile( int const tileX, int const tileY )
 {
     int const tileKey = tileId( tileX, tileY );
-
-    // first check cache
-    QImage * const cachedTile = m_tileCache.object( tileKey );
-    if ( cachedTile )
-        return QPair<QImage, bool>( *cachedTile, true );
+    if ( tileKey == m_currentTileKey )
+        return m_currentTileValid ? &m_currentTile : NULL;
+
+    m_currentTileKey = tileKey;
+    m_currentTileValid = false;
+    m_currentTile = QImage();
+
+    // then check shared cache
+    NwwTileCache::TileState const state = m_tileCache->find( tileKey, m_currentTile );
+    if ( state == NwwTileCache::TileMissing )
+        return NULL;
+    if ( state == NwwTileCache::TileCached ) {
+        m_currentTileValid = true;
+        return &m_currentTile;
+    }
 
     QString const filename = QString("%1/%2/%2_%3.jpg")
             .arg( m_baseDirectory.path() )
@@ -98,13 +156,25 @@ QPair<QImage, bool> NwwMapImage::tile( int const tileX, int const tileY )
     QImage tile;
     bool const loaded = tile.load( filename );
     if ( !loaded ) {
-        m_tileMissing.insert( tileKey );
+        m_tileCache->insertMissing( tileKey );
         //qDebug() << "Tile" << filename << "not found";
-    } else {
-        m_tileCache.insert( tileKey, new QImage( tile ), tile.byteCount() );
-        //qDebug() << "Tile" << filename << "loaded and inserted in cache";
+        return NULL;
+    }
+    if ( tile.width() != m_tileEdgeLengthPixel || tile.height() != m_tileEdgeLengthPixel ) {
+        qWarning() << "Tile" << filename << "has unexpected size" << tile.size();
+        m_tileCache->insertMissing( tileKey );
+        return NULL;
     }
-    return QPair<QImage, bool>( tile, loaded );
+
+    // pixelRow() copies scanlines directly
+    if ( tile.format() != QImage::Format_ARGB32 && tile.format() != QImage::Format_RGB32 )
+        tile = tile.convertToFormat( QImage::Format_ARGB32 );
+
+    m_tileCache->insert( tileKey, tile );
+    //qDebug() << "Tile" << filename << "loaded and inserted in cache";
+    m_currentTile = tile;
+    m_currentTileValid = true;
+    return &m_currentTile;
 }
 
 inline double NwwMapImage::lonRadToPixelX( double const lonRad ) const
@@ -4,14 +4,14 @@
 #include "mapreproject.h"
 #include "ReadOnlyMapImage.h"
 
-#include <QCache>
 #include <QDir>
-#include <QPair>
-#include <QSet>
 #include <QColor>
 #include <QImage>
+#include <QSharedPointer>
+#include <QVector>
 
 class InterpolationMethod;
+class NwwTileCache;
 
 class NwwMapImage: public ReadOnlyMapImage
 {
@@ -20,17 +20,18 @@ public:
 
     virtual QRgb pixel( double const lonRad, double const latRad );
     virtual QRgb pixel( int const x, int const y );
+    virtual void scanLine( double const * const lonRad, double const latRad,
+                           int const count, QRgb * const line );
+    virtual void pixelRow( int const x, int const y, int const count, QRgb * const row );
 
     void setBaseDirectory( QDir const & baseDirectory );
-    void setCacheSizeBytes( int const cacheSizeBytes );
+    void setTileCache( QSharedPointer<NwwTileCache> const & tileCache );
     void setInterpolationMethod( InterpolationMethod * const method );
     void setTileLevel( int const level );
 
 private:
-    enum { DefaultCacheSizeBytes = 32 * 1024 * 1024 };
-
     static int tileId( int const tileX, int const tileY );
-    QPair<QImage, bool> tile( int const tileX, int const tileY );
+    QImage const * tile( int const tileX, int const tileY );
     double lonRadToPixelX( double const lonRad ) const;
     double latRadToPixelY( double const latRad ) const;
 
@@ -51,8 +52,15 @@ private:
 
     InterpolationMethod * m_interpolationMethod;
 
-    QSet<int> m_tileMissing;
-    QCache<int, QImage> m_tileCache;
+    QSharedPointer<NwwTileCache> m_tileCache;
+
+    // last tile used, saves cache lookups for neighboring pixels
+    int m_currentTileKey;
+    bool m_currentTileValid;
+    QImage m_currentTile;
+
+    // source columns of the line passed to scanLine()
+    QVector<double> m_lineX;
 };
 
 #endif
@@ -0,0 +1,76 @@
+#include "NwwTileCache.h"
+
+#include <QMutexLocker>
+
+#include <limits>
+
+NwwTileCache::NwwTileCache( qint64 const maxCostBytes )
+    : m_mutex(),
+      m_tileCache( costKiB( maxCostBytes )),
+      m_tileMissing(),
+      m_hitCount(),
+      m_missCount()
+{
+}
+
+NwwTileCache::TileState NwwTileCache::find( int const tileKey, QImage & tile )
+{
+    QMutexLocker locker( &m_mutex );
+    if ( m_tileMissing.contains( tileKey ))
+        return TileMissing;
+
+    QImage const * const cachedTile = m_tileCache.object( tileKey );
+    if ( cachedTile ) {
+        ++m_hitCount;
+        tile = *cachedTile;
+        return TileCached;
+    }
+
+    ++m_missCount;
+    return TileUnknown;
+}
+
+void NwwTileCache::insert( int const tileKey, QImage const & tile )
+{
+    QMutexLocker locker( &m_mutex );
+    // the tile might have been loaded by a different thread in the meantime
+    if ( !m_tileCache.contains( tileKey ))
+        m_tileCache.insert( tileKey, new QImage( tile ), costKiB( tile.byteCount() ));
+}
+
+void NwwTileCache::insertMissing( int const tileKey )
+{
+    QMutexLocker locker( &m_mutex );
+    m_tileMissing.insert( tileKey );
+}
+
+void NwwTileCache::setMaxCostBytes( qint64 const maxCostBytes )
+{
+    QMutexLocker locker( &m_mutex );
+    m_tileCache.setMaxCost( costKiB( maxCostBytes > 0 ? maxCostBytes : static_cast<qint64>( DefaultCacheSizeBytes )));
+}
+
+qint64 NwwTileCache::hitCount() const
+{
+    QMutexLocker locker( &m_mutex );
+    return m_hitCount;
+}
+
+qint64 NwwTileCache::missCount() const
+{
+    QMutexLocker locker( &m_mutex );
+    return m_missCount;
+}
+
+qint64 NwwTileCache::totalCostBytes() const
+{
+    QMutexLocker locker( &m_mutex );
+    return static_cast<qint64>( m_tileCache.totalCost() ) * 1024;
+}
+
+int NwwTileCache::costKiB( qint64 const bytes )
+{
+    // round up, so that a tile never costs nothing
+    qint64 const kiB = ( bytes + 1023 ) / 1024;
+    return static_cast<int>( qMin( kiB, static_cast<qint64>( std::numeric_limits<int>::max() )));
+}
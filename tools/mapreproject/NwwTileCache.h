@@ -0,0 +1,46 @@
+#ifndef NWWTILECACHE_H
+#define NWWTILECACHE_H
+
+#include <QCache>
+#include <QImage>
+#include <QMutex>
+#include <QSet>
+
+// Least recently used cache of source tiles, shared by all threads reading the
+// same map source. The cost of a tile is its size in bytes, so the cache size
+// is a global memory budget rather than a per thread one. QCache counts its cost
+// in an int, so tiles are accounted in KiB to allow budgets beyond 2 GB.
+class NwwTileCache
+{
+public:
+    enum TileState { TileUnknown,
+                     TileCached,
+                     TileMissing };
+
+    explicit NwwTileCache( qint64 const maxCostBytes = DefaultCacheSizeBytes );
+
+    TileState find( int const tileKey, QImage & tile );
+    void insert( int const tileKey, QImage const & tile );
+    void insertMissing( int const tileKey );
+
+    void setMaxCostBytes( qint64 const maxCostBytes );
+
+    qint64 hitCount() const;
+    qint64 missCount() const;
+    qint64 totalCostBytes() const;
+
+private:
+    Q_DISABLE_COPY( NwwTileCache )
+
+    enum { DefaultCacheSizeBytes = 256 * 1024 * 1024 };
+
+    static int costKiB( qint64 const bytes );
+
+    mutable QMutex m_mutex;
+    QCache<int, QImage> m_tileCache;
+    QSet<int> m_tileMissing;
+    qint64 m_hitCount;
+    qint64 m_missCount;
+};
+
+#endif
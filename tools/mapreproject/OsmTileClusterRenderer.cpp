@@ -1,6 +1,7 @@
 #include "OsmTileClusterRenderer.h"
 
 #include "ReadOnlyMapImage.h"
+#include "TileClusterQueue.h"
 
 #include <QDebug>
 #include <QTime>
@@ -15,9 +16,12 @@ OsmTileClusterRenderer::OsmTileClusterRenderer( QObject * const parent )
       m_osmTileLevel(),
       m_osmMapEdgeLengthPixel(),
       m_clusterEdgeLengthTiles(),
+      m_tileQueue(),
       m_mapSourceDefinitions(),
       m_mapSources(),
-      m_mapSourceCount()
+      m_mapSourceCount(),
+      m_sourceLine(),
+      m_lonRads()
 {
 }
 
@@ -46,6 +50,11 @@ void OsmTileClusterRenderer::setOsmTileLevel( int const level )
              << "\nosmMapEdgeLengthPixel:" << m_osmMapEdgeLengthPixel;
 }
 
+void OsmTileClusterRenderer::setTileQueue( TileClusterQueue * const tileQueue )
+{
+    m_tileQueue = tileQueue;
+}
+
 QDir OsmTileClusterRenderer::checkAndCreateDirectory( int const tileX ) const
 {
     QDir const tileDirectory( m_osmBaseDirectory.path() + QString("/%1/%2").arg( m_osmTileLevel ).arg( tileX ));
@@ -74,39 +83,38 @@ void OsmTileClusterRenderer::initMapSources()
     m_mapSourceCount = m_mapSources.count();
 }
 
-void OsmTileClusterRenderer::renderOsmTileCluster( int const clusterX, int const clusterY )
+void OsmTileClusterRenderer::renderOsmTiles()
 {
-    qDebug() << objectName() << "rendering clusterX:" << clusterX << ", clusterY:" << clusterY;
+    qDebug() << objectName() << "rendering";
     int tilesRenderedCount = 0;
     QTime t;
     t.start();
-    int const tileX1 = clusterX * m_clusterEdgeLengthTiles;
-    int const tileX2 = tileX1 + m_clusterEdgeLengthTiles;
-    int const tileY1 = clusterY * m_clusterEdgeLengthTiles;
-    int const tileY2 = tileY1 + m_clusterEdgeLengthTiles;
 
-    for ( int tileX = tileX1; tileX < tileX2; ++tileX ) {
-        QDir const tileDirectory = checkAndCreateDirectory( tileX );
-        for ( int tileY = tileY1; tileY < tileY2; ++tileY ) {
-            QImage const osmTile = renderOsmTile( tileX, tileY );
-
-            // hack
-            if ( osmTile.isNull() )
-                continue;
-
-            QString const filename = tileDirectory.path() + QString( "/%1.png" ).arg( tileY );
-            bool const saved = osmTile.save( filename );
-            if ( saved )
-                ++tilesRenderedCount;
-            else
-                qFatal("Unable to save tile '%s'.", filename.toStdString().c_str() );
+    TileClusterQueue::Position position;
+    int tileX;
+    int tileY;
+    while ( m_tileQueue->nextTile( position, tileX, tileY )) {
+        QImage const osmTile = renderOsmTile( tileX, tileY );
+
+        // hack
+        if ( osmTile.isNull() ) {
+            m_tileQueue->addProcessedTile( false );
+            continue;
         }
+
+        QDir const tileDirectory = checkAndCreateDirectory( tileX );
+        QString const filename = tileDirectory.path() + QString( "/%1.png" ).arg( tileY );
+        bool const saved = osmTile.save( filename );
+        if ( saved )
+            ++tilesRenderedCount;
+        else
+            qFatal("Unable to save tile '%s'.", filename.toStdString().c_str() );
+        m_tileQueue->addProcessedTile( saved );
     }
     int const durationMs = t.elapsed();
-    qDebug() << objectName() << "clusterX:" <<clusterX << ", clusterY:" << clusterY
-             << "rendered:" << tilesRenderedCount << "tiles in" << durationMs << "ms =>"
+    qDebug() << objectName() << "rendered:" << tilesRenderedCount << "tiles in" << durationMs << "ms =>"
              << static_cast<double>( tilesRenderedCount ) * 1000.0 / static_cast<double>( durationMs ) << "tiles/s";
-    emit clusterRendered( this );
+    emit finished( this );
 }
 
 QImage OsmTileClusterRenderer::renderOsmTile( int const tileX, int const tileY )
@@ -117,28 +125,46 @@ QImage OsmTileClusterRenderer::renderOsmTile( int const tileX, int const tileY )
 
     QSize const tileSize( m_osmTileEdgeLengthPixel, m_osmTileEdgeLengthPixel );
     QImage tile( tileSize, QImage::Format_ARGB32 );
+    m_sourceLine.resize( m_osmTileEdgeLengthPixel );
     bool tileEmpty = true;
 
+    // the longitudes are the same for every row of the tile
+    m_lonRads.resize( m_osmTileEdgeLengthPixel );
+    for ( int x = 0; x < m_osmTileEdgeLengthPixel; ++x )
+        m_lonRads[x] = osmPixelXtoLonRad( basePixelX + x );
+    double const * const lonRads = m_lonRads.constData();
+
     for ( int y = 0; y < m_osmTileEdgeLengthPixel; ++y ) {
         int const pixelY = basePixelY + y;
         double const latRad = osmPixelYtoLatRad( pixelY );
-
-        for ( int x = 0; x < m_osmTileEdgeLengthPixel; ++x ) {
-            int const pixelX = basePixelX + x;
-            double const lonRad = osmPixelXtoLonRad( pixelX );
-
-            QRgb color = m_emptyPixel;
-            for (int i = 0; i < m_mapSourceCount; ++i)
-            {
-               color = m_mapSources[i]->pixel( lonRad, latRad );
-               if ( color != m_emptyPixel ) {
-                   tileEmpty = false;
-                   break;
-               }
+        QRgb * const line = reinterpret_cast<QRgb *>( tile.scanLine( y ));
+
+        // interpolate the whole row from the first map source, and fill the
+        // pixels it does not cover from the following ones
+        int emptyCount = m_osmTileEdgeLengthPixel;
+        for ( int i = 0; i < m_mapSourceCount && emptyCount > 0; ++i ) {
+            if ( i == 0 ) {
+                m_mapSources[i]->scanLine( lonRads, latRad, m_osmTileEdgeLengthPixel, line );
+            } else {
+                QRgb * const sourceLine = m_sourceLine.data();
+                m_mapSources[i]->scanLine( lonRads, latRad, m_osmTileEdgeLengthPixel, sourceLine );
+                for ( int x = 0; x < m_osmTileEdgeLengthPixel; ++x )
+                    if ( line[x] == m_emptyPixel )
+                        line[x] = sourceLine[x];
             }
 
-            tile.setPixel( x, y, color );
+            emptyCount = 0;
+            for ( int x = 0; x < m_osmTileEdgeLengthPixel; ++x )
+                if ( line[x] == m_emptyPixel )
+                    ++emptyCount;
         }
+
+        if ( m_mapSourceCount == 0 )
+            for ( int x = 0; x < m_osmTileEdgeLengthPixel; ++x )
+                line[x] = m_emptyPixel;
+
+        if ( emptyCount < m_osmTileEdgeLengthPixel )
+            tileEmpty = false;
     }
     return tileEmpty ? QImage() : tile;
 }
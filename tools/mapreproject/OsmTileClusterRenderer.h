@@ -10,6 +10,7 @@
 #include <QImage>
 
 class ReadOnlyMapImage;
+class TileClusterQueue;
 
 class OsmTileClusterRenderer: public QObject
 {
@@ -22,13 +23,14 @@ public:
     void setMapSources( QVector<ReadOnlyMapDefinition> const & mapSources );
     void setOsmBaseDirectory( QDir const & osmBaseDirectory );
     void setOsmTileLevel( int const level );
+    void setTileQueue( TileClusterQueue * const tileQueue );
 
 signals:
-    void clusterRendered( OsmTileClusterRenderer * );
+    void finished( OsmTileClusterRenderer * );
 
 public slots:
     void initMapSources();
-    void renderOsmTileCluster( int const clusterX, int const clusterY );
+    void renderOsmTiles();
 
 private:
     QDir checkAndCreateDirectory( int const tileX ) const;
@@ -43,10 +45,17 @@ private:
     int m_osmTileLevel;
     int m_osmMapEdgeLengthPixel;
     int m_clusterEdgeLengthTiles;
+    TileClusterQueue * m_tileQueue;
 
     QVector<ReadOnlyMapDefinition> m_mapSourceDefinitions;
     QVector<ReadOnlyMapImage*> m_mapSources;
     int m_mapSourceCount;
+
+    // one output row of a fallback map source
+    QVector<QRgb> m_sourceLine;
+
+    // longitudes of the pixel columns of the current tile
+    QVector<double> m_lonRads;
 };
 
 #endif
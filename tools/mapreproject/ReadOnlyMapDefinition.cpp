@@ -4,6 +4,7 @@
 #include "IntegerInterpolation.h"
 #include "NearestNeighborInterpolation.h"
 #include "NwwMapImage.h"
+#include "NwwTileCache.h"
 #include "SimpleMapImage.h"
 
 ReadOnlyMapDefinition::ReadOnlyMapDefinition()
@@ -12,10 +13,17 @@ ReadOnlyMapDefinition::ReadOnlyMapDefinition()
       m_baseDirectory(),
       m_tileLevel( -1 ),
       m_cacheSizeBytes(),
+      m_tileCache( new NwwTileCache ),
       m_filename()
 {
 }
 
+void ReadOnlyMapDefinition::setCacheSizeBytes( qint64 const cacheSizeBytes )
+{
+    m_cacheSizeBytes = cacheSizeBytes;
+    m_tileCache->setMaxCostBytes( cacheSizeBytes );
+}
+
 InterpolationMethod * ReadOnlyMapDefinition::createInterpolationMethod() const
 {
     switch ( m_interpolationMethod ) {
@@ -42,7 +50,7 @@ ReadOnlyMapImage * ReadOnlyMapDefinition::createReadOnlyMap() const
         NwwMapImage * const mapImage = new NwwMapImage( m_baseDirectory, m_tileLevel );
         interpolationMethod->setMapImage( mapImage );
         mapImage->setInterpolationMethod( interpolationMethod );
-        mapImage->setCacheSizeBytes( m_cacheSizeBytes );
+        mapImage->setTileCache( m_tileCache );
         return mapImage;
     }
     else if ( m_mapType == BathymetryMap ) {
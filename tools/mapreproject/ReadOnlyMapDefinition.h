@@ -4,9 +4,11 @@
 #include "mapreproject.h"
 
 #include <QDebug>
+#include <QSharedPointer>
 #include <QString>
 
 class InterpolationMethod;
+class NwwTileCache;
 class ReadOnlyMapImage;
 
 class ReadOnlyMapDefinition
@@ -19,12 +21,15 @@ public:
     ReadOnlyMapImage * createReadOnlyMap() const;
 
     void setBaseDirectory( QString const & baseDirectory );
-    void setCacheSizeBytes( int const cacheSizeBytes );
+    // size of the tile cache shared by all map images created from copies of this definition
+    void setCacheSizeBytes( qint64 const cacheSizeBytes );
     void setInterpolationMethod( EInterpolationMethod const interpolationMethod );
     void setFileName( QString const & fileName );
     void setMapType( MapSourceType const mapType );
     void setTileLevel( int const tileLevel );
 
+    QSharedPointer<NwwTileCache> tileCache() const;
+
 private:
     InterpolationMethod * createInterpolationMethod() const;
 
@@ -34,7 +39,8 @@ private:
     // relevant for tiled maps
     QString m_baseDirectory;
     int m_tileLevel;
-    int m_cacheSizeBytes;
+    qint64 m_cacheSizeBytes;
+    QSharedPointer<NwwTileCache> m_tileCache;
 
     // relevant for non-tiled maps (only one image)
     QString m_filename;
@@ -50,11 +56,6 @@ inline void ReadOnlyMapDefinition::setBaseDirectory( QString const & baseDirecto
     m_baseDirectory = baseDirectory;
 }
 
-inline void ReadOnlyMapDefinition::setCacheSizeBytes( int const cacheSizeBytes )
-{
-    m_cacheSizeBytes = cacheSizeBytes;
-}
-
 inline void ReadOnlyMapDefinition::setInterpolationMethod( EInterpolationMethod const interpolationMethod )
 {
     m_interpolationMethod = interpolationMethod;
@@ -75,6 +76,11 @@ inline void ReadOnlyMapDefinition::setTileLevel( int const tileLevel )
     m_tileLevel = tileLevel;
 }
 
+inline QSharedPointer<NwwTileCache> ReadOnlyMapDefinition::tileCache() const
+{
+    return m_tileCache;
+}
+
 
 inline QDebug operator<<( QDebug dbg, ReadOnlyMapDefinition const & r)
 {
@@ -3,3 +3,16 @@
 ReadOnlyMapImage::~ReadOnlyMapImage()
 {
 }
+
+void ReadOnlyMapImage::scanLine( double const * const lonRad, double const latRad,
+                                 int const count, QRgb * const line )
+{
+    for ( int i = 0; i < count; ++i )
+        line[ i ] = pixel( lonRad[ i ], latRad );
+}
+
+void ReadOnlyMapImage::pixelRow( int const x, int const y, int const count, QRgb * const row )
+{
+    for ( int i = 0; i < count; ++i )
+        row[ i ] = pixel( x + i, y );
+}
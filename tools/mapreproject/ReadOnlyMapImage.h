@@ -13,6 +13,16 @@ public:
     virtual QRgb pixel( double const lonRad, double const latRad ) = 0;
     virtual QRgb pixel( int const x, int const y ) = 0;
     virtual void setInterpolationMethod( InterpolationMethod * const interpolationMethod ) = 0;
+
+    // Interpolates count pixels at constant latitude and the ascending longitudes
+    // lonRad[0..count-1]. The default implementation calls pixel( lonRad, latRad )
+    // for each of them.
+    virtual void scanLine( double const * const lonRad, double const latRad,
+                           int const count, QRgb * const line );
+
+    // Copies count source pixels of row y starting at column x. The default
+    // implementation calls pixel( x, y ) for each of them.
+    virtual void pixelRow( int const x, int const y, int const count, QRgb * const row );
 };
 
 #endif
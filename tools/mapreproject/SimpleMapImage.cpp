@@ -3,6 +3,7 @@
 #include "InterpolationMethod.h"
 
 #include <cmath>
+#include <cstring>
 
 SimpleMapImage::SimpleMapImage( QString const & fileName )
     : m_image( fileName ),
@@ -11,6 +12,10 @@ SimpleMapImage::SimpleMapImage( QString const & fileName )
 {
     if ( m_image.isNull() )
         qFatal( "Invalid image '%s'", fileName.toStdString().c_str() );
+
+    // pixelRow() copies scanlines directly
+    if ( m_image.format() != QImage::Format_ARGB32 && m_image.format() != QImage::Format_RGB32 )
+        m_image = m_image.convertToFormat( QImage::Format_ARGB32 );
 }
 
 QRgb SimpleMapImage::pixel( double const lonRad,  double const latRad )
@@ -25,6 +30,29 @@ QRgb SimpleMapImage::pixel( int const x, int const y )
     return m_image.pixel( x, m_mapHeightPixel - y - 1 );
 }
 
+void SimpleMapImage::scanLine( double const * const lonRad, double const latRad,
+                               int const count, QRgb * const line )
+{
+    // same conversion as pixel( lonRad, latRad ) for each pixel
+    m_lineX.resize( count );
+    for ( int i = 0; i < count; ++i )
+        m_lineX[ i ] = lonRadToPixelX( lonRad[ i ] );
+    double const y = latRadToPixelY( latRad );
+    m_interpolationMethod->interpolateLine( m_lineX.constData(), y, count, line );
+}
+
+void SimpleMapImage::pixelRow( int const x, int const y, int const count, QRgb * const row )
+{
+    if ( y < 0 || y >= m_mapHeightPixel || x < 0 || x + count > m_mapWidthPixel ) {
+        // let QImage deal with the pixels out of range
+        ReadOnlyMapImage::pixelRow( x, y, count, row );
+        return;
+    }
+
+    QRgb const * const imageLine = reinterpret_cast<QRgb const *>( m_image.constScanLine( m_mapHeightPixel - y - 1 ));
+    memcpy( row, imageLine + x, count * sizeof( QRgb ));
+}
+
 void SimpleMapImage::setInterpolationMethod( InterpolationMethod * const interpolationMethod )
 {
     m_interpolationMethod = interpolationMethod;
@@ -6,6 +6,7 @@
 #include <QString>
 #include <QColor>
 #include <QImage>
+#include <QVector>
 
 class InterpolationMethod;
 
@@ -16,6 +17,9 @@ public:
 
     virtual QRgb pixel( double const lonRad, double const latRad );
     virtual QRgb pixel( int const x, int const y );
+    virtual void scanLine( double const * const lonRad, double const latRad,
+                           int const count, QRgb * const line );
+    virtual void pixelRow( int const x, int const y, int const count, QRgb * const row );
     virtual void setInterpolationMethod( InterpolationMethod * const interpolationMethod );
 
 private:
@@ -26,6 +30,9 @@ private:
     int m_mapWidthPixel;
     int m_mapHeightPixel;
     InterpolationMethod * m_interpolationMethod;
+
+    // source columns of the line passed to scanLine()
+    QVector<double> m_lineX;
 };
 
 #endif
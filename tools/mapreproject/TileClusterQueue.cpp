@@ -0,0 +1,94 @@
+#include "TileClusterQueue.h"
+
+#include <QMutexLocker>
+
+TileClusterQueue::Position::Position()
+    : m_clusterIndex( -1 ),
+      m_stealing( false )
+{
+}
+
+TileClusterQueue::TileClusterQueue( int const mapEdgeLengthClusters, int const clusterEdgeLengthTiles )
+    : m_mapEdgeLengthClusters( mapEdgeLengthClusters ),
+      m_clusterEdgeLengthTiles( clusterEdgeLengthTiles ),
+      m_clusterTileCount( clusterEdgeLengthTiles * clusterEdgeLengthTiles ),
+      m_mutex(),
+      m_front( mapEdgeLengthClusters * mapEdgeLengthClusters, 0 ),
+      m_back( mapEdgeLengthClusters * mapEdgeLengthClusters, clusterEdgeLengthTiles * clusterEdgeLengthTiles ),
+      m_nextCluster( 0 ),
+      m_processedTileCount( 0 ),
+      m_savedTileCount( 0 )
+{
+}
+
+bool TileClusterQueue::nextTile( Position & position, int & tileX, int & tileY )
+{
+    QMutexLocker locker( &m_mutex );
+
+    // continue with the current cluster
+    int const current = position.m_clusterIndex;
+    if ( current >= 0 && m_front[ current ] < m_back[ current ] ) {
+        if ( position.m_stealing )
+            tileAt( current, --m_back[ current ], tileX, tileY );
+        else
+            tileAt( current, m_front[ current ]++, tileX, tileY );
+        return true;
+    }
+
+    // start a new cluster
+    if ( m_nextCluster < m_front.size() ) {
+        position.m_clusterIndex = m_nextCluster++;
+        position.m_stealing = false;
+        tileAt( position.m_clusterIndex, m_front[ position.m_clusterIndex ]++, tileX, tileY );
+        return true;
+    }
+
+    // steal from the cluster with the most remaining tiles
+    int victim = -1;
+    int victimRemaining = 0;
+    for ( int i = 0; i < m_front.size(); ++i ) {
+        int const remaining = m_back[ i ] - m_front[ i ];
+        if ( remaining > victimRemaining ) {
+            victim = i;
+            victimRemaining = remaining;
+        }
+    }
+    if ( victim < 0 )
+        return false;
+
+    position.m_clusterIndex = victim;
+    position.m_stealing = true;
+    tileAt( victim, --m_back[ victim ], tileX, tileY );
+    return true;
+}
+
+void TileClusterQueue::addProcessedTile( bool const saved )
+{
+    m_processedTileCount.fetchAndAddOrdered( 1 );
+    if ( saved )
+        m_savedTileCount.fetchAndAddOrdered( 1 );
+}
+
+int TileClusterQueue::tileCount() const
+{
+    return m_front.size() * m_clusterTileCount;
+}
+
+int TileClusterQueue::processedTileCount() const
+{
+    return m_processedTileCount.fetchAndAddOrdered( 0 );
+}
+
+int TileClusterQueue::savedTileCount() const
+{
+    return m_savedTileCount.fetchAndAddOrdered( 0 );
+}
+
+inline void TileClusterQueue::tileAt( int const clusterIndex, int const tileIndex, int & tileX, int & tileY ) const
+{
+    // same order as before: clusters column by column, tiles within a cluster column by column
+    int const clusterX = clusterIndex / m_mapEdgeLengthClusters;
+    int const clusterY = clusterIndex % m_mapEdgeLengthClusters;
+    tileX = clusterX * m_clusterEdgeLengthTiles + tileIndex / m_clusterEdgeLengthTiles;
+    tileY = clusterY * m_clusterEdgeLengthTiles + tileIndex % m_clusterEdgeLengthTiles;
+}
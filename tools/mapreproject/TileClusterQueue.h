@@ -0,0 +1,54 @@
+#ifndef TILECLUSTERQUEUE_H
+#define TILECLUSTERQUEUE_H
+
+#include <QAtomicInt>
+#include <QMutex>
+#include <QVector>
+
+// Hands out the tiles of quadratic tile clusters to the render threads.
+// Each thread renders the tiles of its current cluster front to back, which keeps
+// its source tiles hot in the cache. When no unstarted cluster is left, threads
+// which ran out of work steal tiles from the back of the cluster with the most
+// remaining tiles, so that no thread sits idle while a single cluster is rendered.
+class TileClusterQueue
+{
+public:
+    class Position
+    {
+    public:
+        Position();
+
+        int m_clusterIndex;
+        bool m_stealing;
+    };
+
+    TileClusterQueue( int const mapEdgeLengthClusters, int const clusterEdgeLengthTiles );
+
+    bool nextTile( Position & position, int & tileX, int & tileY );
+
+    void addProcessedTile( bool const saved );
+
+    int tileCount() const;
+    int processedTileCount() const;
+    int savedTileCount() const;
+
+private:
+    Q_DISABLE_COPY( TileClusterQueue )
+
+    void tileAt( int const clusterIndex, int const tileIndex, int & tileX, int & tileY ) const;
+
+    int const m_mapEdgeLengthClusters;
+    int const m_clusterEdgeLengthTiles;
+    int const m_clusterTileCount;
+
+    QMutex m_mutex;
+    // per cluster: tiles [front, back) are not handed out yet
+    QVector<int> m_front;
+    QVector<int> m_back;
+    int m_nextCluster;
+
+    mutable QAtomicInt m_processedTileCount;
+    mutable QAtomicInt m_savedTileCount;
+};
+
+#endif
@@ -39,7 +39,7 @@ void printUsage()
                  "          type              \n"
                  "          base-directory    \n"
                  "          tile-level        \n"
-                 "          cache-size        \n"
+                 "          cache-size        memory budget in bytes for source tiles, shared by all threads (default 256 MB)\n"
                  "          file              \n"
                  "          interpolation-method  one of \"integer\", \"nearest-neighbor\" (default), \"average\" or \"bilinear\"\n";
 }
@@ -79,6 +79,18 @@ int parseInt( char const * const value )
     return result;
 }
 
+qint64 parseInt64( char const * const value )
+{
+    if ( !value )
+        qFatal("Suboption does not have a value.");
+    QString str( value );
+    bool ok;
+    qint64 const result = str.toLongLong( &ok );
+    if ( !ok )
+        qFatal("Suboption does not have an integer value.");
+    return result;
+}
+
 EInterpolationMethod parseInterpolationMethod( char const * const value )
 {
     EInterpolationMethod result = UnknownInterpolationMethod;
@@ -151,7 +163,7 @@ ReadOnlyMapDefinition parseInput( char * subopts )
             break;
 
         case CacheSizeOption:
-            mapDefinition.setCacheSizeBytes( parseInt( value ));
+            mapDefinition.setCacheSizeBytes( parseInt64( value ));
             break;
 
         default:
@@ -64,7 +64,7 @@ bool moreImportantAdminArea( const OsmRegion &a, const OsmRegion b )
 }
 
 OsmParser::OsmParser( QObject *parent ) :
-    QObject( parent ), m_convexHull( 0 )
+    QObject( parent ), m_placemarkCount( 0 ), m_convexHull( 0 )
 {
     m_categoryMap["tourism/camp_site"] = OsmPlacemark::AccomodationCamping;
     m_categoryMap["tourism/hostel"] = OsmPlacemark::AccomodationHostel;
@@ -179,7 +179,7 @@ void Way::setPosition( const QHash<int, Coordinate> &database, OsmPlacemark &pla
     }
 }
 
-void Way::setRegion( const QHash<int, Node> &database,  const OsmRegionTree & tree, QList<OsmOsmRegion> & osmOsmRegions, OsmPlacemark &placemark ) const
+void Way::setRegion( const QHash<int, Node> &database,  const OsmRegionIndex & index, QList<OsmOsmRegion> & osmOsmRegions, OsmPlacemark &placemark ) const
 {
     if ( !city.isEmpty() ) {
         foreach( const OsmOsmRegion & region, osmOsmRegions ) {
@@ -213,7 +213,7 @@ void Way::setRegion( const QHash<int, Node> &database,  const OsmRegionTree & tr
     }
 
     GeoDataCoordinates position( placemark.longitude(), placemark.latitude(), 0.0, GeoDataCoordinates::Degree );
-    placemark.setRegionId( tree.smallestRegionId( position ) );
+    placemark.setRegionId( index.smallestRegionId( position ) );
 }
 
 void OsmParser::read( const QFileInfo &content, const QString &areaName )
@@ -225,7 +225,7 @@ void OsmParser::read( const QFileInfo &content, const QString &areaName )
     m_ways.clear();
     m_relations.clear();
 
-    m_placemarks.clear();
+    m_placemarkCount = 0;
     m_osmOsmRegions.clear();
 
     int pass = 0;
@@ -321,28 +321,42 @@ void OsmParser::read( const QFileInfo &content, const QString &areaName )
     Q_ASSERT( regions.isEmpty() );
     int left = 0;
     regionTree.traverse( left );
+    OsmRegionIndex const regionIndex( regionTree );
 
     qWarning() << "Step 4: Creating placemarks from" << m_nodes.size() << "nodes";
 
-    foreach( const Node & node, m_nodes ) {
-        if ( node.save ) {
-            OsmPlacemark placemark = node;
-            GeoDataCoordinates position( node.lon, node.lat, 0.0, GeoDataCoordinates::Degree );
-            placemark.setRegionId( regionTree.smallestRegionId( position ) );
+    QVector<const Node*> savedNodes;
+    QVector<GeoDataCoordinates> positions;
+    QHash<int, Node>::const_iterator node = m_nodes.constBegin();
+    QHash<int, Node>::const_iterator const endNode = m_nodes.constEnd();
+    for ( ; node != endNode; ++node ) {
+        if ( node.value().save ) {
+            savedNodes << &node.value();
+            positions << GeoDataCoordinates( node.value().lon, node.value().lat, 0.0, GeoDataCoordinates::Degree );
+        }
+    }
 
-            if ( !node.name.isEmpty() ) {
-                placemark.setHouseNumber( QString() );
-                m_placemarks.push_back( placemark );
-            }
+    QVector<int> const regionIds = regionIndex.smallestRegionIds( positions );
+    positions.clear();
 
-            if ( !node.street.isEmpty() && node.name != node.street ) {
-                placemark.setCategory( OsmPlacemark::Address );
-                placemark.setName( node.street.trimmed() );
-                placemark.setHouseNumber( node.houseNumber.trimmed() );
-                m_placemarks.push_back( placemark );
-            }
+    for ( int i = 0; i < savedNodes.size(); ++i ) {
+        const Node & node = *savedNodes[i];
+        OsmPlacemark placemark = node;
+        placemark.setRegionId( regionIds[i] );
+
+        if ( !node.name.isEmpty() ) {
+            placemark.setHouseNumber( QString() );
+            writePlacemark( placemark );
+        }
+
+        if ( !node.street.isEmpty() && node.name != node.street ) {
+            placemark.setCategory( OsmPlacemark::Address );
+            placemark.setName( node.street.trimmed() );
+            placemark.setHouseNumber( node.houseNumber.trimmed() );
+            writePlacemark( placemark );
         }
     }
+    savedNodes.clear();
 
     qWarning() << "Step 5: Creating placemarks from" << m_ways.size() << "ways";
     QMultiMap<QString, Way> waysByName;
@@ -367,11 +381,11 @@ void OsmParser::read( const QFileInfo &content, const QString &areaName )
             Q_ASSERT( !ways.isEmpty() );
             OsmPlacemark placemark = ways.first();
             ways.first().setPosition( m_coordinates, placemark );
-            ways.first().setRegion( m_nodes, regionTree, m_osmOsmRegions, placemark );
+            ways.first().setRegion( m_nodes, regionIndex, m_osmOsmRegions, placemark );
 
             if ( placemark.category() != OsmPlacemark::Address && !ways.first().name.isEmpty() ) {
                 placemark.setHouseNumber( QString() );
-                m_placemarks.push_back( placemark );
+                writePlacemark( placemark );
             }
 
             if ( !ways.first().isBuilding || !ways.first().houseNumber.isEmpty() ) {
@@ -380,7 +394,7 @@ void OsmParser::read( const QFileInfo &content, const QString &areaName )
                 if ( !name.isEmpty() ) {
                     placemark.setName( name.trimmed() );
                     placemark.setHouseNumber( ways.first().houseNumber.trimmed() );
-                    m_placemarks.push_back( placemark );
+                    writePlacemark( placemark );
                 }
             }
         }
@@ -412,18 +426,21 @@ void OsmParser::read( const QFileInfo &content, const QString &areaName )
         }
     }
 
-    qWarning() << "Step 7: Serializing" << m_placemarks.size() << "placemarks";
-    foreach( const OsmPlacemark & placemark, m_placemarks ) {
-        foreach( Writer * writer, m_writers ) {
-            Q_ASSERT( !placemark.name().isEmpty() );
-            writer->addOsmPlacemark( placemark );
-        }
-    }
+    qWarning() << "Step 7:" << m_placemarkCount << "placemarks have been serialized while creating them";
 
     qWarning() << "Step 8: There is no step 8. Done after " << timer.elapsed() / 1000 << "s.";
     //writeOutlineKml( areaName );
 }
 
+void OsmParser::writePlacemark( const OsmPlacemark &placemark )
+{
+    Q_ASSERT( !placemark.name().isEmpty() );
+    ++m_placemarkCount;
+    foreach( Writer * writer, m_writers ) {
+        writer->addOsmPlacemark( placemark );
+    }
+}
+
 QList< QList<Way> > OsmParser::merge( const QList<Way> &ways ) const
 {
     QList<WayMerger> mergers;
@@ -615,18 +632,18 @@ bool OsmParser::shouldSave( ElementType /*type*/, const QString &key, const QStr
         interestingTags["place"] = places;
     }
 
-    return interestingTags.contains( key ) &&
-           interestingTags[key].contains( value );
+    return interestingTags.value( key ).contains( value );
 }
 
 void OsmParser::setCategory( Element &element, const QString &key, const QString &value )
 {
     QString const term = key + '/' + value;
-    if ( m_categoryMap.contains( term ) ) {
+    QHash<QString, OsmPlacemark::OsmCategory>::const_iterator const category = m_categoryMap.constFind( term );
+    if ( category != m_categoryMap.constEnd() ) {
         if ( element.category != OsmPlacemark::UnknownCategory ) {
-            qDebug() << "Overwriting category " << element.category << " with " << m_categoryMap[term] << " for " << element.name;
+            qDebug() << "Overwriting category " << element.category << " with " << category.value() << " for " << element.name;
         }
-        element.category = m_categoryMap[term];
+        element.category = category.value();
     }
 }
 
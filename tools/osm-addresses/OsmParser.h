@@ -15,6 +15,7 @@
 #include "OsmRegion.h"
 #include "OsmPlacemark.h"
 #include "OsmRegionTree.h"
+#include "OsmRegionIndex.h"
 
 #include "GeoDataLineString.h"
 #include "GeoDataPolygon.h"
@@ -82,7 +83,7 @@ struct Way : public Element {
 
     operator OsmPlacemark() const;
     void setPosition( const QHash<int, Coordinate> &database, OsmPlacemark &placemark ) const;
-    void setRegion( const QHash<int, Node> &database, const OsmRegionTree & tree, QList<OsmOsmRegion> & osmOsmRegions, OsmPlacemark &placemark ) const;
+    void setRegion( const QHash<int, Node> &database, const OsmRegionIndex & index, QList<OsmOsmRegion> & osmOsmRegions, OsmPlacemark &placemark ) const;
 };
 
 struct WayMerger {
@@ -205,11 +206,13 @@ private:
 
     Marble::GeoDataLineString reverse( const Marble::GeoDataLineString & string );
 
+    void writePlacemark( const OsmPlacemark &placemark );
+
     QList<Writer*> m_writers;
 
     QList<OsmOsmRegion> m_osmOsmRegions;
 
-    QList<OsmPlacemark> m_placemarks;
+    int m_placemarkCount;
 
     QHash<QString, OsmPlacemark::OsmCategory> m_categoryMap;
 
@@ -0,0 +1,361 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2014 The Marble contributors
+//
+
+#include "OsmRegionIndex.h"
+
+#include "OsmRegionTree.h"
+#include "GeoDataLinearRing.h"
+
+#include <QRunnable>
+#include <QThreadPool>
+#include <QVarLengthArray>
+#include <QtAlgorithms>
+
+#include <cmath>
+#include <limits>
+
+namespace Marble
+{
+
+namespace
+{
+
+enum {
+    NodeCapacity = 16,
+    EdgesPerSlab = 8,
+    MaximumSlabCount = 1024,
+    BatchSize = 1024
+};
+
+struct BoxItem
+{
+    qreal west;
+    qreal east;
+    qreal south;
+    qreal north;
+    int index;
+};
+
+bool lessLongitude( const BoxItem &a, const BoxItem &b )
+{
+    return a.west + a.east < b.west + b.east;
+}
+
+bool lessLatitude( const BoxItem &a, const BoxItem &b )
+{
+    return a.south + a.north < b.south + b.north;
+}
+
+class RegionLookupJob : public QRunnable
+{
+public:
+    RegionLookupJob( const OsmRegionIndex *index, const GeoDataCoordinates *positions, int *regionIds, int count ) :
+        m_index( index ), m_positions( positions ), m_regionIds( regionIds ), m_count( count )
+    {
+        // nothing to do
+    }
+
+    virtual void run()
+    {
+        for ( int i = 0; i < m_count; ++i ) {
+            m_regionIds[i] = m_index->smallestRegionId( m_positions[i] );
+        }
+    }
+
+private:
+    const OsmRegionIndex *const m_index;
+    const GeoDataCoordinates *const m_positions;
+    int *const m_regionIds;
+    const int m_count;
+};
+
+}
+
+OsmRegionIndex::PreparedRing::PreparedRing() :
+    m_minLon( 0.0 ), m_maxLon( 0.0 ), m_slabFactor( 0.0 ), m_slabCount( 0 )
+{
+    // nothing to do
+}
+
+OsmRegionIndex::PreparedRing::PreparedRing( const GeoDataLinearRing &ring ) :
+    m_box( ring.latLonAltBox() ),
+    m_minLon( 0.0 ), m_maxLon( 0.0 ), m_slabFactor( 0.0 ), m_slabCount( 0 )
+{
+    int const points = ring.size();
+    if ( points == 0 ) {
+        return;
+    }
+
+    m_lon.reserve( points );
+    m_lat.reserve( points );
+    for ( int i = 0; i < points; ++i ) {
+        m_lon << ring.at( i ).longitude();
+        m_lat << ring.at( i ).latitude();
+    }
+
+    m_minLon = m_lon.first();
+    m_maxLon = m_lon.first();
+    foreach( qreal lon, m_lon ) {
+        m_minLon = qMin( m_minLon, lon );
+        m_maxLon = qMax( m_maxLon, lon );
+    }
+
+    m_slabCount = qBound<int>( 1, points / EdgesPerSlab, MaximumSlabCount );
+    m_slabFactor = m_maxLon > m_minLon ? m_slabCount / ( m_maxLon - m_minLon ) : 0.0;
+
+    // Each edge goes into all slabs its longitude range overlaps. First count, then fill.
+    m_slabOffsets.fill( 0, m_slabCount + 1 );
+    for ( int i = 0, j = points - 1; i < points; j = i++ ) {
+        int const first = slab( qMin( m_lon[i], m_lon[j] ) );
+        int const last = slab( qMax( m_lon[i], m_lon[j] ) );
+        for ( int s = first; s <= last; ++s ) {
+            ++m_slabOffsets[s+1];
+        }
+    }
+    for ( int s = 0; s < m_slabCount; ++s ) {
+        m_slabOffsets[s+1] += m_slabOffsets[s];
+    }
+
+    m_slabEdges.resize( m_slabOffsets.last() );
+    QVector<int> position = m_slabOffsets;
+    for ( int i = 0, j = points - 1; i < points; j = i++ ) {
+        int const first = slab( qMin( m_lon[i], m_lon[j] ) );
+        int const last = slab( qMax( m_lon[i], m_lon[j] ) );
+        for ( int s = first; s <= last; ++s ) {
+            m_slabEdges[position[s]++] = i;
+        }
+    }
+}
+
+inline int OsmRegionIndex::PreparedRing::slab( qreal lon ) const
+{
+    return qMin( m_slabCount - 1, static_cast<int>( ( lon - m_minLon ) * m_slabFactor ) );
+}
+
+bool OsmRegionIndex::PreparedRing::contains( const GeoDataCoordinates &coordinates ) const
+{
+    // Same test as GeoDataLinearRing::contains(), restricted to the edges which can
+    // cross the meridian of the given coordinates
+    if ( !m_box.contains( coordinates ) ) {
+        return false;
+    }
+
+    qreal const lon = coordinates.longitude();
+    qreal const lat = coordinates.latitude();
+    if ( m_lon.isEmpty() || lon < m_minLon || lon > m_maxLon ) {
+        return false;
+    }
+
+    int const points = m_lon.size();
+    int const s = slab( lon );
+    bool inside = false;
+    for ( int k = m_slabOffsets[s]; k < m_slabOffsets[s+1]; ++k ) {
+        int const i = m_slabEdges[k];
+        int const j = i > 0 ? i - 1 : points - 1;
+        qreal const oneLon = m_lon[i];
+        qreal const twoLon = m_lon[j];
+
+        if ( ( oneLon < lon && twoLon >= lon ) || ( twoLon < lon && oneLon >= lon ) ) {
+            if ( m_lat[i] + ( lon - oneLon ) / ( twoLon - oneLon ) * ( m_lat[j] - m_lat[i] ) < lat ) {
+                inside = !inside;
+            }
+        }
+    }
+
+    return inside;
+}
+
+OsmRegionIndex::OsmRegionIndex( const OsmRegionTree &tree ) :
+    m_root( -1 )
+{
+    addRegions( tree, -1 );
+    bulkLoad();
+}
+
+void OsmRegionIndex::addRegions( const OsmRegionTree &tree, int parent )
+{
+    Region region;
+    region.identifier = tree.node().identifier();
+    region.adminLevel = tree.node().adminLevel();
+    region.parent = parent;
+
+    // The geometry of the root is never tested
+    if ( parent >= 0 ) {
+        region.outer = PreparedRing( tree.node().geometry().outerBoundary() );
+        foreach( const GeoDataLinearRing &ring, tree.node().geometry().innerBoundaries() ) {
+            region.inner << PreparedRing( ring );
+        }
+    }
+
+    int const index = m_regions.size();
+    m_regions << region;
+
+    foreach( const OsmRegionTree &child, tree.children() ) {
+        addRegions( child, index );
+    }
+}
+
+void OsmRegionIndex::bulkLoad()
+{
+    // Sort-Tile-Recursive packing of the region bounding boxes
+    QVector<BoxItem> items;
+    for ( int i = 1; i < m_regions.size(); ++i ) {
+        const GeoDataLatLonAltBox &box = m_regions[i].outer.m_box;
+        BoxItem item;
+        if ( box.west() < box.east() ) {
+            item.west = box.west();
+            item.east = box.east();
+        } else {
+            // crosses the date line (or covers all longitudes)
+            item.west = -std::numeric_limits<qreal>::max();
+            item.east = std::numeric_limits<qreal>::max();
+        }
+        item.south = box.south();
+        item.north = box.north();
+        item.index = i;
+        items << item;
+    }
+
+    bool leaf = true;
+    while ( !items.isEmpty() ) {
+        int const nodeCount = ( items.size() + NodeCapacity - 1 ) / NodeCapacity;
+        int const sliceSize = static_cast<int>( std::ceil( std::sqrt( static_cast<qreal>( nodeCount ) ) ) ) * NodeCapacity;
+        qSort( items.begin(), items.end(), lessLongitude );
+        for ( int s = 0; s < items.size(); s += sliceSize ) {
+            qSort( items.begin() + s, items.begin() + qMin( s + sliceSize, items.size() ), lessLatitude );
+        }
+
+        QVector<BoxItem> parents;
+        for ( int i = 0; i < items.size(); i += NodeCapacity ) {
+            Node node;
+            node.first = m_entries.size();
+            node.count = qMin<int>( NodeCapacity, items.size() - i );
+            node.leaf = leaf;
+            node.west = items[i].west;
+            node.east = items[i].east;
+            node.south = items[i].south;
+            node.north = items[i].north;
+            for ( int k = i; k < i + node.count; ++k ) {
+                node.west = qMin( node.west, items[k].west );
+                node.east = qMax( node.east, items[k].east );
+                node.south = qMin( node.south, items[k].south );
+                node.north = qMax( node.north, items[k].north );
+                m_entries << items[k].index;
+            }
+
+            BoxItem parent;
+            parent.west = node.west;
+            parent.east = node.east;
+            parent.south = node.south;
+            parent.north = node.north;
+            parent.index = m_nodes.size();
+            parents << parent;
+            m_nodes << node;
+        }
+
+        if ( parents.size() == 1 ) {
+            m_root = parents.first().index;
+            break;
+        }
+
+        items = parents;
+        leaf = false;
+    }
+}
+
+bool OsmRegionIndex::contains( const Region &region, const GeoDataCoordinates &coordinates ) const
+{
+    if ( !region.outer.contains( coordinates ) ) {
+        return false;
+    }
+
+    foreach( const PreparedRing &ring, region.inner ) {
+        if ( ring.contains( coordinates ) ) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int OsmRegionIndex::smallestRegionId( const GeoDataCoordinates &coordinates ) const
+{
+    qreal lon, lat;
+    coordinates.geoCoordinates( lon, lat );
+
+    // All regions containing the coordinates, in tree preorder
+    QVector<int> candidates;
+    candidates << 0;
+
+    if ( m_root >= 0 ) {
+        QVarLengthArray<int, 64> stack;
+        stack.append( m_root );
+        while ( stack.size() > 0 ) {
+            const Node &node = m_nodes[stack[stack.size()-1]];
+            stack.removeLast();
+            if ( lon < node.west || lon > node.east || lat < node.south || lat > node.north ) {
+                continue;
+            }
+
+            for ( int i = node.first; i < node.first + node.count; ++i ) {
+                int const entry = m_entries[i];
+                if ( !node.leaf ) {
+                    stack.append( entry );
+                } else if ( contains( m_regions[entry], coordinates ) ) {
+                    candidates << entry;
+                }
+            }
+        }
+    }
+
+    qSort( candidates );
+    int level = m_regions.first().adminLevel;
+    return smallestRegionId( candidates, 0, level );
+}
+
+int OsmRegionIndex::smallestRegionId( const QVector<int> &candidates, int index, int &level ) const
+{
+    // Mirrors OsmRegionTree::smallestRegionId(), visiting only children which contain the coordinates
+    int maxLevel = m_regions[index].adminLevel;
+    int minId = m_regions[index].identifier;
+    foreach( int child, candidates ) {
+        if ( m_regions[child].parent == index ) {
+            int childLevel = level;
+            int const id = smallestRegionId( candidates, child, childLevel );
+            if ( childLevel >= maxLevel ) {
+                maxLevel = childLevel;
+                minId = id;
+            }
+        }
+    }
+
+    level = maxLevel;
+    return minId;
+}
+
+QVector<int> OsmRegionIndex::smallestRegionIds( const QVector<GeoDataCoordinates> &positions ) const
+{
+    QVector<int> result( positions.size() );
+    if ( positions.isEmpty() ) {
+        return result;
+    }
+
+    int *const regionIds = result.data();
+    QThreadPool pool;
+    for ( int i = 0; i < positions.size(); i += BatchSize ) {
+        int const count = qMin<int>( BatchSize, positions.size() - i );
+        pool.start( new RegionLookupJob( this, positions.constData() + i, regionIds + i, count ) );
+    }
+    pool.waitForDone();
+
+    return result;
+}
+
+}
@@ -0,0 +1,114 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2014 The Marble contributors
+//
+
+#ifndef MARBLE_OSMREGIONINDEX_H
+#define MARBLE_OSMREGIONINDEX_H
+
+#include "GeoDataCoordinates.h"
+#include "GeoDataLatLonAltBox.h"
+
+#include <QVector>
+
+namespace Marble
+{
+
+class GeoDataLinearRing;
+class OsmRegionTree;
+
+/**
+  * Spatial index of the regions of an OsmRegionTree. Gives the same results
+  * as OsmRegionTree::smallestRegionId(), but looks up candidate regions in a
+  * bulk loaded R-tree of their bounding boxes and tests them against prepared
+  * polygons instead of testing all children on each level of the tree.
+  *
+  * The index is immutable after construction and can be queried from several
+  * threads at once.
+  */
+class OsmRegionIndex
+{
+public:
+    explicit OsmRegionIndex( const OsmRegionTree &tree );
+
+    int smallestRegionId( const GeoDataCoordinates &coordinates ) const;
+
+    /** Looks up the regions of all positions in parallel batches */
+    QVector<int> smallestRegionIds( const QVector<GeoDataCoordinates> &positions ) const;
+
+private:
+    /**
+      * A linear ring whose edges are bucketed into longitude slabs, such that
+      * a point in polygon test only looks at the edges of a single slab
+      */
+    class PreparedRing
+    {
+    public:
+        PreparedRing();
+
+        explicit PreparedRing( const GeoDataLinearRing &ring );
+
+        bool contains( const GeoDataCoordinates &coordinates ) const;
+
+        GeoDataLatLonAltBox m_box;
+
+    private:
+        int slab( qreal lon ) const;
+
+        QVector<qreal> m_lon;
+        QVector<qreal> m_lat;
+        qreal m_minLon;
+        qreal m_maxLon;
+        qreal m_slabFactor;
+        int m_slabCount;
+        QVector<int> m_slabOffsets;
+        QVector<int> m_slabEdges;
+    };
+
+    struct Region
+    {
+        int identifier;
+        int adminLevel;
+        int parent;
+        PreparedRing outer;
+        QVector<PreparedRing> inner;
+    };
+
+    struct Node
+    {
+        qreal west;
+        qreal east;
+        qreal south;
+        qreal north;
+        int first;
+        int count;
+        bool leaf;
+    };
+
+    void addRegions( const OsmRegionTree &tree, int parent );
+
+    void bulkLoad();
+
+    bool contains( const Region &region, const GeoDataCoordinates &coordinates ) const;
+
+    int smallestRegionId( const QVector<int> &candidates, int index, int &level ) const;
+
+    /** Regions in tree preorder, the root of the tree first */
+    QVector<Region> m_regions;
+
+    QVector<Node> m_nodes;
+
+    /** Region indices of leaf nodes, node indices of inner nodes */
+    QVector<int> m_entries;
+
+    int m_root;
+};
+
+}
+
+#endif // MARBLE_OSMREGIONINDEX_H
@@ -36,18 +36,29 @@ const QVector<OsmRegionTree> & OsmRegionTree::children() const
 
 void OsmRegionTree::append( QList<OsmRegion> &regions )
 {
+    // Group the regions by their parent once instead of scanning all of them on each level
+    QHash<int, QList<OsmRegion> > regionsByParent;
     foreach( const OsmRegion &candidate, regions ) {
-        if ( candidate.parentIdentifier() == m_node.identifier() ) {
-            m_children << OsmRegionTree( candidate );
-        }
+        regionsByParent[candidate.parentIdentifier()] << candidate;
     }
 
-    foreach( const OsmRegionTree & child, m_children ) {
-        regions.removeAll( child.node() );
+    append( regionsByParent );
+
+    // Regions whose parent is not part of the tree are left over
+    regions.clear();
+    foreach( const QList<OsmRegion> &remaining, regionsByParent ) {
+        regions << remaining;
+    }
+}
+
+void OsmRegionTree::append( QHash<int, QList<OsmRegion> > &regionsByParent )
+{
+    foreach( const OsmRegion &candidate, regionsByParent.take( m_node.identifier() ) ) {
+        m_children << OsmRegionTree( candidate );
     }
 
     for ( int i = 0; i < m_children.size(); ++i ) {
-        m_children[i].append( regions );
+        m_children[i].append( regionsByParent );
     }
 }
 
@@ -13,6 +13,8 @@
 
 #include "OsmRegion.h"
 
+#include <QHash>
+#include <QList>
 #include <QVector>
 
 namespace Marble
@@ -38,6 +40,8 @@ public:
     int smallestRegionId( const GeoDataCoordinates &coordinates ) const;
 
 private:
+    void append( QHash<int, QList<OsmRegion> > &regionsByParent );
+
     int smallestRegionId( const GeoDataCoordinates &coordinates, int &level ) const;
 
     void enumerate( QList<OsmRegion> &list ) const;
@@ -10,6 +10,8 @@
 
 #include "SqlWriter.h"
 
+#include "OsmDatabase.h"
+
 #include <QVariant>
 #include <QDebug>
 #include <QSqlDatabase>
@@ -29,48 +31,31 @@ SqlWriter::SqlWriter( const QString &filename, QObject* parent ) :
         return;
     }
 
-    execQuery( "DROP TABLE IF EXISTS placemarks;" );
-    execQuery( "CREATE TABLE placemarks ("
-               " regionId INTEGER,"
-               " nameId INTEGER,"
-               " number VARCHAR(8),"
-               " category INTEGER,"
-               " lon FLOAT(8),"
-               " lat FLOAT(8) )" );
-    execQuery( "DROP TABLE IF EXISTS names" );
-    execQuery( "CREATE TABLE names ("
-               " id INTEGER PRIMARY KEY,"
-               " name VARCHAR(50) )" );
-    execQuery( "DROP TABLE IF EXISTS regions" );
-    execQuery( "CREATE TABLE regions ("
-               " id INTEGER PRIMARY KEY,"
-               " parent INTEGER NOT NULL,"
-               " lft INTEGER NOT NULL,"
-               " rgt INTEGER NOT NULL,"
-               " name VARCHAR(50),"
-               " lon FLOAT(8),"
-               " lat FLOAT(8) )" );
-    execQuery( "DROP VIEW IF EXISTS places" );
-    execQuery( "CREATE VIEW places AS "
-               " SELECT"
-               "  placemarks.regionId AS region,"
-               "  names.name AS name,"
-               "  placemarks.number AS number,"
-               "  placemarks.category AS category,"
-               "  placemarks.lon AS lon,"
-               "  placemarks.lat AS lat"
-               " FROM names"
-               " INNER JOIN placemarks"
-               " ON names.id=placemarks.nameId" );
+    OsmDatabase::createTables( database );
     execQuery( "BEGIN TRANSACTION" );
+
+    // Placemarks are streamed in one by one, prepare their queries only once
+    m_insertName = QSqlQuery( database );
+    m_insertName.prepare( "INSERT INTO names"
+                          " (id, name)"
+                          " VALUES (?, ?)" );
+    m_insertPlacemark = QSqlQuery( database );
+    m_insertPlacemark.prepare( "INSERT INTO placemarks"
+                               " (regionId, nameId, number, category, lon, lat)"
+                               " VALUES (?, ?, ?, ?, ?, ?)" );
 }
 
 SqlWriter::~SqlWriter()
 {
+    m_insertName.finish();
+    m_insertPlacemark.finish();
     execQuery( "END TRANSACTION" );
-    execQuery( "CREATE INDEX namesIndex ON names(name)" );
-    execQuery( "CREATE INDEX placemarksIndex ON placemarks(regionId,nameId,category)" );
-    execQuery( "CREATE INDEX regionsIndex ON regions(name,parent,lft,rgt)" );
+
+    QSqlDatabase database = QSqlDatabase::database();
+    OsmDatabase::createIndexes( database );
+    if ( !OsmDatabase::createSearchIndexes( database ) ) {
+        qWarning() << "SQLite lacks full text or r-tree support, searching the database will be slow";
+    }
 }
 
 void SqlWriter::addOsmRegion( const OsmRegion &region )
@@ -96,28 +81,20 @@ void SqlWriter::addOsmPlacemark( const OsmPlacemark &placemark )
         m_lastPlacemark.second = placemark.name();
         m_placemarks[m_lastPlacemark.second] = m_lastPlacemark.first;
 
-        QSqlQuery insertQuery;
-        insertQuery.prepare( "INSERT INTO names"
-                             " (id, name)"
-                             " VALUES (?, ?)" );
-        insertQuery.addBindValue( m_lastPlacemark.first );
-        insertQuery.addBindValue( m_lastPlacemark.second );
-        execQuery( insertQuery );
+        m_insertName.bindValue( 0, m_lastPlacemark.first );
+        m_insertName.bindValue( 1, m_lastPlacemark.second );
+        execQuery( m_insertName );
     }
 
     Q_ASSERT( m_placemarks.contains( placemark.name() ) );
 
-    QSqlQuery query;
-    query.prepare( "INSERT INTO placemarks"
-                   " (regionId, nameId, number, category, lon, lat)"
-                   " VALUES (?, ?, ?, ?, ?, ?)" );
-    query.addBindValue( ( qint32 ) placemark.regionId() );
-    query.addBindValue( m_placemarks[placemark.name()] );
-    query.addBindValue( placemark.houseNumber() );
-    query.addBindValue( ( qint32 ) placemark.category() );
-    query.addBindValue( placemark.longitude() );
-    query.addBindValue( placemark.latitude() );
-    execQuery( query );
+    m_insertPlacemark.bindValue( 0, ( qint32 ) placemark.regionId() );
+    m_insertPlacemark.bindValue( 1, m_placemarks[placemark.name()] );
+    m_insertPlacemark.bindValue( 2, placemark.houseNumber() );
+    m_insertPlacemark.bindValue( 3, ( qint32 ) placemark.category() );
+    m_insertPlacemark.bindValue( 4, placemark.longitude() );
+    m_insertPlacemark.bindValue( 5, placemark.latitude() );
+    execQuery( m_insertPlacemark );
 }
 
 void SqlWriter::execQuery( const QString &query ) const
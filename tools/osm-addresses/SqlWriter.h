@@ -43,6 +43,10 @@ private:
     QPair<int, QString> m_lastPlacemark;
 
     int m_placemarkId;
+
+    QSqlQuery m_insertName;
+
+    QSqlQuery m_insertPlacemark;
 };
 
 }
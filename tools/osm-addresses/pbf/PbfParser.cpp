@@ -15,20 +15,127 @@
 #include "PbfParser.h"
 
 #include <QDebug>
+#include <QMap>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QPair>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QTime>
+#include <QVector>
+#include <QWaitCondition>
 
 #include <zlib.h>
 
-#include <fstream>
-
-#include <netinet/in.h>
-
 using namespace std;
 using namespace OSMPBF;
 
+/**
+  * Converts the strings of a block on first use only, most blocks need few of them
+  */
+class PbfParser::StringTable
+{
+public:
+    explicit StringTable( const OSMPBF::StringTable &table ) :
+        m_table( table ),
+        m_strings( table.s_size() )
+    {
+    }
+
+    const QString &operator[]( int index )
+    {
+        QString &string = m_strings[index];
+        if ( string.isNull() ) {
+            const std::string &data = m_table.s( index );
+            string = QString::fromUtf8( data.data(), data.size() );
+        }
+        return string;
+    }
+
+private:
+    const OSMPBF::StringTable &m_table;
+    QVector<QString> m_strings;
+};
+
+/**
+  * Elements decoded from one block, merged into the parser in file order
+  */
+struct PbfParser::Block
+{
+    Block() : m_valid( false ) {}
+
+    bool m_valid;
+    QVector< QPair<int, Marble::Node> > m_nodes;
+    QVector< QPair<int, Marble::Coordinate> > m_coordinates;
+    QVector< QPair<int, Marble::Way> > m_ways;
+    QVector< QPair<int, Marble::Relation> > m_relations;
+    QVector<int> m_referencedWays;
+    QVector<int> m_referencedNodes;
+};
+
+/**
+  * Hands decoded blocks from the worker threads to the reading thread in file order
+  */
+class PbfParser::BlockQueue
+{
+public:
+    ~BlockQueue()
+    {
+        qDeleteAll( m_blocks );
+    }
+
+    void add( int index, Block *block )
+    {
+        QMutexLocker locker( &m_mutex );
+        m_blocks.insert( index, block );
+        m_blockAdded.wakeAll();
+    }
+
+    Block *take( int index, bool wait )
+    {
+        QMutexLocker locker( &m_mutex );
+        while ( !m_blocks.contains( index ) ) {
+            if ( !wait ) {
+                return 0;
+            }
+            m_blockAdded.wait( &m_mutex );
+        }
+        return m_blocks.take( index );
+    }
+
+private:
+    QMutex m_mutex;
+    QWaitCondition m_blockAdded;
+    QMap<int, Block*> m_blocks;
+};
+
+class PbfParser::BlockDecoder : public QRunnable
+{
+public:
+    BlockDecoder( PbfParser *parser, BlockQueue *queue, int index, const QByteArray &blobData ) :
+        m_parser( parser ),
+        m_queue( queue ),
+        m_index( index ),
+        m_blobData( blobData )
+    {
+    }
+
+    virtual void run()
+    {
+        Block *block = new Block;
+        m_parser->decodeBlock( m_blobData, *block );
+        m_queue->add( m_index, block );
+    }
+
+private:
+    PbfParser *const m_parser;
+    BlockQueue *const m_queue;
+    const int m_index;
+    const QByteArray m_blobData;
+};
+
 PbfParser::PbfParser() :
-    m_currentGroup( 0 ),
-    m_currentEntity( 0 ),
-    m_loadBlock( false )
+    m_pass( 0 )
 {
     GOOGLE_PROTOBUF_VERIFY_VERSION;
 }
@@ -44,142 +151,167 @@ bool PbfParser::parse( const QFileInfo &fileInfo, int pass, bool &needAnotherPas
         return false;
     }
 
-    m_stream.setDevice( &file );
-    m_stream.setByteOrder( QDataStream::BigEndian );
+    QDataStream stream( &file );
+    stream.setByteOrder( QDataStream::BigEndian );
 
-    if ( !parseBlobHeader() ) {
+    BlobHeader blobHeader;
+    QByteArray blobData;
+    if ( !readBlob( stream, blobHeader, blobData ) ) {
         return false;
     }
 
-    if ( m_blobHeader.type() != "OSMHeader" ) {
-        qCritical() << "Unable to parse blob header type " << m_blobHeader.type().c_str();
+    if ( blobHeader.type() != "OSMHeader" ) {
+        qCritical() << "Unable to parse blob header type " << blobHeader.type().c_str();
         return false;
     }
 
-    if ( !parseBlob() ) {
+    QByteArray buffer;
+    if ( !inflateBlob( blobData, buffer ) || !parseHeader( buffer ) ) {
         return false;
     }
 
-    if ( !parseData() ) {
-        return false;
-    }
+    // Initialize the lookup tables of the base class before the workers share them
+    shouldSave( Marble::NodeType, QString(), QString() );
 
-    m_loadBlock = true;
+    QTime timer;
+    timer.start();
 
-    while ( true ) {
+    BlockQueue queue;
+    QThreadPool pool;
+    // Limits the memory used by blocks that are read or decoded, but not merged yet
+    int const maxPendingBlocks = 4 * qMax( 1, pool.maxThreadCount() );
+    int readBlocks = 0;
+    int mergedBlocks = 0;
+    bool success = true;
 
-        if ( m_loadBlock ) {
-            if ( !readNext() ) {
-                if ( pass == 1 ) {
-                    m_referencedWays.clear();
-                } else if ( pass == 2 ) {
-                    m_referencedNodes.clear();
-                }
+    while ( success && !stream.atEnd() ) {
+        if ( !readBlob( stream, blobHeader, blobData ) ) {
+            success = false;
+            break;
+        }
 
-                return true;
+        if ( blobHeader.type() != "OSMData" ) {
+            qCritical() << "invalid block type, found" << blobHeader.type().data() << "instead of OSMData";
+            success = false;
+            break;
+        }
+
+        pool.start( new BlockDecoder( this, &queue, readBlocks, blobData ) );
+        ++readBlocks;
+
+        // Merge all blocks that are decoded already, wait if too many are pending
+        while ( success && mergedBlocks < readBlocks ) {
+            Block *block = queue.take( mergedBlocks, readBlocks - mergedBlocks >= maxPendingBlocks );
+            if ( !block ) {
+                break;
             }
-            loadBlock();
-            loadGroup();
+            ++mergedBlocks;
+            success = block->m_valid;
+            if ( success ) {
+                mergeBlock( *block );
+            }
+            delete block;
         }
+    }
 
-        switch ( m_mode ) {
-        case ModeNode:
-            parseNode();
-            break;
-        case ModeWay:
-            parseWay();
-            break;
-        case ModeRelation:
-            parseRelation();
-            break;
-        case ModeDense:
-            parseDense();
-            break;
+    for ( ; mergedBlocks < readBlocks; ++mergedBlocks ) {
+        Block *block = queue.take( mergedBlocks, true );
+        success = success && block->m_valid;
+        if ( success ) {
+            mergeBlock( *block );
         }
+        delete block;
     }
 
-    return true;
+    qreal const seconds = qMax( 1, timer.elapsed() ) / 1000.0;
+    qreal const megaBytes = file.pos() / ( 1024.0 * 1024.0 );
+    qWarning() << "Pass" << pass << "decoded" << readBlocks << "blocks (" << megaBytes << "MB) in" << seconds << "s using"
+               << pool.maxThreadCount() << "threads:" << megaBytes / seconds << "MB/s," << readBlocks / seconds << "blocks/s";
+
+    if ( pass == 1 ) {
+        m_referencedWays.clear();
+    } else if ( pass == 2 ) {
+        m_referencedNodes.clear();
+    }
+
+    return success;
 }
 
-bool PbfParser::parseBlobHeader()
+bool PbfParser::readBlob( QDataStream &stream, BlobHeader &blobHeader, QByteArray &blobData )
 {
     int size( -1 );
-    m_stream >> size;
+    stream >> size;
 
     if ( size < 0 ) {
         qCritical() << "Invalid blob header size " << size;
         return false;
     }
 
-    m_buffer.resize( size );
-    int readBytes = m_stream.readRawData( m_buffer.data(), size );
-    if ( readBytes != size ) {
+    QByteArray buffer;
+    buffer.resize( size );
+    if ( stream.readRawData( buffer.data(), size ) != size ) {
         qCritical() << "Unable to read blob header";
         return false;
     }
 
-    if ( !m_blobHeader.ParseFromArray( m_buffer.constData(), size ) ) {
+    if ( !blobHeader.ParseFromArray( buffer.constData(), size ) ) {
         qCritical() << "Unable to parse blob header";
         return false;
     }
 
-    return true;
-}
-
-bool PbfParser::parseBlob()
-{
-    int size = m_blobHeader.datasize();
-    if ( size < 0 ) {
-        qCritical() << "invalid blob size:" << size;
+    int const dataSize = blobHeader.datasize();
+    if ( dataSize < 0 ) {
+        qCritical() << "invalid blob size:" << dataSize;
         return false;
     }
 
-    m_buffer.resize( size );
-    int readBytes = m_stream.readRawData( m_buffer.data(), size );
-    if ( readBytes != size ) {
+    blobData.resize( dataSize );
+    if ( stream.readRawData( blobData.data(), dataSize ) != dataSize ) {
         qCritical() << "failed to read blob";
         return false;
     }
 
-    if ( !m_blob.ParseFromArray( m_buffer.constData(), size ) ) {
+    return true;
+}
+
+bool PbfParser::inflateBlob( const QByteArray &blobData, QByteArray &buffer )
+{
+    Blob blob;
+    if ( !blob.ParseFromArray( blobData.constData(), blobData.size() ) ) {
         qCritical() << "failed to parse blob";
         return false;
     }
 
-    if ( m_blob.has_raw() ) {
-        const std::string& data = m_blob.raw();
-        m_buffer.resize( data.size() );
-        for ( unsigned int i = 0; i < data.size(); ++i ) {
-            m_buffer[i] = data[i];
-        }
-    } else if ( m_blob.has_zlib_data() ) {
-        m_buffer.resize( m_blob.raw_size() );
+    if ( blob.has_raw() ) {
+        const std::string& data = blob.raw();
+        buffer = QByteArray( data.data(), data.size() );
+    } else if ( blob.has_zlib_data() ) {
+        buffer.resize( blob.raw_size() );
         z_stream zStream;
-        zStream.next_in = ( unsigned char* ) m_blob.zlib_data().data();
-        zStream.avail_in = m_blob.zlib_data().size();
-        zStream.next_out = ( unsigned char* ) m_buffer.data();
-        zStream.avail_out = m_blob.raw_size();
+        zStream.next_in = ( unsigned char* ) blob.zlib_data().data();
+        zStream.avail_in = blob.zlib_data().size();
+        zStream.next_out = ( unsigned char* ) buffer.data();
+        zStream.avail_out = blob.raw_size();
         zStream.zalloc = Z_NULL;
         zStream.zfree = Z_NULL;
         zStream.opaque = Z_NULL;
         int result = inflateInit( &zStream );
         if ( result != Z_OK ) {
-            qCritical() << "failed to open zlib m_stream";
+            qCritical() << "failed to open zlib stream";
             return false;
         }
         result = inflate( &zStream, Z_FINISH );
         if ( result != Z_STREAM_END ) {
-            qCritical() << "failed to inflate zlib m_stream";
+            qCritical() << "failed to inflate zlib stream";
+            inflateEnd( &zStream );
             return false;
         }
         result = inflateEnd( &zStream );
         if ( result != Z_OK ) {
-            qCritical() << "failed to close zlib m_stream";
+            qCritical() << "failed to close zlib stream";
             return false;
         }
-
-        return true;
-    } else if ( m_blob.has_lzma_data() ) {
+    } else if ( blob.has_lzma_data() ) {
         qCritical() << "No support for lzma decryption implemented, sorry.";
         return false;
     } else {
@@ -190,15 +322,16 @@ bool PbfParser::parseBlob()
     return true;
 }
 
-bool PbfParser::parseData()
+bool PbfParser::parseHeader( const QByteArray &buffer )
 {
-    if ( !m_headerBlock.ParseFromArray( m_buffer.data(), m_buffer.size() ) ) {
+    HeaderBlock headerBlock;
+    if ( !headerBlock.ParseFromArray( buffer.constData(), buffer.size() ) ) {
         qCritical() << "failed to parse header block";
         return false;
     }
 
-    for ( int i = 0; i < m_headerBlock.required_features_size(); ++i ) {
-        string const & feature = m_headerBlock.required_features( i );
+    for ( int i = 0; i < headerBlock.required_features_size(); ++i ) {
+        string const & feature = headerBlock.required_features( i );
         if ( feature != "OsmSchema-V0.6" && feature != "DenseNodes" ) {
             qCritical() << "Support for feature " << feature.c_str() << "not implemented";
             return false;
@@ -208,115 +341,91 @@ bool PbfParser::parseData()
     return true;
 }
 
-bool PbfParser::readNext()
+void PbfParser::decodeBlock( const QByteArray &blobData, Block &block )
 {
-    if ( !parseBlobHeader() )
-        return false;
-
-    if ( m_blobHeader.type() != "OSMData" ) {
-        qCritical() << "invalid block type, found" << m_blobHeader.type().data() << "instead of OSMData";
-        return false;
+    QByteArray buffer;
+    if ( !inflateBlob( blobData, buffer ) ) {
+        return;
     }
 
-    if ( !parseBlob() )
-        return false;
-
-    if ( !m_primitiveBlock.ParseFromArray( m_buffer.data(), m_buffer.size() ) ) {
+    PrimitiveBlock primitiveBlock;
+    if ( !primitiveBlock.ParseFromArray( buffer.constData(), buffer.size() ) ) {
         qCritical() << "failed to parse PrimitiveBlock";
-        return false;
+        return;
     }
-    return true;
-}
 
-void PbfParser::loadGroup()
-{
-    const PrimitiveGroup& group = m_primitiveBlock.primitivegroup( m_currentGroup );
-    if ( group.nodes_size() != 0 ) {
-        m_mode = ModeNode;
-    } else if ( group.ways_size() != 0 ) {
-        m_mode = ModeWay;
-    } else if ( group.relations_size() != 0 ) {
-        m_mode = ModeRelation;
-    } else if ( group.has_dense() )  {
-        m_mode = ModeDense;
-        m_lastDenseID = 0;
-        m_lastDenseTag = 0;
-        m_lastDenseLatitude = 0;
-        m_lastDenseLongitude = 0;
-        assert( group.dense().id_size() != 0 );
-    } else
-        assert( false );
+    StringTable strings( primitiveBlock.stringtable() );
+    for ( int i = 0; i < primitiveBlock.primitivegroup_size(); ++i ) {
+        const PrimitiveGroup &group = primitiveBlock.primitivegroup( i );
+        if ( m_pass == 0 ) {
+            parseRelations( primitiveBlock, group, strings, block );
+        } else if ( m_pass == 1 ) {
+            parseWays( group, strings, block );
+        } else if ( m_pass == 2 ) {
+            parseNodes( primitiveBlock, group, strings, block );
+            if ( group.has_dense() ) {
+                parseDense( primitiveBlock, group, strings, block );
+            }
+        }
+    }
+
+    block.m_valid = true;
 }
 
-void PbfParser::loadBlock()
+void PbfParser::parseNodeTag( Marble::Node &node, const QString &key, const QString &value )
 {
-    m_loadBlock = false;
-    m_currentGroup = 0;
-    m_currentEntity = 0;
+    if ( key == "name" ) {
+        node.name = value.trimmed();
+    } else if ( key == "addr:street" ) {
+        node.street = value.trimmed();
+        node.save = true;
+    } else if ( key == "addr:housenumber" ) {
+        node.houseNumber = value;
+        node.save = true;
+    } else if ( key == "addr:city" ) {
+        node.city = value;
+        node.save = true;
+    } else {
+        if ( shouldSave( Marble::NodeType, key, value ) ) {
+            node.save = true;
+        }
+        setCategory( node, key, value );
+    }
 }
 
-void PbfParser::parseNode()
+void PbfParser::parseNodes( const PrimitiveBlock &primitiveBlock, const PrimitiveGroup &group, StringTable &strings, Block &block )
 {
-    if ( m_pass == 2 ) {
-        const Node& inputNode = m_primitiveBlock.primitivegroup( m_currentGroup ).nodes( m_currentEntity );
+    for ( int i = 0; i < group.nodes_size(); ++i ) {
+        const Node& inputNode = group.nodes( i );
         Marble::Node node;
-        node.lat = ( ( double ) inputNode.lat() * m_primitiveBlock.granularity() + m_primitiveBlock.lat_offset() ) / ( 1000.0 * 1000.0 * 1000.0 );
-        node.lon = ( ( double ) inputNode.lon() * m_primitiveBlock.granularity() + m_primitiveBlock.lon_offset() ) / ( 1000.0 * 1000.0 * 1000.0 );
+        node.lat = ( ( double ) inputNode.lat() * primitiveBlock.granularity() + primitiveBlock.lat_offset() ) / ( 1000.0 * 1000.0 * 1000.0 );
+        node.lon = ( ( double ) inputNode.lon() * primitiveBlock.granularity() + primitiveBlock.lon_offset() ) / ( 1000.0 * 1000.0 * 1000.0 );
 
         for ( int tag = 0; tag < inputNode.keys_size(); tag++ ) {
-
-            QString key = QString::fromUtf8( m_primitiveBlock.stringtable().s( inputNode.keys( tag ) ).data() );
-            QString value = QString::fromUtf8( m_primitiveBlock.stringtable().s( inputNode.vals( tag ) ).data() );
-
-            if ( key == "name" ) {
-                node.name = value.trimmed();
-            } else if ( key == "addr:street" ) {
-                node.street = value.trimmed();
-                node.save = true;
-            } else if ( key == "addr:housenumber" ) {
-                node.houseNumber = value;
-                node.save = true;
-            } else if ( key == "addr:city" ) {
-                node.city = value;
-                node.save = true;
-            } else {
-                if ( shouldSave( Marble::NodeType, key, value ) ) {
-                    node.save = true;
-                }
-                setCategory( node, key, value );
-            }
+            parseNodeTag( node, strings[inputNode.keys( tag )], strings[inputNode.vals( tag )] );
         }
 
         if ( node.save ) {
-            m_nodes[inputNode.id()] = node;
+            block.m_nodes << qMakePair<int, Marble::Node>( inputNode.id(), node );
         }
 
         if ( m_referencedNodes.contains( inputNode.id() ) ) {
-            m_coordinates[inputNode.id()] = node;
+            block.m_coordinates << qMakePair<int, Marble::Coordinate>( inputNode.id(), node );
         }
     }
-
-    m_currentEntity++;
-    if ( m_currentEntity >= m_primitiveBlock.primitivegroup( m_currentGroup ).nodes_size() ) {
-        m_currentEntity = 0;
-        m_currentGroup++;
-        if ( m_currentGroup >= m_primitiveBlock.primitivegroup_size() )
-            m_loadBlock = true;
-        else
-            loadGroup();
-    }
 }
 
-void PbfParser::parseWay()
+void PbfParser::parseWays( const PrimitiveGroup &group, StringTable &strings, Block &block )
 {
-    if ( m_pass == 1 ) {
-        const Way& inputWay = m_primitiveBlock.primitivegroup( m_currentGroup ).ways( m_currentEntity );
+    for ( int i = 0; i < group.ways_size(); ++i ) {
+        const Way& inputWay = group.ways( i );
         Marble::Way way;
+        way.isBuilding = false;
         Marble::Relation relation;
 
         for ( int tag = 0; tag < inputWay.keys_size(); tag++ ) {
-            QString key = QString::fromUtf8( m_primitiveBlock.stringtable().s( inputWay.keys( tag ) ).data() );
-            QString value = QString::fromUtf8( m_primitiveBlock.stringtable().s( inputWay.vals( tag ) ).data() );
+            const QString &key = strings[inputWay.keys( tag )];
+            const QString &value = strings[inputWay.vals( tag )];
 
             if ( key == "name" ) {
                 way.name = value.trimmed();
@@ -344,19 +453,20 @@ void PbfParser::parseWay()
         }
 
         long long lastRef = 0;
-        for ( int i = 0; i < inputWay.refs_size(); i++ ) {
-            lastRef += inputWay.refs( i );
+        for ( int ref = 0; ref < inputWay.refs_size(); ref++ ) {
+            lastRef += inputWay.refs( ref );
             way.nodes.push_back( lastRef );
         }
 
         if ( relation.isAdministrativeBoundary && !way.name.isEmpty() ) {
             relation.name = way.name;
             relation.ways << QPair<int, Marble::RelationRole>( inputWay.id(), Marble::Outer );
-            m_relations[inputWay.id()] = relation;
+            block.m_relations << qMakePair<int, Marble::Relation>( inputWay.id(), relation );
         }
 
-        if ( way.save || m_referencedWays.contains( inputWay.id() ) ) {
-            if ( !way.isBuilding && way.nodes.size() > 1 && !m_referencedWays.contains( inputWay.id() ) ) {
+        bool const referenced = m_referencedWays.contains( inputWay.id() );
+        if ( way.save || referenced ) {
+            if ( !way.isBuilding && way.nodes.size() > 1 && !referenced ) {
                 QList<int> nodes = way.nodes;
                 way.nodes.clear();
                 way.nodes << nodes.first();
@@ -367,34 +477,23 @@ void PbfParser::parseWay()
             }
 
             foreach( int node, way.nodes ) {
-                m_referencedNodes << node;
+                block.m_referencedNodes << node;
             }
 
-            m_ways[inputWay.id()] = way;
+            block.m_ways << qMakePair<int, Marble::Way>( inputWay.id(), way );
         }
     }
-
-    m_currentEntity++;
-    if ( m_currentEntity >= m_primitiveBlock.primitivegroup( m_currentGroup ).ways_size() ) {
-        m_currentEntity = 0;
-        m_currentGroup++;
-        if ( m_currentGroup >= m_primitiveBlock.primitivegroup_size() )
-            m_loadBlock = true;
-        else
-            loadGroup();
-    }
 }
 
-void PbfParser::parseRelation()
+void PbfParser::parseRelations( const PrimitiveBlock &primitiveBlock, const PrimitiveGroup &group, StringTable &strings, Block &block )
 {
-    if ( m_pass == 0 ) {
-        const Relation& inputRelation = m_primitiveBlock.primitivegroup( m_currentGroup ).relations( m_currentEntity );
+    for ( int i = 0; i < group.relations_size(); ++i ) {
+        const Relation& inputRelation = group.relations( i );
         Marble::Relation relation;
 
         for ( int tag = 0; tag < inputRelation.keys_size(); tag++ ) {
-
-            QString key = QString::fromUtf8( m_primitiveBlock.stringtable().s( inputRelation.keys( tag ) ).data() );
-            QString value = QString::fromUtf8( m_primitiveBlock.stringtable().s( inputRelation.vals( tag ) ).data() );
+            const QString &key = strings[inputRelation.keys( tag )];
+            const QString &value = strings[inputRelation.vals( tag )];
 
             if ( key == "boundary" && value == "administrative" ) {
                 relation.isAdministrativeBoundary = true;
@@ -409,18 +508,18 @@ void PbfParser::parseRelation()
 
         if ( relation.isAdministrativeBoundary ) {
             long long lastRef = 0;
-            for ( int i = 0; i < inputRelation.types_size(); i++ ) {
-                lastRef += inputRelation.memids( i );
-                switch ( inputRelation.types( i ) ) {
+            for ( int member = 0; member < inputRelation.types_size(); member++ ) {
+                lastRef += inputRelation.memids( member );
+                switch ( inputRelation.types( member ) ) {
                 case OSMPBF::Relation::NODE:
                     relation.nodes.push_back( lastRef );
                     break;
                 case OSMPBF::Relation::WAY: {
-                    string role = m_primitiveBlock.stringtable().s( inputRelation.roles_sid( i ) ).data();
+                    const string &role = primitiveBlock.stringtable().s( inputRelation.roles_sid( member ) );
                     Marble::RelationRole relationRole = Marble::None;
                     if ( role == "outer" ) relationRole = Marble::Outer;
                     if ( role == "inner" ) relationRole = Marble::Inner;
-                    m_referencedWays << lastRef;
+                    block.m_referencedWays << lastRef;
                     relation.ways.push_back( QPair<int, Marble::RelationRole>( lastRef, relationRole ) );
                 }
                 break;
@@ -429,84 +528,72 @@ void PbfParser::parseRelation()
                 }
             }
 
-            m_relations[inputRelation.id()] = relation;
+            block.m_relations << qMakePair<int, Marble::Relation>( inputRelation.id(), relation );
         }
     }
-
-    m_currentEntity++;
-    if ( m_currentEntity >= m_primitiveBlock.primitivegroup( m_currentGroup ).relations_size() ) {
-        m_currentEntity = 0;
-        m_currentGroup++;
-        if ( m_currentGroup >= m_primitiveBlock.primitivegroup_size() )
-            m_loadBlock = true;
-        else
-            loadGroup();
-    }
 }
 
-void PbfParser::parseDense()
+void PbfParser::parseDense( const PrimitiveBlock &primitiveBlock, const PrimitiveGroup &group, StringTable &strings, Block &block )
 {
-    const DenseNodes& dense = m_primitiveBlock.primitivegroup( m_currentGroup ).dense();
-    if ( m_pass == 2 ) {
-        m_lastDenseID += dense.id( m_currentEntity );
-        m_lastDenseLatitude += dense.lat( m_currentEntity );
-        m_lastDenseLongitude += dense.lon( m_currentEntity );
+    const DenseNodes& dense = group.dense();
+    long long denseId = 0;
+    long long denseLatitude = 0;
+    long long denseLongitude = 0;
+    int denseTag = 0;
 
-        Marble::Node node;
-        node.lat = ( ( double ) m_lastDenseLatitude * m_primitiveBlock.granularity() + m_primitiveBlock.lat_offset() ) / ( 1000.0 * 1000.0 * 1000.0 );
-        node.lon = ( ( double ) m_lastDenseLongitude * m_primitiveBlock.granularity() + m_primitiveBlock.lon_offset() ) / ( 1000.0 * 1000.0 * 1000.0 );
+    for ( int i = 0; i < dense.id_size(); ++i ) {
+        denseId += dense.id( i );
+        denseLatitude += dense.lat( i );
+        denseLongitude += dense.lon( i );
 
-        while ( true ) {
-            if ( m_lastDenseTag >= dense.keys_vals_size() )
-                break;
+        Marble::Node node;
+        node.lat = ( ( double ) denseLatitude * primitiveBlock.granularity() + primitiveBlock.lat_offset() ) / ( 1000.0 * 1000.0 * 1000.0 );
+        node.lon = ( ( double ) denseLongitude * primitiveBlock.granularity() + primitiveBlock.lon_offset() ) / ( 1000.0 * 1000.0 * 1000.0 );
 
-            int tagValue = dense.keys_vals( m_lastDenseTag );
+        while ( denseTag < dense.keys_vals_size() ) {
+            int tagValue = dense.keys_vals( denseTag );
             if ( tagValue == 0 ) {
-                m_lastDenseTag++;
+                denseTag++;
                 break;
             }
 
-            QString key = QString::fromUtf8( m_primitiveBlock.stringtable().s( dense.keys_vals( m_lastDenseTag ) ).data() );
-            QString value = QString::fromUtf8( m_primitiveBlock.stringtable().s( dense.keys_vals( m_lastDenseTag + 1 ) ).data() );
-
-            if ( key == "name" ) {
-                node.name = value.trimmed();
-            } else if ( key == "addr:street" ) {
-                node.street = value.trimmed();
-                node.save = true;
-            } else if ( key == "addr:housenumber" ) {
-                node.houseNumber = value;
-                node.save = true;
-            } else if ( key == "addr:city" ) {
-                node.city = value;
-                node.save = true;
-            } else {
-                if ( shouldSave( Marble::NodeType, key, value ) ) {
-                    node.save = true;
-                }
-                setCategory( node, key, value );
-            }
-
-            m_lastDenseTag += 2;
+            parseNodeTag( node, strings[tagValue], strings[dense.keys_vals( denseTag + 1 )] );
+            denseTag += 2;
         }
 
-        if ( node.save) {
-            m_nodes[m_lastDenseID] = node;
+        if ( node.save ) {
+            block.m_nodes << qMakePair<int, Marble::Node>( denseId, node );
         }
 
-        if ( m_referencedNodes.contains( m_lastDenseID ) ) {
-            m_coordinates[m_lastDenseID] = node;
+        if ( m_referencedNodes.contains( denseId ) ) {
+            block.m_coordinates << qMakePair<int, Marble::Coordinate>( denseId, node );
         }
     }
+}
 
-    ++m_currentEntity;
-    if ( m_currentEntity >= dense.id_size() ) {
-        m_currentEntity = 0;
-        m_currentGroup++;
-        if ( m_currentGroup >= m_primitiveBlock.primitivegroup_size() ) {
-            m_loadBlock = true;
-        } else {
-            loadGroup();
-        }
+void PbfParser::mergeBlock( const Block &block )
+{
+    for ( int i = 0; i < block.m_nodes.size(); ++i ) {
+        m_nodes[block.m_nodes[i].first] = block.m_nodes[i].second;
+    }
+
+    for ( int i = 0; i < block.m_coordinates.size(); ++i ) {
+        m_coordinates[block.m_coordinates[i].first] = block.m_coordinates[i].second;
+    }
+
+    for ( int i = 0; i < block.m_ways.size(); ++i ) {
+        m_ways[block.m_ways[i].first] = block.m_ways[i].second;
+    }
+
+    for ( int i = 0; i < block.m_relations.size(); ++i ) {
+        m_relations[block.m_relations[i].first] = block.m_relations[i].second;
+    }
+
+    for ( int i = 0; i < block.m_referencedWays.size(); ++i ) {
+        m_referencedWays << block.m_referencedWays[i];
+    }
+
+    for ( int i = 0; i < block.m_referencedNodes.size(); ++i ) {
+        m_referencedNodes << block.m_referencedNodes[i];
     }
 }
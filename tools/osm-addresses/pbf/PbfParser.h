@@ -25,6 +25,11 @@
 #include <QFile>
 #include <QDataStream>
 
+/**
+  * Reads OSM PBF files in a pipeline: The calling thread reads the blob boundaries
+  * from the file, a thread pool inflates and decodes the blocks in parallel and the
+  * decoded blocks are merged into the parser in file order.
+  */
 class PbfParser : public Marble::OsmParser
 {
 public:
@@ -33,57 +38,31 @@ public:
     virtual bool parse( const QFileInfo &file, int pass, bool &needAnotherPass );
 
 private:
-    enum Mode {
-        ModeNode,
-        ModeWay,
-        ModeRelation,
-        ModeDense
-    };
+    class StringTable;
+    struct Block;
+    class BlockQueue;
+    class BlockDecoder;
 
-    bool parseBlobHeader();
+    static bool readBlob( QDataStream &stream, OSMPBF::BlobHeader &blobHeader, QByteArray &blobData );
 
-    bool parseBlob();
+    static bool inflateBlob( const QByteArray &blobData, QByteArray &buffer );
 
-    bool parseData();
+    bool parseHeader( const QByteArray &buffer );
 
-    bool readNext();
+    void decodeBlock( const QByteArray &blobData, Block &block );
 
-    void loadBlock();
+    void parseNodes( const OSMPBF::PrimitiveBlock &primitiveBlock, const OSMPBF::PrimitiveGroup &group, StringTable &strings, Block &block );
 
-    void loadGroup();
+    void parseWays( const OSMPBF::PrimitiveGroup &group, StringTable &strings, Block &block );
 
-    void parseNode();
+    void parseRelations( const OSMPBF::PrimitiveBlock &primitiveBlock, const OSMPBF::PrimitiveGroup &group, StringTable &strings, Block &block );
 
-    void parseWay();
+    void parseDense( const OSMPBF::PrimitiveBlock &primitiveBlock, const OSMPBF::PrimitiveGroup &group, StringTable &strings, Block &block );
 
-    void parseRelation();
+    void parseNodeTag( Marble::Node &node, const QString &key, const QString &value );
 
-    void parseDense();
+    void mergeBlock( const Block &block );
 
-    QByteArray m_buffer;
-
-    QDataStream m_stream;
-
-    OSMPBF::BlobHeader m_blobHeader;
-
-    OSMPBF::Blob m_blob;
-
-    OSMPBF::HeaderBlock m_headerBlock;
-
-    OSMPBF::PrimitiveBlock m_primitiveBlock;
-
-    Mode m_mode;
-
-    int m_currentGroup;
-
-    int m_currentEntity;
-
-    bool m_loadBlock;
-
-    long long m_lastDenseID;
-    long long m_lastDenseLatitude;
-    long long m_lastDenseLongitude;
-    int m_lastDenseTag;
     int m_pass;
 
     QSet<int> m_referencedWays;
@@ -0,0 +1,115 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+// Copyright 2014 The Marble contributors
+//
+
+// Renders the first tour of a KML file into a movie or an image sequence
+// without a window. Frames are rendered at a fixed time step, so the result
+// does not depend on the speed of the machine.
+
+#include <GeoDataContainer.h>
+#include <GeoDataDocument.h>
+#include <GeoDataTour.h>
+#include <GeoDataTreeModel.h>
+#include <GeoDataTypes.h>
+#include <MarbleMap.h>
+#include <MarbleModel.h>
+#include <ParsingRunnerManager.h>
+#include <TourRenderer.h>
+
+#include <QApplication>
+#include <QDebug>
+#include <QStringList>
+#include <QThread>
+
+using namespace Marble;
+
+GeoDataTour *findTour( GeoDataFeature *feature )
+{
+    if ( feature && feature->nodeType() == GeoDataTypes::GeoDataTourType ) {
+        return static_cast<GeoDataTour*>( feature );
+    }
+
+    GeoDataContainer *container = dynamic_cast<GeoDataContainer*>( feature );
+    if ( container ) {
+        foreach ( GeoDataFeature *child, container->featureList() ) {
+            GeoDataTour *tour = findTour( child );
+            if ( tour ) {
+                return tour;
+            }
+        }
+    }
+    return 0;
+}
+
+QString stringArgument( const QStringList &arguments, const QString &name, const QString &defaultValue )
+{
+    int const index = arguments.indexOf( name );
+    if ( index > 0 && index + 1 < arguments.size() ) {
+        return arguments.at( index + 1 );
+    }
+    return defaultValue;
+}
+
+int intArgument( const QStringList &arguments, const QString &name, int defaultValue )
+{
+    return stringArgument( arguments, name, QString::number( defaultValue ) ).toInt();
+}
+
+int main(int argc, char** argv)
+{
+    QApplication app(argc,argv);
+
+    QStringList const arguments = app.arguments();
+    QString const tourFile = stringArgument( arguments, "-i", QString() );
+    QString const outputFile = stringArgument( arguments, "-o", QString() );
+    if ( tourFile.isEmpty() || outputFile.isEmpty() ) {
+        qDebug( " Syntax: tour-render -i tour.kml -o output [-m maptheme] [-s widthxheight] [-r fps]" );
+        qDebug( "                     [-w max-wait-msecs] [-t writer-threads]" );
+        qDebug( " An output file name containing %%1 is written as image sequence, e.g. frames/%%1.png" );
+        qDebug( " Other output files are encoded as movie with avconv or ffmpeg, e.g. tour.mp4" );
+        return 1;
+    }
+
+    MarbleModel model;
+    ParsingRunnerManager parser( model.pluginManager() );
+    GeoDataDocument *document = parser.openFile( tourFile );
+    GeoDataTour *tour = findTour( document );
+    if ( !tour ) {
+        qDebug() << "No tour found in" << tourFile;
+        delete document;
+        return 2;
+    }
+    // Animated updates of the tour change features of the document
+    model.treeModel()->addDocument( document );
+
+    QStringList const size = stringArgument( arguments, "-s", "1920x1080" ).split( 'x' );
+    if ( size.size() != 2 ) {
+        qDebug() << "Invalid size" << stringArgument( arguments, "-s", QString() );
+        return 1;
+    }
+
+    TourRenderer renderer( &model );
+    renderer.map()->setMapThemeId( stringArgument( arguments, "-m", "earth/bluemarble/bluemarble.dgml" ) );
+    renderer.setSize( QSize( size.at( 0 ).toInt(), size.at( 1 ).toInt() ) );
+    renderer.setFramesPerSecond( intArgument( arguments, "-r", 30 ) );
+    renderer.setMaximumWaitTime( intArgument( arguments, "-w", 0 ) );
+    renderer.setWriterThreadCount( intArgument( arguments, "-t", QThread::idealThreadCount() ) );
+    renderer.setOutputFile( outputFile );
+    renderer.setTour( tour );
+
+    qDebug() << "Rendering" << renderer.frameCount() << "frames";
+    bool const success = renderer.render();
+    if ( !success ) {
+        qDebug() << renderer.errorString();
+    }
+
+    model.treeModel()->removeDocument( document );
+    delete document;
+    return success ? 0 : 3;
+}